@@ -77,6 +77,7 @@
 #include "GteCuller.h"
 #include "GteCullingPlane.h"
 #include "GteMeshFactory.h"
+#include "GteMeshOptimizer.h"
 #include "GteNode.h"
 #include "GtePicker.h"
 #include "GtePickRecord.h"
@@ -183,9 +184,6 @@
 #include "GteLogToMessageBox.h"
 #include "GteLogToOutputWindow.h"
 
-// LowLevel/Timer
-#include "GteTimer.h"
-
 // Physics/Fluid2
 #include "GteFluid2.h"
 #include "GteFluid2AdjustVelocity.h"
@@ -211,23 +209,31 @@
 #endif
 
 // Imagics
+#include "GteBrickedImage3.h"
 #include "GteHistogram.h"
 #include "GteImage.h"
 #include "GteImage1.h"
 #include "GteImage2.h"
 #include "GteImage3.h"
+#include "GteImageChunkReader.h"
+#include "GteImageConvolution.h"
 #include "GteImageUtility2.h"
 #include "GteImageUtility3.h"
 #include "GteMarchingCubes.h"
 #include "GteMarchingCubesTable.h"
+#include "GteMorphologyFilter.h"
 #include "GteSurfaceExtractor.h"
 
 // LowLevel/DataTypes
 #include "GteArray2.h"
 #include "GteAtomicMinMax.h"
+#include "GteBarrier.h"
+#include "GteLockFreeQueue.h"
 #include "GteRangeIteration.h"
+#include "GteThreadPool.h"
 #include "GteThreadSafeMap.h"
 #include "GteThreadSafeQueue.h"
+#include "GteThreadSafeShardedMap.h"
 
 // LowLevel/Graphs
 #include "GteEdgeKey.h"
@@ -246,6 +252,11 @@
 
 // LowLevel/Memory
 #include "GteMemory.h"
+#include "GteMemoryMappedFile.h"
+
+// LowLevel/Timer
+#include "GteProfiler.h"
+#include "GteTimer.h"
 
 // Mathematics/Algebra
 #include "GteAxisAngle.h"
@@ -305,6 +316,7 @@
 #include "GteDelaunay3.h"
 #include "GteDelaunay3Mesh.h"
 #include "GteGenerateMeshUV.h"
+#include "GteMeshSimplifier.h"
 #include "GteMinimumAreaBox2.h"
 #include "GteMinimumAreaCircle2.h"
 #include "GteMinimumVolumeBox3.h"
@@ -584,6 +596,7 @@
 #include "GteLinearSystem.h"
 #include "GteMinimize1.h"
 #include "GteMinimizeN.h"
+#include "GteOdeEnsemble.h"
 #include "GteOdeEuler.h"
 #include "GteOdeImplicitEuler.h"
 #include "GteOdeMidpoint.h"
@@ -598,11 +611,23 @@
 // Mathematics/Projection
 #include "GteProjection.h"
 
+// Physics/Fluid2
+#include "GteFluid2CPU.h"
+
+// Physics/Fluid3
+#include "GteFluid3CPU.h"
+
 // Physics/RigidBody
 #include "GteMassSpringArbitrary.h"
+#include "GteMassSpringArbitrarySoA.h"
 #include "GteMassSpringCurve.h"
+#include "GteMassSpringCurveSoA.h"
 #include "GteMassSpringSurface.h"
+#include "GteMassSpringSurfaceSoA.h"
 #include "GteMassSpringVolume.h"
+#include "GteMassSpringVolumeSoA.h"
 #include "GteParticleSystem.h"
+#include "GteParticleSystemSoA.h"
 #include "GtePolyhedralMassProperties.h"
 #include "GteRigidBody.h"
+#include "GteRigidBodyWorld.h"
@@ -0,0 +1,45 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/05)
+
+#pragma once
+
+#include "GTEngineDEF.h"
+#include <condition_variable>
+#include <mutex>
+
+// A reusable barrier for a fixed number of threads.  Each thread calls
+// Wait(), which blocks until all threads have called it; the barrier is
+// then reset for the next phase.  The threads must run concurrently, so do
+// not use a barrier among the tasks of a ThreadPool unless the pool has a
+// thread for each of them; a task that blocks at the barrier occupies its
+// worker thread.
+
+namespace gte
+{
+
+class GTE_IMPEXP Barrier
+{
+public:
+    // Construction.  The number of threads must be positive.
+    Barrier(unsigned int numThreads);
+
+    // Block until numThreads threads have called Wait().  The function
+    // returns 'true' for exactly one thread of each phase (the last to
+    // arrive), which allows that thread to do serial work between phases.
+    bool Wait();
+
+private:
+    // Disallow copying.
+    Barrier(Barrier const&);
+    Barrier& operator=(Barrier const&);
+
+    std::mutex mMutex;
+    std::condition_variable mReleased;
+    unsigned int mNumThreads, mNumWaiting, mPhase;
+};
+
+}
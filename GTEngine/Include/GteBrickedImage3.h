@@ -0,0 +1,151 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/03)
+
+#pragma once
+
+#include "GteImage3.h"
+#include "GteComputeModel.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// A 3D image stored as bricks, each brick a cube of 2^BrickLog pixels per
+// side stored contiguously in x-fastest order, and the bricks themselves
+// stored in x-fastest order.  Image3 stores the pixels in x-fastest order
+// for the entire image, so the z-neighbors of a pixel are a slice apart
+// in memory; in a bricked image, most neighbors of a pixel are in the same
+// brick, which is 512 pixels for BrickLog = 3 and 4096 pixels for
+// BrickLog = 4.  This benefits neighborhood operations (morphology,
+// filtering, interpolation, surface extraction) on large images whose
+// slices do not fit in cache.
+//
+// The dimensions need not be multiples of the brick size.  The bricks on
+// the upper boundaries are padded; the padding pixels are not visited by
+// ForEachPixel and are not copied by CopyTo.
+//
+// Stencil operations should process the image brick by brick.  The
+// function GetBrickWithApron copies a brick and its neighbors within a
+// radius into a linear array, after which the stencil can be applied
+// using the constant offsets of an x-fastest layout.
+
+namespace gte
+{
+
+template <typename PixelType, int BrickLog = 3>
+class BrickedImage3
+{
+public:
+    static_assert(1 <= BrickLog && BrickLog <= 5, "Invalid brick size.");
+
+    enum
+    {
+        BRICK_SIZE = (1 << BrickLog),
+        BRICK_MASK = BRICK_SIZE - 1,
+        BRICK_NUM_PIXELS = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE
+    };
+
+    // Construction.  The input dimensions must be positive; otherwise, a
+    // null image is created.  The conversion from Image3 copies the pixels.
+    ~BrickedImage3();
+    BrickedImage3();
+    BrickedImage3(int dimension0, int dimension1, int dimension2);
+    BrickedImage3(Image3<PixelType> const& image,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    // Resize the image.  All data is lost from the original image.  The
+    // return value is 'true' whenever the image is resized.
+    bool Resize(int dimension0, int dimension1, int dimension2);
+
+    // Member access.
+    inline int GetDimension(int i) const;
+    inline int GetNumBricks(int i) const;
+    inline size_t GetNumBricks() const;
+    inline size_t GetNumPixels() const;
+
+    // The storage, including the padding pixels of the boundary bricks.
+    // The number of elements is GetNumBricks()*BRICK_NUM_PIXELS.
+    inline PixelType* GetData();
+    inline PixelType const* GetData() const;
+
+    // Conversion between 3-dimensional coordinates and the index into the
+    // storage.
+    inline size_t GetIndex(int x, int y, int z) const;
+
+    // The operator() functions test for valid (x,y,z) in debug
+    // configurations and assert on invalid (x,y,z).  The Get() functions
+    // test for valid (x,y,z) and clamp when invalid (debug and release).
+    // The image must not be null for Get().
+    inline PixelType& operator() (int x, int y, int z);
+    inline PixelType const& operator() (int x, int y, int z) const;
+    inline PixelType& Get(int x, int y, int z);
+    inline PixelType const& Get(int x, int y, int z) const;
+
+    // Access to the BRICK_NUM_PIXELS pixels of brick (bx,by,bz), which
+    // contains the pixels (x,y,z) with x >> BrickLog equal to bx, and
+    // similarly for y and z.  The pixels are stored in x-fastest order.
+    inline PixelType* GetBrick(int bx, int by, int bz);
+    inline PixelType const* GetBrick(int bx, int by, int bz) const;
+
+    // Set all pixels to the specified value, including the padding.
+    void SetAllPixels(PixelType const& value);
+
+    // Conversions to and from linear layout.  CopyFrom resizes 'this' to
+    // the dimensions of the input and CopyTo resizes the output to the
+    // dimensions of 'this'.  The copies are by runs of BRICK_SIZE pixels.
+    void CopyFrom(Image3<PixelType> const& image,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    void CopyTo(Image3<PixelType>& image,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr) const;
+
+    // Copy the pixels (x,y,z) of brick (bx,by,bz) and of the neighboring
+    // bricks for which x is in [x0-radius,x0+BRICK_SIZE+radius), where
+    // x0 = bx*BRICK_SIZE, and similarly for y and z.  Pixels outside the
+    // image are clamped to the boundary.  The 'block' array must have
+    // (BRICK_SIZE+2*radius)^3 elements and is stored in x-fastest order,
+    // so pixel (x,y,z) of the brick is block[u+n*(v+n*w)] where
+    // n = BRICK_SIZE+2*radius, u = x-x0+radius, v = y-y0+radius and
+    // w = z-z0+radius.
+    void GetBrickWithApron(int bx, int by, int bz, int radius,
+        PixelType* block) const;
+
+    // Iterate over the bricks, calling visitor(bx,by,bz) for each brick.
+    // When the compute model has multiple threads, slabs of bricks
+    // (constant bz) are partitioned among the threads of its thread pool,
+    // so the visitor must be safe to call concurrently for different
+    // bricks.
+    template <typename Visitor>
+    void ForEachBrick(Visitor visitor,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr) const;
+
+    // Iterate over the pixels brick by brick, calling
+    // visitor(x,y,z,pixel) for each pixel that is not padding.
+    template <typename Visitor>
+    void ForEachPixel(Visitor visitor,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+private:
+    // Support for multithreading.  The lines are slabs of bricks, which
+    // are processed in ranges on at most cmodel->numThreads threads of the
+    // compute model's thread pool.  If cmodel is null, the lines are
+    // processed on the calling thread.
+    static void Execute(int numLines, ComputeModel const* cmodel,
+        std::function<void(int, int)> const& process);
+
+    std::array<int, 3> mDimensions, mNumBricks;
+    std::vector<PixelType> mPixels;
+
+    // Uninitialized, used in the operator() calls.
+    PixelType mInvalidPixel;
+};
+
+#include "GteBrickedImage3.inl"
+
+}
@@ -0,0 +1,403 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/03)
+
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+BrickedImage3<PixelType, BrickLog>::~BrickedImage3()
+{
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+BrickedImage3<PixelType, BrickLog>::BrickedImage3()
+{
+    mDimensions.fill(0);
+    mNumBricks.fill(0);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+BrickedImage3<PixelType, BrickLog>::BrickedImage3(int dimension0,
+    int dimension1, int dimension2)
+{
+    mDimensions.fill(0);
+    mNumBricks.fill(0);
+    Resize(dimension0, dimension1, dimension2);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+BrickedImage3<PixelType, BrickLog>::BrickedImage3(
+    Image3<PixelType> const& image,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    mDimensions.fill(0);
+    mNumBricks.fill(0);
+    CopyFrom(image, cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+bool BrickedImage3<PixelType, BrickLog>::Resize(int dimension0,
+    int dimension1, int dimension2)
+{
+    if (dimension0 == mDimensions[0]
+        && dimension1 == mDimensions[1]
+        && dimension2 == mDimensions[2])
+    {
+        return false;
+    }
+
+    if (dimension0 > 0 && dimension1 > 0 && dimension2 > 0)
+    {
+        mDimensions = { dimension0, dimension1, dimension2 };
+        for (int i = 0; i < 3; ++i)
+        {
+            mNumBricks[i] = (mDimensions[i] + BRICK_MASK) >> BrickLog;
+        }
+        mPixels.resize(GetNumBricks()*BRICK_NUM_PIXELS);
+    }
+    else
+    {
+        mDimensions.fill(0);
+        mNumBricks.fill(0);
+        mPixels.clear();
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+int BrickedImage3<PixelType, BrickLog>::GetDimension(int i) const
+{
+    return mDimensions[i];
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+int BrickedImage3<PixelType, BrickLog>::GetNumBricks(int i) const
+{
+    return mNumBricks[i];
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+size_t BrickedImage3<PixelType, BrickLog>::GetNumBricks() const
+{
+    return (size_t)mNumBricks[0] * (size_t)mNumBricks[1] *
+        (size_t)mNumBricks[2];
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+size_t BrickedImage3<PixelType, BrickLog>::GetNumPixels() const
+{
+    return (size_t)mDimensions[0] * (size_t)mDimensions[1] *
+        (size_t)mDimensions[2];
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+PixelType* BrickedImage3<PixelType, BrickLog>::GetData()
+{
+    return (mPixels.size() > 0 ? &mPixels[0] : nullptr);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+PixelType const* BrickedImage3<PixelType, BrickLog>::GetData() const
+{
+    return (mPixels.size() > 0 ? &mPixels[0] : nullptr);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+size_t BrickedImage3<PixelType, BrickLog>::GetIndex(int x, int y, int z)
+    const
+{
+    size_t brick = (size_t)(x >> BrickLog) + (size_t)mNumBricks[0] *
+        ((size_t)(y >> BrickLog) + (size_t)mNumBricks[1] *
+        (size_t)(z >> BrickLog));
+    size_t local = (size_t)((x & BRICK_MASK) + ((((z & BRICK_MASK)
+        << BrickLog) + (y & BRICK_MASK)) << BrickLog));
+    return (brick << (3 * BrickLog)) + local;
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+PixelType& BrickedImage3<PixelType, BrickLog>::operator() (int x, int y,
+    int z)
+{
+#if defined(GTE_IMAGICS_ASSERT_ON_INVALID_INDEX)
+    if (0 <= x && x < mDimensions[0]
+        && 0 <= y && y < mDimensions[1]
+        && 0 <= z && z < mDimensions[2])
+    {
+        return mPixels[GetIndex(x, y, z)];
+    }
+    LogError("Invalid coordinates (" + std::to_string(x) + "," +
+        std::to_string(y) + "," + std::to_string(z) + ").");
+    return mInvalidPixel;
+#else
+    return mPixels[GetIndex(x, y, z)];
+#endif
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+PixelType const& BrickedImage3<PixelType, BrickLog>::operator() (int x,
+    int y, int z) const
+{
+#if defined(GTE_IMAGICS_ASSERT_ON_INVALID_INDEX)
+    if (0 <= x && x < mDimensions[0]
+        && 0 <= y && y < mDimensions[1]
+        && 0 <= z && z < mDimensions[2])
+    {
+        return mPixels[GetIndex(x, y, z)];
+    }
+    LogError("Invalid coordinates (" + std::to_string(x) + "," +
+        std::to_string(y) + "," + std::to_string(z) + ").");
+    return mInvalidPixel;
+#else
+    return mPixels[GetIndex(x, y, z)];
+#endif
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+PixelType& BrickedImage3<PixelType, BrickLog>::Get(int x, int y, int z)
+{
+    // Clamp to valid (x,y,z).
+    x = std::min(std::max(x, 0), mDimensions[0] - 1);
+    y = std::min(std::max(y, 0), mDimensions[1] - 1);
+    z = std::min(std::max(z, 0), mDimensions[2] - 1);
+    return mPixels[GetIndex(x, y, z)];
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+PixelType const& BrickedImage3<PixelType, BrickLog>::Get(int x, int y,
+    int z) const
+{
+    // Clamp to valid (x,y,z).
+    x = std::min(std::max(x, 0), mDimensions[0] - 1);
+    y = std::min(std::max(y, 0), mDimensions[1] - 1);
+    z = std::min(std::max(z, 0), mDimensions[2] - 1);
+    return mPixels[GetIndex(x, y, z)];
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+PixelType* BrickedImage3<PixelType, BrickLog>::GetBrick(int bx, int by,
+    int bz)
+{
+    size_t brick = (size_t)bx + (size_t)mNumBricks[0] *
+        ((size_t)by + (size_t)mNumBricks[1] * (size_t)bz);
+    return &mPixels[brick << (3 * BrickLog)];
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog> inline
+PixelType const* BrickedImage3<PixelType, BrickLog>::GetBrick(int bx,
+    int by, int bz) const
+{
+    size_t brick = (size_t)bx + (size_t)mNumBricks[0] *
+        ((size_t)by + (size_t)mNumBricks[1] * (size_t)bz);
+    return &mPixels[brick << (3 * BrickLog)];
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+void BrickedImage3<PixelType, BrickLog>::SetAllPixels(
+    PixelType const& value)
+{
+    std::fill(mPixels.begin(), mPixels.end(), value);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+void BrickedImage3<PixelType, BrickLog>::CopyFrom(
+    Image3<PixelType> const& image,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    Resize(image.GetDimension(0), image.GetDimension(1),
+        image.GetDimension(2));
+    if (mPixels.size() == 0)
+    {
+        return;
+    }
+
+    PixelType const* source = image.GetPixels1D();
+    int const dim0 = mDimensions[0], dim1 = mDimensions[1];
+    Execute(mNumBricks[2], cmodel.get(), [&](int bzmin, int bzmax)
+    {
+        for (int bz = bzmin; bz <= bzmax; ++bz)
+        {
+            int z0 = (bz << BrickLog);
+            int z1 = std::min(z0 + BRICK_SIZE, mDimensions[2]);
+            for (int by = 0; by < mNumBricks[1]; ++by)
+            {
+                int y0 = (by << BrickLog);
+                int y1 = std::min(y0 + BRICK_SIZE, dim1);
+                for (int bx = 0; bx < mNumBricks[0]; ++bx)
+                {
+                    int x0 = (bx << BrickLog);
+                    size_t const numBytes = sizeof(PixelType) *
+                        std::min<int>(BRICK_SIZE, dim0 - x0);
+                    PixelType* brick = GetBrick(bx, by, bz);
+                    for (int z = z0; z < z1; ++z)
+                    {
+                        for (int y = y0; y < y1; ++y)
+                        {
+                            memcpy(&brick[(size_t)((((z - z0) << BrickLog)
+                                + y - y0) << BrickLog)],
+                                &source[x0 + dim0 * (y + (size_t)dim1 * z)],
+                                numBytes);
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+void BrickedImage3<PixelType, BrickLog>::CopyTo(Image3<PixelType>& image,
+    std::shared_ptr<ComputeModel> const& cmodel) const
+{
+    image.Resize(mDimensions[0], mDimensions[1], mDimensions[2]);
+    if (mPixels.size() == 0)
+    {
+        return;
+    }
+
+    PixelType* target = image.GetPixels1D();
+    int const dim0 = mDimensions[0], dim1 = mDimensions[1];
+    Execute(mNumBricks[2], cmodel.get(), [&](int bzmin, int bzmax)
+    {
+        for (int bz = bzmin; bz <= bzmax; ++bz)
+        {
+            int z0 = (bz << BrickLog);
+            int z1 = std::min(z0 + BRICK_SIZE, mDimensions[2]);
+            for (int by = 0; by < mNumBricks[1]; ++by)
+            {
+                int y0 = (by << BrickLog);
+                int y1 = std::min(y0 + BRICK_SIZE, dim1);
+                for (int bx = 0; bx < mNumBricks[0]; ++bx)
+                {
+                    int x0 = (bx << BrickLog);
+                    size_t const numBytes = sizeof(PixelType) *
+                        std::min<int>(BRICK_SIZE, dim0 - x0);
+                    PixelType const* brick = GetBrick(bx, by, bz);
+                    for (int z = z0; z < z1; ++z)
+                    {
+                        for (int y = y0; y < y1; ++y)
+                        {
+                            memcpy(&target[x0 + dim0 * (y + (size_t)dim1 * z)],
+                                &brick[(size_t)((((z - z0) << BrickLog)
+                                + y - y0) << BrickLog)],
+                                numBytes);
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+void BrickedImage3<PixelType, BrickLog>::GetBrickWithApron(int bx, int by,
+    int bz, int radius, PixelType* block) const
+{
+    int const n = BRICK_SIZE + 2 * radius;
+    int const x0 = (bx << BrickLog) - radius;
+    int const y0 = (by << BrickLog) - radius;
+    int const z0 = (bz << BrickLog) - radius;
+    int const xmax = mDimensions[0] - 1;
+    int const ymax = mDimensions[1] - 1;
+    int const zmax = mDimensions[2] - 1;
+
+    for (int w = 0; w < n; ++w)
+    {
+        int z = std::min(std::max(z0 + w, 0), zmax);
+        for (int v = 0; v < n; ++v)
+        {
+            int y = std::min(std::max(y0 + v, 0), ymax);
+            PixelType* row = &block[n * (v + (size_t)n * w)];
+
+            // Copy the row in runs of pixels that are contiguous in a
+            // brick.  The pixels outside the image are clamped.
+            int u = 0;
+            for (/**/; u < n && x0 + u < 0; ++u)
+            {
+                row[u] = mPixels[GetIndex(0, y, z)];
+            }
+            while (u < n && x0 + u <= xmax)
+            {
+                int x = x0 + u;
+                int numCopy = std::min(BRICK_SIZE - (x & BRICK_MASK),
+                    std::min(n - u, xmax + 1 - x));
+                PixelType const* source = &mPixels[GetIndex(x, y, z)];
+                for (int i = 0; i < numCopy; ++i)
+                {
+                    row[u + i] = source[i];
+                }
+                u += numCopy;
+            }
+            for (/**/; u < n; ++u)
+            {
+                row[u] = mPixels[GetIndex(xmax, y, z)];
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+template <typename Visitor>
+void BrickedImage3<PixelType, BrickLog>::ForEachBrick(Visitor visitor,
+    std::shared_ptr<ComputeModel> const& cmodel) const
+{
+    Execute(mNumBricks[2], cmodel.get(), [&](int bzmin, int bzmax)
+    {
+        for (int bz = bzmin; bz <= bzmax; ++bz)
+        {
+            for (int by = 0; by < mNumBricks[1]; ++by)
+            {
+                for (int bx = 0; bx < mNumBricks[0]; ++bx)
+                {
+                    visitor(bx, by, bz);
+                }
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+template <typename Visitor>
+void BrickedImage3<PixelType, BrickLog>::ForEachPixel(Visitor visitor,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    ForEachBrick([this, &visitor](int bx, int by, int bz)
+    {
+        int x0 = (bx << BrickLog), y0 = (by << BrickLog);
+        int z0 = (bz << BrickLog);
+        int x1 = std::min(x0 + BRICK_SIZE, mDimensions[0]);
+        int y1 = std::min(y0 + BRICK_SIZE, mDimensions[1]);
+        int z1 = std::min(z0 + BRICK_SIZE, mDimensions[2]);
+        PixelType* brick = GetBrick(bx, by, bz);
+        for (int z = z0; z < z1; ++z)
+        {
+            for (int y = y0; y < y1; ++y)
+            {
+                PixelType* row = &brick[(size_t)((((z - z0) << BrickLog)
+                    + y - y0) << BrickLog)];
+                for (int x = x0; x < x1; ++x)
+                {
+                    visitor(x, y, z, row[x - x0]);
+                }
+            }
+        }
+    }, cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, int BrickLog>
+void BrickedImage3<PixelType, BrickLog>::Execute(int numLines,
+    ComputeModel const* cmodel, std::function<void(int, int)> const& process)
+{
+    int const numThreads =
+        (cmodel ? static_cast<int>(cmodel->numThreads) : 1);
+    if (numThreads > 1 && numLines > 1)
+    {
+        cmodel->GetThreadPool().ParallelFor(numLines, numThreads, process);
+    }
+    else if (numLines > 0)
+    {
+        process(0, numLines - 1);
+    }
+}
+//----------------------------------------------------------------------------
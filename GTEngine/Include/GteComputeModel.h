@@ -3,11 +3,13 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/25)
+// File Version: 1.4.1 (2014/11/05)
 
 #pragma once
 
 #include "GTEngineDEF.h"
+#include "GteThreadPool.h"
+#include <memory>
 
 // The ComputeModel class allows you to select the type of hardware to use
 // in your computational algorithms.
@@ -38,6 +40,15 @@
 // Of course, your algorithm can interpret cmodel anyway it likes.  For
 // example, you might ignore cmodel.engine if all you care about is
 // multithreading on the CPU.
+//
+// CPU multithreading should use the persistent threads of a ThreadPool
+// rather than launch threads for each computation,
+//
+//  cmodel.GetThreadPool().ParallelFor(numLines, cmodel.numThreads,
+//      [&](int lmin, int lmax) { <process lines lmin through lmax> });
+//
+// The pool is 'threadPool' when you set it; otherwise, it is the
+// process-wide pool ThreadPool::GetDefault().
 
 
 #if defined(WIN32)
@@ -58,6 +69,9 @@ public:
     ComputeModel(unsigned int inNumThreads);
     unsigned int numThreads;
 
+    std::shared_ptr<ThreadPool> threadPool;
+    ThreadPool& GetThreadPool() const;
+
 #if defined(WIN32)
     ComputeModel(DX11Engine* inEngine, unsigned int inNumThreads);
     DX11Engine* engine;
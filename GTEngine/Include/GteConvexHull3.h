@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/19)
+// File Version: 1.0.2 (2014/11/15)
 
 #pragma once
 
@@ -17,6 +17,7 @@
 #include "GtePlane3.h"
 #include "GtePrimalQuery3.h"
 #include "GteETManifoldMesh.h"
+#include "GteProfiler.h"
 #include <set>
 #include <vector>
 
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/11/15)
 
 //----------------------------------------------------------------------------
 template <typename InputType, typename ComputeType>
@@ -23,6 +23,8 @@ template <typename InputType, typename ComputeType>
 bool ConvexHull3<InputType, ComputeType>::operator()(int numPoints,
     Vector3<InputType> const* points, InputType epsilon)
 {
+    ProfileScope("ConvexHull3");
+
     mEpsilon = std::max(epsilon, (InputType)0);
     mDimension = 0;
     mLine.origin = Vector3<InputType>::Zero();
@@ -103,12 +105,15 @@ bool ConvexHull3<InputType, ComputeType>::operator()(int numPoints,
     {
         processed.insert(points[info.extreme[i]]);
     }
-    for (i = 0; i < mNumPoints; ++i)
     {
-        if (processed.find(points[i]) == processed.end())
+        ProfileScope("ConvexHull3::Update");
+        for (i = 0; i < mNumPoints; ++i)
         {
-            Update(i);
-            processed.insert(points[i]);
+            if (processed.find(points[i]) == processed.end())
+            {
+                Update(i);
+                processed.insert(points[i]);
+            }
         }
     }
     mNumUniquePoints = static_cast<int>(processed.size());
@@ -179,6 +184,7 @@ ETManifoldMesh const& ConvexHull3<InputType, ComputeType>::GetHullMesh()
     // Create the mesh only on demand.
     if (mHullMesh.GetTriangles().size() == 0)
     {
+        ProfileScope("ConvexHull3::GetHullMesh");
         for (auto const& tri : mHullUnordered)
         {
             mHullMesh.Insert(tri.V[0], tri.V[1], tri.V[2]);
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/31)
+// File Version: 1.0.2 (2014/11/11)
 
 #pragma once
 
@@ -16,7 +16,7 @@
 #include "GteDX11Resource.h"
 #include "GteFont.h"
 #include "GteRasterizerState.h"
-#include "GteThreadSafeMap.h"
+#include "GteThreadSafeShardedMap.h"
 
 // Each DX11Engine call using the immediate context is set to test that the
 // thread in which the call occurs is the same one in which the device and
@@ -432,8 +432,10 @@ private:
     std::shared_ptr<Font> mActiveFont;
 
     // Bridge pattern to create DX11 objects that correspond to GTE objects.
-    ThreadSafeMap<GraphicsObject const*, DX11GraphicsObject*> mGOMap;
-    ThreadSafeMap<DrawTarget const*, DX11DrawTarget*> mDTMap;
+    // The maps are queried on every Bind/Update/Draw, so they are sharded
+    // to reduce contention when several threads use the engine.
+    ThreadSafeShardedMap<GraphicsObject const*, DX11GraphicsObject*> mGOMap;
+    ThreadSafeShardedMap<DrawTarget const*, DX11DrawTarget*> mDTMap;
     DX11InputLayoutManager mILMap;
 
     // Track GraphicsObject destruction and delete to-be-destroyed objects
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/17)
+// File Version: 1.0.2 (2014/11/15)
 
 //----------------------------------------------------------------------------
 template <typename InputType, typename ComputeType>
@@ -24,6 +24,8 @@ template <typename InputType, typename ComputeType>
 bool Delaunay3<InputType, ComputeType>::operator()(int numVertices,
     Vector3<InputType> const* vertices, InputType epsilon)
 {
+    ProfileScope("Delaunay3");
+
     mEpsilon = std::max(epsilon, (InputType)0);
     mDimension = 0;
     mLine.origin = Vector3<InputType>::Zero();
@@ -100,17 +102,21 @@ bool Delaunay3<InputType, ComputeType>::operator()(int numVertices,
     {
         processed.insert(vertices[info.extreme[i]]);
     }
-    for (i = 0; i < mNumVertices; ++i)
     {
-        if (processed.find(vertices[i]) == processed.end())
+        ProfileScope("Delaunay3::Update");
+        for (i = 0; i < mNumVertices; ++i)
         {
-            Update(i);
-            processed.insert(vertices[i]);
+            if (processed.find(vertices[i]) == processed.end())
+            {
+                Update(i);
+                processed.insert(vertices[i]);
+            }
         }
     }
     mNumUniqueVertices = static_cast<int>(processed.size());
 
     // Assign integer values to the tetrahedra for use by the caller.
+    ProfileScope("Delaunay3::Output");
     std::map<Tetrahedron*, int> permute;
     i = -1;
     permute[nullptr] = i++;
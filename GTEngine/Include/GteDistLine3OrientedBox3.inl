@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/19)
+// File Version: 1.0.2 (2014/10/12)
 
 //----------------------------------------------------------------------------
 template <typename Real>
@@ -18,7 +18,7 @@ DCPQuery<Real, Line3<Real>, OrientedBox3<Real>>::operator()(
     for (int i = 0; i < 3; ++i)
     {
         point[i] = Dot(diff, box.axis[i]);
-        direction[i] = Dot(direction, box.axis[i]);
+        direction[i] = Dot(line.direction, box.axis[i]);
     }
 
     Result result;
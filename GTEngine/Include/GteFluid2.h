@@ -8,8 +8,10 @@
 #pragma once
 
 #include "GTEngineDEF.h"
+#include "GteComputeModel.h"
 #include "GteFluid2AdjustVelocity.h"
 #include "GteFluid2ComputeDivergence.h"
+#include "GteFluid2CPU.h"
 #include "GteFluid2EnforceStateBoundary.h"
 #include "GteFluid2InitializeSource.h"
 #include "GteFluid2InitializeState.h"
@@ -27,11 +29,25 @@ public:
     Fluid2(gte::DX11Engine* engine, int xSize, int ySize, float dt,
         float densityViscosity, float velocityViscosity);
 
+    // Select the implementation with a compute model.  If cmodel->engine is
+    // not null, the simulation runs on the GPU as with the previous
+    // constructor.  Otherwise, it runs on the CPU using Fluid2CPU with
+    // cmodel->numThreads threads.  In that case, Initialize() and
+    // DoSimulationStep() copy the state to the texture of GetState(), which
+    // has usage DYNAMIC_UPDATE; call engine->Update(GetState()) before
+    // drawing with it.
+    Fluid2(std::shared_ptr<gte::ComputeModel> const& cmodel, int xSize,
+        int ySize, float dt, float densityViscosity,
+        float velocityViscosity);
+
     void Initialize();
     void DoSimulationStep();
     std::shared_ptr<gte::Texture2> const& GetState () const;
 
 private:
+    void CreateShaders(float densityViscosity, float velocityViscosity);
+    void CopyStateFromCPU();
+
     // Constructor inputs.
     gte::DX11Engine* mEngine;
     int mXSize, mYSize;
@@ -55,6 +71,9 @@ private:
     std::shared_ptr<gte::Texture2> mStateTp1Texture;
     std::shared_ptr<gte::Texture2> mDivergenceTexture;
     std::shared_ptr<gte::Texture2> mPoissonTexture;
+
+    // The CPU implementation, used when the compute model has no engine.
+    std::shared_ptr<gte::Fluid2CPU> mCPU;
 };
 
 }
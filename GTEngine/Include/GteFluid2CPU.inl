@@ -0,0 +1,29 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/16)
+
+//----------------------------------------------------------------------------
+inline std::vector<float> const& Fluid2CPU::GetState() const
+{
+    return mStateT;
+}
+//----------------------------------------------------------------------------
+inline Fluid2Parameters const& Fluid2CPU::GetParameters() const
+{
+    return mParameters;
+}
+//----------------------------------------------------------------------------
+inline float Fluid2CPU::GetTime() const
+{
+    return mTime;
+}
+//----------------------------------------------------------------------------
+inline int Fluid2CPU::Index(int x, int y) const
+{
+    return x + mXSize*y;
+}
+//----------------------------------------------------------------------------
+
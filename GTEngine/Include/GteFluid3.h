@@ -8,8 +8,10 @@
 #pragma once
 
 #include "GTEngineDEF.h"
+#include "GteComputeModel.h"
 #include "GteFluid3AdjustVelocity.h"
 #include "GteFluid3ComputeDivergence.h"
+#include "GteFluid3CPU.h"
 #include "GteFluid3EnforceStateBoundary.h"
 #include "GteFluid3InitializeSource.h"
 #include "GteFluid3InitializeState.h"
@@ -26,11 +28,24 @@ public:
     ~Fluid3();
     Fluid3(DX11Engine* engine, int xSize, int ySize, int zSize, float dt);
 
+    // Select the implementation with a compute model.  If cmodel->engine is
+    // not null, the simulation runs on the GPU as with the previous
+    // constructor.  Otherwise, it runs on the CPU using Fluid3CPU with
+    // cmodel->numThreads threads.  In that case, Initialize() and
+    // DoSimulationStep() copy the state to the texture of GetState(), which
+    // has usage DYNAMIC_UPDATE; call engine->Update(GetState()) before
+    // drawing with it.
+    Fluid3(std::shared_ptr<ComputeModel> const& cmodel, int xSize,
+        int ySize, int zSize, float dt);
+
     void Initialize();
     void DoSimulationStep();
     std::shared_ptr<Texture3> const& GetState() const;
 
 private:
+    void CreateShaders();
+    void CopyStateFromCPU();
+
     // Constructor inputs.
     DX11Engine* mEngine;
     int mXSize, mYSize, mZSize;
@@ -54,6 +69,9 @@ private:
     std::shared_ptr<Texture3> mStateTp1Texture;
     std::shared_ptr<Texture3> mDivergenceTexture;
     std::shared_ptr<Texture3> mPoissonTexture;
+
+    // The CPU implementation, used when the compute model has no engine.
+    std::shared_ptr<Fluid3CPU> mCPU;
 };
 
 }
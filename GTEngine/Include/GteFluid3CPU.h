@@ -0,0 +1,105 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/16)
+
+#pragma once
+
+#include "GTEngineDEF.h"
+#include "GteComputeModel.h"
+#include "GteFluid3Parameters.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+// A CPU implementation of the Fluid3 simulation.  The stages are those of
+// the Fluid3* compute shaders and use the same parameters, grid layout, and
+// boundary conditions.  The state is stored as 4-tuples (vx,vy,vz,density)
+// in the order x fastest, then y, then z, which is the memory layout of the
+// Texture3 that Fluid3 uses, so GetState() can be copied directly to a
+// texture for drawing.
+//
+// Each stage processes ranges of slabs of constant z on at most
+// cmodel->numThreads threads of the compute model's thread pool.  The
+// Poisson equation is solved by red-black Gauss-Seidel iterations rather
+// than the Jacobi iterations of the shader.  The update for a cell is the
+// same, but the red and black cells are updated in separate passes, each
+// reading the latest values of the other color.
+// For the same number of iterations the residual is smaller than that of
+// Jacobi iteration, and a single Poisson array is required.
+//
+// On Windows, the Fluid3 constructor that takes a ComputeModel uses
+// this class when cmodel->engine is null.  On other platforms, use this
+// class directly.
+
+namespace gte
+{
+
+class GTE_IMPEXP Fluid3CPU
+{
+public:
+    // Construction and destruction.  The (x,y,z) grid covers [0,1]^3.  If
+    // cmodel is null, the simulation is single-threaded.
+    ~Fluid3CPU();
+    Fluid3CPU(int xSize, int ySize, int zSize, float dt,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr,
+        int numPoissonIterations = 32);
+
+    void Initialize();
+    void DoSimulationStep();
+
+    // Member access.  The state has 4*xSize*ySize*zSize elements.
+    inline std::vector<float> const& GetState() const;
+    inline Fluid3Parameters const& GetParameters() const;
+    inline float GetTime() const;
+
+private:
+    // The stages of the simulation, each for the slabs zmin <= z <= zmax.
+    void InitializeSource(int zmin, int zmax);
+    void UpdateState(int zmin, int zmax);
+    void ComputeDivergence(int zmin, int zmax);
+    void SolvePoisson(int zmin, int zmax, int color);
+    void AdjustVelocity(int zmin, int zmax);
+    void EnforceStateBoundary(std::vector<float>& state);
+
+    // Process the slabs 0 through numSlabs-1 in ranges on the thread pool
+    // and wait for the ranges to finish.
+    void Execute(int numSlabs, std::function<void(int, int)> const& stage);
+
+    // Trilinear interpolation of stateTm1 at the continuous voxel
+    // coordinates (u,v,w), clamped to the grid.
+    void Sample(float u, float v, float w, float* result) const;
+
+    inline int Index(int x, int y, int z) const;
+
+    // Constructor inputs.
+    int mXSize, mYSize, mZSize;
+    float mDt;
+    std::shared_ptr<ComputeModel> mCModel;
+    int mNumThreads, mNumPoissonIterations;
+
+    // Current simulation time.
+    float mTime;
+
+    Fluid3Parameters mParameters;
+
+    // The vortices generated by Initialize, each (position, normal,
+    // variance, amplitude).
+    enum { NUM_VORTICES = 1024 };
+    struct Vortex
+    {
+        float position[3], normal[3], variance, amplitude;
+    };
+    std::vector<Vortex> mVortices;
+
+    // The simulation arrays.  The states and source store 4-tuples.
+    std::vector<float> mSource;
+    std::vector<float> mStateTm1, mStateT, mStateTp1;
+    std::vector<float> mDivergence, mPoisson;
+};
+
+#include "GteFluid3CPU.inl"
+
+}
@@ -0,0 +1,29 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/16)
+
+//----------------------------------------------------------------------------
+inline std::vector<float> const& Fluid3CPU::GetState() const
+{
+    return mStateT;
+}
+//----------------------------------------------------------------------------
+inline Fluid3Parameters const& Fluid3CPU::GetParameters() const
+{
+    return mParameters;
+}
+//----------------------------------------------------------------------------
+inline float Fluid3CPU::GetTime() const
+{
+    return mTime;
+}
+//----------------------------------------------------------------------------
+inline int Fluid3CPU::Index(int x, int y, int z) const
+{
+    return x + mXSize*(y + mYSize*z);
+}
+//----------------------------------------------------------------------------
+
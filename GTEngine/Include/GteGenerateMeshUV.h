@@ -3,16 +3,19 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.3.4 (2014/09/25)
+// File Version: 1.3.6 (2014/11/15)
 
 #pragma once
 
 #include "GteComputeModel.h"
 #include "GteConstants.h"
 #include "GteETManifoldMesh.h"
+#include "GteProfiler.h"
 #include "GteVector2.h"
 #include "GteVector3.h"
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstring>
 #include <functional>
 #include <limits>
@@ -44,6 +47,15 @@ extern std::string const gGenerateMeshUVsHLSLString;
 // texture coordinates are propagated inward by updating the vertices in
 // topological distance order, leading to fast convergence for large numbers
 // of vertices.
+//
+// The number of Gauss-Seidel iterations is chosen by the caller and there is
+// no convergence test.  For very large meshes, call SetTolerance with a
+// positive tolerance.  The sparse linear system is then solved on the CPU
+// by the biconjugate gradient stabilized method (BiCGSTAB), using the
+// threads of the compute model, until the residual relative to the
+// right-hand side is at most the tolerance or the number of iterations
+// passed to operator() is reached.  The mean value weights are not
+// symmetric, which is why conjugate gradient is not applicable.
 
 namespace gte
 {
@@ -80,6 +92,17 @@ public:
         int numVertices, Vector3<Real> const* vertices, int numIndices,
         int const* indices, Vector2<Real>* tcoords);
 
+    // Select the convergence-driven solver by setting a positive tolerance.
+    // The default tolerance is zero, which selects the fixed number of
+    // Gauss-Seidel iterations.  The progress callback of the compute model
+    // is called for each iteration of either solver.  After operator()
+    // with a positive tolerance, the residual history has the relative
+    // residual of the initial guess followed by that of each iteration;
+    // the larger of the residuals of the u and v systems is stored.
+    void SetTolerance(Real tolerance);
+    inline Real GetTolerance() const;
+    inline std::vector<Real> const& GetResidualHistory() const;
+
 private:
     void TopologicalVertexDistanceTransform();
     void AssignBoundaryTextureCoordinatesSquare();
@@ -88,6 +111,7 @@ private:
     void SolveSystem(unsigned int numIterations);
     void SolveSystemCPUSingle(unsigned int numIterations);
     void SolveSystemCPUMultiple(unsigned int numIterations);
+    void SolveSystemBiCGStab(unsigned int maxIterations);
 
     // Convenience members that store the input parameters to operator().
     int mNumVertices;
@@ -131,6 +155,10 @@ private:
 
     std::shared_ptr<UVComputeModel> mCModel;
 
+    // Support for the convergence-driven solver.
+    Real mTolerance;
+    std::vector<Real> mResidualHistory;
+
 #if defined(WIN32)
     // Support for solving the sparse linear system on the GPU.
     void SolveSystemGPU(unsigned int numIterations);
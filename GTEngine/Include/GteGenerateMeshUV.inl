@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.3.4 (2014/09/25)
+// File Version: 1.3.7 (2014/11/15)
 
 //----------------------------------------------------------------------------
 template <typename Real>
@@ -53,7 +53,8 @@ GenerateMeshUV<Real>::GenerateMeshUV(
     mVertices(nullptr),
     mTCoords(nullptr),
     mNumBoundaryEdges(0),
-    mBoundaryStart(0)
+    mBoundaryStart(0),
+    mTolerance((Real)0)
 {
 }
 //----------------------------------------------------------------------------
@@ -62,6 +63,8 @@ void GenerateMeshUV<Real>::operator()(unsigned int numIterations,
     bool useSquareTopology, int numVertices, Vector3<Real> const* vertices,
     int numIndices, int const* indices, Vector2<Real>* tcoords)
 {
+    ProfileScope("GenerateMeshUV");
+
     // Ensure that numIterations is even, which avoids having a memory
     // copy from the temporary ping-pong buffer to 'tcoords'.
     if (numIterations & 1)
@@ -110,8 +113,28 @@ void GenerateMeshUV<Real>::operator()(unsigned int numIterations,
 }
 //----------------------------------------------------------------------------
 template <typename Real>
+void GenerateMeshUV<Real>::SetTolerance(Real tolerance)
+{
+    mTolerance = (tolerance > (Real)0 ? tolerance : (Real)0);
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+Real GenerateMeshUV<Real>::GetTolerance() const
+{
+    return mTolerance;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+std::vector<Real> const& GenerateMeshUV<Real>::GetResidualHistory() const
+{
+    return mResidualHistory;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
 void GenerateMeshUV<Real>::TopologicalVertexDistanceTransform()
 {
+    ProfileScope("GenerateMeshUV::TopologicalVertexDistanceTransform");
+
     // Initialize the graph information.
     mVertexInfo.resize(mNumVertices);
     std::fill(mVertexInfo.begin(), mVertexInfo.end(), INTERIOR_VERTEX);
@@ -242,6 +265,8 @@ void GenerateMeshUV<Real>::TopologicalVertexDistanceTransform()
 template <typename Real>
 void GenerateMeshUV<Real>::AssignBoundaryTextureCoordinatesSquare()
 {
+    ProfileScope("GenerateMeshUV::AssignBoundaryTextureCoordinatesSquare");
+
     // Map the boundary of the mesh to the unit square [0,1]^2.  The selection
     // of square vertices is such that the relative distances between boundary
     // vertices and the relative distances between polygon vertices is
@@ -325,6 +350,8 @@ void GenerateMeshUV<Real>::AssignBoundaryTextureCoordinatesSquare()
 template <typename Real>
 void GenerateMeshUV<Real>::AssignBoundaryTextureCoordinatesDisk()
 {
+    ProfileScope("GenerateMeshUV::AssignBoundaryTextureCoordinatesDisk");
+
     // Map the boundary of the mesh to a convex polygon.  The selection of
     // convex polygon vertices is such that the relative distances between
     // boundary vertices and the relative distances between polygon vertices
@@ -365,6 +392,8 @@ void GenerateMeshUV<Real>::AssignBoundaryTextureCoordinatesDisk()
 template <typename Real>
 void GenerateMeshUV<Real>::ComputeMeanValueWeights()
 {
+    ProfileScope("GenerateMeshUV::ComputeMeanValueWeights");
+
     for (auto const& edge : mInteriorEdges)
     {
         int v0 = edge->V[0], v1 = edge->V[1];
@@ -421,6 +450,8 @@ void GenerateMeshUV<Real>::ComputeMeanValueWeights()
 template <typename Real>
 void GenerateMeshUV<Real>::SolveSystem(unsigned int numIterations)
 {
+    ProfileScope("GenerateMeshUV::SolveSystem");
+
     // On the first pass, average only neighbors whose texture coordinates
     // have been computed.  This is a good initial guess for the linear system
     // and leads to relatively fast convergence of the Gauss-Seidel iterates.
@@ -446,6 +477,13 @@ void GenerateMeshUV<Real>::SolveSystem(unsigned int numIterations)
         mTCoords[v0] = tcoord;
     }
 
+    mResidualHistory.clear();
+    if (mTolerance > zero)
+    {
+        SolveSystemBiCGStab(numIterations);
+        return;
+    }
+
 #if defined(WIN32)
     if (mCModel->engine)
     {
@@ -468,6 +506,8 @@ void GenerateMeshUV<Real>::SolveSystem(unsigned int numIterations)
 template <typename Real>
 void GenerateMeshUV<Real>::SolveSystemCPUSingle(unsigned int numIterations)
 {
+    ProfileScope("GenerateMeshUV::SolveSystemCPUSingle");
+
     // Use ping-pong buffers for the texture coordinates.
     std::vector<Vector2<Real>> tcoords(mNumVertices);
     size_t numBytes = mNumVertices * sizeof(Vector2<Real>);
@@ -514,6 +554,8 @@ void GenerateMeshUV<Real>::SolveSystemCPUSingle(unsigned int numIterations)
 template <typename Real>
 void GenerateMeshUV<Real>::SolveSystemCPUMultiple(unsigned int numIterations)
 {
+    ProfileScope("GenerateMeshUV::SolveSystemCPUMultiple");
+
     // Use ping-pong buffers for the texture coordinates.
     std::vector<Vector2<Real>> tcoords(mNumVertices);
     size_t numBytes = mNumVertices * sizeof(Vector2<Real>);
@@ -525,16 +567,11 @@ void GenerateMeshUV<Real>::SolveSystemCPUMultiple(unsigned int numIterations)
     Vector2<Real>* inTCoords = mTCoords;
     Vector2<Real>* outTCoords = &tcoords[0];
 
-    // Partition the data for multiple threads.
-    int numV = mNumVertices - mNumBoundaryEdges;
-    int numVPerThread = numV / mCModel->numThreads;
-    std::vector<int> vmin(mCModel->numThreads), vmax(mCModel->numThreads);
-    for (unsigned int t = 0; t < mCModel->numThreads; ++t)
-    {
-        vmin[t] = mNumBoundaryEdges + t * numVPerThread;
-        vmax[t] = vmin[t] + numVPerThread - 1;
-    }
-    vmax[mCModel->numThreads - 1] = mNumVertices - 1;
+    // The Gauss-Seidel iterations are executed by the persistent threads
+    // of the thread pool, so no threads are launched per iteration.
+    ThreadPool& pool = mCModel->GetThreadPool();
+    int const numThreads = static_cast<int>(mCModel->numThreads);
+    int const numV = mNumVertices - mNumBoundaryEdges;
 
     // The value numIterations is even, so we always swap an even number
     // of times.  This ensures that on exit from the loop, outTCoords is
@@ -547,39 +584,276 @@ void GenerateMeshUV<Real>::SolveSystemCPUMultiple(unsigned int numIterations)
         }
 
         // Execute Gauss-Seidel iterations in multiple threads.
-        std::vector<std::thread> process(mCModel->numThreads);
-        for (unsigned int t = 0; t < mCModel->numThreads; ++t)
+        pool.ParallelFor(numV, numThreads, [this, inTCoords, outTCoords](
+            int lmin, int lmax)
         {
-            process[t] = std::thread([this, t, &vmin, &vmax, inTCoords,
-                outTCoords]()
+            int const jmin = mNumBoundaryEdges + lmin;
+            int const jmax = mNumBoundaryEdges + lmax;
+            for (int j = jmin; j <= jmax; ++j)
             {
-                for (int j = vmin[t]; j <= vmax[t]; ++j)
+                int v0 = mOrderedVertices[j];
+                std::array<int, 2> range = mVertexGraph[v0].range;
+                auto const* current = &mVertexGraphData[range[0]];
+                Vector2<Real> tcoord((Real)0, (Real)0);
+                Real weight, weightSum = (Real)0;
+                for (int k = 0; k < range[1]; ++k, ++current)
                 {
-                    int v0 = mOrderedVertices[j];
-                    std::array<int, 2> range = mVertexGraph[v0].range;
-                    auto const* current = &mVertexGraphData[range[0]];
-                    Vector2<Real> tcoord((Real)0, (Real)0);
-                    Real weight, weightSum = (Real)0;
-                    for (int k = 0; k < range[1]; ++k, ++current)
+                    int v1 = current->first;
+                    weight = current->second;
+                    weightSum += weight;
+                    tcoord += weight * inTCoords[v1];
+                }
+                tcoord /= weightSum;
+                outTCoords[v0] = tcoord;
+            }
+        });
+
+        std::swap(inTCoords, outTCoords);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void GenerateMeshUV<Real>::SolveSystemBiCGStab(unsigned int maxIterations)
+{
+    ProfileScope("GenerateMeshUV::SolveSystemBiCGStab");
+
+    // The unknowns are the texture coordinates of the interior vertices,
+    // which are listed after the boundary vertices in mOrderedVertices.
+    // Dividing the equation of an interior vertex by its weight sum gives a
+    // system A*x = b whose matrix has unit diagonal, which is the Jacobi
+    // preconditioning of the system.  The u and v systems share the matrix
+    // and are solved together.
+    int const numUnknowns = mNumVertices - mNumBoundaryEdges;
+    if (numUnknowns <= 0)
+    {
+        return;
+    }
+
+    std::vector<int> unknown(mNumVertices, -1);
+    for (int i = 0; i < numUnknowns; ++i)
+    {
+        unknown[mOrderedVertices[mNumBoundaryEdges + i]] = i;
+    }
+
+    // Store the off-diagonal entries of A by rows.  The boundary vertices
+    // contribute to b.
+    Real const zero = (Real)0, one = (Real)1;
+    std::vector<int> rowStart(numUnknowns + 1);
+    std::vector<std::pair<int, Real>> entries;
+    entries.reserve(mVertexGraphData.size());
+    std::vector<Vector2<Real>> b(numUnknowns), x(numUnknowns);
+    for (int i = 0; i < numUnknowns; ++i)
+    {
+        int v0 = mOrderedVertices[mNumBoundaryEdges + i];
+        std::array<int, 2> range = mVertexGraph[v0].range;
+        auto const* current = &mVertexGraphData[range[0]];
+        Real weightSum = zero;
+        for (int k = 0; k < range[1]; ++k)
+        {
+            weightSum += current[k].second;
+        }
+
+        rowStart[i] = static_cast<int>(entries.size());
+        b[i] = Vector2<Real>(zero, zero);
+        for (int k = 0; k < range[1]; ++k)
+        {
+            int v1 = current[k].first;
+            Real coefficient = current[k].second / weightSum;
+            if (unknown[v1] >= 0)
+            {
+                entries.push_back(std::make_pair(unknown[v1], -coefficient));
+            }
+            else
+            {
+                b[i] += coefficient * mTCoords[v1];
+            }
+        }
+        x[i] = mTCoords[v0];
+    }
+    rowStart[numUnknowns] = static_cast<int>(entries.size());
+
+    ThreadPool& pool = mCModel->GetThreadPool();
+    int const numThreads = static_cast<int>(mCModel->numThreads);
+
+    // y = A*x for the u and v components.
+    auto Multiply = [&](std::vector<Vector2<Real>> const& input,
+        std::vector<Vector2<Real>>& output)
+    {
+        pool.ParallelFor(numUnknowns, numThreads, [&](int imin, int imax)
+        {
+            for (int i = imin; i <= imax; ++i)
+            {
+                Vector2<Real> sum = input[i];
+                for (int k = rowStart[i]; k < rowStart[i + 1]; ++k)
+                {
+                    sum += entries[k].second * input[entries[k].first];
+                }
+                output[i] = sum;
+            }
+        });
+    };
+
+    // The dot products of the u components and of the v components.
+    auto Dot = [&](std::vector<Vector2<Real>> const& u,
+        std::vector<Vector2<Real>> const& v)
+    {
+        return pool.ParallelReduce<Vector2<Real>>(numUnknowns, numThreads,
+            Vector2<Real>(zero, zero), [&](int imin, int imax)
+        {
+            Vector2<Real> sum(zero, zero);
+            for (int i = imin; i <= imax; ++i)
+            {
+                sum[0] += u[i][0] * v[i][0];
+                sum[1] += u[i][1] * v[i][1];
+            }
+            return sum;
+        },
+        [](Vector2<Real> const& a, Vector2<Real> const& c) { return a + c; });
+    };
+
+    // r = b - A*x and the norms used for the relative residuals.
+    std::vector<Vector2<Real>> r(numUnknowns), v(numUnknowns);
+    Multiply(x, v);
+    for (int i = 0; i < numUnknowns; ++i)
+    {
+        r[i] = b[i] - v[i];
+    }
+
+    std::array<Real, 2> bNorm, rNorm;
+    Vector2<Real> bDot = Dot(b, b), rDot = Dot(r, r);
+    for (int j = 0; j < 2; ++j)
+    {
+        bNorm[j] = (bDot[j] > zero ? std::sqrt(bDot[j]) : one);
+        rNorm[j] = std::sqrt(rDot[j]) / bNorm[j];
+    }
+    mResidualHistory.push_back(std::max(rNorm[0], rNorm[1]));
+
+    // A component is updated until its residual reaches the tolerance or
+    // the iteration breaks down (a zero denominator).
+    std::array<bool, 2> active;
+    std::array<Real, 2> rho, alpha, omega, beta;
+    for (int j = 0; j < 2; ++j)
+    {
+        active[j] = (rNorm[j] > mTolerance);
+        rho[j] = one;
+        alpha[j] = one;
+        omega[j] = one;
+    }
+
+    std::vector<Vector2<Real>> rHat = r, p(numUnknowns), s(numUnknowns),
+        t(numUnknowns);
+    std::fill(p.begin(), p.end(), Vector2<Real>(zero, zero));
+    std::fill(v.begin(), v.end(), Vector2<Real>(zero, zero));
+
+    for (unsigned int iteration = 1; iteration <= maxIterations; ++iteration)
+    {
+        if (!active[0] && !active[1])
+        {
+            break;
+        }
+
+        if (mCModel->progress)
+        {
+            (*mCModel->progress)(iteration);
+        }
+
+        Vector2<Real> rho1 = Dot(rHat, r);
+        for (int j = 0; j < 2; ++j)
+        {
+            if (active[j])
+            {
+                if (rho1[j] == zero || omega[j] == zero)
+                {
+                    active[j] = false;
+                    continue;
+                }
+                beta[j] = (rho1[j] / rho[j]) * (alpha[j] / omega[j]);
+                rho[j] = rho1[j];
+            }
+        }
+
+        // p = r + beta*(p - omega*v)
+        pool.ParallelFor(numUnknowns, numThreads, [&](int imin, int imax)
+        {
+            for (int i = imin; i <= imax; ++i)
+            {
+                for (int j = 0; j < 2; ++j)
+                {
+                    if (active[j])
                     {
-                        int v1 = current->first;
-                        weight = current->second;
-                        weightSum += weight;
-                        tcoord += weight * inTCoords[v1];
+                        p[i][j] = r[i][j] +
+                            beta[j] * (p[i][j] - omega[j] * v[i][j]);
                     }
-                    tcoord /= weightSum;
-                    outTCoords[v0] = tcoord;
                 }
-            });
+            }
+        });
+
+        Multiply(p, v);
+        Vector2<Real> rHatDotV = Dot(rHat, v);
+        for (int j = 0; j < 2; ++j)
+        {
+            if (active[j])
+            {
+                if (rHatDotV[j] == zero)
+                {
+                    active[j] = false;
+                    continue;
+                }
+                alpha[j] = rho[j] / rHatDotV[j];
+            }
         }
 
-        // Wait for all threads to finish.
-        for (unsigned int t = 0; t < mCModel->numThreads; ++t)
+        // s = r - alpha*v
+        pool.ParallelFor(numUnknowns, numThreads, [&](int imin, int imax)
         {
-            process[t].join();
+            for (int i = imin; i <= imax; ++i)
+            {
+                for (int j = 0; j < 2; ++j)
+                {
+                    s[i][j] = (active[j] ? r[i][j] - alpha[j] * v[i][j] :
+                        zero);
+                }
+            }
+        });
+
+        Multiply(s, t);
+        Vector2<Real> tDotS = Dot(t, s), tDotT = Dot(t, t);
+        for (int j = 0; j < 2; ++j)
+        {
+            omega[j] = (tDotT[j] > zero ? tDotS[j] / tDotT[j] : zero);
         }
 
-        std::swap(inTCoords, outTCoords);
+        // x = x + alpha*p + omega*s and r = s - omega*t
+        pool.ParallelFor(numUnknowns, numThreads, [&](int imin, int imax)
+        {
+            for (int i = imin; i <= imax; ++i)
+            {
+                for (int j = 0; j < 2; ++j)
+                {
+                    if (active[j])
+                    {
+                        x[i][j] += alpha[j] * p[i][j] + omega[j] * s[i][j];
+                        r[i][j] = s[i][j] - omega[j] * t[i][j];
+                    }
+                }
+            }
+        });
+
+        rDot = Dot(r, r);
+        for (int j = 0; j < 2; ++j)
+        {
+            if (active[j])
+            {
+                rNorm[j] = std::sqrt(rDot[j]) / bNorm[j];
+                active[j] = (rNorm[j] > mTolerance);
+            }
+        }
+        mResidualHistory.push_back(std::max(rNorm[0], rNorm[1]));
+    }
+
+    for (int i = 0; i < numUnknowns; ++i)
+    {
+        mTCoords[mOrderedVertices[mNumBoundaryEdges + i]] = x[i];
     }
 }
 //----------------------------------------------------------------------------
@@ -588,6 +862,8 @@ void GenerateMeshUV<Real>::SolveSystemCPUMultiple(unsigned int numIterations)
 template <typename Real>
 void GenerateMeshUV<Real>::SolveSystemGPU(unsigned int numIterations)
 {
+    ProfileScope("GenerateMeshUV::SolveSystemGPU");
+
     HLSLDefiner definer;
     definer.SetInt("NUM_X_THREADS", 8);
     definer.SetInt("NUM_Y_THREADS", 8);
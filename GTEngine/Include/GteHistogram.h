@@ -3,11 +3,19 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/10/30)
 
 #pragma once
 
+#include "GteComputeModel.h"
 #include "GteImage1.h"
+#include "GteImage2.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace gte
 {
@@ -16,7 +24,10 @@ class Histogram
 {
 public:
     // Construction and destruction.  The first three constructors are for
-    // computing the histogram of the entire image at one time.
+    // computing the histogram of the entire image at one time.  The samples
+    // are partitioned among cmodel->numThreads threads, each counting into
+    // its own buckets, and the buckets of the threads are then summed.  The
+    // histogram is the same for any number of threads.
     ~Histogram ();
 
     // In the constructor with input 'int const* samples', set noRescaling to
@@ -25,10 +36,16 @@ public:
     // {0,1,...,numBuckets-1}, but in the event of out-of-range values, the
     // histogram stores a count for those numbers smaller than 0 and those
     // numbers larger or equal to numBuckets.
+    //
+    // When the samples are rescaled, the minimum sample value maps to bucket
+    // 0 and the maximum sample value maps to bucket numBuckets-1.
     Histogram (int numBuckets, int numSamples, int const* samples,
-        bool noRescaling);
-    Histogram (int numBuckets, int numSamples, float const* samples);
-    Histogram (int numBuckets, int numSamples, double const* samples);
+        bool noRescaling,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+    Histogram (int numBuckets, int numSamples, float const* samples,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+    Histogram (int numBuckets, int numSamples, double const* samples,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
 
     // Construction where you plan on updating the histogram incrementally.
     // The incremental update is implemented only for integer samples and
@@ -44,12 +61,27 @@ public:
     // constructor.  Bounds checking is used.
     void InsertCheck (int value);
 
+    // This function is called when you have used the Histogram(int)
+    // constructor and the samples arrive in chunks, for example, the rows
+    // of an image that is read incrementally.  Bounds checking is used as
+    // in InsertCheck(int).  The samples are partitioned among
+    // cmodel->numThreads threads.
+    void InsertCheck (int numSamples, int const* samples,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
     // Member access.
     inline int GetNumBuckets () const;
     inline int const* GetBuckets () const;
     inline int GetExcessLess () const;
     inline int GetExcessGreater () const;
 
+    // The sample values that map to buckets 0 and numBuckets-1.  Sample
+    // value v maps to bucket (int)((numBuckets-1)*(v-min)/(max-min)).
+    // Without rescaling, min is 0 and max is numBuckets-1.  For a constant
+    // image, min and max are the constant and all samples are in bucket 0.
+    inline double GetMinValue () const;
+    inline double GetMaxValue () const;
+
     // In the following, define cdf(V) = sum_{i=0}^{V} bucket[i], where
     // 0 <= V < B and B is the number of buckets.  Define N = cdf(B-1),
     // which must be the number of pixels in the image.
@@ -68,6 +100,37 @@ public:
     // cdf(U)/N >= 1-tailAmount/2, and cdf(U+1) < 1-tailAmount/2.
     void GetTails (double tailAmount, int& lower, int& upper);
 
+    // Get the normalized cumulative distribution, cdf[V] = cdf(V)/N for
+    // 0 <= V < B.
+    void GetCDF (std::vector<double>& cdf) const;
+
+    // Get the smallest index P for which cdf(P)/N >= fraction.  For example,
+    // fraction 0.5 gives the bucket that contains the median.
+    int GetPercentile (double fraction) const;
+
+    // Get the threshold T that maximizes the between-class variance of the
+    // classes of buckets {0,...,T} and {T+1,...,B-1} (Otsu's method).
+    int GetOtsuThreshold () const;
+
+    // Histogram equalization of an image whose pixels map to the buckets as
+    // described for GetMinValue and GetMaxValue; typically the histogram is
+    // that of the image.  The pixels in bucket V are replaced by the sample
+    // value of bucket (B-1)*(cdf(V)-cdf(V0))/(N-cdf(V0)), where V0 is the
+    // first nonempty bucket, so the output uses the entire range of sample
+    // values.  Pixels outside the range [min,max] are clamped to it.  For
+    // integer pixel types the output values are rounded.  The pixels are
+    // partitioned among cmodel->numThreads threads.
+    template <typename PixelType>
+    void Equalize (Image2<PixelType>& image,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr) const;
+
+    // Set the pixels in the buckets {0,...,threshold} to 0 and the other
+    // pixels to 1.  The pixels map to the buckets as in Equalize.  Use
+    // threshold = GetOtsuThreshold() to segment the image by Otsu's method.
+    template <typename PixelType>
+    void ApplyThreshold (Image2<PixelType>& image, int threshold,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr) const;
+
     // Save the histogram to a text file with two columns.  The first
     // column is the bucket index and the second column is the number of
     // items in the bucket.
@@ -79,9 +142,36 @@ public:
     void SaveAsImage (std::string const& name, int dimension0);
 
 private:
+    // Count the samples that map directly to the buckets, adding to the
+    // current counts.
+    void Count (int numSamples, int const* samples,
+        ComputeModel const* cmodel);
+
+    // Compute the extremes of the samples and count the rescaled samples.
+    template <typename Real>
+    void Rescale (int numSamples, Real const* samples,
+        ComputeModel const* cmodel);
+
+    // Add the buckets of partitions 1 through numThreads-1 to mBuckets,
+    // which partition 0 counts into.  The loop over the buckets vectorizes.
+    void AddBuckets (std::vector<std::vector<int>> const& buckets);
+
+    inline int GetBucket (double value) const;
+
+    // Partition the samples into GetNumThreads(numSamples,cmodel) ranges,
+    // call process(t,imin,imax) for range t, which is samples imin through
+    // imax, and wait for the ranges to finish.  The ranges are processed by
+    // the compute model's thread pool.  The number of ranges is clamped so
+    // that each range has at least one sample, and the histogram does not
+    // depend on which pool thread processes which range.
+    static int GetNumThreads (int numSamples, ComputeModel const* cmodel);
+    static void Execute (int numSamples, ComputeModel const* cmodel,
+        std::function<void(int, int, int)> const& process);
+
     int mNumBuckets;
     int* mBuckets;
     int mExcessLess, mExcessGreater;
+    double mMinValue, mMaxValue, mMultiplier;
 };
 
 #include "GteHistogram.inl"
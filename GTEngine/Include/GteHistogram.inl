@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/10/30)
 
 //----------------------------------------------------------------------------
 inline void Histogram::Insert (int value)
@@ -31,3 +31,169 @@ inline int Histogram::GetExcessGreater () const
     return mExcessGreater;
 }
 //----------------------------------------------------------------------------
+inline double Histogram::GetMinValue () const
+{
+    return mMinValue;
+}
+//----------------------------------------------------------------------------
+inline double Histogram::GetMaxValue () const
+{
+    return mMaxValue;
+}
+//----------------------------------------------------------------------------
+inline int Histogram::GetBucket (double value) const
+{
+    double index = mMultiplier*(value - mMinValue);
+    if (index <= 0.0)
+    {
+        return 0;
+    }
+    if (index >= (double)(mNumBuckets - 1))
+    {
+        return mNumBuckets - 1;
+    }
+    return (int)index;
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void Histogram::Equalize (Image2<PixelType>& image,
+    std::shared_ptr<ComputeModel> const& cmodel) const
+{
+    if (mNumBuckets <= 0)
+    {
+        return;
+    }
+
+    std::vector<double> cdf;
+    GetCDF(cdf);
+    double cdfFirst = 0.0;
+    for (int i = 0; i < mNumBuckets; ++i)
+    {
+        if (mBuckets[i] > 0)
+        {
+            cdfFirst = cdf[i];
+            break;
+        }
+    }
+
+    // The output pixel value for each bucket.  When all the samples are in
+    // one bucket, the buckets are unchanged.
+    double const maxLevel = (double)(mNumBuckets - 1);
+    double const range = mMaxValue - mMinValue;
+    std::vector<PixelType> table(mNumBuckets);
+    for (int i = 0; i < mNumBuckets; ++i)
+    {
+        double level = (double)i;
+        if (cdfFirst < 1.0)
+        {
+            level = maxLevel*(cdf[i] - cdfFirst)/(1.0 - cdfFirst);
+            level = std::min(std::max(level, 0.0), maxLevel);
+        }
+
+        double value = mMinValue;
+        if (maxLevel > 0.0)
+        {
+            value += range*level/maxLevel;
+        }
+        if (std::is_integral<PixelType>::value)
+        {
+            value = std::floor(value + 0.5);
+        }
+        table[i] = (PixelType)value;
+    }
+
+    int const numPixels = (int)image.GetNumPixels();
+    PixelType* pixels = image.GetPixels1D();
+    Execute(numPixels, cmodel.get(), [&](int, int imin, int imax)
+    {
+        for (int i = imin; i <= imax; ++i)
+        {
+            pixels[i] = table[GetBucket((double)pixels[i])];
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void Histogram::ApplyThreshold (Image2<PixelType>& image, int threshold,
+    std::shared_ptr<ComputeModel> const& cmodel) const
+{
+    int const numPixels = (int)image.GetNumPixels();
+    PixelType* pixels = image.GetPixels1D();
+    Execute(numPixels, cmodel.get(), [&](int, int imin, int imax)
+    {
+        for (int i = imin; i <= imax; ++i)
+        {
+            pixels[i] = (GetBucket((double)pixels[i]) <= threshold ?
+                (PixelType)0 : (PixelType)1);
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void Histogram::Rescale (int numSamples, Real const* samples,
+    ComputeModel const* cmodel)
+{
+    int const numThreads = GetNumThreads(numSamples, cmodel);
+
+    // Compute the extremes.
+    std::vector<Real> minValues(numThreads), maxValues(numThreads);
+    Execute(numSamples, cmodel, [&](int t, int imin, int imax)
+    {
+        Real minValue = samples[imin], maxValue = minValue;
+        for (int i = imin + 1; i <= imax; ++i)
+        {
+            Real value = samples[i];
+            if (value < minValue)
+            {
+                minValue = value;
+            }
+            else if (value > maxValue)
+            {
+                maxValue = value;
+            }
+        }
+        minValues[t] = minValue;
+        maxValues[t] = maxValue;
+    });
+    Real minValue = *std::min_element(minValues.begin(), minValues.end());
+    Real maxValue = *std::max_element(maxValues.begin(), maxValues.end());
+
+    // Map to the buckets.
+    if (minValue < maxValue)
+    {
+        // The image is not constant.
+        double numer = (double)(mNumBuckets - 1);
+        double denom = (double)(maxValue - minValue);
+        double mult = numer/denom;
+        mMinValue = (double)minValue;
+        mMaxValue = (double)maxValue;
+        mMultiplier = mult;
+
+        std::vector<std::vector<int>> buckets(numThreads);
+        Execute(numSamples, cmodel, [&](int t, int imin, int imax)
+        {
+            int* counts = mBuckets;
+            if (t > 0)
+            {
+                buckets[t].resize(mNumBuckets);
+                counts = buckets[t].data();
+            }
+
+            for (int i = imin; i <= imax; ++i)
+            {
+                int index = (int)(mult*(double)(samples[i] - minValue));
+                ++counts[index];
+            }
+        });
+        AddBuckets(buckets);
+    }
+    else
+    {
+        // The image is constant.
+        mBuckets[0] = numSamples;
+        mMinValue = (double)minValue;
+        mMaxValue = (double)maxValue;
+        mMultiplier = 0.0;
+    }
+}
+//----------------------------------------------------------------------------
@@ -3,12 +3,15 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/09/25)
+// File Version: 1.0.2 (2014/11/01)
 
 #pragma once
 
 #include "GTEngineDEF.h"
+#include "GteComputeModel.h"
+#include "GteMemoryMappedFile.h"
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -99,6 +102,40 @@ public:
 
     bool Save(std::string const& name) const;
 
+    // Load an image by mapping the file into memory.  The pixels are not
+    // copied; the raw pixels are the pixel region of the mapped file, which
+    // the operating system reads on demand, and the file remains mapped
+    // until the image is destroyed, resized, or loaded again.  The header
+    // and metadata are read into memory as in Load.  With READ_ONLY access,
+    // writing to the pixels is an access violation; ClearPixels reports an
+    // error and assignment of a compatible image reallocates the pixels.
+    // With COPY_ON_WRITE access the pixels may be modified without changing
+    // the file, and with READ_WRITE access the modifications are stored in
+    // the file.  The pixels are used in place, so they must start at a
+    // multiple of GetPixelAlignment(pixelSize) bytes.  Save pads the header
+    // to ensure this.  LoadMapped reports an error for a file whose pixels
+    // are not aligned, for example one written by an older version; such a
+    // file can be read with Load.
+    bool LoadMapped(std::string const& name,
+        MemoryMappedFile::Access access,
+        std::vector<int> const* requiredNumDimensions,
+        std::vector<std::string> const* requiredPixelTypes);
+
+    inline bool IsMapped() const;
+
+    // Save the image, where the pixels are partitioned among
+    // cmodel->numThreads threads of the compute model's thread pool and
+    // each thread writes its pixels to the file with its own stream.  The
+    // file is the same as that of Save(name).
+    bool Save(std::string const& name,
+        std::shared_ptr<ComputeModel> const& cmodel) const;
+
+    // The alignment of the pixels in a saved file, which is the largest
+    // power of two that divides the pixel size, but at most 16.  The pixel
+    // type string in the header is padded with null characters to align
+    // the pixels; LoadHeader ignores the padding.
+    static size_t GetPixelAlignment(size_t pixelSize);
+
 protected:
     // Deallocate arrays and initialize all data members to zero.
     void CreateNullImage();
@@ -118,6 +155,16 @@ protected:
     // Support for copying that avoids reallocation when possible.
     bool Copy(Image const& image);
 
+    // Support for loading and saving.  The header is the data up to and
+    // including the number of pixels, and the metadata is the data that
+    // follows the pixels.
+    bool ReadHeader(std::ifstream& input,
+        std::vector<int> const* requiredNumDimensions,
+        std::vector<std::string> const* requiredPixelTypes);
+    bool ReadMetaData(std::ifstream& input);
+    bool WriteHeader(std::ofstream& output) const;
+    bool WriteMetaData(std::ofstream& output) const;
+
     // Information needed for typecasting to ImageD<T>, where D is the number
     // of dimensions and T is the pixel type.
     std::string mPixelType;
@@ -131,6 +178,9 @@ protected:
     char* mRawPixels;
     bool mOwnerRawPixels;
 
+    // The mapped file when the image is loaded by LoadMapped.
+    std::shared_ptr<MemoryMappedFile> mMappedFile;
+
     // Per-image metadata.
     std::string mImageMetaData;
 
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/09/25)
+// File Version: 1.0.2 (2014/11/01)
 
 //----------------------------------------------------------------------------
 inline std::string Image::GetPixelType() const
@@ -67,3 +67,8 @@ inline bool Image::HasPixelMetaData() const
     return mPixelMetaData != nullptr;
 }
 //----------------------------------------------------------------------------
+inline bool Image::IsMapped() const
+{
+    return mMappedFile != nullptr;
+}
+//----------------------------------------------------------------------------
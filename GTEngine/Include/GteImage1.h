@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.2 (2014/09/25)
+// File Version: 1.0.3 (2014/11/01)
 
 #pragma once
 
@@ -78,6 +78,11 @@ public:
     // object.
     bool Load(std::string const& filename);
 
+    // Load the image by mapping the file into memory; see Image::LoadMapped
+    // for the restrictions on modifying the pixels.
+    bool LoadMapped(std::string const& filename,
+        MemoryMappedFile::Access access = MemoryMappedFile::READ_ONLY);
+
 private:
     // A typed pointer to Image::mRawPixels.
     PixelType* mPixels;
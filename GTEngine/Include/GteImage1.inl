@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.2 (2014/09/25)
+// File Version: 1.0.3 (2014/11/01)
 
 //----------------------------------------------------------------------------
 template <typename PixelType>
@@ -255,3 +255,23 @@ bool Image1<PixelType>::Load(std::string const& filename)
     return false;
 }
 //----------------------------------------------------------------------------
+template <typename PixelType>
+bool Image1<PixelType>::LoadMapped(std::string const& filename,
+    MemoryMappedFile::Access access)
+{
+    std::vector<int> numDimensions(1);
+    numDimensions[0] = mNumDimensions;
+
+    std::vector<std::string> pixelTypes(1);
+    pixelTypes[0] = mPixelType;
+
+    if (Image::LoadMapped(filename, access, &numDimensions,
+        &pixelTypes))
+    {
+        mPixels = (PixelType*)mRawPixels;
+        return true;
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.2 (2014/09/25)
+// File Version: 1.0.3 (2014/11/01)
 
 //----------------------------------------------------------------------------
 template <typename PixelType>
@@ -633,6 +633,26 @@ bool Image2<PixelType>::Load(std::string const& filename)
 }
 //----------------------------------------------------------------------------
 template <typename PixelType>
+bool Image2<PixelType>::LoadMapped(std::string const& filename,
+    MemoryMappedFile::Access access)
+{
+    std::vector<int> numDimensions(1);
+    numDimensions[0] = mNumDimensions;
+
+    std::vector<std::string> pixelTypes(1);
+    pixelTypes[0] = mPixelType;
+
+    if (Image::LoadMapped(filename, access, &numDimensions,
+        &pixelTypes))
+    {
+        AllocatePointers();
+        return true;
+    }
+
+    return false;
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
 void Image2<PixelType>::AllocatePointers()
 {
     if (mPixels)
@@ -0,0 +1,77 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/01)
+
+#pragma once
+
+#include "GteImage2.h"
+#include "GteImage3.h"
+#include <fstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+// Read the pixels of an image file (the format of Image::Save) in slabs of
+// consecutive slices, where a slice is the set of pixels with the same last
+// coordinate; for example, a slice of an Image3 is the set of pixels with
+// the same z and a slice of an Image2 is a row.  This supports out-of-core
+// processing of images too large to be loaded.  The metadata of the file is
+// not read.  The Read functions use the reader's file stream, so they are
+// not thread safe; create a reader for each thread to read slabs
+// concurrently.
+
+namespace gte
+{
+
+class GTE_IMPEXP ImageChunkReader
+{
+public:
+    // Construction and destruction.
+    ~ImageChunkReader();
+    ImageChunkReader();
+
+    // Open the file and read its header.  The function returns 'false' when
+    // the file cannot be opened or the header is invalid.
+    bool Open(std::string const& name);
+    void Close();
+
+    // Member access.  These are valid after a successful Open.
+    inline bool IsOpen() const;
+    inline std::string const& GetPixelType() const;
+    inline size_t GetPixelSize() const;
+    inline std::vector<int> const& GetDimensions() const;
+    inline int GetNumSlices() const;
+    inline size_t GetNumSlicePixels() const;
+
+    // Read slices first through first+numSlices-1 to 'pixels', which must
+    // have numSlices*GetNumSlicePixels()*GetPixelSize() bytes.
+    bool Read(int first, int numSlices, char* pixels);
+
+    // Read slices to an image.  The image must be of the pixel type and
+    // dimension of the file.  It is resized to the dimensions of the file
+    // except for the last dimension, which is numSlices.
+    template <typename PixelType>
+    bool Read(int first, int numSlices, Image2<PixelType>& slab);
+
+    template <typename PixelType>
+    bool Read(int first, int numSlices, Image3<PixelType>& slab);
+
+private:
+    // Disallow copying, because the object owns the file stream.
+    ImageChunkReader(ImageChunkReader const&);
+    ImageChunkReader& operator=(ImageChunkReader const&);
+
+    std::ifstream mInput;
+    std::string mPixelType;
+    size_t mPixelSize;
+    std::vector<int> mDimensions;
+    size_t mNumSlicePixels;
+    std::streamoff mPixelOffset;
+};
+
+#include "GteImageChunkReader.inl"
+
+}
@@ -0,0 +1,66 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/01)
+
+//----------------------------------------------------------------------------
+inline bool ImageChunkReader::IsOpen() const
+{
+    return mInput.is_open();
+}
+//----------------------------------------------------------------------------
+inline std::string const& ImageChunkReader::GetPixelType() const
+{
+    return mPixelType;
+}
+//----------------------------------------------------------------------------
+inline size_t ImageChunkReader::GetPixelSize() const
+{
+    return mPixelSize;
+}
+//----------------------------------------------------------------------------
+inline std::vector<int> const& ImageChunkReader::GetDimensions() const
+{
+    return mDimensions;
+}
+//----------------------------------------------------------------------------
+inline int ImageChunkReader::GetNumSlices() const
+{
+    return (mDimensions.size() > 0 ? mDimensions.back() : 0);
+}
+//----------------------------------------------------------------------------
+inline size_t ImageChunkReader::GetNumSlicePixels() const
+{
+    return mNumSlicePixels;
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+bool ImageChunkReader::Read(int first, int numSlices,
+    Image2<PixelType>& slab)
+{
+    if (mDimensions.size() != 2 || mPixelType != typeid(PixelType).name())
+    {
+        LogError("The image is not of the file's type and dimension.");
+        return false;
+    }
+
+    slab.Resize(mDimensions[0], numSlices);
+    return Read(first, numSlices, slab.GetRawPixels());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+bool ImageChunkReader::Read(int first, int numSlices,
+    Image3<PixelType>& slab)
+{
+    if (mDimensions.size() != 3 || mPixelType != typeid(PixelType).name())
+    {
+        LogError("The image is not of the file's type and dimension.");
+        return false;
+    }
+
+    slab.Resize(mDimensions[0], mDimensions[1], numSlices);
+    return Read(first, numSlices, slab.GetRawPixels());
+}
+//----------------------------------------------------------------------------
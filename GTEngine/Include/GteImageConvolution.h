@@ -0,0 +1,191 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/28)
+
+#pragma once
+
+#include "GteComputeModel.h"
+#include "GteImage2.h"
+#include "GteImage3.h"
+#include "GteLogger.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// CPU convolution of 2D and 3D images with kernels of odd dimensions.  A
+// kernel with dimensions (2*r0+1)x(2*r1+1) produces
+//   output(x,y) = sum_{i,j} kernel(i,j)*input(x+i-r0,y+j-r1)
+// which is the form used by the Convolve*.hlsl shaders of the Convolution
+// sample.  (This is the correlation of the input with the kernel; for a
+// symmetric kernel it is the same as convolution.  Reflect the kernel to
+// obtain convolution in general.)  The 3D form is similar.  Input pixels
+// outside the image are determined by a BoundaryMode.
+//
+// Three methods are available.
+//   DIRECT:  The sum is evaluated as written, O(N*K) for N pixels and K
+//     nonzero kernel elements.  The rows are extended once according to the
+//     boundary mode, and each output row is accumulated in blocks of
+//     adjacent pixels, so the inner loops vectorize.
+//   SEPARABLE:  When the kernel is the outer product of 1D kernels (rank
+//     one), the image is filtered by the 1D kernels in turn, O(N*(k0+k1))
+//     in 2D or O(N*(k0+k1+k2)) in 3D.
+//   FFT:  The boundary-extended image and the kernel are transformed by
+//     a single complex FFT (the image is the real part and the kernel is
+//     the imaginary part), multiplied in the frequency domain, and
+//     transformed back, O(M*log(M)) where M is the number of elements of
+//     the extended image after padding each dimension to a power of two.
+// The AUTOMATIC method chooses the method of least estimated cost.  The
+// work is partitioned among cmodel->numThreads threads of the compute
+// model's thread pool.
+
+namespace gte
+{
+
+template <typename Real>
+class ImageConvolution
+{
+public:
+    // Handling of the input pixels outside the image, described for index i
+    // of a dimension of size n.
+    //   CLAMP:  i is clamped to [0,n-1].
+    //   WRAP:  i is reduced modulo n.
+    //   ZERO:  the pixel value is zero.
+    //   MIRROR:  the image is reflected about its boundary, repeating the
+    //     boundary pixel, so -1 maps to 0 and n maps to n-1.
+    enum BoundaryMode
+    {
+        CLAMP,
+        WRAP,
+        ZERO,
+        MIRROR
+    };
+
+    enum Method
+    {
+        AUTOMATIC,
+        DIRECT,
+        SEPARABLE,
+        FFT
+    };
+
+    // A description of the method choice.  The costs are estimates of the
+    // number of multiply-add operations.  The FFT cost is scaled relative to
+    // the direct cost by the measured throughput of the two methods.  If
+    // the kernel is not separable, separableCost is the maximum double.
+    struct Report
+    {
+        Method method;
+        bool isSeparable;
+        double directCost, separableCost, fftCost;
+    };
+
+    // Convolution with a kernel of odd dimensions.  The output must have
+    // the dimensions of the input and must be an object different from it.
+    // If SEPARABLE is requested for a kernel that is not rank one, the
+    // direct method is used.  If 'report' is not null, it is set to the
+    // method that was used and the estimated costs.
+    static void Convolve(Image2<Real> const& input,
+        Image2<Real> const& kernel, BoundaryMode mode, Image2<Real>& output,
+        Method method = AUTOMATIC,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr,
+        Report* report = nullptr);
+
+    static void Convolve(Image3<Real> const& input,
+        Image3<Real> const& kernel, BoundaryMode mode, Image3<Real>& output,
+        Method method = AUTOMATIC,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr,
+        Report* report = nullptr);
+
+    // Convolution with a separable kernel whose factors are specified
+    // directly.  Each factor must have an odd number of elements.
+    static void Convolve(Image2<Real> const& input,
+        std::vector<Real> const& kernel0, std::vector<Real> const& kernel1,
+        BoundaryMode mode, Image2<Real>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    static void Convolve(Image3<Real> const& input,
+        std::vector<Real> const& kernel0, std::vector<Real> const& kernel1,
+        std::vector<Real> const& kernel2, BoundaryMode mode,
+        Image3<Real>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    // The method that Convolve would use, without convolving.
+    static Report GetReport(Image2<Real> const& input,
+        Image2<Real> const& kernel, Method method = AUTOMATIC);
+
+    static Report GetReport(Image3<Real> const& input,
+        Image3<Real> const& kernel, Method method = AUTOMATIC);
+
+private:
+    // The 2D and 3D functions share an implementation for 3D arrays with x
+    // varying fastest.  A 2D image has dimension 1 in z.
+    typedef std::array<int, 3> Size;
+    typedef std::array<std::vector<Real>, 3> Factors;
+
+    static void Convolve(Real const* input, Size const& dim,
+        Real const* kernel, Size const& kdim, BoundaryMode mode,
+        Real* output, Method method, ComputeModel const* cmodel,
+        Report* report);
+
+    // Select a method and, when the kernel is separable, compute its
+    // factors.
+    static Report Choose(Size const& dim, Real const* kernel,
+        Size const& kdim, Method method, Factors& factors);
+
+    static void ConvolveDirect(Real const* input, Size const& dim,
+        Real const* kernel, Size const& kdim, BoundaryMode mode,
+        Real* output, ComputeModel const* cmodel);
+
+    static void ConvolveSeparable(Real const* input, Size const& dim,
+        Factors const& factors, BoundaryMode mode, Real* output,
+        ComputeModel const* cmodel);
+
+    static void ConvolveFFT(Real const* input, Size const& dim,
+        Real const* kernel, Size const& kdim, BoundaryMode mode,
+        Real* output, ComputeModel const* cmodel);
+
+    // Map index i of a dimension of size n to an index in [0,n-1].  The
+    // return value is -1 when the pixel is zero (BoundaryMode ZERO).
+    static int Map(int i, int n, BoundaryMode mode);
+
+    // Copy the lines of the input to lines of 'stride' elements, extended
+    // by 'radius' pixels at each end according to the boundary mode.
+    static void ExtendLines(Real const* input, Size const& dim, int radius,
+        BoundaryMode mode, int stride, Real* extended,
+        ComputeModel const* cmodel);
+
+    // target[x] = sum_t weight[t]*source[t][x] for 0 <= x < length, where
+    // length is a multiple of BLOCK_SIZE.  The sums are accumulated in a
+    // local array of BLOCK_SIZE elements.
+    enum { BLOCK_SIZE = 16 };
+    static void Accumulate(int length, int numTerms,
+        Real const* const* source, Real const* weight, Real* target);
+
+    // Radix-2 FFT of n = 2^m elements with the twiddle factors
+    // twiddle[k] = exp(-2*pi*i*k/n) for 0 <= k < n/2.
+    static void FFT1(int n, std::complex<Real> const* twiddle,
+        std::complex<Real>* data);
+
+    // Forward FFT of an array of size[0]*size[1]*size[2] elements, where
+    // each size is a power of two.
+    static void FFT3(Size const& size, std::complex<Real>* data,
+        ComputeModel const* cmodel);
+
+    // Process the lines 0 through numLines-1 with the thread pool of the
+    // compute model and wait for them to finish.  If cmodel is null, the
+    // lines are processed on the calling thread.
+    static void Execute(int numLines, ComputeModel const* cmodel,
+        std::function<void(int, int)> const& process);
+};
+
+#include "GteImageConvolution.inl"
+
+}
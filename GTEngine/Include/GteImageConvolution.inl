@@ -0,0 +1,751 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/28)
+
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::Convolve(Image2<Real> const& input,
+    Image2<Real> const& kernel, BoundaryMode mode, Image2<Real>& output,
+    Method method, std::shared_ptr<ComputeModel> const& cmodel,
+    Report* report)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+    LogAssert(output.GetDimension(0) == input.GetDimension(0)
+        && output.GetDimension(1) == input.GetDimension(1),
+        "Input and output must have the same dimensions.");
+
+    Size dim = { input.GetDimension(0), input.GetDimension(1), 1 };
+    Size kdim = { kernel.GetDimension(0), kernel.GetDimension(1), 1 };
+    Convolve(input.GetPixels1D(), dim, kernel.GetPixels1D(), kdim, mode,
+        output.GetPixels1D(), method, cmodel.get(), report);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::Convolve(Image3<Real> const& input,
+    Image3<Real> const& kernel, BoundaryMode mode, Image3<Real>& output,
+    Method method, std::shared_ptr<ComputeModel> const& cmodel,
+    Report* report)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+    LogAssert(output.GetDimension(0) == input.GetDimension(0)
+        && output.GetDimension(1) == input.GetDimension(1)
+        && output.GetDimension(2) == input.GetDimension(2),
+        "Input and output must have the same dimensions.");
+
+    Size dim = { input.GetDimension(0), input.GetDimension(1),
+        input.GetDimension(2) };
+    Size kdim = { kernel.GetDimension(0), kernel.GetDimension(1),
+        kernel.GetDimension(2) };
+    Convolve(input.GetPixels1D(), dim, kernel.GetPixels1D(), kdim, mode,
+        output.GetPixels1D(), method, cmodel.get(), report);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::Convolve(Image2<Real> const& input,
+    std::vector<Real> const& kernel0, std::vector<Real> const& kernel1,
+    BoundaryMode mode, Image2<Real>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+    LogAssert(output.GetDimension(0) == input.GetDimension(0)
+        && output.GetDimension(1) == input.GetDimension(1),
+        "Input and output must have the same dimensions.");
+    LogAssert((kernel0.size() & 1) == 1 && (kernel1.size() & 1) == 1,
+        "Kernel sizes must be odd.");
+
+    Size dim = { input.GetDimension(0), input.GetDimension(1), 1 };
+    Factors factors = { kernel0, kernel1, std::vector<Real>(1, (Real)1) };
+    ConvolveSeparable(input.GetPixels1D(), dim, factors, mode,
+        output.GetPixels1D(), cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::Convolve(Image3<Real> const& input,
+    std::vector<Real> const& kernel0, std::vector<Real> const& kernel1,
+    std::vector<Real> const& kernel2, BoundaryMode mode,
+    Image3<Real>& output, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    LogAssert(&output != &input, "Input and output must be different.");
+    LogAssert(output.GetDimension(0) == input.GetDimension(0)
+        && output.GetDimension(1) == input.GetDimension(1)
+        && output.GetDimension(2) == input.GetDimension(2),
+        "Input and output must have the same dimensions.");
+    LogAssert((kernel0.size() & 1) == 1 && (kernel1.size() & 1) == 1
+        && (kernel2.size() & 1) == 1, "Kernel sizes must be odd.");
+
+    Size dim = { input.GetDimension(0), input.GetDimension(1),
+        input.GetDimension(2) };
+    Factors factors = { kernel0, kernel1, kernel2 };
+    ConvolveSeparable(input.GetPixels1D(), dim, factors, mode,
+        output.GetPixels1D(), cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+typename ImageConvolution<Real>::Report ImageConvolution<Real>::GetReport(
+    Image2<Real> const& input, Image2<Real> const& kernel, Method method)
+{
+    Size dim = { input.GetDimension(0), input.GetDimension(1), 1 };
+    Size kdim = { kernel.GetDimension(0), kernel.GetDimension(1), 1 };
+    Factors factors;
+    return Choose(dim, kernel.GetPixels1D(), kdim, method, factors);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+typename ImageConvolution<Real>::Report ImageConvolution<Real>::GetReport(
+    Image3<Real> const& input, Image3<Real> const& kernel, Method method)
+{
+    Size dim = { input.GetDimension(0), input.GetDimension(1),
+        input.GetDimension(2) };
+    Size kdim = { kernel.GetDimension(0), kernel.GetDimension(1),
+        kernel.GetDimension(2) };
+    Factors factors;
+    return Choose(dim, kernel.GetPixels1D(), kdim, method, factors);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::Convolve(Real const* input, Size const& dim,
+    Real const* kernel, Size const& kdim, BoundaryMode mode, Real* output,
+    Method method, ComputeModel const* cmodel, Report* report)
+{
+    LogAssert((kdim[0] & 1) == 1 && (kdim[1] & 1) == 1 && (kdim[2] & 1) == 1,
+        "Kernel dimensions must be odd.");
+
+    Factors factors;
+    Report choice = Choose(dim, kernel, kdim, method, factors);
+    switch (choice.method)
+    {
+    case SEPARABLE:
+        ConvolveSeparable(input, dim, factors, mode, output, cmodel);
+        break;
+    case FFT:
+        ConvolveFFT(input, dim, kernel, kdim, mode, output, cmodel);
+        break;
+    default:
+        ConvolveDirect(input, dim, kernel, kdim, mode, output, cmodel);
+        break;
+    }
+
+    if (report)
+    {
+        *report = choice;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+typename ImageConvolution<Real>::Report ImageConvolution<Real>::Choose(
+    Size const& dim, Real const* kernel, Size const& kdim, Method method,
+    Factors& factors)
+{
+    int const numKernel = kdim[0] * kdim[1] * kdim[2];
+
+    // The kernel is rank one when kernel(i,j,k) = f0[i]*f1[j]*f2[k].  If
+    // it is, the factors are the lines through the element of maximum
+    // magnitude, two of them divided by that element.
+    int pivot = 0, numNonzero = 0;
+    Real maxAbs = (Real)0;
+    for (int i = 0; i < numKernel; ++i)
+    {
+        Real absValue = std::abs(kernel[i]);
+        if (absValue > maxAbs)
+        {
+            maxAbs = absValue;
+            pivot = i;
+        }
+        if (kernel[i] != (Real)0)
+        {
+            ++numNonzero;
+        }
+    }
+
+    Size p = { pivot % kdim[0], (pivot / kdim[0]) % kdim[1],
+        pivot / (kdim[0] * kdim[1]) };
+    Real const divisor = (maxAbs > (Real)0 ? kernel[pivot] : (Real)1);
+    for (int d = 0, stride = 1; d < 3; stride *= kdim[d], ++d)
+    {
+        int base = pivot - p[d] * stride;
+        factors[d].resize(kdim[d]);
+        for (int i = 0; i < kdim[d]; ++i)
+        {
+            factors[d][i] = kernel[base + i * stride];
+            if (d > 0)
+            {
+                factors[d][i] /= divisor;
+            }
+        }
+    }
+
+    Real const tolerance =
+        (Real)32 * std::numeric_limits<Real>::epsilon() * maxAbs;
+    bool isSeparable = true;
+    for (int k = 0, i = 0; k < kdim[2] && isSeparable; ++k)
+    {
+        for (int y = 0; y < kdim[1] && isSeparable; ++y)
+        {
+            Real product = factors[1][y] * factors[2][k];
+            for (int x = 0; x < kdim[0]; ++x, ++i)
+            {
+                if (std::abs(kernel[i] - factors[0][x] * product) > tolerance)
+                {
+                    isSeparable = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    double const numPixels = static_cast<double>(dim[0]) *
+        static_cast<double>(dim[1]) * static_cast<double>(dim[2]);
+
+    // Each pass of the separable method is skipped when its factor is the
+    // identity.
+    int numSeparable = 0;
+    for (int d = 0; d < 3; ++d)
+    {
+        if (kdim[d] > 1 || factors[d][0] != (Real)1)
+        {
+            numSeparable += kdim[d];
+        }
+    }
+
+    double numPadded = 1.0, logNumPadded = 0.0;
+    for (int d = 0; d < 3; ++d)
+    {
+        int size = 1, logSize = 0;
+        while (size < dim[d] + kdim[d] - 1)
+        {
+            size <<= 1;
+            ++logSize;
+        }
+        numPadded *= static_cast<double>(size);
+        logNumPadded += static_cast<double>(logSize);
+    }
+
+    // The cost of the FFT method per element and per level of the
+    // transforms (half a butterfly for each of the two transforms), in
+    // units of the vectorized multiply-add of Accumulate.  The constant was
+    // measured for 2D and 3D float images.  The conversions of the input
+    // and output cost about one unit per element.
+    double const fftFactor = 14.0;
+
+    Report report;
+    report.isSeparable = isSeparable;
+    report.directCost = numPixels * static_cast<double>(numNonzero);
+    report.separableCost = (isSeparable ?
+        numPixels * static_cast<double>(numSeparable) :
+        std::numeric_limits<double>::max());
+    report.fftCost = numPadded * (fftFactor * logNumPadded + 1.0);
+
+    if (method == AUTOMATIC)
+    {
+        report.method = DIRECT;
+        double minCost = report.directCost;
+        if (report.separableCost < minCost)
+        {
+            report.method = SEPARABLE;
+            minCost = report.separableCost;
+        }
+        if (report.fftCost < minCost)
+        {
+            report.method = FFT;
+        }
+    }
+    else if (method == SEPARABLE && !isSeparable)
+    {
+        report.method = DIRECT;
+    }
+    else
+    {
+        report.method = method;
+    }
+    return report;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::ConvolveDirect(Real const* input,
+    Size const& dim, Real const* kernel, Size const& kdim,
+    BoundaryMode mode, Real* output, ComputeModel const* cmodel)
+{
+    Size radius = { kdim[0] / 2, kdim[1] / 2, kdim[2] / 2 };
+    int const length = (dim[0] + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+    int const stride = length + 2 * radius[0];
+    int const numLines = dim[1] * dim[2];
+    std::vector<Real> extended(static_cast<size_t>(numLines) * stride);
+    ExtendLines(input, dim, radius[0], mode, stride, extended.data(),
+        cmodel);
+
+    Execute(numLines, cmodel, [&](int lmin, int lmax)
+    {
+        int const numKernel = kdim[0] * kdim[1] * kdim[2];
+        std::vector<Real const*> source(numKernel);
+        std::vector<Real> weight(numKernel), target(length);
+        for (int line = lmin; line <= lmax; ++line)
+        {
+            int const y = line % dim[1], z = line / dim[1];
+            int numTerms = 0;
+            for (int k = 0, i = 0; k < kdim[2]; ++k)
+            {
+                int zs = Map(z + k - radius[2], dim[2], mode);
+                for (int j = 0; j < kdim[1]; ++j, i += kdim[0])
+                {
+                    int ys = Map(y + j - radius[1], dim[1], mode);
+                    if (zs < 0 || ys < 0)
+                    {
+                        continue;
+                    }
+
+                    Real const* row =
+                        &extended[static_cast<size_t>(ys + dim[1] * zs) *
+                        stride];
+                    for (int x = 0; x < kdim[0]; ++x)
+                    {
+                        if (kernel[i + x] != (Real)0)
+                        {
+                            source[numTerms] = row + x;
+                            weight[numTerms] = kernel[i + x];
+                            ++numTerms;
+                        }
+                    }
+                }
+            }
+
+            Accumulate(length, numTerms, source.data(), weight.data(),
+                target.data());
+            std::copy(target.begin(), target.begin() + dim[0],
+                output + static_cast<size_t>(line) * dim[0]);
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::ConvolveSeparable(Real const* input,
+    Size const& dim, Factors const& factors, BoundaryMode mode,
+    Real* output, ComputeModel const* cmodel)
+{
+    // The intermediate images have lines of 'length' elements so that
+    // Accumulate can process whole blocks.
+    int const length = (dim[0] + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+    int const numLines = dim[1] * dim[2];
+    size_t const numElements = static_cast<size_t>(numLines) * length;
+    std::vector<Real> buffer0(numElements), buffer1(numElements);
+    Real* current = buffer0.data();
+    Real* next = buffer1.data();
+
+    // Filter along x.  The lines are extended as they are processed.
+    int const radius0 = static_cast<int>(factors[0].size()) / 2;
+    int const stride = length + 2 * radius0;
+    Execute(numLines, cmodel, [&](int lmin, int lmax)
+    {
+        Size lineDim = { dim[0], 1, 1 };
+        std::vector<Real> extended(stride);
+        std::vector<Real const*> source(factors[0].size());
+        for (size_t i = 0; i < source.size(); ++i)
+        {
+            source[i] = &extended[i];
+        }
+
+        for (int line = lmin; line <= lmax; ++line)
+        {
+            ExtendLines(input + static_cast<size_t>(line) * dim[0], lineDim,
+                radius0, mode, stride, extended.data(), nullptr);
+            Accumulate(length, static_cast<int>(source.size()),
+                source.data(), factors[0].data(),
+                current + static_cast<size_t>(line) * length);
+        }
+    });
+
+    // Filter along y and then z.  An output line is a weighted sum of
+    // whole input lines, so these passes access memory sequentially.
+    for (int d = 1; d < 3; ++d)
+    {
+        std::vector<Real> const& factor = factors[d];
+        int const size = static_cast<int>(factor.size());
+        if (size == 1 && factor[0] == (Real)1)
+        {
+            continue;
+        }
+
+        int const radius = size / 2;
+        Execute(numLines, cmodel, [&](int lmin, int lmax)
+        {
+            std::vector<Real const*> source(size);
+            std::vector<Real> weight(size);
+            for (int line = lmin; line <= lmax; ++line)
+            {
+                int coord[2] = { line % dim[1], line / dim[1] };
+                int numTerms = 0;
+                for (int i = 0; i < size; ++i)
+                {
+                    int c[2] = { coord[0], coord[1] };
+                    c[d - 1] = Map(c[d - 1] + i - radius, dim[d], mode);
+                    if (c[d - 1] >= 0)
+                    {
+                        source[numTerms] = current +
+                            static_cast<size_t>(c[0] + dim[1] * c[1]) * length;
+                        weight[numTerms] = factor[i];
+                        ++numTerms;
+                    }
+                }
+                Accumulate(length, numTerms, source.data(), weight.data(),
+                    next + static_cast<size_t>(line) * length);
+            }
+        });
+        std::swap(current, next);
+    }
+
+    for (int line = 0; line < numLines; ++line)
+    {
+        Real const* source = current + static_cast<size_t>(line) * length;
+        std::copy(source, source + dim[0],
+            output + static_cast<size_t>(line) * dim[0]);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::ConvolveFFT(Real const* input,
+    Size const& dim, Real const* kernel, Size const& kdim,
+    BoundaryMode mode, Real* output, ComputeModel const* cmodel)
+{
+    // The boundary-extended image has dimensions dim[d]+kdim[d]-1.  It is
+    // padded with zeros to powers of two.  The circular correlation of the
+    // padded arrays is then the linear correlation at the output pixels.
+    Size radius = { kdim[0] / 2, kdim[1] / 2, kdim[2] / 2 };
+    Size extent, size;
+    for (int d = 0; d < 3; ++d)
+    {
+        extent[d] = dim[d] + 2 * radius[d];
+        size[d] = 1;
+        while (size[d] < extent[d])
+        {
+            size[d] <<= 1;
+        }
+    }
+    int const numLines = size[1] * size[2];
+    std::vector<std::complex<Real>> data(
+        static_cast<size_t>(numLines) * size[0]);
+
+    // The real part is the extended image and the imaginary part is the
+    // kernel.
+    Execute(numLines, cmodel, [&](int lmin, int lmax)
+    {
+        std::vector<int> xMap(extent[0]);
+        for (int x = 0; x < extent[0]; ++x)
+        {
+            xMap[x] = Map(x - radius[0], dim[0], mode);
+        }
+
+        for (int line = lmin; line <= lmax; ++line)
+        {
+            int const y = line % size[1], z = line / size[1];
+            std::complex<Real>* target =
+                &data[static_cast<size_t>(line) * size[0]];
+
+            Real const* source = nullptr;
+            if (y < extent[1] && z < extent[2])
+            {
+                int ys = Map(y - radius[1], dim[1], mode);
+                int zs = Map(z - radius[2], dim[2], mode);
+                if (ys >= 0 && zs >= 0)
+                {
+                    source = input +
+                        static_cast<size_t>(ys + dim[1] * zs) * dim[0];
+                }
+            }
+
+            Real const* kernelLine = nullptr;
+            if (y < kdim[1] && z < kdim[2])
+            {
+                kernelLine = kernel + (y + kdim[1] * z) * kdim[0];
+            }
+
+            for (int x = 0; x < size[0]; ++x)
+            {
+                Real re = (Real)0, im = (Real)0;
+                if (source && x < extent[0] && xMap[x] >= 0)
+                {
+                    re = source[xMap[x]];
+                }
+                if (kernelLine && x < kdim[0])
+                {
+                    im = kernelLine[x];
+                }
+                target[x] = std::complex<Real>(re, im);
+            }
+        }
+    });
+
+    FFT3(size, data.data(), cmodel);
+
+    // With Z the transform of image+i*kernel, the transforms of the image
+    // and kernel at frequency f are E = (Z[f] + conj(Z[-f]))/2 and
+    // K = (Z[f] - conj(Z[-f]))/(2i).  The correlation has transform
+    // P = E*conj(K), and P[-f] = conj(P[f]).  The inverse transform is
+    // computed as the forward transform of conj(P), of which only the real
+    // part is used.  Each pair (f,-f) is processed by the line that
+    // contains the smaller index, so the threads write disjoint elements.
+    Execute(numLines, cmodel, [&](int lmin, int lmax)
+    {
+        for (int line = lmin; line <= lmax; ++line)
+        {
+            int const y = line % size[1], z = line / size[1];
+            int const yNeg = (size[1] - y) & (size[1] - 1);
+            int const zNeg = (size[2] - z) & (size[2] - 1);
+            size_t const base = static_cast<size_t>(line) * size[0];
+            size_t const baseNeg =
+                static_cast<size_t>(yNeg + size[1] * zNeg) * size[0];
+            for (int x = 0; x < size[0]; ++x)
+            {
+                int xNeg = (size[0] - x) & (size[0] - 1);
+                size_t i = base + x, iNeg = baseNeg + xNeg;
+                if (i > iNeg)
+                {
+                    continue;
+                }
+
+                Real zr = data[i].real(), zi = data[i].imag();
+                Real nr = data[iNeg].real(), ni = data[iNeg].imag();
+                Real er = (Real)0.5 * (zr + nr), ei = (Real)0.5 * (zi - ni);
+                Real kr = (Real)0.5 * (zi + ni), ki = (Real)0.5 * (nr - zr);
+                Real pr = er * kr + ei * ki, pi = ei * kr - er * ki;
+                data[iNeg] = std::complex<Real>(pr, pi);
+                data[i] = std::complex<Real>(pr, -pi);
+            }
+        }
+    });
+
+    FFT3(size, data.data(), cmodel);
+
+    Real const scale = (Real)1 / (static_cast<Real>(size[0]) *
+        static_cast<Real>(size[1]) * static_cast<Real>(size[2]));
+    Execute(dim[1] * dim[2], cmodel, [&](int lmin, int lmax)
+    {
+        for (int line = lmin; line <= lmax; ++line)
+        {
+            int const y = line % dim[1], z = line / dim[1];
+            std::complex<Real> const* source =
+                &data[static_cast<size_t>(y + size[1] * z) * size[0]];
+            Real* target = output + static_cast<size_t>(line) * dim[0];
+            for (int x = 0; x < dim[0]; ++x)
+            {
+                target[x] = scale * source[x].real();
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int ImageConvolution<Real>::Map(int i, int n, BoundaryMode mode)
+{
+    if (0 <= i && i < n)
+    {
+        return i;
+    }
+
+    switch (mode)
+    {
+    case WRAP:
+        i %= n;
+        return (i < 0 ? i + n : i);
+    case ZERO:
+        return -1;
+    case MIRROR:
+        i %= 2 * n;
+        if (i < 0)
+        {
+            i += 2 * n;
+        }
+        return (i < n ? i : 2 * n - 1 - i);
+    default:
+        return (i < 0 ? 0 : n - 1);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::ExtendLines(Real const* input, Size const& dim,
+    int radius, BoundaryMode mode, int stride, Real* extended,
+    ComputeModel const* cmodel)
+{
+    Execute(dim[1] * dim[2], cmodel, [&](int lmin, int lmax)
+    {
+        for (int line = lmin; line <= lmax; ++line)
+        {
+            Real const* source = input + static_cast<size_t>(line) * dim[0];
+            Real* target = extended + static_cast<size_t>(line) * stride;
+            for (int x = 0; x < radius; ++x)
+            {
+                int i = Map(x - radius, dim[0], mode);
+                target[x] = (i >= 0 ? source[i] : (Real)0);
+            }
+            std::copy(source, source + dim[0], target + radius);
+            for (int x = dim[0] + radius; x < stride; ++x)
+            {
+                int i = Map(x - radius, dim[0], mode);
+                target[x] = (i >= 0 ? source[i] : (Real)0);
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::Accumulate(int length, int numTerms,
+    Real const* const* source, Real const* weight, Real* target)
+{
+    for (int x0 = 0; x0 < length; x0 += BLOCK_SIZE)
+    {
+        Real sum[BLOCK_SIZE] = { (Real)0 };
+        for (int t = 0; t < numTerms; ++t)
+        {
+            Real const w = weight[t];
+            Real const* s = source[t] + x0;
+            for (int e = 0; e < BLOCK_SIZE; ++e)
+            {
+                sum[e] += w * s[e];
+            }
+        }
+        for (int e = 0; e < BLOCK_SIZE; ++e)
+        {
+            target[x0 + e] = sum[e];
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::FFT1(int n, std::complex<Real> const* twiddle,
+    std::complex<Real>* data)
+{
+    // Bit-reversal permutation.
+    for (int i = 1, j = 0; i < n; ++i)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    // The butterflies are written in real arithmetic; the complex multiply
+    // of the standard library handles infinities and is slow.
+    for (int size = 2, step = n / 2; size <= n; size <<= 1, step >>= 1)
+    {
+        int const half = size / 2;
+        for (int i0 = 0; i0 < n; i0 += size)
+        {
+            std::complex<Real>* lower = data + i0;
+            std::complex<Real>* upper = lower + half;
+            for (int k = 0; k < half; ++k)
+            {
+                Real wr = twiddle[k * step].real();
+                Real wi = twiddle[k * step].imag();
+                Real ur = upper[k].real(), ui = upper[k].imag();
+                Real tr = wr * ur - wi * ui, ti = wr * ui + wi * ur;
+                Real lr = lower[k].real(), li = lower[k].imag();
+                upper[k] = std::complex<Real>(lr - tr, li - ti);
+                lower[k] = std::complex<Real>(lr + tr, li + ti);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::FFT3(Size const& size,
+    std::complex<Real>* data, ComputeModel const* cmodel)
+{
+    // The transforms along y and z gather this many adjacent columns at a
+    // time, so the reads are of consecutive elements.
+    int const numColumns = std::min(size[0], 8);
+
+    for (int d = 0; d < 3; ++d)
+    {
+        int const n = size[d];
+        if (n == 1)
+        {
+            continue;
+        }
+
+        double const angle = -2.0 * 3.14159265358979323846 / n;
+        std::vector<std::complex<Real>> twiddle(n / 2);
+        for (int k = 0; k < n / 2; ++k)
+        {
+            twiddle[k] = std::complex<Real>(
+                static_cast<Real>(std::cos(angle * k)),
+                static_cast<Real>(std::sin(angle * k)));
+        }
+
+        if (d == 0)
+        {
+            Execute(size[1] * size[2], cmodel, [&](int lmin, int lmax)
+            {
+                for (int line = lmin; line <= lmax; ++line)
+                {
+                    FFT1(n, twiddle.data(),
+                        data + static_cast<size_t>(line) * n);
+                }
+            });
+            continue;
+        }
+
+        // The lines along y are indexed by (x,z) and those along z by
+        // (x,y), with x in blocks of numColumns.
+        size_t const stride = (d == 1 ? static_cast<size_t>(size[0]) :
+            static_cast<size_t>(size[0]) * size[1]);
+        size_t const outerStride = (d == 1 ? stride * size[1] :
+            static_cast<size_t>(size[0]));
+        int const numOuter = (d == 1 ? size[2] : size[1]);
+        int const numBlocks = size[0] / numColumns;
+        Execute(numOuter * numBlocks, cmodel, [&](int lmin, int lmax)
+        {
+            std::vector<std::complex<Real>> column(numColumns * n);
+            for (int line = lmin; line <= lmax; ++line)
+            {
+                int const x0 = (line % numBlocks) * numColumns;
+                int const outer = line / numBlocks;
+                std::complex<Real>* base = data + x0 + outer * outerStride;
+
+                for (int i = 0; i < n; ++i)
+                {
+                    std::complex<Real> const* source = base + i * stride;
+                    for (int c = 0; c < numColumns; ++c)
+                    {
+                        column[c * n + i] = source[c];
+                    }
+                }
+                for (int c = 0; c < numColumns; ++c)
+                {
+                    FFT1(n, twiddle.data(), &column[c * n]);
+                }
+                for (int i = 0; i < n; ++i)
+                {
+                    std::complex<Real>* target = base + i * stride;
+                    for (int c = 0; c < numColumns; ++c)
+                    {
+                        target[c] = column[c * n + i];
+                    }
+                }
+            }
+        });
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void ImageConvolution<Real>::Execute(int numLines,
+    ComputeModel const* cmodel, std::function<void(int, int)> const& process)
+{
+    int const numThreads =
+        (cmodel ? static_cast<int>(cmodel->numThreads) : 1);
+    if (numThreads > 1 && numLines > 1)
+    {
+        cmodel->GetThreadPool().ParallelFor(numLines, numThreads, process);
+    }
+    else if (numLines > 0)
+    {
+        process(0, numLines - 1);
+    }
+}
+//----------------------------------------------------------------------------
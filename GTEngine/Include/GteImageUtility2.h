@@ -3,12 +3,19 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.2 (2014/09/25)
+// File Version: 1.0.6 (2014/10/26)
 
 #pragma once
 
 #include "GTEngineDEF.h"
+#include "GteComputeModel.h"
 #include "GteImage2.h"
+#include "GteMorphologyFilter.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
 
 namespace gte
 {
@@ -28,19 +35,38 @@ public:
     // Dilation and erosion functions do not have the requirement that the
     // boundary pixels of the binary image inputs be zero.
 
+    // Statistics for a connected component, computed by GetComponents4 and
+    // GetComponents8 at the same time the labels are assigned.  The
+    // bounding box is [xMin,xMax]x[yMin,yMax] in pixel coordinates and the
+    // centroid is the average of the pixel coordinates.
+    struct ComponentStatistics
+    {
+        size_t numPixels;
+        int xMin, xMax, yMin, yMax;
+        double xCentroid, yCentroid;
+    };
+
     // Compute the 4-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  If 'statistics'
+    // is not null, (*statistics)[k] is the summary of the k-th component.
+    // The labeling is partitioned among cmodel->numThreads threads.
     static void GetComponents4(Image2<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        std::vector<ComponentStatistics>* statistics = nullptr,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
 
     // Compute the 8-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  If 'statistics'
+    // is not null, (*statistics)[k] is the summary of the k-th component.
+    // The labeling is partitioned among cmodel->numThreads threads.
     static void GetComponents8(Image2<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        std::vector<ComponentStatistics>* statistics = nullptr,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
 
     // Compute a dilation with a structuring element consisting of the
     // 4-connected neighbors of each pixel.  The input image is binary with 0
@@ -148,6 +174,127 @@ public:
         int numNeighbors, std::array<int, 2> const* neighbors,
         Image2<int>& output);
 
+    // Grayscale dilation and erosion with large structuring elements.  A
+    // dilation replaces each pixel by the maximum of the input over the
+    // structuring element centered at the pixel, and an erosion replaces
+    // it by the minimum.  For a binary image these are the usual binary
+    // operations.  The structuring element is clipped to the image, which
+    // is equivalent to an image exterior of -infinity for the dilation and
+    // +infinity for the erosion.  The output image must have the same
+    // dimensions as the input image and must be an object different from
+    // it.  PixelType is any type with a total order and a
+    // std::numeric_limits specialization; for example, int, uint8_t, or
+    // float.  The work is partitioned among cmodel->numThreads threads.
+    //
+    // The box has dimensions (2*radius0+1)x(2*radius1+1).  It is separable,
+    // and the 1D filters use the algorithm of van Herk and of Gil and
+    // Werman, which requires 3 comparisons per pixel for any radius.  The
+    // filters along columns are applied to strips of adjacent columns, so
+    // the inner loops are over contiguous pixels and vectorize.
+    //
+    // The disk contains the pixels (x,y) with x^2 + y^2 <= radius^2.  It is
+    // the union of its horizontal chords, so the dilation is the maximum
+    // over rows y+dy of the 1D dilation with the chord for dy.  Each row is
+    // filtered once per distinct chord length, so the cost is O(radius)
+    // per pixel rather than the O(radius^2) of a direct evaluation.  Each
+    // filtered row is combined into the output rows that use its chord as
+    // soon as it is computed, so each thread needs temporary storage for
+    // only a few rows for any radius.
+    template <typename PixelType>
+    static void DilateBox(Image2<PixelType> const& input, int radius0,
+        int radius1, Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void ErodeBox(Image2<PixelType> const& input, int radius0,
+        int radius1, Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void DilateDisk(Image2<PixelType> const& input, int radius,
+        Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void ErodeDisk(Image2<PixelType> const& input, int radius,
+        Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    // An opening is an erosion followed by a dilation, and a closing is a
+    // dilation followed by an erosion, both with the same structuring
+    // element.
+    template <typename PixelType>
+    static void OpenBox(Image2<PixelType> const& input, int radius0,
+        int radius1, Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void CloseBox(Image2<PixelType> const& input, int radius0,
+        int radius1, Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void OpenDisk(Image2<PixelType> const& input, int radius,
+        Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void CloseDisk(Image2<PixelType> const& input, int radius,
+        Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    // Rank filtering with a (2*radius+1)x(2*radius+1) window.  The output
+    // pixel is the element of the specified rank among the window pixels,
+    // where rank 0 is the minimum, rank (2*radius+1)^2-1 is the maximum,
+    // and rank ((2*radius+1)^2-1)/2 is the median.  The image is extended
+    // by replicating its boundary pixels, so every window is full.  The
+    // radius must be nonnegative and the rank must satisfy
+    // 0 <= rank < (2*radius+1)^2; otherwise, an error is logged and the
+    // output is not modified.  The output image must have the same
+    // dimensions as the input image and must be an object different from
+    // it.  The rows are partitioned among cmodel->numThreads threads.
+    //
+    // The median for radius 1 or 2 (3x3 or 5x5 windows) is computed for
+    // any PixelType by forgetful selection: the minimum and maximum of
+    // (2*radius+1)^2/2+2 window elements cannot be the median, so they are
+    // discarded and the next window element is added, until 3 elements
+    // remain.  This is the algorithm of the MedianFiltering sample shaders.
+    // The compare-exchange operations are applied to a run of adjacent
+    // pixels at a time, so the inner loops vectorize.
+    //
+    // For uint8_t images, other ranks and radii use the constant-time
+    // algorithm of Perreault and Hebert, "Median Filtering in Constant
+    // Time".  Each column has a 256-bin histogram of the 2*radius+1 pixels
+    // in the window rows, and the window histogram is updated by adding and
+    // subtracting one column histogram per pixel.  The search for the rank
+    // uses 16 coarse bins to locate the fine bin.
+    //
+    // For uint16_t images, other ranks and radii use the sliding histogram
+    // of Huang, Yang, and Tang, "A Fast Two-Dimensional Median Filtering
+    // Algorithm", with 256 coarse and 65536 fine bins.  The cost is
+    // O(radius) per pixel; per-column histograms are not used because they
+    // would require 65536 bins per column.
+    //
+    // For other types, other ranks and radii use std::nth_element on the
+    // window elements, which costs O(radius^2) per pixel.
+    static void RankFilter(Image2<uint8_t> const& input, int radius,
+        int rank, Image2<uint8_t>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    static void RankFilter(Image2<uint16_t> const& input, int radius,
+        int rank, Image2<uint16_t>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void RankFilter(Image2<PixelType> const& input, int radius,
+        int rank, Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void MedianFilter(Image2<PixelType> const& input, int radius,
+        Image2<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
     // Locate a pixel and walk around the edge of a component.  The input
     // (x,y) is where the search starts for a nonzero pixel.  If (x,y) is
     // outside the component, the walk is around the outside the component.
@@ -175,10 +322,29 @@ public:
     // distance should not be larger than 100, so you have to ensure this is
     // the case for the input image.  The function returns the maximum
     // distance and a point at which the maximum distance is attained.
-    // Comments about the algorithm are in the source file.
+    // Comments about the algorithm are in the source file.  For large
+    // images, use the exact GetL2Distance that follows.
     static void GetL2Distance(Image2<int> const& image, float& maxDistance,
         int& xMax, int& yMax, Image2<float>& transform);
 
+    // Compute the exact L2-distance transform of the binary image.  The
+    // transform at a pixel is the distance to the nearest 0-valued pixel,
+    // so it is zero for the background.  The image boundary does not have
+    // to be zero, and there is no limit on the distances.  The algorithm is
+    // the separable one of Felzenszwalb and Huttenlocher, "Distance
+    // Transforms of Sampled Functions": a 1D lower envelope of parabolas is
+    // computed along every row and then every column, so the time is linear
+    // in the number of pixels.  The rows (columns) are partitioned among
+    // cmodel->numThreads threads.  The transform must have the same
+    // dimensions as the image.  If 'nearest' is not null, it must also have
+    // the same dimensions; on return nearest[i] is the index of the
+    // background pixel closest to pixel i, or -1 when the image has no
+    // background pixels (in which case the transform values are
+    // std::numeric_limits<float>::max()).
+    static void GetL2Distance(Image2<int> const& image,
+        Image2<float>& transform, Image2<int>* nearest = nullptr,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
     // Compute a skeleton of a binary image.  Boundary pixels are trimmed from
     // the object one layer at a time based on their adjacency to interior
     // pixels.  At each step the connectivity and cycles of the object are
@@ -219,14 +385,75 @@ public:
         std::function<PixelType(int, int)> const& getCallback);
 
 private:
-    // Connected component labeling using depth-first search.
-    static void GetComponents(int numNeighbors, int const* delta,
-        Image2<int>& image, std::vector<std::vector<size_t>>& components);
+    // Connected component labeling using union-find.  The image rows are
+    // partitioned into slabs, one per thread.  Each slab is scanned in
+    // raster order, and a foreground pixel is merged with its neighbors
+    // that precede it in the slab.  The equivalence trees are linked so
+    // that the root is always the smallest pixel index of the set.  The
+    // pairs of neighbors that straddle slab boundaries are merged next, and
+    // then the roots are numbered in raster order.  This produces the same
+    // labels as a depth-first search started at each unlabeled pixel in
+    // raster order.
+    static void GetComponents(int numNeighbors,
+        std::array<int, 2> const* offsets, Image2<int>& image,
+        std::vector<std::vector<size_t>>& components,
+        std::vector<ComponentStatistics>* statistics,
+        ComputeModel const* cmodel);
+
+    static int FindRoot(int* parent, int i);
+    static int Union(int* parent, int i0, int i1);
+    static int Popcount(unsigned int bits);
 
     // Support for GetL2Distance.
     static void L2Check(int x, int y, int dx, int dy, Image2<int>& xNear,
         Image2<int>& yNear, Image2<int>& dist);
 
+    // Support for the exact GetL2Distance.  L2Pass processes all rows
+    // (axis 0) or all columns (axis 1).  On input to the column pass,
+    // nearest[i] is the index of the closest background pixel in the row of
+    // pixel i (-1 if there is none).  For the row pass, the indices are
+    // initialized from 'image'.  For the column pass, the distances are
+    // written to 'transform'.  L2Envelope computes the lower envelope of the
+    // parabolas (p-q)^2 + f[q] for the samples q with site[q] >= 0 and
+    // returns in closest[p] the q that attains the minimum at sample p.
+    static void L2Pass(int axis, Image2<int> const* image,
+        Image2<int>& nearest, Image2<float>* transform,
+        ComputeModel const* cmodel);
+
+    static void L2Envelope(int numSamples, int const* site, double const* f,
+        int* closest, int* v, double* z);
+
+    // Process lines 0 through numLines-1 in ranges on at most
+    // cmodel->numThreads threads of the compute model's thread pool and wait
+    // for the ranges to finish.  If cmodel is null, the lines are processed
+    // on the calling thread.
+    static void Execute(int numLines, ComputeModel const* cmodel,
+        std::function<void(int, int)> const& process);
+
+    // Support for the box and disk filters.  The operation is std::max or
+    // std::min, and 'identity' is its identity element.  The 1D filters
+    // and the disk filter are those of MorphologyFilter.
+    template <typename PixelType, typename Operation>
+    static void FilterBox(Image2<PixelType> const& input, int radius0,
+        int radius1, Image2<PixelType>& output, PixelType identity,
+        Operation op, ComputeModel const* cmodel);
+
+    template <typename PixelType, typename Operation>
+    static void FilterDisk(Image2<PixelType> const& input, int radius,
+        Image2<PixelType>& output, PixelType identity, Operation op,
+        ComputeModel const* cmodel);
+
+    // Support for the rank filters.  GetPaddedRows copies the rows
+    // y-radius through y+radius, clamped to the image, to 'rows' with
+    // 'radius' replicated pixels at each end of a row.
+    template <typename PixelType>
+    static void GetPaddedRows(Image2<PixelType> const& input, int y,
+        int radius, std::vector<PixelType>& rows);
+
+    template <typename PixelType>
+    static void MedianBySelection(Image2<PixelType> const& input,
+        int radius, Image2<PixelType>& output, ComputeModel const* cmodel);
+
     // Support for GetSkeleton.
     static bool Interior2 (Image2<int>& image, int x, int y);
     static bool Interior3 (Image2<int>& image, int x, int y);
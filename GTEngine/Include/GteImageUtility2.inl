@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/09/25)
+// File Version: 1.0.3 (2014/10/26)
 
 //----------------------------------------------------------------------------
 template <typename PixelType>
@@ -168,3 +168,316 @@ void ImageUtility2::DrawFloodFill4(int x, int y, int xSize, int ySize,
     }
 }
 //----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::DilateBox(Image2<PixelType> const& input, int radius0,
+    int radius1, Image2<PixelType>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    FilterBox(input, radius0, radius1, output,
+        std::numeric_limits<PixelType>::lowest(),
+        [](PixelType v0, PixelType v1) { return std::max(v0, v1); },
+        cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::ErodeBox(Image2<PixelType> const& input, int radius0,
+    int radius1, Image2<PixelType>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    FilterBox(input, radius0, radius1, output,
+        std::numeric_limits<PixelType>::max(),
+        [](PixelType v0, PixelType v1) { return std::min(v0, v1); },
+        cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::DilateDisk(Image2<PixelType> const& input, int radius,
+    Image2<PixelType>& output, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    FilterDisk(input, radius, output,
+        std::numeric_limits<PixelType>::lowest(),
+        [](PixelType v0, PixelType v1) { return std::max(v0, v1); },
+        cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::ErodeDisk(Image2<PixelType> const& input, int radius,
+    Image2<PixelType>& output, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    FilterDisk(input, radius, output,
+        std::numeric_limits<PixelType>::max(),
+        [](PixelType v0, PixelType v1) { return std::min(v0, v1); },
+        cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::OpenBox(Image2<PixelType> const& input, int radius0,
+    int radius1, Image2<PixelType>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    Image2<PixelType> temp(input.GetDimension(0), input.GetDimension(1));
+    ErodeBox(input, radius0, radius1, temp, cmodel);
+    DilateBox(temp, radius0, radius1, output, cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::CloseBox(Image2<PixelType> const& input, int radius0,
+    int radius1, Image2<PixelType>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    Image2<PixelType> temp(input.GetDimension(0), input.GetDimension(1));
+    DilateBox(input, radius0, radius1, temp, cmodel);
+    ErodeBox(temp, radius0, radius1, output, cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::OpenDisk(Image2<PixelType> const& input, int radius,
+    Image2<PixelType>& output, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    Image2<PixelType> temp(input.GetDimension(0), input.GetDimension(1));
+    ErodeDisk(input, radius, temp, cmodel);
+    DilateDisk(temp, radius, output, cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::CloseDisk(Image2<PixelType> const& input, int radius,
+    Image2<PixelType>& output, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    Image2<PixelType> temp(input.GetDimension(0), input.GetDimension(1));
+    DilateDisk(input, radius, temp, cmodel);
+    ErodeDisk(temp, radius, output, cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::RankFilter(Image2<PixelType> const& input, int radius,
+    int rank, Image2<PixelType>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    int const size = 2 * radius + 1;
+    if (radius < 0 || rank < 0 || rank >= size * size)
+    {
+        LogError("Invalid radius or rank.");
+        return;
+    }
+
+    int const numElements = size * size;
+    if (1 <= radius && radius <= 2 && rank == (numElements - 1) / 2)
+    {
+        MedianBySelection(input, radius, output, cmodel.get());
+        return;
+    }
+
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    int const numPadded = dim0 + 2 * radius;
+    Execute(dim1, cmodel.get(), [&](int ymin, int ymax)
+    {
+        std::vector<PixelType> rows, window(numElements);
+        for (int y = ymin; y <= ymax; ++y)
+        {
+            GetPaddedRows(input, y, radius, rows);
+            for (int x = 0; x < dim0; ++x)
+            {
+                for (int dy = 0, i = 0; dy < size; ++dy)
+                {
+                    PixelType const* source = &rows[dy * numPadded + x];
+                    for (int dx = 0; dx < size; ++dx, ++i)
+                    {
+                        window[i] = source[dx];
+                    }
+                }
+                std::nth_element(window.begin(), window.begin() + rank,
+                    window.end());
+                output(x, y) = window[rank];
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::MedianFilter(Image2<PixelType> const& input, int radius,
+    Image2<PixelType>& output, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    int const size = 2 * radius + 1;
+    RankFilter(input, radius, (size * size - 1) / 2, output, cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, typename Operation>
+void ImageUtility2::FilterBox(Image2<PixelType> const& input, int radius0,
+    int radius1, Image2<PixelType>& output, PixelType identity,
+    Operation op, ComputeModel const* cmodel)
+{
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    PixelType const* inPixels = input.GetPixels1D();
+    PixelType* outPixels = output.GetPixels1D();
+
+    // Filter the rows.
+    Execute(dim1, cmodel, [&](int ymin, int ymax)
+    {
+        std::vector<PixelType> g(dim0 + 4 * radius0);
+        std::vector<PixelType> h(dim0 + 4 * radius0);
+        for (int y = ymin; y <= ymax; ++y)
+        {
+            size_t offset = static_cast<size_t>(dim0) * y;
+            MorphologyFilter::VanHerk(dim0, 1, 1, radius0,
+                inPixels + offset, outPixels + offset, &g[0], &h[0],
+                identity, op);
+        }
+    });
+
+    // Filter the columns in place, a strip of adjacent columns at a time.
+    int const stripSize = 64;
+    int const numStrips = (dim0 + stripSize - 1) / stripSize;
+    Execute(numStrips, cmodel, [&](int smin, int smax)
+    {
+        size_t const numElements =
+            static_cast<size_t>(dim1 + 4 * radius1) * stripSize;
+        std::vector<PixelType> g(numElements), h(numElements);
+        for (int s = smin; s <= smax; ++s)
+        {
+            int x = s * stripSize;
+            int count = std::min(stripSize, dim0 - x);
+            MorphologyFilter::VanHerk(dim1, dim0, count, radius1,
+                outPixels + x, outPixels + x, &g[0], &h[0], identity, op);
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, typename Operation>
+void ImageUtility2::FilterDisk(Image2<PixelType> const& input, int radius,
+    Image2<PixelType>& output, PixelType identity, Operation op,
+    ComputeModel const* cmodel)
+{
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    PixelType const* inPixels = input.GetPixels1D();
+    PixelType* outPixels = output.GetPixels1D();
+    Execute(dim1, cmodel, [&](int ymin, int ymax)
+    {
+        std::vector<PixelType> buffer;
+        MorphologyFilter::FilterDiskRows(dim0, dim1, radius * radius,
+            inPixels, outPixels, ymin, ymax, identity, op, buffer);
+    });
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::GetPaddedRows(Image2<PixelType> const& input, int y,
+    int radius, std::vector<PixelType>& rows)
+{
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    int const numPadded = dim0 + 2 * radius;
+    rows.resize((2 * radius + 1) * numPadded);
+    for (int dy = -radius; dy <= radius; ++dy)
+    {
+        int row = std::min(std::max(y + dy, 0), dim1 - 1);
+        PixelType const* source = &input(0, row);
+        PixelType* target = &rows[(dy + radius) * numPadded];
+        std::fill(target, target + radius, source[0]);
+        std::copy(source, source + dim0, target + radius);
+        std::fill(target + radius + dim0, target + numPadded,
+            source[dim0 - 1]);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility2::MedianBySelection(Image2<PixelType> const& input,
+    int radius, Image2<PixelType>& output, ComputeModel const* cmodel)
+{
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    int const size = 2 * radius + 1;
+    int const numElements = size * size;
+    int const numSlots = numElements / 2 + 2;
+    int const numPadded = dim0 + 2 * radius;
+
+    // The pixels of a row are processed in runs of runSize, so the working
+    // set fits in the L1 cache.  The compare-exchange operations are
+    // applied to blocks of blockSize pixels.
+    int const runSize = 256;
+    int const blockSize = 16;
+
+    Execute(dim1, cmodel, [&](int ymin, int ymax)
+    {
+        std::vector<PixelType> rows, storage(numSlots * runSize);
+        std::vector<PixelType*> slot(numSlots);
+        for (int y = ymin; y <= ymax; ++y)
+        {
+            GetPaddedRows(input, y, radius, rows);
+            for (int x0 = 0; x0 < dim0; x0 += runSize)
+            {
+                int const count = std::min(runSize, dim0 - x0);
+
+                // Window element i is at offset (dy,dx) = (i/size,i%size)
+                // from the upper-left corner of the window.
+                auto Element = [&](int i)
+                {
+                    return &rows[(i / size) * numPadded + x0 + i % size];
+                };
+
+                for (int k = 0; k < numSlots; ++k)
+                {
+                    slot[k] = &storage[k * runSize];
+                    PixelType const* source = Element(k);
+                    std::copy(source, source + count, slot[k]);
+                }
+
+                // The results are computed in local arrays and then
+                // copied, because the compiler cannot prove that 'a' and
+                // 'b' do not overlap and otherwise does not vectorize the
+                // loops.  The trailing elements of the last block of a
+                // run are unused.
+                auto CompareExchange = [count](PixelType* a, PixelType* b)
+                {
+                    for (int e0 = 0; e0 < count; e0 += blockSize)
+                    {
+                        PixelType lo[blockSize], hi[blockSize];
+                        for (int e = 0; e < blockSize; ++e)
+                        {
+                            PixelType u = a[e0 + e], v = b[e0 + e];
+                            bool less = (u < v);
+                            lo[e] = (less ? u : v);
+                            hi[e] = (less ? v : u);
+                        }
+                        for (int e = 0; e < blockSize; ++e)
+                        {
+                            a[e0 + e] = lo[e];
+                            b[e0 + e] = hi[e];
+                        }
+                    }
+                };
+
+                int numActive = numSlots;
+                for (int next = numSlots; ; ++next)
+                {
+                    // Move the minimum to slot 0 and the maximum to slot
+                    // numActive-1.
+                    for (int k = 1; k < numActive; ++k)
+                    {
+                        CompareExchange(slot[0], slot[k]);
+                    }
+                    for (int k = 1; k < numActive - 1; ++k)
+                    {
+                        CompareExchange(slot[k], slot[numActive - 1]);
+                    }
+
+                    if (next == numElements)
+                    {
+                        break;
+                    }
+
+                    // Discard the minimum and maximum and add the next
+                    // element in the slot of the minimum.
+                    PixelType const* source = Element(next);
+                    std::copy(source, source + count, slot[0]);
+                    --numActive;
+                }
+
+                // Three elements remain, and the median is in slot 1.
+                std::copy(slot[1], slot[1] + count, &output(x0, y));
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
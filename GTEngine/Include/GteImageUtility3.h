@@ -3,12 +3,18 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.2 (2014/09/25)
+// File Version: 1.0.5 (2014/10/24)
 
 #pragma once
 
 #include "GTEngineDEF.h"
+#include "GteComputeModel.h"
 #include "GteImage3.h"
+#include "GteMorphologyFilter.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
 
 namespace gte
 {
@@ -25,26 +31,50 @@ public:
     // algorithms.  If you need to preserve the input image, make a copy of it
     // before calling these functions.
 
+    // Statistics for a connected component, computed by GetComponents6,
+    // GetComponents18, and GetComponents26 at the same time the labels are
+    // assigned.  The bounding box is [xMin,xMax]x[yMin,yMax]x[zMin,zMax] in
+    // voxel coordinates and the centroid is the average of the voxel
+    // coordinates.
+    struct ComponentStatistics
+    {
+        size_t numVoxels;
+        int xMin, xMax, yMin, yMax, zMin, zMax;
+        double xCentroid, yCentroid, zCentroid;
+    };
+
     // Compute the 6-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  If 'statistics'
+    // is not null, (*statistics)[k] is the summary of the k-th component.
+    // The labeling is partitioned among cmodel->numThreads threads.
     static void GetComponents6(Image3<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        std::vector<ComponentStatistics>* statistics = nullptr,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
 
     // Compute the 18-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  If 'statistics'
+    // is not null, (*statistics)[k] is the summary of the k-th component.
+    // The labeling is partitioned among cmodel->numThreads threads.
     static void GetComponents18(Image3<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        std::vector<ComponentStatistics>* statistics = nullptr,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
 
     // Compute the 26-connected components of a binary image.  The input image
     // is modified to avoid the cost of making a copy.  On output, the image
     // values are the labels for the components.  The array components[k],
-    // k >= 1, contains the indices for the k-th component.
+    // k >= 1, contains the indices for the k-th component.  If 'statistics'
+    // is not null, (*statistics)[k] is the summary of the k-th component.
+    // The labeling is partitioned among cmodel->numThreads threads.
     static void GetComponents26(Image3<int>& image,
-        std::vector<std::vector<size_t>>& components);
+        std::vector<std::vector<size_t>>& components,
+        std::vector<ComponentStatistics>* statistics = nullptr,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
 
     // Dilate the image using a structuring element that contains the
     // 6-connected neighbors.
@@ -58,6 +88,48 @@ public:
     // 26-connected neighbors.
     static void Dilate26(Image3<int> const& inImage, Image3<int>& outImage);
 
+    // Grayscale dilation and erosion with large structuring elements.  A
+    // dilation replaces each voxel by the maximum of the input over the
+    // structuring element centered at the voxel, and an erosion replaces
+    // it by the minimum.  The structuring element is clipped to the image.
+    // The output image must have the same dimensions as the input image and
+    // must be an object different from it.  PixelType is any type with a
+    // total order and a std::numeric_limits specialization; for example,
+    // int, uint8_t, or float.  The work is partitioned among
+    // cmodel->numThreads threads.  See the comments for the box and disk
+    // filters of ImageUtility2.
+    //
+    // The box has dimensions (2*radius0+1)x(2*radius1+1)x(2*radius2+1) and
+    // is separable into three van Herk/Gil-Werman filters.
+    //
+    // The ball contains the voxels (x,y,z) with x^2 + y^2 + z^2 <=
+    // radius^2.  It is the union of the disks x^2 + y^2 <= radius^2 - dz^2
+    // in the slices dz = -radius through dz = radius, and each disk is the
+    // union of its x-chords.  The dilation is the maximum over slices z+dz
+    // of the disk dilations, each computed from 1D filters as in
+    // ImageUtility2::DilateDisk.  The cost is O(radius^2) per voxel rather
+    // than the O(radius^3) of a direct evaluation.  Each thread uses a
+    // temporary buffer of one slice and a few rows for any radius.
+    template <typename PixelType>
+    static void DilateBox(Image3<PixelType> const& input, int radius0,
+        int radius1, int radius2, Image3<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void ErodeBox(Image3<PixelType> const& input, int radius0,
+        int radius1, int radius2, Image3<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void DilateBall(Image3<PixelType> const& input, int radius,
+        Image3<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    template <typename PixelType>
+    static void ErodeBall(Image3<PixelType> const& input, int radius,
+        Image3<PixelType>& output,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
     // Compute coordinate-directional convex set.  For a given coordinate
     // direction (x, y, or z), identify the first and last 1-valued voxels
     // on a segment of voxels in that direction.  All voxels from first to
@@ -65,6 +137,27 @@ public:
     // coordinate directions.
     static void ComputeCDConvex(Image3<int>& image);
 
+    // Compute the exact L2-distance transform of a binary image.  The
+    // transform at a voxel is the distance to the nearest 0-valued voxel,
+    // so it is zero for the background.  The image boundary does not have
+    // to be zero.  The voxel spacing is (spacing[0],spacing[1],spacing[2]),
+    // which allows for anisotropic volumes such as medical scans with thick
+    // slices.  The algorithm is the separable one of Felzenszwalb and
+    // Huttenlocher, "Distance Transforms of Sampled Functions": a 1D lower
+    // envelope of parabolas is computed along every x-row, then y-column,
+    // then z-line, so the time is linear in the number of voxels regardless
+    // of the distances involved.  The lines of each pass are partitioned
+    // among cmodel->numThreads threads.  The transform must have the same
+    // dimensions as the image.  If 'nearest' is not null, it must also have
+    // the same dimensions; on return nearest[i] is the index of the
+    // background voxel closest to voxel i, or -1 when the image has no
+    // background voxels (in which case the transform values are
+    // std::numeric_limits<float>::max()).
+    static void GetL2Distance(Image3<int> const& image,
+        std::array<float, 3> const& spacing, Image3<float>& transform,
+        Image3<int>* nearest = nullptr,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
     // Use a depth-first search for filling a 6-connected region.  This is
     // nonrecursive, simulated by using a heap-allocated "stack".  The input
     // (x,y,z) is the seed point that starts the fill.
@@ -82,9 +175,60 @@ private:
     static void Dilate(int numNeighbors, std::array<int, 3> const* delta,
         Image3<int> const& inImage, Image3<int>& outImage);
 
-    // Connected component labeling using depth-first search.
-    static void GetComponents(int numNeighbors, int const* delta,
-        Image3<int>& image, std::vector<std::vector<size_t>>& components);
+    // Connected component labeling using union-find.  The image slices are
+    // partitioned into slabs, one per thread.  Each slab is scanned in
+    // raster order, and a foreground voxel is merged with its neighbors
+    // that precede it in the slab.  The equivalence trees are linked so
+    // that the root is always the smallest voxel index of the set.  The
+    // pairs of neighbors that straddle slab boundaries are merged next, and
+    // then the roots are numbered in raster order.  This produces the same
+    // labels as a depth-first search started at each unlabeled voxel in
+    // raster order.
+    static void GetComponents(int numNeighbors,
+        std::array<int, 3> const* offsets, Image3<int>& image,
+        std::vector<std::vector<size_t>>& components,
+        std::vector<ComponentStatistics>* statistics,
+        ComputeModel const* cmodel);
+
+    static int FindRoot(int* parent, int i);
+    static int Union(int* parent, int i0, int i1);
+    static int Popcount(unsigned int bits);
+
+    // Support for GetL2Distance.  L2Pass processes all lines parallel to
+    // the specified axis.  On input, nearest[i] is the index of the closest
+    // background voxel in the subspace spanned by the previous axes (-1 if
+    // there is none).  On output, it is the closest in the subspace that
+    // includes 'axis'.  For axis 0, the indices are initialized from
+    // 'image'.  For the last axis, the distances are written to
+    // 'transform'.  L2Envelope computes the lower envelope of the parabolas
+    // weight^2*(p-q)^2 + f[q] for the samples q with site[q] >= 0 and
+    // returns in closest[p] the q that attains the minimum at sample p.
+    static void L2Pass(int axis, std::array<float, 3> const& spacing,
+        Image3<int> const* image, Image3<int>& nearest,
+        Image3<float>* transform, ComputeModel const* cmodel);
+
+    static void L2Envelope(int numSamples, double weight, int const* site,
+        double const* f, int* closest, int* v, double* z);
+
+    // Process lines 0 through numLines-1 in ranges on at most
+    // cmodel->numThreads threads of the compute model's thread pool and wait
+    // for the ranges to finish.  If cmodel is null, the lines are processed
+    // on the calling thread.
+    static void Execute(int numLines, ComputeModel const* cmodel,
+        std::function<void(int, int)> const& process);
+
+    // Support for the box and ball filters.  The operation is std::max or
+    // std::min, and 'identity' is its identity element.  The 1D filters
+    // and the disk filters of the slices are those of MorphologyFilter.
+    template <typename PixelType, typename Operation>
+    static void FilterBox(Image3<PixelType> const& input, int radius0,
+        int radius1, int radius2, Image3<PixelType>& output,
+        PixelType identity, Operation op, ComputeModel const* cmodel);
+
+    template <typename PixelType, typename Operation>
+    static void FilterBall(Image3<PixelType> const& input, int radius,
+        Image3<PixelType>& output, PixelType identity, Operation op,
+        ComputeModel const* cmodel);
 };
 
 #include "GteImageUtility3.inl"
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/09/25)
+// File Version: 1.0.2 (2014/10/24)
 
 //----------------------------------------------------------------------------
 template <typename PixelType>
@@ -120,3 +120,146 @@ void ImageUtility3::FloodFill6(Image3<PixelType>& image, int x, int y,
     delete[] zStack;
 }
 //----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility3::DilateBox(Image3<PixelType> const& input, int radius0,
+    int radius1, int radius2, Image3<PixelType>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    FilterBox(input, radius0, radius1, radius2, output,
+        std::numeric_limits<PixelType>::lowest(),
+        [](PixelType v0, PixelType v1) { return std::max(v0, v1); },
+        cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility3::ErodeBox(Image3<PixelType> const& input, int radius0,
+    int radius1, int radius2, Image3<PixelType>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    FilterBox(input, radius0, radius1, radius2, output,
+        std::numeric_limits<PixelType>::max(),
+        [](PixelType v0, PixelType v1) { return std::min(v0, v1); },
+        cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility3::DilateBall(Image3<PixelType> const& input, int radius,
+    Image3<PixelType>& output, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    FilterBall(input, radius, output,
+        std::numeric_limits<PixelType>::lowest(),
+        [](PixelType v0, PixelType v1) { return std::max(v0, v1); },
+        cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void ImageUtility3::ErodeBall(Image3<PixelType> const& input, int radius,
+    Image3<PixelType>& output, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    FilterBall(input, radius, output,
+        std::numeric_limits<PixelType>::max(),
+        [](PixelType v0, PixelType v1) { return std::min(v0, v1); },
+        cmodel.get());
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, typename Operation>
+void ImageUtility3::FilterBox(Image3<PixelType> const& input, int radius0,
+    int radius1, int radius2, Image3<PixelType>& output, PixelType identity,
+    Operation op, ComputeModel const* cmodel)
+{
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    int const dim2 = input.GetDimension(2);
+    size_t const dim01 = static_cast<size_t>(dim0) * dim1;
+    PixelType const* inPixels = input.GetPixels1D();
+    PixelType* outPixels = output.GetPixels1D();
+
+    // Filter the x-rows.
+    Execute(dim1 * dim2, cmodel, [&](int lmin, int lmax)
+    {
+        std::vector<PixelType> g(dim0 + 4 * radius0);
+        std::vector<PixelType> h(dim0 + 4 * radius0);
+        for (int line = lmin; line <= lmax; ++line)
+        {
+            size_t offset = static_cast<size_t>(dim0) * line;
+            MorphologyFilter::VanHerk(dim0, 1, 1, radius0,
+                inPixels + offset, outPixels + offset, &g[0], &h[0],
+                identity, op);
+        }
+    });
+
+    // Filter the y-columns of each slice in place, a strip of adjacent
+    // columns at a time.
+    int const stripSize = 64;
+    int const numStrips0 = (dim0 + stripSize - 1) / stripSize;
+    Execute(numStrips0 * dim2, cmodel, [&](int smin, int smax)
+    {
+        size_t const numElements =
+            static_cast<size_t>(dim1 + 4 * radius1) * stripSize;
+        std::vector<PixelType> g(numElements), h(numElements);
+        for (int s = smin; s <= smax; ++s)
+        {
+            int x = (s % numStrips0) * stripSize;
+            int z = s / numStrips0;
+            int count = std::min(stripSize, dim0 - x);
+            PixelType* pixels = outPixels + dim01 * z + x;
+            MorphologyFilter::VanHerk(dim1, dim0, count, radius1, pixels,
+                pixels, &g[0], &h[0], identity, op);
+        }
+    });
+
+    // Filter the z-lines in place, a strip of adjacent lines at a time.
+    int const numStrips01 =
+        static_cast<int>((dim01 + stripSize - 1) / stripSize);
+    Execute(numStrips01, cmodel, [&](int smin, int smax)
+    {
+        size_t const numElements =
+            static_cast<size_t>(dim2 + 4 * radius2) * stripSize;
+        std::vector<PixelType> g(numElements), h(numElements);
+        for (int s = smin; s <= smax; ++s)
+        {
+            size_t i = static_cast<size_t>(s) * stripSize;
+            int count = static_cast<int>(
+                std::min(static_cast<size_t>(stripSize), dim01 - i));
+            MorphologyFilter::VanHerk(dim2, dim01, count, radius2,
+                outPixels + i, outPixels + i, &g[0], &h[0], identity, op);
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, typename Operation>
+void ImageUtility3::FilterBall(Image3<PixelType> const& input, int radius,
+    Image3<PixelType>& output, PixelType identity, Operation op,
+    ComputeModel const* cmodel)
+{
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    int const dim2 = input.GetDimension(2);
+    size_t const dim01 = static_cast<size_t>(dim0) * dim1;
+    PixelType const* inPixels = input.GetPixels1D();
+    PixelType* outPixels = output.GetPixels1D();
+
+    Execute(dim2, cmodel, [&](int zmin, int zmax)
+    {
+        std::vector<PixelType> disk(dim01), buffer;
+        for (int z = zmin; z <= zmax; ++z)
+        {
+            PixelType* target = outPixels + dim01 * z;
+            std::fill(target, target + dim01, identity);
+            int smin = std::max(z - radius, 0);
+            int smax = std::min(z + radius, dim2 - 1);
+            for (int s = smin; s <= smax; ++s)
+            {
+                int dz = s - z;
+                MorphologyFilter::FilterDiskRows(dim0, dim1,
+                    radius * radius - dz * dz, inPixels + dim01 * s,
+                    &disk[0], 0, dim1 - 1, identity, op, buffer);
+                for (size_t i = 0; i < dim01; ++i)
+                {
+                    target[i] = op(target[i], disk[i]);
+                }
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
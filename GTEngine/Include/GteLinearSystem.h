@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/10/10)
 
 #pragma once
 
@@ -12,7 +12,9 @@
 #include "GteMatrix2x2.h"
 #include "GteMatrix3x3.h"
 #include "GteMatrix4x4.h"
+#include <array>
 #include <map>
+#include <vector>
 
 // Solve linear systems of equations where the matrix A is NxN.  The return
 // value of a function is 'true' when A is invertible.  In this case the
@@ -85,11 +87,35 @@ public:
     static unsigned int SolveSymmetricCG(int N, SparseMatrix const& A,
         Real const* B, Real* X, unsigned int maxIterations, Real tolerance);
 
+    // Solve A*X = B using the Jacobi-preconditioned conjugate gradient
+    // method, where A is sparse, symmetric, and positive definite.  The
+    // matrix is stored in compressed sparse row (CSR) form:  the nonzero
+    // entries of row i are A(i,column[k]) = value[k] for
+    // rowStart[i] <= k < rowStart[i+1], so rowStart has N+1 elements.
+    // Unlike SparseMatrix, both (i,j) and (j,i) must be stored.  Duplicate
+    // (i,j) entries are allowed; their values are summed.  The CSR form is
+    // faster to multiply than SparseMatrix and can be reassembled without
+    // reallocation when the sparsity pattern does not change.
+    //
+    // On input X is the initial guess for the solution.  Set it to zero
+    // for a cold start, or to the solution of a nearby system (for example,
+    // the previous time step of a simulation) for a warm start.  The return
+    // value is the number of iterations used; it is 0 when the initial
+    // guess already satisfies the tolerance.
+    struct CSRMatrix
+    {
+        std::vector<int> rowStart, column;
+        std::vector<Real> value;
+    };
+    static unsigned int SolveSymmetricCG(int N, CSRMatrix const& A,
+        Real const* B, Real* X, unsigned int maxIterations, Real tolerance);
+
 private:
     // Support for the conjugate gradient method.
     static Real Dot(int N, Real const* U, Real const* V);
     static void Mul(int N, Real const* A, Real const* X, Real* P);
     static void Mul(int N, SparseMatrix const& A, Real const* X, Real* P);
+    static void Mul(int N, CSRMatrix const& A, Real const* X, Real* P);
     static void UpdateX(int N, Real* X, Real alpha, Real const* P);
     static void UpdateR(int N, Real* R, Real alpha, Real const* W);
     static void UpdateP(int N, Real* P, Real beta, Real const* R);
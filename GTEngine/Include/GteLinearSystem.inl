@@ -249,6 +249,67 @@ unsigned int LinearSystem<Real>::SolveSymmetricCG(int N,
 }
 //----------------------------------------------------------------------------
 template <typename Real>
+unsigned int LinearSystem<Real>::SolveSymmetricCG(int N, CSRMatrix const& A,
+    Real const* B, Real* X, unsigned int maxIterations, Real tolerance)
+{
+    // The Jacobi preconditioner is the inverse of the diagonal of A.
+    std::vector<Real> tmpR(N), tmpZ(N), tmpP(N), tmpW(N), invDiagonal(N);
+    Real* R = &tmpR[0];
+    Real* Z = &tmpZ[0];
+    Real* P = &tmpP[0];
+    Real* W = &tmpW[0];
+    for (int i = 0; i < N; ++i)
+    {
+        Real diagonal = (Real)0;
+        for (int k = A.rowStart[i]; k < A.rowStart[i + 1]; ++k)
+        {
+            if (A.column[k] == i)
+            {
+                diagonal += A.value[k];
+            }
+        }
+        invDiagonal[i] = (diagonal != (Real)0 ? (Real)1 / diagonal : (Real)1);
+    }
+
+    // The initial residual is R = B - A*X for the initial guess X.
+    Mul(N, A, X, W);
+    for (int i = 0; i < N; ++i)
+    {
+        R[i] = B[i] - W[i];
+        Z[i] = invDiagonal[i] * R[i];
+    }
+#ifdef WIN32
+    memcpy_s(P, N * sizeof(Real), Z, N * sizeof(Real));
+#else
+    memcpy(P, Z, N * sizeof(Real));
+#endif
+    Real rho = Dot(N, R, Z);
+    Real threshold = tolerance * sqrt(Dot(N, B, B));
+
+    unsigned int iteration;
+    for (iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        if (sqrt(Dot(N, R, R)) <= threshold)
+        {
+            break;
+        }
+
+        Mul(N, A, P, W);
+        Real alpha = rho / Dot(N, P, W);
+        UpdateX(N, X, alpha, P);
+        UpdateR(N, R, alpha, W);
+        for (int i = 0; i < N; ++i)
+        {
+            Z[i] = invDiagonal[i] * R[i];
+        }
+        Real rhoNext = Dot(N, R, Z);
+        UpdateP(N, P, rhoNext / rho, Z);
+        rho = rhoNext;
+    }
+    return iteration;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
 Real LinearSystem<Real>::Dot(int N, Real const* U, Real const* V)
 {
     Real dot = (Real)0;
@@ -297,6 +358,22 @@ void LinearSystem<Real>::Mul(int N, SparseMatrix const& A, Real const* X,
 }
 //----------------------------------------------------------------------------
 template <typename Real>
+void LinearSystem<Real>::Mul(int N, CSRMatrix const& A, Real const* X,
+    Real* P)
+{
+    for (int i = 0; i < N; ++i)
+    {
+        Real sum = (Real)0;
+        int const kmax = A.rowStart[i + 1];
+        for (int k = A.rowStart[i]; k < kmax; ++k)
+        {
+            sum += A.value[k] * X[A.column[k]];
+        }
+        P[i] = sum;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
 void LinearSystem<Real>::UpdateX(int N, Real* X, Real alpha, Real const* P)
 {
     for (int i = 0; i < N; ++i)
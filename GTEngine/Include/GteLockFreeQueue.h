@@ -0,0 +1,106 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/09)
+
+#pragma once
+
+#include "GteLogger.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+// A bounded queue that does not use locks for Push and Pop.  The interface
+// is that of ThreadSafeQueue, so users of ThreadSafeQueue can switch to
+// LockFreeQueue by changing the type.
+//
+// The default is a multiple-producer multiple-consumer queue, which is an
+// implementation of the bounded MPMC queue of Dmitry Vyukov,
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// Each slot of the ring buffer has a sequence number that tells producers
+// and consumers whether the slot is free or filled for their position.
+// Set SingleProducerConsumer to 'true' when exactly one thread calls the
+// Push functions and exactly one thread calls the Pop functions; the
+// positions are then updated without compare-and-swap operations.
+//
+// The capacity is maxNumElements rounded up to a power of two, and
+// GetMaxNumElements() returns the rounded value.  The capacity must be
+// specified and must be positive; there is no unbounded LockFreeQueue.  A
+// maxNumElements of 0 is an error, unlike ThreadSafeQueue(0), and it is
+// rounded up to the minimum capacity of 2.  The Element type need not be
+// default constructible; elements are constructed in the ring buffer when
+// pushed and destroyed when popped.
+//
+// Push and Pop return immediately.  BlockingPush waits while the queue is
+// full and BlockingPop waits while the queue is empty.  The waiting threads
+// sleep on a condition variable, and Push and Pop lock its mutex only when
+// some thread is waiting.
+
+namespace gte
+{
+
+template <typename Element, bool SingleProducerConsumer = false>
+class LockFreeQueue
+{
+public:
+    // Construction and destruction.
+    ~LockFreeQueue();
+    LockFreeQueue(size_t maxNumElements);
+
+    // All the operations are thread-safe.  GetNumElements() is exact only
+    // when no other thread is modifying the queue.
+    size_t GetMaxNumElements() const;
+    size_t GetNumElements() const;
+    bool Push(Element const& element);
+    bool Pop(Element& element);
+    void BlockingPush(Element const& element);
+    void BlockingPop(Element& element);
+
+private:
+    // Disallow copying.
+    LockFreeQueue(LockFreeQueue const&);
+    LockFreeQueue& operator=(LockFreeQueue const&);
+
+    bool TryPush(Element const& element);
+    bool TryPop(Element& element);
+
+    // Wake threads that wait in BlockingPush or BlockingPop.
+    void NotifyWaiting(std::atomic<int>& numWaiting,
+        std::condition_variable& condition);
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(Element),
+            std::alignment_of<Element>::value>::type storage;
+    };
+
+    // Place the positions on separate cache lines so that producers and
+    // consumers do not invalidate each other's cache lines.
+    enum { CACHE_LINE_SIZE = 64 };
+
+    char mPad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> mPushPosition;
+    char mPad1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> mPopPosition;
+    char mPad2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+    size_t mCapacity, mMask;
+    std::unique_ptr<Slot[]> mSlots;
+
+    // Support for blocking.
+    std::atomic<int> mNumWaitingPush, mNumWaitingPop;
+    std::mutex mMutex;
+    std::condition_variable mNotFull, mNotEmpty;
+};
+
+#include "GteLockFreeQueue.inl"
+
+}
@@ -0,0 +1,246 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/09)
+
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+LockFreeQueue<Element, SingleProducerConsumer>::~LockFreeQueue()
+{
+    // Destroy the elements that were not popped.
+    size_t const pushPosition = mPushPosition.load();
+    for (size_t i = mPopPosition.load(); i != pushPosition; ++i)
+    {
+        reinterpret_cast<Element*>(&mSlots[i & mMask].storage)->~Element();
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+LockFreeQueue<Element, SingleProducerConsumer>::LockFreeQueue(
+    size_t maxNumElements)
+    :
+    mPushPosition(0),
+    mPopPosition(0),
+    mNumWaitingPush(0),
+    mNumWaitingPop(0)
+{
+    if (maxNumElements == 0)
+    {
+        LogError("The capacity of a LockFreeQueue must be positive.");
+    }
+
+    mCapacity = 2;
+    while (mCapacity < maxNumElements)
+    {
+        mCapacity <<= 1;
+    }
+    mMask = mCapacity - 1;
+
+    mSlots.reset(new Slot[mCapacity]);
+    for (size_t i = 0; i < mCapacity; ++i)
+    {
+        mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+size_t LockFreeQueue<Element, SingleProducerConsumer>::GetMaxNumElements()
+    const
+{
+    return mCapacity;
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+size_t LockFreeQueue<Element, SingleProducerConsumer>::GetNumElements()
+    const
+{
+    size_t const popPosition = mPopPosition.load();
+    size_t const pushPosition = mPushPosition.load();
+    if (pushPosition <= popPosition)
+    {
+        return 0;
+    }
+    return std::min(pushPosition - popPosition, mCapacity);
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+bool LockFreeQueue<Element, SingleProducerConsumer>::Push(
+    Element const& element)
+{
+    if (TryPush(element))
+    {
+        NotifyWaiting(mNumWaitingPop, mNotEmpty);
+        return true;
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+bool LockFreeQueue<Element, SingleProducerConsumer>::Pop(Element& element)
+{
+    if (TryPop(element))
+    {
+        NotifyWaiting(mNumWaitingPush, mNotFull);
+        return true;
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+void LockFreeQueue<Element, SingleProducerConsumer>::BlockingPush(
+    Element const& element)
+{
+    if (!TryPush(element))
+    {
+        // The waiting count is incremented before the queue is tested
+        // again, so a consumer that pops after the test sees the count and
+        // notifies.
+        std::unique_lock<std::mutex> lock(mMutex);
+        ++mNumWaitingPush;
+        mNotFull.wait(lock, [this, &element]() { return TryPush(element); });
+        --mNumWaitingPush;
+    }
+    NotifyWaiting(mNumWaitingPop, mNotEmpty);
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+void LockFreeQueue<Element, SingleProducerConsumer>::BlockingPop(
+    Element& element)
+{
+    if (!TryPop(element))
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        ++mNumWaitingPop;
+        mNotEmpty.wait(lock, [this, &element]() { return TryPop(element); });
+        --mNumWaitingPop;
+    }
+    NotifyWaiting(mNumWaitingPush, mNotFull);
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+bool LockFreeQueue<Element, SingleProducerConsumer>::TryPush(
+    Element const& element)
+{
+    Slot* slot;
+    size_t position = mPushPosition.load(std::memory_order_relaxed);
+    if (SingleProducerConsumer)
+    {
+        // Only this thread modifies mPushPosition.
+        if (position - mPopPosition.load(std::memory_order_acquire)
+            >= mCapacity)
+        {
+            return false;
+        }
+        slot = &mSlots[position & mMask];
+        new (&slot->storage) Element(element);
+        mPushPosition.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // The slot for 'position' is free when its sequence number equals the
+    // position.  It is filled for the previous lap when the sequence
+    // number is smaller, in which case the queue is full.
+    for (;;)
+    {
+        slot = &mSlots[position & mMask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) -
+            static_cast<std::ptrdiff_t>(position);
+        if (difference == 0)
+        {
+            if (mPushPosition.compare_exchange_weak(position, position + 1,
+                std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = mPushPosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    new (&slot->storage) Element(element);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+bool LockFreeQueue<Element, SingleProducerConsumer>::TryPop(
+    Element& element)
+{
+    Slot* slot;
+    size_t position = mPopPosition.load(std::memory_order_relaxed);
+    if (SingleProducerConsumer)
+    {
+        // Only this thread modifies mPopPosition.
+        if (mPushPosition.load(std::memory_order_acquire) == position)
+        {
+            return false;
+        }
+        slot = &mSlots[position & mMask];
+        Element* stored = reinterpret_cast<Element*>(&slot->storage);
+        element = std::move(*stored);
+        stored->~Element();
+        mPopPosition.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // The slot for 'position' is filled when its sequence number is
+    // position+1.  It is smaller when the slot has not yet been filled, in
+    // which case the queue is empty.
+    for (;;)
+    {
+        slot = &mSlots[position & mMask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) -
+            static_cast<std::ptrdiff_t>(position + 1);
+        if (difference == 0)
+        {
+            if (mPopPosition.compare_exchange_weak(position, position + 1,
+                std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = mPopPosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    Element* stored = reinterpret_cast<Element*>(&slot->storage);
+    element = std::move(*stored);
+    stored->~Element();
+
+    // The slot is free for the position of the next lap.
+    slot->sequence.store(position + mCapacity, std::memory_order_release);
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Element, bool SingleProducerConsumer>
+void LockFreeQueue<Element, SingleProducerConsumer>::NotifyWaiting(
+    std::atomic<int>& numWaiting, std::condition_variable& condition)
+{
+    // The fence orders the modification of the queue before the read of
+    // the waiting count.  A waiting thread increments the count before it
+    // tests the queue, so either it sees the modification or this thread
+    // sees the count.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (numWaiting.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        condition.notify_all();
+    }
+}
+//----------------------------------------------------------------------------
@@ -3,20 +3,39 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/11/13)
 
 #pragma once
 
 #include "GTEngineDEF.h"
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 
 // Uncomment this to turn off the logging system.  The macros LogAssert,
 // LogError, LogWarning, and LogInformation expand to nothing.  (Do this for
 // optimal performance.)
 //#define GTE_NO_LOGGER
 
+// The logging level selects at compile time which macros generate code.
+// The macros of the disabled levels expand to nothing, so their messages
+// are not even constructed.
+//   0 = no logging (same as GTE_NO_LOGGER)
+//   1 = LogAssert
+//   2 = LogAssert, LogError
+//   3 = LogAssert, LogError, LogWarning
+//   4 = LogAssert, LogError, LogWarning, LogInformation
+#if !defined(GTE_LOG_LEVEL)
+#if defined(GTE_NO_LOGGER)
+#define GTE_LOG_LEVEL 0
+#else
+#define GTE_LOG_LEVEL 4
+#endif
+#endif
+
 namespace gte
 {
 
@@ -68,43 +87,104 @@ public:
         int mFlags;
     };
 
+    // Unsubscribe flushes the pending asynchronous messages first, so the
+    // listener does not receive messages after the function returns.
     static void Subscribe(Listener* listener);
     static void Unsubscribe(Listener* listener);
 
+    // By default, the messages are reported to the listeners in the calling
+    // thread while a global mutex is locked, so threads that log serialize
+    // on that mutex.  In asynchronous mode, Warning and Information append
+    // the message to a lock-free ring buffer of the calling thread, and a
+    // background thread reports the messages to the listeners.  Each ring
+    // buffer stores at most maxThreadMessages messages; when it is full,
+    // the message is dropped and counted.  Assertion and Error flush the
+    // pending messages and then report synchronously, so the messages that
+    // lead to a failure are reported before it.  The order of the messages
+    // of a thread is preserved, but messages of different threads may be
+    // reported in a different order than they were logged.
+    //
+    // Call SetAsynchronous when no other thread is logging, typically at
+    // application startup and before exit.  SetAsynchronous(false) stops
+    // the background thread after reporting the pending messages.  The
+    // buffer size applies to threads that log for the first time after the
+    // call.
+    static void SetAsynchronous(bool asynchronous,
+        unsigned int maxThreadMessages = 1024);
+    static bool IsAsynchronous();
+
+    // Report all pending messages to the listeners before returning.
+    static void Flush();
+
+    // The number of messages dropped because a ring buffer was full.
+    static unsigned int GetNumDropped();
+
 private:
+    // Report the message to the listeners that have the flag.
+    static void Report(int flag, std::string const& message);
+
+    // Report the message synchronously, or append it to the ring buffer of
+    // the calling thread in asynchronous mode.
+    static void Post(int flag, std::string const& message);
+
+    // Support for asynchronous logging.  The types are defined in the
+    // source file.
+    class Message;
+    class ThreadBuffer;
+    static ThreadBuffer* GetThreadBuffer();
+    static void Drain();
+    static void DrainerLoop();
+
     std::string mMessage;
 
     static std::mutex msMutex;
     static std::set<Listener*> msListeners;
+
+    // The ring buffers are in a list that only grows, so threads search it
+    // without locking.  A thread whose identifier is that of an exited
+    // thread reuses the buffer of that thread.
+    static std::atomic<ThreadBuffer*> msThreadBuffers;
+    static std::atomic<bool> msAsynchronous;
+    static std::atomic<unsigned int> msMaxThreadMessages;
+    static std::atomic<unsigned int> msNumDropped;
+    static std::mutex msDrainMutex;
+    static std::mutex msDrainerMutex;
+    static std::condition_variable msDrainerWakeUp;
+    static bool msDrainerStop;
+    static std::thread msDrainer;
 };
 
 }
 
 //----------------------------------------------------------------------------
-#ifndef GTE_NO_LOGGER
-
+#if GTE_LOG_LEVEL >= 1
 #define LogAssert(condition, message) \
     if (!(condition)) \
     { \
         gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Assertion(); \
     }
+#else
+#define LogAssert(condition, message)
+#endif
 
+#if GTE_LOG_LEVEL >= 2
 #define LogError(message) \
     gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Error()
+#else
+#define LogError(message)
+#endif
 
+#if GTE_LOG_LEVEL >= 3
 #define LogWarning(message) \
     gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Warning()
+#else
+#define LogWarning(message)
+#endif
 
+#if GTE_LOG_LEVEL >= 4
 #define LogInformation(message) \
     gte::Logger(__FILE__, __FUNCTION__, __LINE__, message).Information()
-
 #else
-
-// No logging of assertions, warnings, errors, or information.
-#define LogAssert(condition, message)
-#define LogError(message)
-#define LogWarning(message)
 #define LogInformation(message)
-
 #endif
 //----------------------------------------------------------------------------
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/10/18)
 
 #pragma once
 
@@ -26,6 +26,11 @@ namespace gte
 // positive; otherwise, the bit is one and the value is negative.  The
 // triangles are counterclockwise ordered according to an observer viewing
 // the triangle from the negative side of the level surface.
+//
+// The table is stored in gMarchingCubesTable (GteMarchingCubesTable.cpp),
+// which is compiled into the library, so construction of MarchingCubes
+// objects does not recompute it.  GenerateTable computes the table from the
+// voxel configurations; its output is identical to gMarchingCubesTable.
 
 class GTE_IMPEXP MarchingCubes
 {
@@ -44,6 +49,9 @@ public:
     // The return value is a pointer to the table via &table[0][0].
     int const* GetTable () const;
 
+    // Compute the table from the voxel configurations.
+    static void GenerateTable (int table[256][41]);
+
     // Get the configuration type for the voxel, which is one of the string
     // names of the 'void Bits* (int[8])' functions.
     static std::string GetConfigurationType (int entry);
@@ -54,7 +62,10 @@ protected:
     // mTable[i][1] = numTriangles
     // mTable[i][2..25] = pairs of corner indices (maximum of 12 pairs)
     // mTable[i][26..40] = triples of indices (maximum of 5 triples)
-    int mTable[256][41];
+    // The pointer is used only by GenerateTable, which sets mEntry to each
+    // configuration in turn and calls the Bits* function that packs the
+    // entry.
+    int (*mTable)[41];
     int mEntry;
 
     enum GTE_IMPEXP
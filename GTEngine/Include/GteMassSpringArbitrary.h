@@ -3,12 +3,12 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/14)
+// File Version: 1.4.2 (2014/10/10)
 
 #pragma once
 
 #include "GteParticleSystem.h"
-#include <set>
+#include <cstring>
 
 namespace gte
 {
@@ -35,6 +35,10 @@ public:
     void SetSpring(int index, Spring const& spring);
     inline Spring const& GetSpring(int index) const;
 
+    // Update the adjacency information if any springs have changed since
+    // the last call and then update the particle state.
+    virtual void Update(Real time);
+
     // The default external force is zero.  Derive a class from this one to
     // provide nonzero external forces such as gravity, wind, friction,
     // and so on.  This function is called by Acceleration(...) to compute
@@ -52,12 +56,35 @@ protected:
         std::vector<Vector<N, Real>> const& position,
         std::vector<Vector<N, Real>> const& velocity);
 
+    // Compute the force of each spring once, before the accelerations of
+    // its two particles are computed.
+    virtual void PrepareAcceleration(Real time,
+        std::vector<Vector<N, Real>> const& position,
+        std::vector<Vector<N, Real>> const& velocity);
+
+    // Support for the implicit Euler integrator.  The springs are appended
+    // to the array, each one once.
+    virtual void GetImplicitSprings(
+        std::vector<typename ParticleSystem<N, Real>::ImplicitSpring>&
+        springs) const;
+
+    // Build the compressed adjacency arrays from mSpring.
+    void UpdateAdjacent();
+
     std::vector<Spring> mSpring;
 
     // Each particle has an associated array of spring indices for those
-    // springs adjacent to the particle.  The set elements are spring
-    // indices, not indices of adjacent particles.
-    std::vector<std::set<int>> mAdjacent;
+    // springs adjacent to the particle.  The arrays are stored in compressed
+    // sparse row (CSR) form: the springs adjacent to particle i are
+    // mAdjacent[j] for mAdjacentOffset[i] <= j < mAdjacentOffset[i+1].  The
+    // elements are spring indices, not indices of adjacent particles.  The
+    // arrays are rebuilt by Update(...) after SetSpring(...) is called.
+    std::vector<int> mAdjacentOffset, mAdjacent;
+    bool mAdjacentValid;
+
+    // The force of spring s on its particle0 for the positions passed to
+    // PrepareAcceleration(...).  The force on its particle1 is the negative.
+    std::vector<Vector<N, Real>> mForce;
 };
 
 #include "GteMassSpringArbitrary.inl"
@@ -6,7 +6,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/14)
+// File Version: 1.4.2 (2014/10/10)
 
 //----------------------------------------------------------------------------
 template <int N, typename Real>
@@ -20,7 +20,8 @@ MassSpringArbitrary<N, Real>::MassSpringArbitrary(int numParticles,
     :
     ParticleSystem<N, Real>(numParticles, step),
     mSpring(numSprings),
-    mAdjacent(numParticles)
+    mAdjacentOffset(numParticles + 1),
+    mAdjacentValid(false)
 {
     memset(&mSpring[0], 0, numSprings * sizeof(Spring));
 }
@@ -35,8 +36,7 @@ template <int N, typename Real>
 void MassSpringArbitrary<N, Real>::SetSpring(int index, Spring const& spring)
 {
     mSpring[index] = spring;
-    mAdjacent[spring.particle0].insert(index);
-    mAdjacent[spring.particle1].insert(index);
+    mAdjacentValid = false;
 }
 //----------------------------------------------------------------------------
 template <int N, typename Real> inline
@@ -47,6 +47,16 @@ MassSpringArbitrary<N, Real>::GetSpring(int index) const
 }
 //----------------------------------------------------------------------------
 template <int N, typename Real>
+void MassSpringArbitrary<N, Real>::Update(Real time)
+{
+    if (!mAdjacentValid)
+    {
+        UpdateAdjacent();
+    }
+    ParticleSystem<N, Real>::Update(time);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
 Vector<N, Real> MassSpringArbitrary<N, Real>::ExternalAcceleration(int, Real,
     std::vector<Vector<N, Real>> const&, std::vector<Vector<N, Real>> const&)
 {
@@ -58,32 +68,112 @@ Vector<N, Real> MassSpringArbitrary<N, Real>::Acceleration(int i, Real time,
     std::vector<Vector<N, Real>> const& position,
     std::vector<Vector<N, Real>> const& velocity)
 {
-    // Compute spring forces on position X[i].  The positions are not
-    // necessarily mkPosition, because the RK4 solver in ParticleSystem
+    // Sum the spring forces on particle i.  The forces were computed by
+    // PrepareAcceleration(...) for the same positions, which are not
+    // necessarily mPosition, because the RK4 solver in ParticleSystem
     // evaluates the acceleration function at intermediate positions.
 
     Vector<N, Real> acceleration = ExternalAcceleration(i, time, position,
         velocity);
 
-    for (auto adj : mAdjacent[i])
+    int const jmax = mAdjacentOffset[i + 1];
+    for (int j = mAdjacentOffset[i]; j < jmax; ++j)
     {
         // Process a spring connected to particle i.
-        Spring const& spring = mSpring[adj];
-        Vector<N, Real> diff;
-        if (i != spring.particle0)
+        int s = mAdjacent[j];
+        if (i == mSpring[s].particle0)
         {
-            diff = position[spring.particle0] - position[i];
+            acceleration += this->mInvMass[i] * mForce[s];
         }
         else
         {
-            diff = position[spring.particle1] - position[i];
+            acceleration -= this->mInvMass[i] * mForce[s];
         }
-
-        Real ratio = spring.length / Length(diff);
-        Vector<N, Real> force = spring.constant * ((Real)1 - ratio) * diff;
-        acceleration += this->mInvMass[i] * force;
     }
 
     return acceleration;
 }
 //----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrary<N, Real>::PrepareAcceleration(Real,
+    std::vector<Vector<N, Real>> const& position,
+    std::vector<Vector<N, Real>> const&)
+{
+    // Each spring is evaluated once rather than once for each of its
+    // particles.  The force on particle1 is the negative of the force on
+    // particle0, which is exactly the force computed from particle1.
+    int const numSprings = static_cast<int>(mSpring.size());
+    for (int s = 0; s < numSprings; ++s)
+    {
+        Spring const& spring = mSpring[s];
+        if (spring.particle0 != spring.particle1)
+        {
+            Vector<N, Real> diff =
+                position[spring.particle1] - position[spring.particle0];
+            Real ratio = spring.length / Length(diff);
+            mForce[s] = spring.constant * ((Real)1 - ratio) * diff;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrary<N, Real>::GetImplicitSprings(
+    std::vector<typename ParticleSystem<N, Real>::ImplicitSpring>& springs)
+    const
+{
+    typename ParticleSystem<N, Real>::ImplicitSpring implicitSpring;
+    for (auto const& spring : mSpring)
+    {
+        // A spring connecting a particle to itself exerts no force.
+        if (spring.particle0 != spring.particle1)
+        {
+            implicitSpring.particle0 = spring.particle0;
+            implicitSpring.particle1 = spring.particle1;
+            implicitSpring.constant = spring.constant;
+            implicitSpring.length = spring.length;
+            springs.push_back(implicitSpring);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrary<N, Real>::UpdateAdjacent()
+{
+    // Count the springs adjacent to each particle.  A spring whose
+    // endpoints are the same particle has not been set by the caller (the
+    // constructor zeros all springs), so it is ignored.
+    int const numSprings = static_cast<int>(mSpring.size());
+    std::fill(mAdjacentOffset.begin(), mAdjacentOffset.end(), 0);
+    for (int s = 0; s < numSprings; ++s)
+    {
+        Spring const& spring = mSpring[s];
+        if (spring.particle0 != spring.particle1)
+        {
+            ++mAdjacentOffset[spring.particle0 + 1];
+            ++mAdjacentOffset[spring.particle1 + 1];
+        }
+    }
+    for (int i = 0; i < this->mNumParticles; ++i)
+    {
+        mAdjacentOffset[i + 1] += mAdjacentOffset[i];
+    }
+
+    // Fill in the spring indices.  They are in increasing order for each
+    // particle.
+    mAdjacent.resize(mAdjacentOffset[this->mNumParticles]);
+    std::vector<int> current(mAdjacentOffset.begin(),
+        mAdjacentOffset.end() - 1);
+    for (int s = 0; s < numSprings; ++s)
+    {
+        Spring const& spring = mSpring[s];
+        if (spring.particle0 != spring.particle1)
+        {
+            mAdjacent[current[spring.particle0]++] = s;
+            mAdjacent[current[spring.particle1]++] = s;
+        }
+    }
+
+    mForce.resize(numSprings);
+    mAdjacentValid = true;
+}
+//----------------------------------------------------------------------------
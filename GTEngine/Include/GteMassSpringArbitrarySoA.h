@@ -0,0 +1,97 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.1 (2014/10/08)
+
+#pragma once
+
+#include "GteParticleSystemSoA.h"
+#include <cstring>
+
+namespace gte
+{
+
+template <int N, typename Real>
+class MassSpringArbitrarySoA : public ParticleSystemSoA<N, Real>
+{
+public:
+    typedef typename ParticleSystemSoA<N, Real>::Components Components;
+
+    // Construction and destruction.  This class represents a set of M
+    // masses that are connected by S springs with arbitrary topology.  The
+    // function SetSpring(...) should be called for each spring that you
+    // want in the system.  This is the structure-of-arrays counterpart of
+    // MassSpringArbitrary.
+    virtual ~MassSpringArbitrarySoA();
+    MassSpringArbitrarySoA(int numParticles, int numSprings, Real step,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    struct Spring
+    {
+        int particle0, particle1;
+        Real constant, length;
+    };
+
+    // Member access.
+    inline int GetNumSprings() const;
+    void SetSpring(int index, Spring const& spring);
+    inline Spring const& GetSpring(int index) const;
+
+    // Update the adjacency information if any springs have changed since
+    // the last call and then update the particle state.
+    virtual void Update(Real time);
+
+    // The default external force is zero.  Derive a class from this one to
+    // provide nonzero external forces such as gravity, wind, friction,
+    // and so on.  This function is called by Acceleration(...) to compute
+    // the impulses F/m generated by the external force F for particles imin
+    // through imax inclusive.  It must write acceleration[j][i] for all
+    // components j and for all i in the range.
+    virtual void ExternalAcceleration(int imin, int imax, Real time,
+        Components const& position, Components const& velocity,
+        Components& acceleration);
+
+protected:
+    // Callback for acceleration (ODE solver uses x" = F/m) applied to
+    // particles imin through imax inclusive.  The positions and velocities
+    // are not necessarily mPosition and mVelocity, because the ODE solver
+    // evaluates the impulse function at intermediate positions.
+    virtual void Acceleration(int imin, int imax, Real time,
+        Components const& position, Components const& velocity,
+        Components& acceleration);
+
+    // Compute the force of each spring once, in parallel over the springs.
+    // The force stored for a spring is the one applied to its particle0;
+    // the force applied to particle1 is the negation.  Acceleration(...)
+    // gathers the forces of the adjacent springs for each particle, so no
+    // two threads write the same memory.
+    virtual void PrepareAcceleration(Real time, Components const& position,
+        Components const& velocity);
+
+    // Build the compressed adjacency arrays from mSpring.
+    void UpdateAdjacent();
+
+    std::vector<Spring> mSpring;
+
+    // Each particle has an associated array of spring indices for those
+    // springs adjacent to the particle.  The arrays are stored in compressed
+    // sparse row (CSR) form: the springs adjacent to particle i are
+    // mAdjacent[j] for mAdjacentOffset[i] <= j < mAdjacentOffset[i+1].  The
+    // elements are spring indices, not indices of adjacent particles.  The
+    // arrays are rebuilt by Update(...) after SetSpring(...) is called.
+    // The sign mAdjacentSign[j] is +1 when the particle is particle0 of
+    // spring mAdjacent[j] and -1 when it is particle1.
+    std::vector<int> mAdjacentOffset, mAdjacent;
+    std::vector<Real> mAdjacentSign;
+    bool mAdjacentValid;
+
+    // The spring forces computed by PrepareAcceleration(...).  These are
+    // gathered in random order, so they are stored as array-of-structures
+    // to fetch the N components of a force with one cache line.
+    std::vector<Vector<N, Real>> mForce;
+};
+
+#include "GteMassSpringArbitrarySoA.inl"
+}
@@ -0,0 +1,176 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.1 (2014/10/08)
+
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+MassSpringArbitrarySoA<N, Real>::~MassSpringArbitrarySoA()
+{
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+MassSpringArbitrarySoA<N, Real>::MassSpringArbitrarySoA(int numParticles,
+    int numSprings, Real step, std::shared_ptr<ComputeModel> const& cmodel)
+    :
+    ParticleSystemSoA<N, Real>(numParticles, step, cmodel),
+    mSpring(numSprings),
+    mAdjacentOffset(numParticles + 1),
+    mAdjacentValid(false)
+{
+    memset(&mSpring[0], 0, numSprings * sizeof(Spring));
+    mForce.resize(numSprings);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringArbitrarySoA<N, Real>::GetNumSprings () const
+{
+    return static_cast<int>(mSpring.size());
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrarySoA<N, Real>::SetSpring(int index,
+    Spring const& spring)
+{
+    mSpring[index] = spring;
+    mAdjacentValid = false;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+typename MassSpringArbitrarySoA<N, Real>::Spring const&
+MassSpringArbitrarySoA<N, Real>::GetSpring(int index) const
+{
+    return mSpring[index];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrarySoA<N, Real>::Update(Real time)
+{
+    if (!mAdjacentValid)
+    {
+        UpdateAdjacent();
+    }
+    ParticleSystemSoA<N, Real>::Update(time);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrarySoA<N, Real>::ExternalAcceleration(int imin,
+    int imax, Real, Components const&, Components const&,
+    Components& acceleration)
+{
+    for (int j = 0; j < N; ++j)
+    {
+        std::fill(acceleration[j].begin() + imin,
+            acceleration[j].begin() + imax + 1, (Real)0);
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrarySoA<N, Real>::Acceleration(int imin, int imax,
+    Real time, Components const& position, Components const& velocity,
+    Components& acceleration)
+{
+    // Accumulate the spring forces computed by PrepareAcceleration(...) on
+    // positions X[imin] through X[imax].
+
+    ExternalAcceleration(imin, imax, time, position, velocity, acceleration);
+
+    for (int i = imin; i <= imax; ++i)
+    {
+        Real const invMass = this->mInvMass[i];
+        int const kmax = mAdjacentOffset[i + 1];
+        for (int k = mAdjacentOffset[i]; k < kmax; ++k)
+        {
+            Vector<N, Real> const& force = mForce[mAdjacent[k]];
+            Real const coeff = invMass * mAdjacentSign[k];
+            for (int j = 0; j < N; ++j)
+            {
+                acceleration[j][i] += coeff * force[j];
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrarySoA<N, Real>::PrepareAcceleration(Real,
+    Components const& position, Components const&)
+{
+    int const numSprings = static_cast<int>(mSpring.size());
+    this->Execute(numSprings, [this, &position](int smin, int smax)
+    {
+        for (int s = smin; s <= smax; ++s)
+        {
+            Spring const& spring = mSpring[s];
+            if (spring.particle0 == spring.particle1)
+            {
+                // The spring has not been set by the caller.
+                continue;
+            }
+
+            Real diff[N];
+            Real sqrLength = (Real)0;
+            for (int j = 0; j < N; ++j)
+            {
+                diff[j] = position[j][spring.particle1] -
+                    position[j][spring.particle0];
+                sqrLength += diff[j] * diff[j];
+            }
+
+            Real ratio = spring.length / sqrt(sqrLength);
+            Real coeff = spring.constant * ((Real)1 - ratio);
+            Vector<N, Real>& force = mForce[s];
+            for (int j = 0; j < N; ++j)
+            {
+                force[j] = coeff * diff[j];
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringArbitrarySoA<N, Real>::UpdateAdjacent()
+{
+    // Count the springs adjacent to each particle.  A spring whose
+    // endpoints are the same particle has not been set by the caller (the
+    // constructor zeros all springs), so it is ignored.
+    int const numSprings = static_cast<int>(mSpring.size());
+    std::fill(mAdjacentOffset.begin(), mAdjacentOffset.end(), 0);
+    for (int s = 0; s < numSprings; ++s)
+    {
+        Spring const& spring = mSpring[s];
+        if (spring.particle0 != spring.particle1)
+        {
+            ++mAdjacentOffset[spring.particle0 + 1];
+            ++mAdjacentOffset[spring.particle1 + 1];
+        }
+    }
+    for (int i = 0; i < this->mNumParticles; ++i)
+    {
+        mAdjacentOffset[i + 1] += mAdjacentOffset[i];
+    }
+
+    // Fill in the spring indices.  They are in increasing order for each
+    // particle.
+    mAdjacent.resize(mAdjacentOffset[this->mNumParticles]);
+    mAdjacentSign.resize(mAdjacentOffset[this->mNumParticles]);
+    std::vector<int> current(mAdjacentOffset.begin(),
+        mAdjacentOffset.end() - 1);
+    for (int s = 0; s < numSprings; ++s)
+    {
+        Spring const& spring = mSpring[s];
+        if (spring.particle0 != spring.particle1)
+        {
+            int k0 = current[spring.particle0]++;
+            mAdjacent[k0] = s;
+            mAdjacentSign[k0] = (Real)1;
+            int k1 = current[spring.particle1]++;
+            mAdjacent[k1] = s;
+            mAdjacentSign[k1] = (Real)-1;
+        }
+    }
+
+    mAdjacentValid = true;
+}
+//----------------------------------------------------------------------------
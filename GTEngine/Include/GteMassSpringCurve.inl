@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/14)
+// File Version: 1.4.1 (2014/10/10)
 
 //----------------------------------------------------------------------------
 template <int N, typename Real>
@@ -97,3 +97,20 @@ Vector<N, Real> MassSpringCurve<N, Real>::Acceleration(int i, Real time,
     return acceleration;
 }
 //----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringCurve<N, Real>::GetImplicitSprings(
+    std::vector<typename ParticleSystem<N, Real>::ImplicitSpring>& springs)
+    const
+{
+    typename ParticleSystem<N, Real>::ImplicitSpring spring;
+    int const numSprings = this->mNumParticles - 1;
+    for (int i = 0; i < numSprings; ++i)
+    {
+        spring.particle0 = i;
+        spring.particle1 = i + 1;
+        spring.constant = mConstant[i];
+        spring.length = mLength[i];
+        springs.push_back(spring);
+    }
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,60 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/06)
+
+#pragma once
+
+#include "GteParticleSystemSoA.h"
+
+namespace gte
+{
+
+template <int N, typename Real>
+class MassSpringCurveSoA : public ParticleSystemSoA<N, Real>
+{
+public:
+    typedef typename ParticleSystemSoA<N, Real>::Components Components;
+
+    // Construction and destruction.  This class represents a set of N-1
+    // springs connecting N masses that lie on a curve.  It is the
+    // structure-of-arrays counterpart of MassSpringCurve.
+    virtual ~MassSpringCurveSoA();
+    MassSpringCurveSoA(int numParticles, Real step,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    // Member access.  The parameters are spring constant and spring resting
+    // length.
+    inline int GetNumSprings() const;
+    inline void SetConstant(int i, Real constant);
+    inline void SetLength(int i, Real length);
+    inline Real const& GetConstant(int i) const;
+    inline Real const& GetLength(int i) const;
+
+    // The default external force is zero.  Derive a class from this one to
+    // provide nonzero external forces such as gravity, wind, friction,
+    // and so on.  This function is called by Acceleration(...) to compute
+    // the impulses F/m generated by the external force F for particles imin
+    // through imax inclusive.  It must write acceleration[j][i] for all
+    // components j and for all i in the range.
+    virtual void ExternalAcceleration(int imin, int imax, Real time,
+        Components const& position, Components const& velocity,
+        Components& acceleration);
+
+protected:
+    // Callback for acceleration (ODE solver uses x" = F/m) applied to
+    // particles imin through imax inclusive.  The positions and velocities
+    // are not necessarily mPosition and mVelocity, because the ODE solver
+    // evaluates the impulse function at intermediate positions.
+    virtual void Acceleration(int imin, int imax, Real time,
+        Components const& position, Components const& velocity,
+        Components& acceleration);
+
+    std::vector<Real> mConstant, mLength;
+};
+
+#include "GteMassSpringCurveSoA.inl"
+
+}
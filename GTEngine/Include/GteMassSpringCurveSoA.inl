@@ -0,0 +1,95 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/06)
+
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+MassSpringCurveSoA<N, Real>::~MassSpringCurveSoA()
+{
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+MassSpringCurveSoA<N, Real>::MassSpringCurveSoA(int numParticles, Real step,
+    std::shared_ptr<ComputeModel> const& cmodel)
+    :
+    ParticleSystemSoA<N, Real>(numParticles, step, cmodel),
+    mConstant(numParticles - 1),
+    mLength(numParticles - 1)
+{
+    std::fill(mConstant.begin(), mConstant.end(), (Real)0);
+    std::fill(mLength.begin(), mLength.end(), (Real)0);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringCurveSoA<N, Real>::GetNumSprings() const
+{
+    return this->mNumParticles - 1;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringCurveSoA<N, Real>::SetConstant(int i, Real constant)
+{
+    mConstant[i] = constant;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringCurveSoA<N, Real>::SetLength(int i, Real length)
+{
+    mLength[i] = length;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringCurveSoA<N, Real>::GetConstant(int i) const
+{
+    return mConstant[i];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringCurveSoA<N, Real>::GetLength(int i) const
+{
+    return mLength[i];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringCurveSoA<N, Real>::ExternalAcceleration(int imin, int imax,
+    Real, Components const&, Components const&, Components& acceleration)
+{
+    for (int j = 0; j < N; ++j)
+    {
+        std::fill(acceleration[j].begin() + imin,
+            acceleration[j].begin() + imax + 1, (Real)0);
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringCurveSoA<N, Real>::Acceleration(int imin, int imax,
+    Real time, Components const& position, Components const& velocity,
+    Components& acceleration)
+{
+    // Compute spring forces on positions X[imin] through X[imax].  The end
+    // points of the curve of masses must be handled separately, because
+    // each has only one spring attached to it.
+
+    ExternalAcceleration(imin, imax, time, position, velocity, acceleration);
+
+    int const numParticlesM1 = this->mNumParticles - 1;
+    for (int i = imin; i <= imax; ++i)
+    {
+        if (i > 0)
+        {
+            int iM1 = i - 1;
+            this->AddSpringAcceleration(i, iM1, mConstant[iM1], mLength[iM1],
+                position, acceleration);
+        }
+
+        if (i < numParticlesM1)
+        {
+            this->AddSpringAcceleration(i, i + 1, mConstant[i], mLength[i],
+                position, acceleration);
+        }
+    }
+}
+//----------------------------------------------------------------------------
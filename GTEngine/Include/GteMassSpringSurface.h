@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/14)
+// File Version: 1.4.1 (2014/10/10)
 
 #pragma once
 
@@ -70,6 +70,12 @@ protected:
         std::vector<Vector<N, Real>> const& position,
         std::vector<Vector<N, Real>> const& velocity);
 
+    // Support for the implicit Euler integrator.  The springs are appended
+    // to the array, each one once.
+    virtual void GetImplicitSprings(
+        std::vector<typename ParticleSystem<N, Real>::ImplicitSpring>&
+        springs) const;
+
     inline int GetIndex(int r, int c) const;
     void GetCoordinates(int i, int& r, int& c) const;
 
@@ -0,0 +1,201 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/06)
+
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+MassSpringSurfaceSoA<N, Real>::~MassSpringSurfaceSoA()
+{
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+MassSpringSurfaceSoA<N, Real>::MassSpringSurfaceSoA(int numRows,
+    int numCols, Real step, std::shared_ptr<ComputeModel> const& cmodel)
+    :
+    ParticleSystemSoA<N, Real>(numRows * numCols, step, cmodel),
+    mNumRows(numRows),
+    mNumCols(numCols),
+    mConstantR(numRows * numCols),
+    mLengthR(numRows * numCols),
+    mConstantC(numRows * numCols),
+    mLengthC(numRows * numCols)
+{
+    std::fill(mConstantR.begin(), mConstantR.end(), (Real)0);
+    std::fill(mLengthR.begin(), mLengthR.end(), (Real)0);
+    std::fill(mConstantC.begin(), mConstantC.end(), (Real)0);
+    std::fill(mLengthC.begin(), mLengthC.end(), (Real)0);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringSurfaceSoA<N, Real>::GetNumRows() const
+{
+    return mNumRows;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringSurfaceSoA<N, Real>::GetNumCols() const
+{
+    return mNumCols;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringSurfaceSoA<N, Real>::SetMass(int r, int c, Real mass)
+{
+    ParticleSystemSoA<N, Real>::SetMass(GetIndex(r, c), mass);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringSurfaceSoA<N, Real>::SetPosition(int r, int c,
+    Vector<N, Real> const& position)
+{
+    ParticleSystemSoA<N, Real>::SetPosition(GetIndex(r, c), position);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringSurfaceSoA<N, Real>::SetVelocity(int r, int c,
+    Vector<N, Real> const& position)
+{
+    ParticleSystemSoA<N, Real>::SetVelocity(GetIndex(r, c), position);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringSurfaceSoA<N, Real>::GetMass(int r, int c) const
+{
+    return ParticleSystemSoA<N, Real>::GetMass(GetIndex(r, c));
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Vector<N, Real> MassSpringSurfaceSoA<N, Real>::GetPosition(int r, int c)
+    const
+{
+    return ParticleSystemSoA<N, Real>::GetPosition(GetIndex(r, c));
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Vector<N, Real> MassSpringSurfaceSoA<N, Real>::GetVelocity(int r, int c)
+    const
+{
+    return ParticleSystemSoA<N, Real>::GetVelocity(GetIndex(r, c));
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringSurfaceSoA<N, Real>::SetConstantR (int r, int c, Real constant)
+{
+    mConstantR[GetIndex(r, c)] = constant;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringSurfaceSoA<N, Real>::SetLengthR(int r, int c, Real length)
+{
+    mLengthR[GetIndex(r, c)] = length;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringSurfaceSoA<N, Real>::SetConstantC(int r, int c, Real constant)
+{
+    mConstantC[GetIndex(r, c)] = constant;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringSurfaceSoA<N, Real>::SetLengthC(int r, int c, Real length)
+{
+    mLengthC[GetIndex(r, c)] = length;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringSurfaceSoA<N, Real>::GetConstantR(int r, int c) const
+{
+    return mConstantR[GetIndex(r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringSurfaceSoA<N, Real>::GetLengthR(int r, int c) const
+{
+    return mLengthR[GetIndex(r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringSurfaceSoA<N, Real>::GetConstantC(int r, int c) const
+{
+    return mConstantC[GetIndex(r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringSurfaceSoA<N, Real>::GetLengthC(int r, int c) const
+{
+    return mLengthC[GetIndex(r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringSurfaceSoA<N, Real>::ExternalAcceleration(int imin, int imax,
+    Real, Components const&, Components const&, Components& acceleration)
+{
+    for (int j = 0; j < N; ++j)
+    {
+        std::fill(acceleration[j].begin() + imin,
+            acceleration[j].begin() + imax + 1, (Real)0);
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringSurfaceSoA<N, Real>::Acceleration(int imin, int imax,
+    Real time, Components const& position, Components const& velocity,
+    Components& acceleration)
+{
+    // Compute spring forces on positions X[imin] through X[imax].  The edge
+    // and corner points of the surface of masses must be handled
+    // separately, because each has fewer than four springs attached to it.
+
+    ExternalAcceleration(imin, imax, time, position, velocity, acceleration);
+
+    int r, c, k;
+    for (int i = imin; i <= imax; ++i)
+    {
+        GetCoordinates(i, r, c);
+
+        if (r > 0)
+        {
+            k = i - mNumCols;  // index to previous row-neighbor
+            this->AddSpringAcceleration(i, k, mConstantR[k], mLengthR[k],
+                position, acceleration);
+        }
+
+        if (r < mNumRows - 1)
+        {
+            k = i;  // spring to next row-neighbor
+            this->AddSpringAcceleration(i, i + mNumCols, mConstantR[k],
+                mLengthR[k], position, acceleration);
+        }
+
+        if (c > 0)
+        {
+            k = i - 1;  // spring to previous col-neighbor
+            this->AddSpringAcceleration(i, k, mConstantC[k], mLengthC[k],
+                position, acceleration);
+        }
+
+        if (c < mNumCols - 1)
+        {
+            k = i;  // spring to next col-neighbor
+            this->AddSpringAcceleration(i, i + 1, mConstantC[k], mLengthC[k],
+                position, acceleration);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringSurfaceSoA<N, Real>::GetIndex(int r, int c) const
+{
+    return c + mNumCols * r;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringSurfaceSoA<N, Real>::GetCoordinates(int i, int& r, int& c) const
+{
+    c = i % mNumCols;
+    r = i / mNumCols;
+}
+//----------------------------------------------------------------------------
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/14)
+// File Version: 1.4.1 (2014/10/10)
 
 //----------------------------------------------------------------------------
 template <int N, typename Real>
@@ -251,6 +251,51 @@ Vector<N, Real> MassSpringVolume<N, Real>::Acceleration(int i, Real time,
     return acceleration;
 }
 //----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringVolume<N, Real>::GetImplicitSprings(
+    std::vector<typename ParticleSystem<N, Real>::ImplicitSpring>& springs)
+    const
+{
+    typename ParticleSystem<N, Real>::ImplicitSpring spring;
+    int const sliceSize = mNumRows * mNumCols;
+    for (int s = 0; s < mNumSlices; ++s)
+    {
+        for (int r = 0; r < mNumRows; ++r)
+        {
+            for (int c = 0; c < mNumCols; ++c)
+            {
+                int i = GetIndex(s, r, c);
+                if (s < mNumSlices - 1)
+                {
+                    spring.particle0 = i;
+                    spring.particle1 = i + sliceSize;
+                    spring.constant = mConstantS[i];
+                    spring.length = mLengthS[i];
+                    springs.push_back(spring);
+                }
+
+                if (r < mNumRows - 1)
+                {
+                    spring.particle0 = i;
+                    spring.particle1 = i + mNumCols;
+                    spring.constant = mConstantR[i];
+                    spring.length = mLengthR[i];
+                    springs.push_back(spring);
+                }
+
+                if (c < mNumCols - 1)
+                {
+                    spring.particle0 = i;
+                    spring.particle1 = i + 1;
+                    spring.constant = mConstantC[i];
+                    spring.length = mLengthC[i];
+                    springs.push_back(spring);
+                }
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
 template <int N, typename Real> inline
 int MassSpringVolume<N, Real>::GetIndex(int s, int r, int c) const
 {
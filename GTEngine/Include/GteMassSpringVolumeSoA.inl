@@ -0,0 +1,265 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/06)
+
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+MassSpringVolumeSoA<N, Real>::~MassSpringVolumeSoA()
+{
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+MassSpringVolumeSoA<N, Real>::MassSpringVolumeSoA(int numSlices,
+    int numRows, int numCols, Real step,
+    std::shared_ptr<ComputeModel> const& cmodel)
+    :
+    ParticleSystemSoA<N, Real>(numSlices * numRows * numCols, step, cmodel),
+    mNumSlices(numSlices),
+    mNumRows(numRows),
+    mNumCols(numCols),
+    mConstantS(numSlices * numRows * numCols),
+    mLengthS(numSlices * numRows * numCols),
+    mConstantR(numSlices * numRows * numCols),
+    mLengthR(numSlices * numRows * numCols),
+    mConstantC(numSlices * numRows * numCols),
+    mLengthC(numSlices * numRows * numCols)
+{
+    std::fill(mConstantS.begin(), mConstantS.end(), (Real)0);
+    std::fill(mLengthS.begin(), mLengthS.end(), (Real)0);
+    std::fill(mConstantR.begin(), mConstantR.end(), (Real)0);
+    std::fill(mLengthR.begin(), mLengthR.end(), (Real)0);
+    std::fill(mConstantC.begin(), mConstantC.end(), (Real)0);
+    std::fill(mLengthC.begin(), mLengthC.end(), (Real)0);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringVolumeSoA<N, Real>::GetNumSlices() const
+{
+    return mNumSlices;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringVolumeSoA<N, Real>::GetNumRows() const
+{
+    return mNumRows;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringVolumeSoA<N, Real>::GetNumCols() const
+{
+    return mNumCols;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetMass(int s, int r, int c, Real mass)
+{
+    ParticleSystemSoA<N, Real>::SetMass(GetIndex(s, r, c), mass);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetPosition(int s, int r, int c,
+    Vector<N, Real> const& position)
+{
+    ParticleSystemSoA<N, Real>::SetPosition(GetIndex(s, r, c), position);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetVelocity(int s, int r, int c,
+    Vector<N, Real> const& velocity)
+{
+    ParticleSystemSoA<N, Real>::SetVelocity(GetIndex(s, r, c), velocity);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringVolumeSoA<N, Real>::GetMass(int s, int r,
+    int c) const
+{
+    return ParticleSystemSoA<N, Real>::GetMass(GetIndex(s, r, c));
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Vector<N, Real> MassSpringVolumeSoA<N, Real>::GetPosition(int s, int r,
+    int c) const
+{
+    return ParticleSystemSoA<N, Real>::GetPosition(GetIndex(s, r, c));
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Vector<N, Real> MassSpringVolumeSoA<N, Real>::GetVelocity(int s, int r,
+    int c) const
+{
+    return ParticleSystemSoA<N, Real>::GetVelocity(GetIndex(s, r, c));
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetConstantS(int s, int r, int c,
+    Real constant)
+{
+    mConstantS[GetIndex(s, r, c)] = constant;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetLengthS(int s, int r, int c, Real length)
+{
+    mLengthS[GetIndex(s, r, c)] = length;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetConstantR(int s, int r, int c,
+    Real constant)
+{
+    mConstantR[GetIndex(s, r, c)] = constant;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetLengthR(int s, int r, int c, Real length)
+{
+    mLengthR[GetIndex(s, r, c)] = length;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetConstantC(int s, int r, int c,
+    Real constant)
+{
+    mConstantC[GetIndex(s, r, c)] = constant;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void MassSpringVolumeSoA<N, Real>::SetLengthC(int s, int r, int c, Real length)
+{
+    mLengthC[GetIndex(s, r, c)] = length;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringVolumeSoA<N, Real>::GetConstantS(int s, int r,
+    int c) const
+{
+    return mConstantS[GetIndex(s, r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringVolumeSoA<N, Real>::GetLengthS(int s, int r,
+    int c) const
+{
+    return mLengthS[GetIndex(s, r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringVolumeSoA<N, Real>::GetConstantR(int s, int r,
+    int c) const
+{
+    return mConstantR[GetIndex(s, r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringVolumeSoA<N, Real>::GetLengthR(int s, int r,
+    int c) const
+{
+    return mLengthR[GetIndex(s, r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringVolumeSoA<N, Real>::GetConstantC(int s, int r,
+    int c) const
+{
+    return mConstantC[GetIndex(s, r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& MassSpringVolumeSoA<N, Real>::GetLengthC(int s, int r,
+    int c) const
+{
+    return mLengthC[GetIndex(s, r, c)];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringVolumeSoA<N, Real>::ExternalAcceleration(int imin, int imax,
+    Real, Components const&, Components const&, Components& acceleration)
+{
+    for (int j = 0; j < N; ++j)
+    {
+        std::fill(acceleration[j].begin() + imin,
+            acceleration[j].begin() + imax + 1, (Real)0);
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringVolumeSoA<N, Real>::Acceleration(int imin, int imax,
+    Real time, Components const& position, Components const& velocity,
+    Components& acceleration)
+{
+    // Compute spring forces on positions X[imin] through X[imax].  The face,
+    // edge, and corner points of the volume of masses must be handled
+    // separately, because each has fewer than six springs attached to it.
+
+    ExternalAcceleration(imin, imax, time, position, velocity, acceleration);
+
+    int const sliceSize = mNumRows * mNumCols;
+    int s, r, c, k;
+    for (int i = imin; i <= imax; ++i)
+    {
+        GetCoordinates(i, s, r, c);
+
+        if (s > 0)
+        {
+            k = i - sliceSize;  // index to previous s-neighbor
+            this->AddSpringAcceleration(i, k, mConstantS[k], mLengthS[k],
+                position, acceleration);
+        }
+
+        if (s < mNumSlices - 1)
+        {
+            k = i;  // spring to next s-neighbor
+            this->AddSpringAcceleration(i, i + sliceSize, mConstantS[k],
+                mLengthS[k], position, acceleration);
+        }
+
+        if (r > 0)
+        {
+            k = i - mNumCols;  // index to previous r-neighbor
+            this->AddSpringAcceleration(i, k, mConstantR[k], mLengthR[k],
+                position, acceleration);
+        }
+
+        if (r < mNumRows - 1)
+        {
+            k = i;  // spring to next r-neighbor
+            this->AddSpringAcceleration(i, i + mNumCols, mConstantR[k],
+                mLengthR[k], position, acceleration);
+        }
+
+        if (c > 0)
+        {
+            k = i - 1;  // index to previous c-neighbor
+            this->AddSpringAcceleration(i, k, mConstantC[k], mLengthC[k],
+                position, acceleration);
+        }
+
+        if (c < mNumCols - 1)
+        {
+            k = i;  // spring to next c-neighbor
+            this->AddSpringAcceleration(i, i + 1, mConstantC[k], mLengthC[k],
+                position, acceleration);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int MassSpringVolumeSoA<N, Real>::GetIndex(int s, int r, int c) const
+{
+    return c + mNumCols * (r + mNumRows * s);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void MassSpringVolumeSoA<N, Real>::GetCoordinates(int i, int& s, int& r,
+    int& c) const
+{
+    c = i % mNumCols;
+    i = (i - c) / mNumCols;
+    r = i % mNumRows;
+    s = i / mNumRows;
+}
+//----------------------------------------------------------------------------
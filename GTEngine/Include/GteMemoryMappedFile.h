@@ -0,0 +1,68 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/01)
+
+#pragma once
+
+#include "GTEngineDEF.h"
+#include <string>
+
+// A file mapped into the address space of the process.  The operating
+// system reads the pages of the file on demand, so a large file can be
+// accessed without first copying it to memory.  The implementation uses
+// CreateFileMapping/MapViewOfFile on Microsoft Windows and mmap elsewhere.
+
+namespace gte
+{
+
+class GTE_IMPEXP MemoryMappedFile
+{
+public:
+    // Access to the mapped memory.
+    //   READ_ONLY:  Writing to the memory is an access violation.
+    //   COPY_ON_WRITE:  Writes are allowed but are private to the process;
+    //     the modified pages are copied and the file is unchanged.
+    //   READ_WRITE:  Writes are allowed and are stored in the file.
+    enum Access
+    {
+        READ_ONLY,
+        COPY_ON_WRITE,
+        READ_WRITE
+    };
+
+    // Construction and destruction.  The destructor unmaps the file.
+    ~MemoryMappedFile();
+    MemoryMappedFile();
+
+    // Map the entire file.  The function returns 'false' when the file
+    // cannot be opened or mapped, or when it is empty.  An already open
+    // mapping is closed first.
+    bool Open(std::string const& name, Access access);
+    void Close();
+
+    // Member access.  GetData() is null when no file is mapped.
+    inline char* GetData() const;
+    inline size_t GetSize() const;
+    inline Access GetAccess() const;
+
+private:
+    // Disallow copying, because the object owns the mapping.
+    MemoryMappedFile(MemoryMappedFile const&);
+    MemoryMappedFile& operator=(MemoryMappedFile const&);
+
+    char* mData;
+    size_t mSize;
+    Access mAccess;
+
+#if defined(WIN32)
+    void* mFile;
+    void* mMapping;
+#endif
+};
+
+#include "GteMemoryMappedFile.inl"
+
+}
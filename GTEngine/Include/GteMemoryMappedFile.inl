@@ -0,0 +1,23 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/01)
+
+//----------------------------------------------------------------------------
+inline char* MemoryMappedFile::GetData() const
+{
+    return mData;
+}
+//----------------------------------------------------------------------------
+inline size_t MemoryMappedFile::GetSize() const
+{
+    return mSize;
+}
+//----------------------------------------------------------------------------
+inline MemoryMappedFile::Access MemoryMappedFile::GetAccess() const
+{
+    return mAccess;
+}
+//----------------------------------------------------------------------------
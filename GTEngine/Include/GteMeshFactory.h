@@ -3,12 +3,13 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/17)
+// File Version: 1.0.2 (2014/11/21)
 
 #pragma once
 
 #include "GTEngineDEF.h"
 #include "GteIndexBuffer.h"
+#include "GteMeshOptimizer.h"
 #include "GteVertexBuffer.h"
 #include "GteVisual.h"
 #include "GteVector2.h"
@@ -60,6 +61,13 @@ public:
     // outside).
     inline void SetOutside(bool outside);
 
+    // Reorder the triangles and vertices of the meshes for the vertex cache
+    // and for vertex fetching when they are created.  The default is 'false'
+    // (the triangles are in row-major order).  Use GetOptimizer() to choose
+    // the algorithm, cache size and overdraw threshold and to read the
+    // statistics for the most recently created mesh.
+    inline void SetOptimize(bool optimize);
+    inline MeshOptimizer& GetOptimizer();
 
     // The rectangle is in the plane z = 0 and is visible to an observer who
     // is on the side of the plane to which the normal (0,0,1) points.  It has
@@ -156,11 +164,14 @@ private:
 
     // Support for index buffers.
     void ReverseTriangleOrder(IndexBuffer* ibuffer);
+    void Optimize(VertexBuffer* vbuffer, IndexBuffer* ibuffer);
 
     VertexFormat mVFormat;
     size_t mIndexSize;
     Resource::Usage mVBUsage, mIBUsage;
     bool mOutside;
+    bool mOptimize;
+    MeshOptimizer mOptimizer;
     bool mAssignTCoords[VA_MAX_TCOORD_UNITS];
 
     char* mPositions;
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/11/21)
 
 //----------------------------------------------------------------------------
 inline void MeshFactory::SetVertexFormat(VertexFormat const& format)
@@ -31,6 +31,16 @@ inline void MeshFactory::SetOutside(bool outside)
     mOutside = outside;
 }
 //----------------------------------------------------------------------------
+inline void MeshFactory::SetOptimize(bool optimize)
+{
+    mOptimize = optimize;
+}
+//----------------------------------------------------------------------------
+inline MeshOptimizer& MeshFactory::GetOptimizer()
+{
+    return mOptimizer;
+}
+//----------------------------------------------------------------------------
 inline Vector3<float>& MeshFactory::Position(unsigned int i)
 {
     return *reinterpret_cast<Vector3<float>*>(
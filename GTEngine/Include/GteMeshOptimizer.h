@@ -0,0 +1,145 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/21)
+
+#pragma once
+
+#include "GTEngineDEF.h"
+#include "GteIndexBuffer.h"
+#include "GteVertexBuffer.h"
+#include <vector>
+
+// Reorder an indexed triangle mesh for rendering.  The triangles are
+// reordered so that the vertices shared by consecutive triangles are found
+// in the post-transform vertex cache, using either the algorithm of Tom
+// Forsyth, "Linear-Speed Vertex Cache Optimisation", or Tipsify from
+// P. Sander, D. Nehab and J. Barczak, "Fast Triangle Reordering for Vertex
+// Locality and Reduced Overdraw", SIGGRAPH 2007.  Tipsify is faster and
+// produces better orders when the cache size matches that of the hardware,
+// but its orders degrade quickly when the hardware cache is smaller than
+// the configured size.  Forsyth's algorithm models an LRU cache and is much
+// less sensitive to the cache size, so it is the default.
+//
+// Optionally, the cache-optimized order is split into clusters that are
+// sorted so that triangles facing away from the center of the mesh are drawn
+// first, which reduces overdraw for convex-like meshes seen from any
+// direction (the view-independent sort of Sander et al.).  A cluster is
+// split where the cache efficiency of the pieces is within the overdraw
+// threshold of that of the cluster, so a threshold of 1.05 allows the ACMR
+// to increase by at most 5%.  A threshold of 0 disables the sort.
+//
+// Finally, the vertices are reordered in the order of their first use by
+// the triangles, so vertex fetches are sequential in memory.  Vertices that
+// are not referenced are moved to the end.
+//
+// The quality of an order is measured for a FIFO cache of the configured
+// size.  The ACMR (average cache miss ratio) is the number of transformed
+// vertices per triangle.  It is between 0.5 and 3 for typical meshes, and
+// 0.5 is the ideal for large regular meshes.  The ATVR (average transformed
+// vertex ratio) is the number of transformed vertices per referenced
+// vertex; its ideal is 1.
+
+namespace gte
+{
+
+class GTE_IMPEXP MeshOptimizer
+{
+public:
+    enum Algorithm
+    {
+        FORSYTH,
+        TIPSIFY
+    };
+
+    struct Statistics
+    {
+        float acmr, atvr;
+    };
+
+    // Construction and destruction.  The defaults are FORSYTH, a cache of
+    // 16 vertices, no overdraw sort and vertex reordering.
+    ~MeshOptimizer();
+    MeshOptimizer();
+
+    // Member access.
+    inline void SetAlgorithm(Algorithm algorithm);
+    inline Algorithm GetAlgorithm() const;
+    inline void SetCacheSize(unsigned int cacheSize);
+    inline unsigned int GetCacheSize() const;
+    inline void SetOverdrawThreshold(float threshold);
+    inline float GetOverdrawThreshold() const;
+    inline void SetReorderVertices(bool reorder);
+    inline bool GetReorderVertices() const;
+
+    // Reorder the triangles of the index buffer and the vertices of the
+    // vertex buffer.  All primitives of the index buffer are reordered,
+    // regardless of the active primitives.  The function returns 'false'
+    // when the index buffer is not an indexed IP_TRIMESH, when a buffer
+    // has no system-memory storage, or when an index is out of range.  The
+    // overdraw sort requires 3-tuple or 4-tuple float positions and is
+    // skipped otherwise.  The statistics are computed for each call.
+    bool Optimize(VertexBuffer* vbuffer, IndexBuffer* ibuffer);
+    inline Statistics const& GetStatisticsBefore() const;
+    inline Statistics const& GetStatisticsAfter() const;
+
+    // The operations on index arrays, for meshes that are not yet in
+    // buffers.  The array has 3 indices per triangle, all smaller than
+    // numVertices.
+    static void ReorderForsyth(unsigned int numVertices,
+        std::vector<unsigned int>& indices, unsigned int cacheSize);
+
+    static void ReorderTipsify(unsigned int numVertices,
+        std::vector<unsigned int>& indices, unsigned int cacheSize);
+
+    // The positions are 3-tuples of floats, 'stride' bytes apart.
+    static void ReorderOverdraw(char const* positions, unsigned int stride,
+        unsigned int numVertices, std::vector<unsigned int>& indices,
+        unsigned int cacheSize, float threshold);
+
+    // Replace the indices by those of the vertices in first-use order.  On
+    // return, newVertex[v] is the new index of old vertex v.
+    static void ReorderVertices(unsigned int numVertices,
+        std::vector<unsigned int>& indices,
+        std::vector<unsigned int>& newVertex);
+
+    static Statistics GetStatistics(unsigned int numVertices,
+        std::vector<unsigned int> const& indices, unsigned int cacheSize);
+
+private:
+    // Support for the overdraw sort.  The clusters are the start indices of
+    // the triangle ranges, followed by the number of triangles.
+    static void GetClusters(unsigned int numVertices,
+        std::vector<unsigned int> const& indices, unsigned int cacheSize,
+        float threshold, std::vector<unsigned int>& clusters);
+
+    // Support for the FIFO cache simulation.  The function returns the
+    // number of cache misses for triangles tmin through tmax-1.  The state
+    // of the cache is in timeStamps and time; adding cacheSize to time
+    // empties the cache.
+    static unsigned int CountMisses(std::vector<unsigned int> const& indices,
+        unsigned int tmin, unsigned int tmax, unsigned int cacheSize,
+        std::vector<unsigned int>& timeStamps, unsigned int& time);
+
+    // Support for Forsyth's algorithm and Tipsify.  The triangles adjacent
+    // to vertex v are adjacent[offsets[v]] through
+    // adjacent[offsets[v]+numLive[v]-1]; emitted triangles are moved out of
+    // this range.
+    static void GetAdjacency(unsigned int numVertices,
+        std::vector<unsigned int> const& indices,
+        std::vector<unsigned int>& offsets,
+        std::vector<unsigned int>& numLive,
+        std::vector<unsigned int>& adjacent);
+
+    Algorithm mAlgorithm;
+    unsigned int mCacheSize;
+    float mOverdrawThreshold;
+    bool mReorderVertices;
+    Statistics mBefore, mAfter;
+};
+
+#include "GteMeshOptimizer.inl"
+
+}
@@ -0,0 +1,60 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/21)
+
+//----------------------------------------------------------------------------
+inline void MeshOptimizer::SetAlgorithm(Algorithm algorithm)
+{
+    mAlgorithm = algorithm;
+}
+//----------------------------------------------------------------------------
+inline MeshOptimizer::Algorithm MeshOptimizer::GetAlgorithm() const
+{
+    return mAlgorithm;
+}
+//----------------------------------------------------------------------------
+inline void MeshOptimizer::SetCacheSize(unsigned int cacheSize)
+{
+    mCacheSize = (cacheSize >= 4 ? cacheSize : 4);
+}
+//----------------------------------------------------------------------------
+inline unsigned int MeshOptimizer::GetCacheSize() const
+{
+    return mCacheSize;
+}
+//----------------------------------------------------------------------------
+inline void MeshOptimizer::SetOverdrawThreshold(float threshold)
+{
+    mOverdrawThreshold = threshold;
+}
+//----------------------------------------------------------------------------
+inline float MeshOptimizer::GetOverdrawThreshold() const
+{
+    return mOverdrawThreshold;
+}
+//----------------------------------------------------------------------------
+inline void MeshOptimizer::SetReorderVertices(bool reorder)
+{
+    mReorderVertices = reorder;
+}
+//----------------------------------------------------------------------------
+inline bool MeshOptimizer::GetReorderVertices() const
+{
+    return mReorderVertices;
+}
+//----------------------------------------------------------------------------
+inline MeshOptimizer::Statistics const&
+MeshOptimizer::GetStatisticsBefore() const
+{
+    return mBefore;
+}
+//----------------------------------------------------------------------------
+inline MeshOptimizer::Statistics const&
+MeshOptimizer::GetStatisticsAfter() const
+{
+    return mAfter;
+}
+//----------------------------------------------------------------------------
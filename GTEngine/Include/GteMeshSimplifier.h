@@ -0,0 +1,234 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/23)
+
+#pragma once
+
+#include "GteComputeModel.h"
+#include "GteProfiler.h"
+#include "GteVector3.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+// Simplification of indexed triangle meshes by edge collapses ordered by the
+// quadric error metric of M. Garland and P. Heckbert, "Surface
+// Simplification Using Quadric Error Metrics", SIGGRAPH 1997.  A collapse
+// moves a vertex onto an adjacent vertex (a half-edge collapse), so the
+// simplified mesh uses a subset of the input vertices and their attributes
+// (normals, texture coordinates) remain valid.
+//
+// The input vertices are typically those of a vertex buffer, where a vertex
+// on a texture seam is duplicated, once for each side of the seam.  The
+// topology is therefore computed for the vertices welded by position.  An
+// edge is a border edge when it has one triangle and a seam edge when its
+// two triangles use different vertices for the same positions.  A vertex on
+// the border moves only along a border edge, and the pair of vertices on a
+// seam moves only along the seam, both vertices of the pair at once.  Other
+// configurations, such as vertices where seams meet or nonmanifold edges,
+// are locked.  Border and seam edges also add quadrics for the planes
+// perpendicular to their triangles, so the border and seam curves are
+// preserved.  A collapse is rejected when it changes the topology (the
+// link condition) or flips a triangle.
+//
+// The error of a collapse is the root-mean-square distance, weighted by
+// area, from the target vertex to the planes of the input triangles that
+// were merged into the vertices, so it is measured in the units of the
+// positions.  The simplification stops when the number of triangles reaches
+// targetTriangles or when the next collapse has an error larger than
+// targetError; pass 0 or the maximum Real to use only one criterion.  The
+// returned error is the largest error of the collapses.
+//
+// When the compute model has more than one thread, a mesh with more than
+// 2*clusterTriangles triangles is split spatially into clusters of at most
+// clusterTriangles triangles.  The clusters are simplified in parallel with
+// the vertices shared by clusters locked.  Each stops at its share of the
+// target or at a common error bound, a quantile of the initial collapse
+// costs, so that smooth clusters do not over-simplify detailed ones.  The
+// result is then simplified as a whole, which removes the locks and reaches
+// the target.
+//
+// GenerateLODChain creates levels of detail by simplifying each level to
+// 'reduction' times the number of triangles of the previous level.  The
+// quadrics are accumulated over the chain, so the error of a level is that
+// with respect to the input mesh.  Level 0 is the input with error 0.  The
+// chain stops early when a level cannot be reduced within targetError.
+// GetScreenSpaceError converts the error of a level to pixels for a
+// perspective projection, and SelectLevel chooses the coarsest level whose
+// error is at most maxPixelError.
+
+namespace gte
+{
+
+template <typename Real>
+class MeshSimplifier
+{
+public:
+    struct Level
+    {
+        std::vector<int> indices;
+        Real error;
+    };
+
+    // Construction.  The default compute model is single-threaded.
+    MeshSimplifier(std::shared_ptr<ComputeModel> const& cmodel = nullptr,
+        int clusterTriangles = 16384);
+
+    // The indices are 3 per triangle.  On success, 'indices' is replaced by
+    // those of the simplified mesh, without the triangles that have two
+    // vertices at the same position.  The function returns 'false' when an
+    // index is out of range.
+    bool operator()(int numVertices, Vector3<Real> const* positions,
+        std::vector<int>& indices, int targetTriangles, Real targetError,
+        Real& error);
+
+    // The reduction must be in (0,1), for example 0.5.  The function returns
+    // 'false' when it is not or when an index is out of range.
+    bool GenerateLODChain(int numVertices, Vector3<Real> const* positions,
+        std::vector<int> const& indices, int numLevels, Real reduction,
+        Real targetError, std::vector<Level>& levels);
+
+    // The field of view fovY is in radians.  The distance is from the eye
+    // point to the object.
+    static Real GetScreenSpaceError(Real error, Real distance, Real fovY,
+        Real viewportHeight);
+
+    static int SelectLevel(std::vector<Level> const& levels, Real distance,
+        Real fovY, Real viewportHeight, Real maxPixelError);
+
+private:
+    enum VertexKind
+    {
+        MANIFOLD,
+        BORDER,
+        SEAM,
+        LOCKED
+    };
+
+    enum EdgeKind
+    {
+        INTERIOR_EDGE,
+        BORDER_EDGE,
+        SEAM_EDGE,
+        COMPLEX_EDGE
+    };
+
+    // The symmetric 4x4 matrix of a sum of squared distances to planes,
+    // w*(Dot(N,X)+d)^2, stored as its upper triangle.  The area is the sum
+    // of the areas of the triangles of the planes, which normalizes the
+    // error.
+    class Quadric
+    {
+    public:
+        Quadric();
+        void AddPlane(Vector3<double> const& normal, double d,
+            double weight);
+        void Add(Quadric const& quadric, double sign);
+        double Evaluate(Vector3<double> const& point) const;
+
+        std::array<double, 10> coefficient;
+        double area;
+    };
+
+    // The part of the mesh that is simplified by one thread.  The vertices,
+    // positions and triangles are renumbered locally.  A corner of a
+    // triangle, 3*t+k, is the half-edge from vertex k to vertex (k+1)%3 of
+    // triangle t, and each vertex has the list of its triangles.  The
+    // collapses are ordered by a binary min-heap of (cost,vertex) pairs for
+    // the best collapse of each vertex.  When the best collapse of a vertex
+    // changes, a new pair is inserted, and the obsolete pair is skipped when
+    // it reaches the top.  This avoids the random memory accesses of an
+    // indexed heap, which dominated the time for large meshes.
+    class Region
+    {
+    public:
+        Region(MeshSimplifier const& simplifier,
+            std::vector<int> const& indices,
+            std::vector<char> const* lockedPositions);
+
+        void Simplify(int targetTriangles, Real targetError);
+        void GetIndices(std::vector<int>& indices) const;
+        void GetCosts(std::vector<double>& costs) const;
+        void UpdateQuadrics(std::vector<Quadric>& quadrics) const;
+        inline Real GetError() const;
+
+    private:
+        // Topological queries and collapses.
+        EdgeKind GetEdgeKind(int p0, int p1, int& numShared) const;
+        void GetNeighbors(int p, std::vector<int>& neighbors) const;
+        int GetNumTriangles(int p) const;
+        bool IsAdjacent(int p0, int p1) const;
+        bool IsValidCollapse(int u, int v) const;
+        bool GetSeamPair(int u, int v, int& u2, int& v2) const;
+        double GetCost(int u, int v) const;
+        void ComputeCandidate(int u, bool validate);
+        void AddCandidates(int u, int p);
+        void Collapse(int u, int v, std::vector<int>& touched);
+
+        // The vertices at position p are mFirstWedge[p], then the vertices
+        // linked by mNextWedge, which is -1 at the end of the list.  The
+        // corners are the positions of the vertices of the triangles.  A
+        // partial position is locked because it has triangles in other
+        // regions.
+        std::vector<int> mVertexGlobal, mPositionGlobal;
+        std::vector<int> mVertexPosition, mFirstWedge, mNextWedge;
+        std::vector<Vector3<double>> mPoints;
+        std::vector<char> mKind, mPartial;
+        std::vector<Quadric> mQuadrics, mInitialQuadrics;
+        std::vector<int> mTriangles, mCorners;
+        std::vector<char> mAlive;
+        std::vector<std::vector<int>> mAdjacent;
+        int mNumTriangles;
+        Real mError;
+
+        // The best collapse of vertex u is onto mTarget[u] with cost
+        // mKey[u], or mTarget[u] is -1 when u has no collapse.
+        std::vector<int> mTarget;
+        std::vector<double> mKey;
+        std::priority_queue<std::pair<double, int>,
+            std::vector<std::pair<double, int>>,
+            std::greater<std::pair<double, int>>> mHeap;
+
+        // Storage for the neighbors of positions and for the candidate
+        // collapses of a vertex, to avoid allocations.
+        mutable std::vector<int> mNeighbors;
+        std::vector<std::pair<double, int>> mCandidates;
+    };
+
+    bool Initialize(int numVertices, Vector3<Real> const* positions,
+        std::vector<int> const& indices);
+    void Classify(std::vector<int> const& indices, bool addConstraints);
+    void Partition(std::vector<int> const& indices,
+        std::vector<std::vector<int>>& clusters) const;
+    void Simplify(std::vector<int>& indices, int targetTriangles,
+        Real targetError, bool addConstraints, Real& error);
+
+    // The weight of the constraint planes of border and seam edges,
+    // relative to the squared length of the edge.
+    static double const msConstraintWeight;
+
+    std::shared_ptr<ComputeModel> mCModel;
+    int mClusterTriangles;
+    int mNumVertices;
+    Vector3<Real> const* mPositions;
+
+    // The vertices welded by position.  The position of vertex v is
+    // mVertexPosition[v], and mPositionVertex[p] is a vertex at position p.
+    std::vector<int> mVertexPosition, mPositionVertex;
+    std::vector<Quadric> mQuadrics;
+    std::vector<char> mKind;
+};
+
+#include "GteMeshSimplifier.inl"
+
+}
@@ -0,0 +1,1238 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/23)
+
+//----------------------------------------------------------------------------
+template <typename Real>
+double const MeshSimplifier<Real>::msConstraintWeight = 10.0;
+//----------------------------------------------------------------------------
+template <typename Real>
+MeshSimplifier<Real>::MeshSimplifier(
+    std::shared_ptr<ComputeModel> const& cmodel, int clusterTriangles)
+    :
+    mCModel(cmodel),
+    mClusterTriangles(clusterTriangles > 1 ? clusterTriangles : 1),
+    mNumVertices(0),
+    mPositions(nullptr)
+{
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool MeshSimplifier<Real>::operator()(int numVertices,
+    Vector3<Real> const* positions, std::vector<int>& indices,
+    int targetTriangles, Real targetError, Real& error)
+{
+    ProfileScope("MeshSimplifier");
+
+    error = (Real)0;
+    if (!Initialize(numVertices, positions, indices))
+    {
+        return false;
+    }
+
+    Simplify(indices, targetTriangles, targetError, true, error);
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool MeshSimplifier<Real>::GenerateLODChain(int numVertices,
+    Vector3<Real> const* positions, std::vector<int> const& indices,
+    int numLevels, Real reduction, Real targetError,
+    std::vector<Level>& levels)
+{
+    ProfileScope("MeshSimplifier::GenerateLODChain");
+
+    levels.clear();
+    if (reduction <= (Real)0 || reduction >= (Real)1
+        || !Initialize(numVertices, positions, indices))
+    {
+        return false;
+    }
+
+    Level level;
+    level.indices = indices;
+    level.error = (Real)0;
+    levels.push_back(level);
+
+    for (int i = 1; i < numLevels; ++i)
+    {
+        int numTriangles = static_cast<int>(level.indices.size() / 3);
+        int targetTriangles = static_cast<int>(reduction * numTriangles);
+        Real levelError;
+        Simplify(level.indices, targetTriangles, targetError, i == 1,
+            levelError);
+
+        if (static_cast<int>(level.indices.size() / 3) == numTriangles)
+        {
+            break;
+        }
+
+        level.error = std::max(level.error, levelError);
+        levels.push_back(level);
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+Real MeshSimplifier<Real>::GetScreenSpaceError(Real error, Real distance,
+    Real fovY, Real viewportHeight)
+{
+    if (distance <= (Real)0)
+    {
+        return std::numeric_limits<Real>::max();
+    }
+    return error * viewportHeight /
+        ((Real)2 * distance * std::tan((Real)0.5 * fovY));
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int MeshSimplifier<Real>::SelectLevel(std::vector<Level> const& levels,
+    Real distance, Real fovY, Real viewportHeight, Real maxPixelError)
+{
+    for (int i = static_cast<int>(levels.size()) - 1; i > 0; --i)
+    {
+        Real pixels = GetScreenSpaceError(levels[i].error, distance, fovY,
+            viewportHeight);
+        if (pixels <= maxPixelError)
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool MeshSimplifier<Real>::Initialize(int numVertices,
+    Vector3<Real> const* positions, std::vector<int> const& indices)
+{
+    if (numVertices <= 0 || !positions || indices.size() % 3 != 0)
+    {
+        return false;
+    }
+    for (auto index : indices)
+    {
+        if (index < 0 || index >= numVertices)
+        {
+            return false;
+        }
+    }
+
+    mNumVertices = numVertices;
+    mPositions = positions;
+
+    // Weld the vertices by sorting them by position.
+    std::vector<int> order(numVertices);
+    for (int v = 0; v < numVertices; ++v)
+    {
+        order[v] = v;
+    }
+    std::sort(order.begin(), order.end(),
+        [positions](int v0, int v1)
+        {
+            return positions[v0] < positions[v1];
+        }
+    );
+
+    mVertexPosition.resize(numVertices);
+    mPositionVertex.clear();
+    for (int i = 0; i < numVertices; ++i)
+    {
+        int v = order[i];
+        if (i == 0 || positions[v] != positions[order[i - 1]])
+        {
+            mPositionVertex.push_back(v);
+        }
+        mVertexPosition[v] = static_cast<int>(mPositionVertex.size()) - 1;
+    }
+
+    // The quadric of a position is the sum of the quadrics of the planes of
+    // its triangles, weighted by area.
+    mQuadrics.assign(mPositionVertex.size(), Quadric());
+    int const numTriangles = static_cast<int>(indices.size() / 3);
+    for (int t = 0; t < numTriangles; ++t)
+    {
+        int const* tri = &indices[3 * t];
+        Vector3<double> p[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            Vector3<Real> const& position = positions[tri[k]];
+            p[k] = Vector3<double>(position[0], position[1], position[2]);
+        }
+
+        Vector3<double> normal = Cross(p[1] - p[0], p[2] - p[0]);
+        double length = Length(normal);
+        if (length > 0.0)
+        {
+            normal /= length;
+            double d = -Dot(normal, p[0]);
+            double area = 0.5 * length;
+            for (int k = 0; k < 3; ++k)
+            {
+                Quadric& quadric = mQuadrics[mVertexPosition[tri[k]]];
+                quadric.AddPlane(normal, d, area);
+                quadric.area += area;
+            }
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Classify(std::vector<int> const& indices,
+    bool addConstraints)
+{
+    ProfileScope("MeshSimplifier::Classify");
+
+    // Count the half-edges of each edge of the welded mesh.  An edge record
+    // stores the number of half-edges and the first two of them, each as
+    // the corner 3*t+k of its triangle.
+    std::unordered_map<uint64_t, std::array<int, 3>> edges;
+    edges.reserve(indices.size());
+    int const numCorners = static_cast<int>(indices.size());
+    for (int c = 0; c < numCorners; ++c)
+    {
+        int p0 = mVertexPosition[indices[c]];
+        int p1 = mVertexPosition[indices[c - c % 3 + (c + 1) % 3]];
+        if (p0 != p1)
+        {
+            uint64_t key = (static_cast<uint64_t>(std::min(p0, p1)) << 32)
+                | static_cast<uint64_t>(std::max(p0, p1));
+            auto iter = edges.find(key);
+            if (iter == edges.end())
+            {
+                std::array<int, 3> record = { 1, c, -1 };
+                edges.insert(std::make_pair(key, record));
+            }
+            else if (++iter->second[0] == 2)
+            {
+                iter->second[2] = c;
+            }
+        }
+    }
+
+    int const numPositions = static_cast<int>(mPositionVertex.size());
+    std::vector<int> numBorder(numPositions, 0), numSeam(numPositions, 0);
+    std::vector<char> complex(numPositions, 0);
+    for (auto const& edge : edges)
+    {
+        std::array<int, 3> const& record = edge.second;
+        int c0 = record[1], c1 = record[2];
+        int a0 = indices[c0], b0 = indices[c0 - c0 % 3 + (c0 + 1) % 3];
+        EdgeKind kind = COMPLEX_EDGE;
+        if (record[0] == 1)
+        {
+            kind = BORDER_EDGE;
+        }
+        else if (record[0] == 2)
+        {
+            int a1 = indices[c1], b1 = indices[c1 - c1 % 3 + (c1 + 1) % 3];
+            if (mVertexPosition[a0] == mVertexPosition[b1]
+                && mVertexPosition[b0] == mVertexPosition[a1])
+            {
+                kind = (a0 == b1 && b0 == a1 ? INTERIOR_EDGE : SEAM_EDGE);
+            }
+        }
+
+        int p0 = static_cast<int>(edge.first >> 32);
+        int p1 = static_cast<int>(edge.first & 0xFFFFFFFFull);
+        if (kind == BORDER_EDGE)
+        {
+            ++numBorder[p0];
+            ++numBorder[p1];
+        }
+        else if (kind == SEAM_EDGE)
+        {
+            ++numSeam[p0];
+            ++numSeam[p1];
+        }
+        else if (kind == COMPLEX_EDGE)
+        {
+            complex[p0] = 1;
+            complex[p1] = 1;
+        }
+
+        // The constraint plane contains the edge and is perpendicular to
+        // the triangle of the first half-edge.
+        if (addConstraints && (kind == BORDER_EDGE || kind == SEAM_EDGE))
+        {
+            int const* tri = &indices[c0 - c0 % 3];
+            Vector3<double> p[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                Vector3<Real> const& position = mPositions[tri[k]];
+                p[k] = Vector3<double>(position[0], position[1],
+                    position[2]);
+            }
+            Vector3<double> edgeDirection = p[(c0 + 1) % 3] - p[c0 % 3];
+            Vector3<double> normal = Cross(edgeDirection,
+                Cross(p[1] - p[0], p[2] - p[0]));
+            double length = Length(normal);
+            if (length > 0.0)
+            {
+                normal /= length;
+                double d = -Dot(normal, p[c0 % 3]);
+                double weight = msConstraintWeight *
+                    Dot(edgeDirection, edgeDirection);
+                mQuadrics[p0].AddPlane(normal, d, weight);
+                mQuadrics[p1].AddPlane(normal, d, weight);
+            }
+        }
+    }
+
+    // Count the vertices of each position that are used by the mesh.
+    std::vector<int> numWedges(numPositions, 0);
+    std::vector<char> used(mNumVertices, 0);
+    for (auto v : indices)
+    {
+        if (!used[v])
+        {
+            used[v] = 1;
+            ++numWedges[mVertexPosition[v]];
+        }
+    }
+
+    mKind.assign(mNumVertices, static_cast<char>(LOCKED));
+    for (int v = 0; v < mNumVertices; ++v)
+    {
+        int p = mVertexPosition[v];
+        if (!used[v] || complex[p])
+        {
+            continue;
+        }
+
+        if (numWedges[p] == 1)
+        {
+            if (numBorder[p] == 0 && numSeam[p] == 0)
+            {
+                mKind[v] = MANIFOLD;
+            }
+            else if (numBorder[p] == 2 && numSeam[p] == 0)
+            {
+                mKind[v] = BORDER;
+            }
+        }
+        else if (numWedges[p] == 2)
+        {
+            if (numBorder[p] == 0 && numSeam[p] == 2)
+            {
+                mKind[v] = SEAM;
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Partition(std::vector<int> const& indices,
+    std::vector<std::vector<int>>& clusters) const
+{
+    int const numTriangles = static_cast<int>(indices.size() / 3);
+    std::vector<int> triangles(numTriangles);
+    std::vector<Vector3<Real>> centroids(numTriangles);
+    for (int t = 0; t < numTriangles; ++t)
+    {
+        triangles[t] = t;
+        centroids[t] = (mPositions[indices[3 * t]] +
+            mPositions[indices[3 * t + 1]] +
+            mPositions[indices[3 * t + 2]]) / (Real)3;
+    }
+
+    // Split the triangles recursively at the median of their centroids
+    // along the axis of largest extent.
+    std::vector<std::array<int, 2>> stack;
+    stack.push_back({ { 0, numTriangles } });
+    while (stack.size() > 0)
+    {
+        std::array<int, 2> range = stack.back();
+        stack.pop_back();
+        if (range[1] - range[0] <= mClusterTriangles)
+        {
+            clusters.push_back(std::vector<int>(
+                triangles.begin() + range[0], triangles.begin() + range[1]));
+            continue;
+        }
+
+        Vector3<Real> vmin = centroids[triangles[range[0]]], vmax = vmin;
+        for (int i = range[0] + 1; i < range[1]; ++i)
+        {
+            Vector3<Real> const& centroid = centroids[triangles[i]];
+            for (int j = 0; j < 3; ++j)
+            {
+                vmin[j] = std::min(vmin[j], centroid[j]);
+                vmax[j] = std::max(vmax[j], centroid[j]);
+            }
+        }
+        Vector3<Real> extent = vmax - vmin;
+        int axis = (extent[0] >= extent[1] ? 0 : 1);
+        axis = (extent[axis] >= extent[2] ? axis : 2);
+
+        int middle = (range[0] + range[1]) / 2;
+        std::nth_element(triangles.begin() + range[0],
+            triangles.begin() + middle, triangles.begin() + range[1],
+            [&centroids, axis](int t0, int t1)
+            {
+                return centroids[t0][axis] < centroids[t1][axis];
+            }
+        );
+        stack.push_back({ { range[0], middle } });
+        stack.push_back({ { middle, range[1] } });
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Simplify(std::vector<int>& indices,
+    int targetTriangles, Real targetError, bool addConstraints, Real& error)
+{
+    ProfileScope("MeshSimplifier::Simplify");
+
+    error = (Real)0;
+    Classify(indices, addConstraints);
+
+    int const numTriangles = static_cast<int>(indices.size() / 3);
+    int const numThreads = (mCModel ? mCModel->numThreads : 1);
+    if (numThreads > 1 && numTriangles > 2 * mClusterTriangles
+        && targetTriangles < numTriangles)
+    {
+        std::vector<std::vector<int>> clusters;
+        Partition(indices, clusters);
+
+        // The positions used by more than one cluster are locked.
+        int const numPositions = static_cast<int>(mPositionVertex.size());
+        int const numClusters = static_cast<int>(clusters.size());
+        std::vector<int> owner(numPositions, -1);
+        std::vector<char> locked(numPositions, 0);
+        for (int c = 0; c < numClusters; ++c)
+        {
+            for (auto t : clusters[c])
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    int p = mVertexPosition[indices[3 * t + k]];
+                    if (owner[p] == -1)
+                    {
+                        owner[p] = c;
+                    }
+                    else if (owner[p] != c)
+                    {
+                        locked[p] = 1;
+                    }
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<Region>> regions(numClusters);
+        ThreadPool& pool = mCModel->GetThreadPool();
+        pool.ParallelFor(numClusters, numThreads,
+            [this, &indices, &clusters, &locked, &regions](int cmin,
+            int cmax)
+        {
+            for (int c = cmin; c <= cmax; ++c)
+            {
+                std::vector<int> clusterIndices;
+                clusterIndices.reserve(3 * clusters[c].size());
+                for (auto t : clusters[c])
+                {
+                    clusterIndices.push_back(indices[3 * t]);
+                    clusterIndices.push_back(indices[3 * t + 1]);
+                    clusterIndices.push_back(indices[3 * t + 2]);
+                }
+                regions[c].reset(new Region(*this, clusterIndices, &locked));
+            }
+        });
+
+        // A cluster that must reach its share of the target while its
+        // boundary is locked makes collapses that are much more expensive
+        // than those of the whole mesh.  Instead, the clusters make only
+        // the collapses that are cheaper than a common bound, the cost of
+        // the k-th cheapest initial collapse, where k is half the number of
+        // collapses required (each collapse removes two triangles).  The
+        // costs increase as the simplification proceeds, so these are
+        // approximately the cheapest collapses of a sequential
+        // simplification, and the global pass makes the remaining ones.
+        // With k equal to the number of collapses required, the bound is
+        // an outlier cost for large reductions.
+        std::vector<double> costs;
+        for (int c = 0; c < numClusters; ++c)
+        {
+            regions[c]->GetCosts(costs);
+        }
+        double clusterError = static_cast<double>(targetError);
+        size_t k = static_cast<size_t>(numTriangles - targetTriangles) / 4;
+        if (k < costs.size())
+        {
+            std::nth_element(costs.begin(), costs.begin() + k, costs.end());
+            clusterError = std::min(clusterError, costs[k]);
+        }
+
+        double const fraction = static_cast<double>(targetTriangles) /
+            static_cast<double>(numTriangles);
+        pool.ParallelFor(numClusters, numThreads,
+            [&clusters, &regions, fraction, clusterError](int cmin, int cmax)
+        {
+            for (int c = cmin; c <= cmax; ++c)
+            {
+                int clusterTarget = static_cast<int>(
+                    fraction * static_cast<double>(clusters[c].size()));
+                regions[c]->Simplify(clusterTarget,
+                    static_cast<Real>(clusterError));
+            }
+        });
+
+        indices.clear();
+        for (int c = 0; c < numClusters; ++c)
+        {
+            regions[c]->GetIndices(indices);
+            regions[c]->UpdateQuadrics(mQuadrics);
+            error = std::max(error, regions[c]->GetError());
+            regions[c] = nullptr;
+        }
+        Classify(indices, false);
+    }
+
+    Region region(*this, indices, nullptr);
+    region.Simplify(targetTriangles, targetError);
+    indices.clear();
+    region.GetIndices(indices);
+    region.UpdateQuadrics(mQuadrics);
+    error = std::max(error, region.GetError());
+}
+//----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// MeshSimplifier::Quadric
+//----------------------------------------------------------------------------
+template <typename Real>
+MeshSimplifier<Real>::Quadric::Quadric()
+    :
+    area(0.0)
+{
+    coefficient.fill(0.0);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Quadric::AddPlane(Vector3<double> const& normal,
+    double d, double weight)
+{
+    double wx = weight * normal[0];
+    double wy = weight * normal[1];
+    double wz = weight * normal[2];
+    double wd = weight * d;
+    coefficient[0] += wx * normal[0];
+    coefficient[1] += wx * normal[1];
+    coefficient[2] += wx * normal[2];
+    coefficient[3] += wx * d;
+    coefficient[4] += wy * normal[1];
+    coefficient[5] += wy * normal[2];
+    coefficient[6] += wy * d;
+    coefficient[7] += wz * normal[2];
+    coefficient[8] += wz * d;
+    coefficient[9] += wd * d;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Quadric::Add(Quadric const& quadric, double sign)
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        coefficient[i] += sign * quadric.coefficient[i];
+    }
+    area += sign * quadric.area;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+double MeshSimplifier<Real>::Quadric::Evaluate(Vector3<double> const& point)
+    const
+{
+    double x = point[0], y = point[1], z = point[2];
+    std::array<double, 10> const& c = coefficient;
+    return x * (c[0] * x + 2.0 * (c[1] * y + c[2] * z + c[3]))
+        + y * (c[4] * y + 2.0 * (c[5] * z + c[6]))
+        + z * (c[7] * z + 2.0 * c[8]) + c[9];
+}
+//----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// MeshSimplifier::Region
+//----------------------------------------------------------------------------
+template <typename Real>
+MeshSimplifier<Real>::Region::Region(MeshSimplifier const& simplifier,
+    std::vector<int> const& indices,
+    std::vector<char> const* lockedPositions)
+    :
+    mNumTriangles(0),
+    mError((Real)0)
+{
+    // Renumber the vertices and the positions in increasing order of their
+    // global indices.  A region that covers a large part of the mesh uses a
+    // table for the vertex renumbering rather than binary searches.
+    mVertexGlobal = indices;
+    std::sort(mVertexGlobal.begin(), mVertexGlobal.end());
+    mVertexGlobal.erase(std::unique(mVertexGlobal.begin(),
+        mVertexGlobal.end()), mVertexGlobal.end());
+    int const numVertices = static_cast<int>(mVertexGlobal.size());
+
+    std::vector<int> localVertex;
+    if (8 * numVertices >= simplifier.mNumVertices)
+    {
+        localVertex.resize(simplifier.mNumVertices);
+        for (int v = 0; v < numVertices; ++v)
+        {
+            localVertex[mVertexGlobal[v]] = v;
+        }
+    }
+
+    mPositionGlobal.resize(numVertices);
+    for (int v = 0; v < numVertices; ++v)
+    {
+        mPositionGlobal[v] = simplifier.mVertexPosition[mVertexGlobal[v]];
+    }
+    std::sort(mPositionGlobal.begin(), mPositionGlobal.end());
+    mPositionGlobal.erase(std::unique(mPositionGlobal.begin(),
+        mPositionGlobal.end()), mPositionGlobal.end());
+    int const numPositions = static_cast<int>(mPositionGlobal.size());
+
+    mPoints.resize(numPositions);
+    mQuadrics.resize(numPositions);
+    for (int p = 0; p < numPositions; ++p)
+    {
+        int g = mPositionGlobal[p];
+        Vector3<Real> const& point =
+            simplifier.mPositions[simplifier.mPositionVertex[g]];
+        mPoints[p] = Vector3<double>(point[0], point[1], point[2]);
+        mQuadrics[p] = simplifier.mQuadrics[g];
+    }
+    mInitialQuadrics = mQuadrics;
+
+    mVertexPosition.resize(numVertices);
+    mFirstWedge.assign(numPositions, -1);
+    mNextWedge.resize(numVertices);
+    mPartial.assign(numPositions, 0);
+    mKind.resize(numVertices);
+    for (int v = 0; v < numVertices; ++v)
+    {
+        int g = simplifier.mVertexPosition[mVertexGlobal[v]];
+        int p = static_cast<int>(std::lower_bound(mPositionGlobal.begin(),
+            mPositionGlobal.end(), g) - mPositionGlobal.begin());
+        mVertexPosition[v] = p;
+        mNextWedge[v] = mFirstWedge[p];
+        mFirstWedge[p] = v;
+        mKind[v] = simplifier.mKind[mVertexGlobal[v]];
+        if (lockedPositions && (*lockedPositions)[g])
+        {
+            mKind[v] = LOCKED;
+            mPartial[p] = 1;
+        }
+    }
+
+    // The triangles with two vertices at the same position are discarded.
+    int const numTriangles = static_cast<int>(indices.size() / 3);
+    mTriangles.resize(indices.size());
+    mCorners.resize(indices.size());
+    mAlive.resize(numTriangles);
+    mAdjacent.resize(numVertices);
+    for (int t = 0; t < numTriangles; ++t)
+    {
+        int* tri = &mTriangles[3 * t];
+        int* corners = &mCorners[3 * t];
+        for (int k = 0; k < 3; ++k)
+        {
+            int g = indices[3 * t + k];
+            tri[k] = (localVertex.size() > 0 ? localVertex[g] :
+                static_cast<int>(std::lower_bound(mVertexGlobal.begin(),
+                mVertexGlobal.end(), g) - mVertexGlobal.begin()));
+            corners[k] = mVertexPosition[tri[k]];
+        }
+
+        if (corners[0] != corners[1] && corners[1] != corners[2]
+            && corners[2] != corners[0])
+        {
+            mAlive[t] = 1;
+            ++mNumTriangles;
+            for (int k = 0; k < 3; ++k)
+            {
+                mAdjacent[tri[k]].push_back(t);
+            }
+        }
+        else
+        {
+            mAlive[t] = 0;
+        }
+    }
+
+    mTarget.assign(numVertices, -1);
+    mKey.assign(numVertices, 0.0);
+    for (int v = 0; v < numVertices; ++v)
+    {
+        ComputeCandidate(v, false);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Region::Simplify(int targetTriangles,
+    Real targetError)
+{
+    ProfileScope("MeshSimplifier::Region::Simplify");
+
+    std::vector<int> touched, recompute;
+    while (mNumTriangles > targetTriangles && mHeap.size() > 0)
+    {
+        double key = mHeap.top().first;
+        int u = mHeap.top().second;
+        if (mTarget[u] < 0 || key != mKey[u])
+        {
+            // The entry is obsolete.
+            mHeap.pop();
+            continue;
+        }
+        if (key > static_cast<double>(targetError))
+        {
+            break;
+        }
+        mHeap.pop();
+
+        // The candidates are validated when they reach the top of the heap.
+        // An invalid candidate is replaced by the cheapest valid collapse
+        // of its vertex, which remains valid when it reaches the top unless
+        // the neighborhood changes again.
+        int v = mTarget[u], u2, v2;
+        bool valid = IsValidCollapse(u, v);
+        if (valid && mKind[u] == SEAM)
+        {
+            valid = GetSeamPair(u, v, u2, v2) && IsValidCollapse(u2, v2);
+        }
+        if (!valid)
+        {
+            ComputeCandidate(u, true);
+            continue;
+        }
+
+        mError = std::max(mError, static_cast<Real>(key));
+        touched.clear();
+        Collapse(u, v, touched);
+
+        // The quadric of the target position has changed, so the candidates
+        // of its vertices and the candidates onto it are recomputed, as are
+        // the candidates that were the collapsed vertices.  The other
+        // vertices adjacent to the collapsed vertices only have new edges to
+        // the target; the costs of their other collapses are unchanged.
+        // Discard the triangles that the collapse removed from the lists of
+        // the target vertices.
+        int pv = mVertexPosition[v];
+        recompute.clear();
+        for (int w = mFirstWedge[pv]; w >= 0; w = mNextWedge[w])
+        {
+            std::vector<int>& adjacent = mAdjacent[w];
+            adjacent.erase(std::remove_if(adjacent.begin(), adjacent.end(),
+                [this](int t) { return !mAlive[t]; }), adjacent.end());
+            recompute.push_back(w);
+            for (auto t : adjacent)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    int target = mTarget[mTriangles[3 * t + k]];
+                    if (target >= 0 && mVertexPosition[target] == pv)
+                    {
+                        recompute.push_back(mTriangles[3 * t + k]);
+                    }
+                }
+            }
+        }
+
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()),
+            touched.end());
+        for (auto w : touched)
+        {
+            int target = mTarget[w];
+            if (target >= 0 && mFirstWedge[mVertexPosition[target]] < 0)
+            {
+                recompute.push_back(w);
+            }
+            else
+            {
+                AddCandidates(w, pv);
+            }
+        }
+
+        std::sort(recompute.begin(), recompute.end());
+        recompute.erase(std::unique(recompute.begin(), recompute.end()),
+            recompute.end());
+        for (auto w : recompute)
+        {
+            ComputeCandidate(w, false);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Region::GetIndices(std::vector<int>& indices)
+    const
+{
+    int const numTriangles = static_cast<int>(mAlive.size());
+    for (int t = 0; t < numTriangles; ++t)
+    {
+        if (mAlive[t])
+        {
+            indices.push_back(mVertexGlobal[mTriangles[3 * t]]);
+            indices.push_back(mVertexGlobal[mTriangles[3 * t + 1]]);
+            indices.push_back(mVertexGlobal[mTriangles[3 * t + 2]]);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Region::GetCosts(std::vector<double>& costs) const
+{
+    int const numVertices = static_cast<int>(mTarget.size());
+    for (int v = 0; v < numVertices; ++v)
+    {
+        if (mTarget[v] >= 0)
+        {
+            costs.push_back(mKey[v]);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Region::UpdateQuadrics(
+    std::vector<Quadric>& quadrics) const
+{
+    // A locked position can be the target of collapses in several regions,
+    // so each region adds the change of its quadric.
+    int const numPositions = static_cast<int>(mPositionGlobal.size());
+    for (int p = 0; p < numPositions; ++p)
+    {
+        Quadric& quadric = quadrics[mPositionGlobal[p]];
+        quadric.Add(mQuadrics[p], 1.0);
+        quadric.Add(mInitialQuadrics[p], -1.0);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+Real MeshSimplifier<Real>::Region::GetError() const
+{
+    return mError;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+typename MeshSimplifier<Real>::EdgeKind
+MeshSimplifier<Real>::Region::GetEdgeKind(int p0, int p1, int& numShared)
+    const
+{
+    // Visit the half-edges from p0 to p1 (forward) and from p1 to p0
+    // (backward) in the triangles of the vertices at p0.
+    int numForward = 0, numBackward = 0;
+    int a0 = -1, b0 = -1, a1 = -1, b1 = -1;
+    for (int w = mFirstWedge[p0]; w >= 0; w = mNextWedge[w])
+    {
+        for (auto t : mAdjacent[w])
+        {
+            if (!mAlive[t])
+            {
+                continue;
+            }
+
+            int const* tri = &mTriangles[3 * t];
+            int const* corners = &mCorners[3 * t];
+            int k = (tri[0] == w ? 0 : (tri[1] == w ? 1 : 2));
+            int next = (k + 1) % 3, prev = (k + 2) % 3;
+            if (corners[next] == p1)
+            {
+                ++numForward;
+                a0 = w;
+                b0 = tri[next];
+            }
+            if (corners[prev] == p1)
+            {
+                ++numBackward;
+                a1 = w;
+                b1 = tri[prev];
+            }
+        }
+    }
+
+    numShared = numForward + numBackward;
+    if (numShared == 1)
+    {
+        return BORDER_EDGE;
+    }
+    if (numForward == 1 && numBackward == 1)
+    {
+        return (a0 == a1 && b0 == b1 ? INTERIOR_EDGE : SEAM_EDGE);
+    }
+    return COMPLEX_EDGE;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Region::GetNeighbors(int p,
+    std::vector<int>& neighbors) const
+{
+    neighbors.clear();
+    for (int w = mFirstWedge[p]; w >= 0; w = mNextWedge[w])
+    {
+        for (auto t : mAdjacent[w])
+        {
+            if (mAlive[t])
+            {
+                int const* corners = &mCorners[3 * t];
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (corners[k] != p)
+                    {
+                        neighbors.push_back(corners[k]);
+                    }
+                }
+            }
+        }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+        neighbors.end());
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int MeshSimplifier<Real>::Region::GetNumTriangles(int p) const
+{
+    int numTriangles = 0;
+    for (int w = mFirstWedge[p]; w >= 0; w = mNextWedge[w])
+    {
+        numTriangles += static_cast<int>(mAdjacent[w].size());
+    }
+    return numTriangles;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool MeshSimplifier<Real>::Region::IsAdjacent(int p0, int p1) const
+{
+    // The triangles of a partial position are only those in the region,
+    // so search those of the other position, and assume the positions are
+    // adjacent when both are partial.
+    if (mPartial[p0] || (!mPartial[p1]
+        && GetNumTriangles(p1) < GetNumTriangles(p0)))
+    {
+        std::swap(p0, p1);
+    }
+
+    for (int w = mFirstWedge[p0]; w >= 0; w = mNextWedge[w])
+    {
+        for (auto t : mAdjacent[w])
+        {
+            if (mAlive[t])
+            {
+                int const* corners = &mCorners[3 * t];
+                if (corners[0] == p1 || corners[1] == p1
+                    || corners[2] == p1)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return mPartial[p0] != 0;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool MeshSimplifier<Real>::Region::IsValidCollapse(int u, int v) const
+{
+    int pu = mVertexPosition[u], pv = mVertexPosition[v];
+    int numShared;
+    GetEdgeKind(pu, pv, numShared);
+    if (numShared == 0)
+    {
+        return false;
+    }
+
+    // The link condition: the positions adjacent to both pu and pv must be
+    // those of the triangles that share the edge, otherwise the collapse
+    // creates a nonmanifold edge or closes a tunnel.  The neighbors are
+    // those of the position with fewer triangles, because the other one
+    // can have a large valence, for example the locked pole of a sphere.
+    // The position of u is not partial, because u is not locked.
+    int p0 = pu, p1 = pv;
+    if (!mPartial[pv] && GetNumTriangles(pv) < GetNumTriangles(pu))
+    {
+        std::swap(p0, p1);
+    }
+    GetNeighbors(p0, mNeighbors);
+    int numCommon = 0;
+    for (auto p : mNeighbors)
+    {
+        if (p != p1 && IsAdjacent(p, p1))
+        {
+            ++numCommon;
+        }
+    }
+    if (numCommon != numShared)
+    {
+        return false;
+    }
+
+    // The triangles of u that remain must not flip or become degenerate.
+    // Rejecting only flips allows a triangle to fold over several
+    // collapses, so the normal of a triangle may rotate by at most 60
+    // degrees in one collapse.
+    for (auto t : mAdjacent[u])
+    {
+        int const* corners = &mCorners[3 * t];
+        if (!mAlive[t] || corners[0] == pv || corners[1] == pv
+            || corners[2] == pv)
+        {
+            continue;
+        }
+
+        Vector3<double> const& p0 = mPoints[corners[0]];
+        Vector3<double> const& p1 = mPoints[corners[1]];
+        Vector3<double> const& p2 = mPoints[corners[2]];
+        Vector3<double> normal0 = Cross(p1 - p0, p2 - p0);
+        Vector3<double> normal1 = Cross(
+            (corners[1] == pu ? mPoints[pv] : p1) -
+            (corners[0] == pu ? mPoints[pv] : p0),
+            (corners[2] == pu ? mPoints[pv] : p2) -
+            (corners[0] == pu ? mPoints[pv] : p0));
+        double dot = Dot(normal0, normal1);
+        if (dot <= 0.5 * Length(normal0) * Length(normal1) && dot != 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool MeshSimplifier<Real>::Region::GetSeamPair(int u, int v, int& u2,
+    int& v2) const
+{
+    // The other vertex at the position of u moves to the vertex at the
+    // position of v that it shares a triangle with.
+    int pu = mVertexPosition[u], pv = mVertexPosition[v];
+    u2 = -1;
+    for (int w = mFirstWedge[pu]; w >= 0; w = mNextWedge[w])
+    {
+        if (w != u)
+        {
+            if (u2 >= 0)
+            {
+                return false;
+            }
+            u2 = w;
+        }
+    }
+    if (u2 < 0)
+    {
+        return false;
+    }
+
+    for (auto t : mAdjacent[u2])
+    {
+        if (mAlive[t])
+        {
+            int const* corners = &mCorners[3 * t];
+            for (int k = 0; k < 3; ++k)
+            {
+                if (corners[k] == pv)
+                {
+                    v2 = mTriangles[3 * t + k];
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+double MeshSimplifier<Real>::Region::GetCost(int u, int v) const
+{
+    int pu = mVertexPosition[u], pv = mVertexPosition[v];
+    Quadric const& quadric0 = mQuadrics[pu];
+    Quadric const& quadric1 = mQuadrics[pv];
+    double error = quadric0.Evaluate(mPoints[pv]) +
+        quadric1.Evaluate(mPoints[pv]);
+    double area = quadric0.area + quadric1.area;
+    if (area > 0.0)
+    {
+        error /= area;
+    }
+    return std::sqrt(std::max(error, 0.0));
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Region::ComputeCandidate(int u, bool validate)
+{
+    if (mKind[u] == LOCKED)
+    {
+        mTarget[u] = -1;
+        return;
+    }
+
+    // Compute the costs of the collapses of u along the edges that are
+    // allowed for its kind.  An edge of a MANIFOLD vertex is always
+    // interior, because the collapses preserve the kinds of the edges.
+    int pu = mVertexPosition[u];
+    mCandidates.clear();
+    for (auto t : mAdjacent[u])
+    {
+        if (!mAlive[t])
+        {
+            continue;
+        }
+
+        int const* tri = &mTriangles[3 * t];
+        for (int k = 0; k < 3; ++k)
+        {
+            int v = tri[k];
+            if (v == u || std::find_if(mCandidates.begin(), mCandidates.end(),
+                [v](std::pair<double, int> const& candidate)
+                {
+                    return candidate.second == v;
+                }) != mCandidates.end())
+            {
+                continue;
+            }
+
+            if (mKind[u] != MANIFOLD)
+            {
+                int numShared;
+                EdgeKind kind = GetEdgeKind(pu, mVertexPosition[v],
+                    numShared);
+                if ((mKind[u] == BORDER && kind != BORDER_EDGE)
+                    || (mKind[u] == SEAM && kind != SEAM_EDGE))
+                {
+                    continue;
+                }
+            }
+            mCandidates.push_back(std::make_pair(GetCost(u, v), v));
+        }
+    }
+
+    // The validity tests are more expensive than the costs.  When requested,
+    // test the candidates in increasing order of cost and stop at the first
+    // valid one; otherwise, the cheapest candidate is tested when it reaches
+    // the top of the heap.
+    std::sort(mCandidates.begin(), mCandidates.end());
+    int best = -1;
+    double bestCost = 0.0;
+    for (auto const& candidate : mCandidates)
+    {
+        int v = candidate.second, u2, v2;
+        if (!validate || (IsValidCollapse(u, v) && (mKind[u] != SEAM
+            || (GetSeamPair(u, v, u2, v2) && IsValidCollapse(u2, v2)))))
+        {
+            best = v;
+            bestCost = candidate.first;
+            break;
+        }
+    }
+
+    // The heap entry of u remains current when the candidate is unchanged.
+    if (best >= 0)
+    {
+        if (best != mTarget[u] || bestCost != mKey[u])
+        {
+            mTarget[u] = best;
+            mKey[u] = bestCost;
+            mHeap.push(std::make_pair(bestCost, u));
+        }
+    }
+    else
+    {
+        mTarget[u] = -1;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Region::AddCandidates(int u, int p)
+{
+    if (mKind[u] == LOCKED)
+    {
+        return;
+    }
+
+    int pu = mVertexPosition[u];
+    for (auto t : mAdjacent[u])
+    {
+        if (!mAlive[t])
+        {
+            continue;
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            if (mCorners[3 * t + k] != p)
+            {
+                continue;
+            }
+
+            int v = mTriangles[3 * t + k];
+            if (mKind[u] != MANIFOLD)
+            {
+                int numShared;
+                EdgeKind kind = GetEdgeKind(pu, p, numShared);
+                if ((mKind[u] == BORDER && kind != BORDER_EDGE)
+                    || (mKind[u] == SEAM && kind != SEAM_EDGE))
+                {
+                    continue;
+                }
+            }
+
+            double cost = GetCost(u, v);
+            if (mTarget[u] < 0 || cost < mKey[u])
+            {
+                mTarget[u] = v;
+                mKey[u] = cost;
+                mHeap.push(std::make_pair(cost, u));
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void MeshSimplifier<Real>::Region::Collapse(int u, int v,
+    std::vector<int>& touched)
+{
+    int pu = mVertexPosition[u], pv = mVertexPosition[v];
+    std::array<int, 2> from = { { u, -1 } }, to = { { v, -1 } };
+    int numMoves = 1;
+    if (mKind[u] == SEAM && GetSeamPair(u, v, from[1], to[1]))
+    {
+        numMoves = 2;
+    }
+
+    for (int i = 0; i < numMoves; ++i)
+    {
+        for (auto t : mAdjacent[from[i]])
+        {
+            if (!mAlive[t])
+            {
+                continue;
+            }
+
+            int* tri = &mTriangles[3 * t];
+            int* corners = &mCorners[3 * t];
+            touched.push_back(tri[0]);
+            touched.push_back(tri[1]);
+            touched.push_back(tri[2]);
+            if (corners[0] == pv || corners[1] == pv || corners[2] == pv)
+            {
+                mAlive[t] = 0;
+                --mNumTriangles;
+            }
+            else
+            {
+                int k = (tri[0] == from[i] ? 0 : (tri[1] == from[i] ? 1 : 2));
+                tri[k] = to[i];
+                corners[k] = pv;
+                mAdjacent[to[i]].push_back(t);
+            }
+        }
+        std::vector<int>().swap(mAdjacent[from[i]]);
+        mTarget[from[i]] = -1;
+        mKind[from[i]] = LOCKED;
+    }
+
+    mQuadrics[pv].Add(mQuadrics[pu], 1.0);
+    mFirstWedge[pu] = -1;
+}
+//----------------------------------------------------------------------------
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/11/15)
 
 #pragma once
 
@@ -11,6 +11,7 @@
 #include "GteConvexHull3.h"
 #include "GteMinimumAreaBox2.h"
 #include "GteEdgeKey.h"
+#include "GteProfiler.h"
 
 // Compute a minimum-volume oriented box containing the specified points.  The
 // algorithm is really about computing the minimum-volume box containing the
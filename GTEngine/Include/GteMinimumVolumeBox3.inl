@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/11/15)
 
 //----------------------------------------------------------------------------
 template <typename InputType, typename ComputeType>
@@ -19,6 +19,8 @@ bool MinimumVolumeBox3<InputType, ComputeType>::operator()(int numPoints,
     Vector3<InputType> const* points, InputType epsilon,
     OrientedBox3<InputType>& minBox)
 {
+    ProfileScope("MinimumVolumeBox3");
+
     mNumPoints = numPoints;
     mPoints = points;
     mHull.clear();
@@ -149,6 +151,8 @@ bool MinimumVolumeBox3<InputType, ComputeType>::operator()(int numPoints,
     Vector3<InputType> const* points, int numIndices, int const* indices,
     OrientedBox3<InputType>& minBox)
 {
+    ProfileScope("MinimumVolumeBox3");
+
     mNumPoints = numPoints;
     mPoints = points;
     mUniqueIndices.clear();
@@ -230,6 +234,8 @@ void MinimumVolumeBox3<InputType, ComputeType>::ProcessFaces(
     ETManifoldMesh const& mesh, Vector3<ComputeType> const* computePoints,
     Box& minBox)
 {
+    ProfileScope("MinimumVolumeBox3::ProcessFaces");
+
     // Compute inner-pointing face normals for searching boxes supported by
     // a face and an extreme vertex.  The indirection in triNormalMap, using
     // an integer index instead of the normal/sqrlength pair itself, avoids
@@ -394,6 +400,8 @@ void MinimumVolumeBox3<InputType, ComputeType>::ProcessEdges(
     ETManifoldMesh const& mesh, Vector3<ComputeType> const* computePoints,
     Box& minBox)
 {
+    ProfileScope("MinimumVolumeBox3::ProcessEdges");
+
     // The minimum-volume box can also be supported by three mutually
     // orthogonal edges of the convex hull.  For each triple of orthogonal
     // edges, compute the minimum-volume box for that coordinate frame by
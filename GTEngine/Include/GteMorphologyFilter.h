@@ -0,0 +1,60 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#pragma once
+
+#include "GTEngineDEF.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Support for the box, disk and ball filters of ImageUtility2 and
+// ImageUtility3.  The filters compute the maximum (dilation) or minimum
+// (erosion) of the pixels in a window clipped to the image.  The operation
+// 'op' returns std::max or std::min of its two arguments, and 'identity' is
+// its identity element.
+
+namespace gte
+{
+
+class GTE_IMPEXP MorphologyFilter
+{
+public:
+    // The van Herk/Gil-Werman 1D filter with window [q-radius,q+radius].
+    // The samples are input[q*stride] for 0 <= q < numSamples, and each
+    // sample is a block of 'count' contiguous elements that are filtered
+    // independently.  The input and output may be the same array.  The
+    // buffers g and h must have at least (numSamples + 4*radius)*count
+    // elements.  The cost is 3 operations per element for any radius.
+    template <typename PixelType, typename Operation>
+    static void VanHerk(int numSamples, size_t stride, int count,
+        int radius, PixelType const* input, PixelType* output, PixelType* g,
+        PixelType* h, PixelType identity, Operation op);
+
+    // The horizontal chord of the disk x^2 + y^2 <= sqrRadius at height dy,
+    // 0 <= dy <= floor(sqrt(sqrRadius)), has half-length
+    // chordRadius[chordIndex[dy]].  The chordRadius[] values are distinct
+    // and decreasing.
+    static void GetChords(int sqrRadius, std::vector<int>& chordIndex,
+        std::vector<int>& chordRadius);
+
+    // Filter the rows ymin through ymax of a dim0-by-dim1 image by the disk
+    // x^2 + y^2 <= sqrRadius.  The input and output must be different
+    // arrays.  Each input row that the rows ymin through ymax depend on is
+    // filtered by one chord at a time, and the result is combined with the
+    // output rows at the heights of that chord.  The cost is O(radius)
+    // operations per pixel.  The scratch 'buffer' has O(dim0) elements for
+    // any radius.
+    template <typename PixelType, typename Operation>
+    static void FilterDiskRows(int dim0, int dim1, int sqrRadius,
+        PixelType const* input, PixelType* output, int ymin, int ymax,
+        PixelType identity, Operation op, std::vector<PixelType>& buffer);
+};
+
+#include "GteMorphologyFilter.inl"
+
+}
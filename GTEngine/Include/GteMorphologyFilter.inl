@@ -0,0 +1,173 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+//----------------------------------------------------------------------------
+template <typename PixelType, typename Operation>
+void MorphologyFilter::VanHerk(int numSamples, size_t stride, int count,
+    int radius, PixelType const* input, PixelType* output, PixelType* g,
+    PixelType* h, PixelType identity, Operation op)
+{
+    // The samples are padded with 'radius' identity elements at the front
+    // and enough at the back to make the padded length a multiple of the
+    // window size k = 2*radius+1.  In the padded sequence, the window for
+    // sample q is [q,q+2*radius].  With g[] the running results from the
+    // start of each block of k samples and h[] the running results to the
+    // end of each block, the window result is op(h[q],g[q+2*radius]).
+    int const k = 2 * radius + 1;
+    int const numPadded = ((numSamples + 2 * radius + k - 1) / k) * k;
+    size_t const sampleSize = static_cast<size_t>(count);
+
+    for (int p = 0; p < numPadded; ++p)
+    {
+        PixelType* gp = g + p * sampleSize;
+        int q = p - radius;
+        if (0 <= q && q < numSamples)
+        {
+            PixelType const* source = input + q * stride;
+            if (p % k == 0)
+            {
+                std::copy(source, source + count, gp);
+            }
+            else
+            {
+                PixelType const* gprev = gp - sampleSize;
+                for (int e = 0; e < count; ++e)
+                {
+                    gp[e] = op(gprev[e], source[e]);
+                }
+            }
+        }
+        else
+        {
+            if (p % k == 0)
+            {
+                std::fill(gp, gp + count, identity);
+            }
+            else
+            {
+                std::copy(gp - sampleSize, gp, gp);
+            }
+        }
+    }
+
+    for (int p = numPadded - 1; p >= 0; --p)
+    {
+        PixelType* hp = h + p * sampleSize;
+        int q = p - radius;
+        if (0 <= q && q < numSamples)
+        {
+            PixelType const* source = input + q * stride;
+            if ((p + 1) % k == 0)
+            {
+                std::copy(source, source + count, hp);
+            }
+            else
+            {
+                PixelType const* hnext = hp + sampleSize;
+                for (int e = 0; e < count; ++e)
+                {
+                    hp[e] = op(hnext[e], source[e]);
+                }
+            }
+        }
+        else
+        {
+            if ((p + 1) % k == 0)
+            {
+                std::fill(hp, hp + count, identity);
+            }
+            else
+            {
+                std::copy(hp + sampleSize, hp + 2 * sampleSize, hp);
+            }
+        }
+    }
+
+    for (int q = 0; q < numSamples; ++q)
+    {
+        PixelType const* hq = h + q * sampleSize;
+        PixelType const* gq = g + (q + 2 * radius) * sampleSize;
+        PixelType* target = output + q * stride;
+        for (int e = 0; e < count; ++e)
+        {
+            target[e] = op(hq[e], gq[e]);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename PixelType, typename Operation>
+void MorphologyFilter::FilterDiskRows(int dim0, int dim1, int sqrRadius,
+    PixelType const* input, PixelType* output, int ymin, int ymax,
+    PixelType identity, Operation op, std::vector<PixelType>& buffer)
+{
+    std::vector<int> chordIndex, chordRadius;
+    GetChords(sqrRadius, chordIndex, chordRadius);
+    int const radius = static_cast<int>(chordIndex.size()) - 1;
+    int const numChords = static_cast<int>(chordRadius.size());
+
+    // The buffer stores one filtered row and the g and h arrays of VanHerk.
+    size_t const rowSize = static_cast<size_t>(dim0);
+    size_t const vhSize = rowSize + 4 * chordRadius[0];
+    buffer.resize(rowSize + 2 * vhSize);
+    PixelType* filtered = &buffer[0];
+    PixelType* g = filtered + rowSize;
+    PixelType* h = g + vhSize;
+
+    for (int y = ymin; y <= ymax; ++y)
+    {
+        PixelType* target = output + rowSize * y;
+        std::fill(target, target + rowSize, identity);
+    }
+
+    // Output row y is the combination over |dy| <= radius of input row y+dy
+    // filtered by the chord at height |dy|.  Equivalently, input row 'row'
+    // filtered by the chord at height dy contributes to output rows row-dy
+    // and row+dy.  The chord half-lengths are nonincreasing in dy, so the
+    // heights of chord c are an interval dmin <= dy <= dmax.
+    int const rmin = std::max(ymin - radius, 0);
+    int const rmax = std::min(ymax + radius, dim1 - 1);
+    for (int row = rmin; row <= rmax; ++row)
+    {
+        PixelType const* source = input + rowSize * row;
+        for (int c = 0, dmin = 0; c < numChords; ++c)
+        {
+            int dmax = dmin;
+            while (dmax < radius && chordIndex[dmax + 1] == c)
+            {
+                ++dmax;
+            }
+
+            // Skip the chord when none of its output rows is in
+            // [ymin,ymax].
+            bool lower = (row - dmin >= ymin && row - dmax <= ymax);
+            bool upper = (row + dmax >= ymin && row + dmin <= ymax);
+            if (lower || upper)
+            {
+                VanHerk(dim0, 1, 1, chordRadius[c], source, filtered, g, h,
+                    identity, op);
+
+                for (int dy = dmin; dy <= dmax; ++dy)
+                {
+                    int const y[2] = { row - dy, row + dy };
+                    for (int k = (dy > 0 ? 0 : 1); k < 2; ++k)
+                    {
+                        if (ymin <= y[k] && y[k] <= ymax)
+                        {
+                            PixelType* target = output + rowSize * y[k];
+                            for (int x = 0; x < dim0; ++x)
+                            {
+                                target[x] = op(target[x], filtered[x]);
+                            }
+                        }
+                    }
+                }
+            }
+            dmin = dmax + 1;
+        }
+    }
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,154 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/14)
+
+#pragma once
+
+#include "GteComputeModel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Integrate many independent systems of ordinary differential equations
+// dx/dt = F(t,x) of the same dimension in lockstep.  The OdeSolver-derived
+// classes integrate one system per Update call and evaluate F once per
+// system per stage through a std::function.  This class stores the states
+// of all systems as a structure of arrays (SoA) and evaluates F for a range
+// of systems per call, so the callback overhead is amortized and the inner
+// loops of the callback can be vectorized by the compiler.
+//
+// Component j of the state of system s is state[j*numSystems + s].  The
+// derivative callback is
+//   F(smin, smax, time, state, derivative)
+// and it must set derivative[j*numSystems + s] to component j of
+// F(time[s], x_s) for all j and for smin <= s <= smax, where x_s is the
+// state of system s stored in 'state' as described previously.  The
+// systems are partitioned into ranges that are processed by at most
+// cmodel->numThreads threads of the compute model's thread pool, so the
+// callback is called concurrently for disjoint ranges of systems.
+//
+// The fixed-step methods are the Euler, midpoint, and Runge-Kutta
+// fourth-order methods, the same as OdeEuler, OdeMidpoint, and
+// OdeRungeKutta4.  The adaptive method is the Dormand-Prince Runge-Kutta
+// 5(4) method.  Each system has its own step size, chosen to keep the
+// estimated local error below the tolerance, and takes as many steps as
+// necessary to advance by tDelta.
+
+namespace gte
+{
+
+template <typename Real>
+class OdeEnsemble
+{
+public:
+    typedef std::function
+    <
+        void
+        (
+            int,            // smin
+            int,            // smax
+            Real const*,    // time[numSystems]
+            Real const*,    // state[dimension*numSystems]
+            Real*           // derivative[dimension*numSystems]
+        )
+    >
+    Function;
+
+    enum Method
+    {
+        METHOD_EULER,
+        METHOD_MIDPOINT,
+        METHOD_RUNGE_KUTTA_4,
+        METHOD_RUNGE_KUTTA_45
+    };
+
+    // Construction and destruction.  The default method is
+    // METHOD_RUNGE_KUTTA_4.  If cmodel is null, the update is
+    // single-threaded.
+    virtual ~OdeEnsemble();
+    OdeEnsemble(int numSystems, int dimension, Real tDelta,
+        Function const& F,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    // Member access.
+    inline int GetNumSystems() const;
+    inline int GetDimension() const;
+    inline void SetTDelta(Real tDelta);
+    inline Real GetTDelta() const;
+    void SetMethod(Method method);
+    inline Method GetMethod() const;
+
+    // The tolerances for METHOD_RUNGE_KUTTA_45.  A step of a system is
+    // accepted when the root-mean-square over the components of
+    // error[j]/(absolute + relative*|x[j]|) is at most 1.  A step of size
+    // minStep or smaller is always accepted, unless its error is not finite
+    // because F returned a NaN or an infinity.  Such a step is retried with
+    // a smaller size, and at size minStep or smaller the system fails: it
+    // keeps the state of its last accepted step and is not integrated
+    // further by this Update.  This guarantees that Update terminates.  The
+    // defaults are absolute = relative = 1e-06 and minStep = 1e-06*tDelta.
+    void SetTolerance(Real absolute, Real relative, Real minStep);
+
+    // Whether system s failed during the last Update of
+    // METHOD_RUNGE_KUTTA_45.  The flag is cleared by the next Update, which
+    // integrates the system again.
+    inline bool HasFailed(int s) const;
+
+    // Access to the states in SoA layout.
+    inline Real* GetState();
+    inline Real const* GetState() const;
+    void SetState(int s, Real const* x);
+    void GetState(int s, Real* x) const;
+
+    // Estimate x_s(tIn + tDelta) from x_s(tIn) for all systems s.  The
+    // function returns tOut = tIn + tDelta.
+    void Update(Real tIn, Real& tOut);
+
+protected:
+    // Integrate the systems smin through smax inclusive.  Update(...) calls
+    // these for blocks of at most BLOCK_SIZE systems.
+    void UpdateFixed(int smin, int smax, Real tIn);
+    void UpdateAdaptive(int smin, int smax, Real tIn, Real tOut);
+
+    // Compute the stage derivatives K[0] through K[mNumStages-1] for the
+    // systems smin through smax inclusive, using step size mH[s] and the
+    // times mTime[s] for system s.
+    void ComputeStages(int smin, int smax);
+
+    int mNumSystems, mDimension;
+    Real mTDelta;
+    Function mFunction;
+    std::shared_ptr<ComputeModel> mCModel;
+    int mNumThreads;
+
+    Method mMethod;
+    Real mAbsoluteTolerance, mRelativeTolerance, mMinStep;
+
+    // The Butcher tableau of the method.  Stage i is evaluated at time
+    // t + mC[i]*h and state x + h*sum_{k<i} mA[i][k]*K[k].  The solution is
+    // x + h*sum_i mB[i]*K[i] and the error estimate is h*sum_i mE[i]*K[i].
+    enum { MAX_STAGES = 7, BLOCK_SIZE = 512 };
+    int mNumStages;
+    Real mC[MAX_STAGES], mA[MAX_STAGES][MAX_STAGES];
+    Real mB[MAX_STAGES], mE[MAX_STAGES];
+
+    // The states and storage for the stages.  The per-system arrays are
+    // the current time, the time of the current stage, the step size of
+    // the current step, the step size proposed by the error control, the
+    // error estimate, whether the system has reached the final time of
+    // the update, and whether it failed.
+    std::vector<Real> mState, mXTemp;
+    std::array<std::vector<Real>, MAX_STAGES> mK;
+    std::vector<Real> mTime, mStageTime, mH, mStep, mError;
+    std::vector<char> mDone, mFailed;
+};
+
+#include "GteOdeEnsemble.inl"
+
+}
@@ -0,0 +1,493 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/14)
+
+//----------------------------------------------------------------------------
+template <typename Real>
+OdeEnsemble<Real>::~OdeEnsemble()
+{
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+OdeEnsemble<Real>::OdeEnsemble(int numSystems, int dimension, Real tDelta,
+    Function const& F, std::shared_ptr<ComputeModel> const& cmodel)
+    :
+    mNumSystems(numSystems),
+    mDimension(dimension),
+    mTDelta(tDelta),
+    mFunction(F),
+    mCModel(cmodel),
+    mNumThreads(cmodel ? static_cast<int>(cmodel->numThreads) : 1),
+    mAbsoluteTolerance((Real)1e-06),
+    mRelativeTolerance((Real)1e-06),
+    mMinStep(((Real)1e-06) * tDelta),
+    mState(dimension * numSystems),
+    mXTemp(dimension * numSystems),
+    mTime(numSystems),
+    mStageTime(numSystems),
+    mH(numSystems),
+    mStep(numSystems),
+    mError(numSystems),
+    mDone(numSystems),
+    mFailed(numSystems)
+{
+    std::fill(mState.begin(), mState.end(), (Real)0);
+    std::fill(mStep.begin(), mStep.end(), tDelta);
+    SetMethod(METHOD_RUNGE_KUTTA_4);
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+int OdeEnsemble<Real>::GetNumSystems() const
+{
+    return mNumSystems;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+int OdeEnsemble<Real>::GetDimension() const
+{
+    return mDimension;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+void OdeEnsemble<Real>::SetTDelta(Real tDelta)
+{
+    mTDelta = tDelta;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+Real OdeEnsemble<Real>::GetTDelta() const
+{
+    return mTDelta;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void OdeEnsemble<Real>::SetMethod(Method method)
+{
+    mMethod = method;
+    for (int i = 0; i < MAX_STAGES; ++i)
+    {
+        mC[i] = (Real)0;
+        mB[i] = (Real)0;
+        mE[i] = (Real)0;
+        for (int k = 0; k < MAX_STAGES; ++k)
+        {
+            mA[i][k] = (Real)0;
+        }
+    }
+
+    if (method == METHOD_EULER)
+    {
+        mNumStages = 1;
+        mB[0] = (Real)1;
+    }
+    else if (method == METHOD_MIDPOINT)
+    {
+        mNumStages = 2;
+        mC[1] = (Real)0.5;
+        mA[1][0] = (Real)0.5;
+        mB[1] = (Real)1;
+    }
+    else if (method == METHOD_RUNGE_KUTTA_4)
+    {
+        mNumStages = 4;
+        mC[1] = (Real)0.5;
+        mC[2] = (Real)0.5;
+        mC[3] = (Real)1;
+        mA[1][0] = (Real)0.5;
+        mA[2][1] = (Real)0.5;
+        mA[3][2] = (Real)1;
+        mB[0] = ((Real)1) / (Real)6;
+        mB[1] = ((Real)1) / (Real)3;
+        mB[2] = ((Real)1) / (Real)3;
+        mB[3] = ((Real)1) / (Real)6;
+    }
+    else  // method == METHOD_RUNGE_KUTTA_45
+    {
+        // Dormand-Prince coefficients.  The error weights are the
+        // differences of the fifth-order and fourth-order weights.
+        mNumStages = 7;
+        mC[1] = ((Real)1) / (Real)5;
+        mC[2] = ((Real)3) / (Real)10;
+        mC[3] = ((Real)4) / (Real)5;
+        mC[4] = ((Real)8) / (Real)9;
+        mC[5] = (Real)1;
+        mC[6] = (Real)1;
+        mA[1][0] = ((Real)1) / (Real)5;
+        mA[2][0] = ((Real)3) / (Real)40;
+        mA[2][1] = ((Real)9) / (Real)40;
+        mA[3][0] = ((Real)44) / (Real)45;
+        mA[3][1] = ((Real)-56) / (Real)15;
+        mA[3][2] = ((Real)32) / (Real)9;
+        mA[4][0] = ((Real)19372) / (Real)6561;
+        mA[4][1] = ((Real)-25360) / (Real)2187;
+        mA[4][2] = ((Real)64448) / (Real)6561;
+        mA[4][3] = ((Real)-212) / (Real)729;
+        mA[5][0] = ((Real)9017) / (Real)3168;
+        mA[5][1] = ((Real)-355) / (Real)33;
+        mA[5][2] = ((Real)46732) / (Real)5247;
+        mA[5][3] = ((Real)49) / (Real)176;
+        mA[5][4] = ((Real)-5103) / (Real)18656;
+        mA[6][0] = ((Real)35) / (Real)384;
+        mA[6][2] = ((Real)500) / (Real)1113;
+        mA[6][3] = ((Real)125) / (Real)192;
+        mA[6][4] = ((Real)-2187) / (Real)6784;
+        mA[6][5] = ((Real)11) / (Real)84;
+        for (int k = 0; k < 6; ++k)
+        {
+            mB[k] = mA[6][k];
+        }
+        mE[0] = ((Real)71) / (Real)57600;
+        mE[2] = ((Real)-71) / (Real)16695;
+        mE[3] = ((Real)71) / (Real)1920;
+        mE[4] = ((Real)-17253) / (Real)339200;
+        mE[5] = ((Real)22) / (Real)525;
+        mE[6] = ((Real)-1) / (Real)40;
+    }
+
+    for (int i = 0; i < mNumStages; ++i)
+    {
+        mK[i].resize(mDimension * mNumSystems);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+typename OdeEnsemble<Real>::Method OdeEnsemble<Real>::GetMethod() const
+{
+    return mMethod;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void OdeEnsemble<Real>::SetTolerance(Real absolute, Real relative,
+    Real minStep)
+{
+    mAbsoluteTolerance = absolute;
+    mRelativeTolerance = relative;
+    mMinStep = minStep;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+bool OdeEnsemble<Real>::HasFailed(int s) const
+{
+    return mFailed[s] != 0;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+Real* OdeEnsemble<Real>::GetState()
+{
+    return &mState[0];
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+Real const* OdeEnsemble<Real>::GetState() const
+{
+    return &mState[0];
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void OdeEnsemble<Real>::SetState(int s, Real const* x)
+{
+    for (int j = 0; j < mDimension; ++j)
+    {
+        mState[j * mNumSystems + s] = x[j];
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void OdeEnsemble<Real>::GetState(int s, Real* x) const
+{
+    for (int j = 0; j < mDimension; ++j)
+    {
+        x[j] = mState[j * mNumSystems + s];
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void OdeEnsemble<Real>::Update(Real tIn, Real& tOut)
+{
+    tOut = tIn + mTDelta;
+
+    // The systems are independent, so each range of systems is integrated
+    // from tIn to tOut without synchronizing with the others.  The ranges
+    // are processed by the thread pool of the compute model.
+    // The range is processed in blocks of systems that are small enough for
+    // the state and stage arrays of a block to remain in cache for all the
+    // stages; otherwise, each stage streams all the arrays through memory.
+    Real const tFinal = tOut;
+    auto update = [this, tIn, tFinal](int smin, int smax)
+    {
+        for (int bmin = smin; bmin <= smax; bmin += BLOCK_SIZE)
+        {
+            int bmax = std::min(bmin + BLOCK_SIZE - 1, smax);
+            if (mMethod == METHOD_RUNGE_KUTTA_45)
+            {
+                UpdateAdaptive(bmin, bmax, tIn, tFinal);
+            }
+            else
+            {
+                UpdateFixed(bmin, bmax, tIn);
+            }
+        }
+    };
+
+    if (mNumThreads > 1 && mNumSystems > 1)
+    {
+        mCModel->GetThreadPool().ParallelFor(mNumSystems, mNumThreads,
+            update);
+    }
+    else if (mNumSystems > 0)
+    {
+        update(0, mNumSystems - 1);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void OdeEnsemble<Real>::UpdateFixed(int smin, int smax, Real tIn)
+{
+    int s;
+    for (s = smin; s <= smax; ++s)
+    {
+        mTime[s] = tIn;
+        mH[s] = mTDelta;
+        mFailed[s] = 0;
+    }
+
+    ComputeStages(smin, smax);
+
+    int const numStages = mNumStages;
+    Real hb[MAX_STAGES];
+    for (int i = 0; i < numStages; ++i)
+    {
+        hb[i] = mTDelta * mB[i];
+    }
+
+    for (int j = 0; j < mDimension; ++j)
+    {
+        int const offset = j * mNumSystems;
+        Real* x = &mState[offset];
+        Real const* K[MAX_STAGES];
+        for (int i = 0; i < numStages; ++i)
+        {
+            K[i] = &mK[i][offset];
+        }
+
+        for (s = smin; s <= smax; ++s)
+        {
+            Real sum = (Real)0;
+            for (int i = 0; i < numStages; ++i)
+            {
+                sum += hb[i] * K[i][s];
+            }
+            x[s] += sum;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void OdeEnsemble<Real>::UpdateAdaptive(int smin, int smax, Real tIn,
+    Real tOut)
+{
+    int s;
+    for (s = smin; s <= smax; ++s)
+    {
+        mTime[s] = tIn;
+        mDone[s] = 0;
+        mFailed[s] = 0;
+    }
+
+    // The range [amin,amax] contains all systems that have not reached
+    // tOut.  It shrinks as the systems at its ends finish.
+    int amin = smin, amax = smax;
+    while (amin <= amax)
+    {
+        for (s = amin; s <= amax; ++s)
+        {
+            mH[s] = (mDone[s] ? (Real)0 :
+                std::min(mStep[s], tOut - mTime[s]));
+        }
+
+        ComputeStages(amin, amax);
+
+        // Compute the fifth-order solution in mXTemp and the sum of squares
+        // of the weighted errors.
+        for (s = amin; s <= amax; ++s)
+        {
+            mError[s] = (Real)0;
+        }
+        int const numStages = mNumStages;
+        Real const absTol = mAbsoluteTolerance, relTol = mRelativeTolerance;
+        Real b[MAX_STAGES], e[MAX_STAGES];
+        for (int i = 0; i < numStages; ++i)
+        {
+            b[i] = mB[i];
+            e[i] = mE[i];
+        }
+        Real const* h = &mH[0];
+        Real* sqrError = &mError[0];
+        for (int j = 0; j < mDimension; ++j)
+        {
+            int const offset = j * mNumSystems;
+            Real const* x = &mState[offset];
+            Real* xNext = &mXTemp[offset];
+            Real const* K[MAX_STAGES];
+            for (int i = 0; i < numStages; ++i)
+            {
+                K[i] = &mK[i][offset];
+            }
+
+            for (s = amin; s <= amax; ++s)
+            {
+                Real sum = (Real)0, error = (Real)0;
+                for (int i = 0; i < numStages; ++i)
+                {
+                    sum += b[i] * K[i][s];
+                    error += e[i] * K[i][s];
+                }
+                xNext[s] = x[s] + h[s] * sum;
+                Real scale = absTol + relTol *
+                    std::max(std::abs(x[s]), std::abs(xNext[s]));
+                Real ratio = h[s] * error / scale;
+                sqrError[s] += ratio * ratio;
+            }
+        }
+
+        for (s = amin; s <= amax; ++s)
+        {
+            if (mDone[s])
+            {
+                continue;
+            }
+
+            Real h = mH[s];
+            Real error = std::sqrt(mError[s] / (Real)mDimension);
+            if (!std::isfinite(error))
+            {
+                // F returned a NaN or an infinity for the step.  The error
+                // control cannot grow the step, so shrink it until the
+                // minimum step, where the system fails.
+                if (h <= mMinStep)
+                {
+                    mDone[s] = 1;
+                    mFailed[s] = 1;
+                }
+                else
+                {
+                    mStep[s] = std::max(h * (Real)0.2, mMinStep);
+                }
+                continue;
+            }
+
+            bool accept = (error <= (Real)1 || h <= mMinStep);
+            if (accept)
+            {
+                for (int j = 0; j < mDimension; ++j)
+                {
+                    int index = j * mNumSystems + s;
+                    mState[index] = mXTemp[index];
+                }
+
+                if (h >= tOut - mTime[s])
+                {
+                    mTime[s] = tOut;
+                    mDone[s] = 1;
+                }
+                else
+                {
+                    mTime[s] += h;
+                }
+            }
+
+            // Choose the next step size.  The step is not enlarged based on
+            // a final step that was shortened to reach tOut.
+            Real factor;
+            if (error > (Real)0)
+            {
+                factor = ((Real)0.9) * std::pow(error, (Real)-0.2);
+                factor = std::min(std::max(factor, (Real)0.2), (Real)5);
+            }
+            else
+            {
+                factor = (Real)5;
+            }
+            if (!accept || h == mStep[s] || factor < (Real)1)
+            {
+                mStep[s] = std::max(h * factor, mMinStep);
+            }
+        }
+
+        while (amin <= amax && mDone[amin])
+        {
+            ++amin;
+        }
+        while (amin <= amax && mDone[amax])
+        {
+            --amax;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void OdeEnsemble<Real>::ComputeStages(int smin, int smax)
+{
+    for (int i = 0; i < mNumStages; ++i)
+    {
+        int s;
+        for (s = smin; s <= smax; ++s)
+        {
+            mStageTime[s] = mTime[s] + mC[i] * mH[s];
+        }
+
+        Real const* xStage;
+        if (i == 0)
+        {
+            xStage = &mState[0];
+        }
+        else
+        {
+            // The stage coefficients of the methods are mostly zero, so
+            // only the nonzero ones are gathered.  The coefficients and
+            // pointers are copied to local arrays so that the compiler does
+            // not reload them in the inner loop.
+            int numTerms = 0;
+            Real a[MAX_STAGES];
+            int term[MAX_STAGES];
+            for (int k = 0; k < i; ++k)
+            {
+                if (mA[i][k] != (Real)0)
+                {
+                    a[numTerms] = mA[i][k];
+                    term[numTerms++] = k;
+                }
+            }
+
+            Real const* h = &mH[0];
+            for (int j = 0; j < mDimension; ++j)
+            {
+                int const offset = j * mNumSystems;
+                Real const* x = &mState[offset];
+                Real* xTemp = &mXTemp[offset];
+                Real const* K[MAX_STAGES];
+                for (int t = 0; t < numTerms; ++t)
+                {
+                    K[t] = &mK[term[t]][offset];
+                }
+
+                for (s = smin; s <= smax; ++s)
+                {
+                    Real sum = (Real)0;
+                    for (int t = 0; t < numTerms; ++t)
+                    {
+                        sum += a[t] * K[t][s];
+                    }
+                    xTemp[s] = x[s] + h[s] * sum;
+                }
+            }
+            xStage = &mXTemp[0];
+        }
+
+        mFunction(smin, smax, &mStageTime[0], xStage, &mK[i][0]);
+    }
+}
+//----------------------------------------------------------------------------
@@ -3,10 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/14)
+// File Version: 1.4.1 (2014/10/10)
 
 #pragma once
 
+#include "GteLinearSystem.h"
 #include "GteVector.h"
 #include <limits>
 #include <vector>
@@ -34,6 +35,31 @@ public:
     inline Vector<N, Real> const& GetVelocity(int i) const;
     inline Real GetStep() const;
 
+    // Selection of the differential equation solver used by Update(...).
+    // The default is the explicit fourth-order Runge-Kutta method.  Stiff
+    // springs require very small steps for that method to be stable.  The
+    // implicit (backward) Euler method is stable for much larger steps.  It
+    // treats the spring forces reported by GetImplicitSprings(...)
+    // implicitly and all other forces explicitly.  Each step solves a
+    // sparse linear system with the conjugate gradient method, warm-started
+    // with the solution of the previous step.  The iterations terminate
+    // after 'maxIterations' or when the relative residual is smaller than
+    // 'tolerance'.  Implicit Euler is first-order accurate and dissipates
+    // energy, which is often desirable for cloth and soft bodies.
+    enum Integrator
+    {
+        IT_RUNGE_KUTTA_4,
+        IT_IMPLICIT_EULER
+    };
+
+    void SetIntegrator(Integrator integrator,
+        unsigned int maxIterations = 64, Real tolerance = (Real)1e-06);
+    inline Integrator GetIntegrator() const;
+
+    // The number of conjugate gradient iterations used by the last implicit
+    // Euler step.
+    inline unsigned int GetNumSolverIterations() const;
+
     // Update the particle positions based on current time and particle state.
     // The Acceleration(...) function is called in this update for each
     // particle.  This function is virtual so that derived classes can perform
@@ -49,6 +75,33 @@ protected:
         std::vector<Vector<N, Real>> const& position,
         std::vector<Vector<N, Real>> const& velocity) = 0;
 
+    // Derived classes may override this function to compute quantities
+    // that Acceleration(...) needs for all particles, for example the
+    // forces of springs that are shared by two particles.  The solvers call
+    // it once before calling Acceleration(...) for the particles with the
+    // same time, positions and velocities.  The default does nothing.
+    virtual void PrepareAcceleration(Real time,
+        std::vector<Vector<N, Real>> const& position,
+        std::vector<Vector<N, Real>> const& velocity);
+
+    // Support for implicit integration.  A derived class that models springs
+    // with force F0 = constant*(1-length/|X1-X0|)*(X1-X0) on particle0 and
+    // F1 = -F0 on particle1 appends its springs to the input array, which is
+    // empty on entry.  The stiffness matrix of these springs is used by the
+    // implicit Euler solver.  The default appends no springs, in which case
+    // implicit Euler reduces to semi-implicit (symplectic) Euler.
+    struct ImplicitSpring
+    {
+        int particle0, particle1;
+        Real constant, length;
+    };
+
+    virtual void GetImplicitSprings(std::vector<ImplicitSpring>& springs)
+        const;
+
+    void UpdateRungeKutta4(Real time);
+    void UpdateImplicitEuler(Real time);
+
     int mNumParticles;
     std::vector<Real> mMass, mInvMass;
     std::vector<Vector<N, Real>> mPosition, mVelocity;
@@ -61,6 +114,17 @@ protected:
     };
     std::vector<Vector<N, Real>> mPTmp, mVTmp;
     std::vector<Temporary> mPAllTmp, mVAllTmp;
+
+    // Storage for the implicit Euler solver.  The linear system is
+    // (M - h^2*K)*dV = h*(F + h*K*V), where M is the diagonal mass matrix,
+    // K is the stiffness matrix of the springs, F are the forces, V are the
+    // velocities, and dV is the change in velocity over the step h.
+    Integrator mIntegrator;
+    unsigned int mMaxIterations, mNumSolverIterations;
+    Real mTolerance;
+    std::vector<ImplicitSpring> mImplicitSprings;
+    typename LinearSystem<Real>::CSRMatrix mMatrix;
+    std::vector<Real> mRHS, mDeltaVelocity;
 };
 
 #include "GteParticleSystem.inl"
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/14)
+// File Version: 1.4.1 (2014/10/10)
 
 //----------------------------------------------------------------------------
 template <int N, typename Real>
@@ -25,7 +25,11 @@ ParticleSystem<N, Real>::ParticleSystem(int numParticles, Real step)
     mPTmp(numParticles),
     mVTmp(numParticles),
     mPAllTmp(numParticles),
-    mVAllTmp(numParticles)
+    mVAllTmp(numParticles),
+    mIntegrator(IT_RUNGE_KUTTA_4),
+    mMaxIterations(64),
+    mNumSolverIterations(0),
+    mTolerance((Real)1e-06)
 {
     std::fill(mMass.begin(), mMass.end(), (Real)0);
     std::fill(mInvMass.begin(), mInvMass.end(), (Real)0);
@@ -101,7 +105,54 @@ Real ParticleSystem<N, Real>::GetStep() const
 }
 //----------------------------------------------------------------------------
 template <int N, typename Real>
+void ParticleSystem<N, Real>::SetIntegrator(Integrator integrator,
+    unsigned int maxIterations, Real tolerance)
+{
+    mIntegrator = integrator;
+    mMaxIterations = maxIterations;
+    mTolerance = tolerance;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+typename ParticleSystem<N, Real>::Integrator
+ParticleSystem<N, Real>::GetIntegrator() const
+{
+    return mIntegrator;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+unsigned int ParticleSystem<N, Real>::GetNumSolverIterations() const
+{
+    return mNumSolverIterations;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
 void ParticleSystem<N, Real>::Update(Real time)
+{
+    if (mIntegrator == IT_IMPLICIT_EULER)
+    {
+        UpdateImplicitEuler(time);
+    }
+    else
+    {
+        UpdateRungeKutta4(time);
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystem<N, Real>::PrepareAcceleration(Real,
+    std::vector<Vector<N, Real>> const&, std::vector<Vector<N, Real>> const&)
+{
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystem<N, Real>::GetImplicitSprings(
+    std::vector<ImplicitSpring>&) const
+{
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystem<N, Real>::UpdateRungeKutta4(Real time)
 {
     // Runge-Kutta fourth-order solver.
     Real halfTime = time + mHalfStep;
@@ -109,6 +160,7 @@ void ParticleSystem<N, Real>::Update(Real time)
 
     // Compute the first step.
     int i;
+    PrepareAcceleration(time, mPosition, mVelocity);
     for (i = 0; i < mNumParticles; ++i)
     {
         if (mInvMass[i] > (Real)0)
@@ -132,6 +184,7 @@ void ParticleSystem<N, Real>::Update(Real time)
     }
 
     // Compute the second step.
+    PrepareAcceleration(halfTime, mPTmp, mVTmp);
     for (i = 0; i < mNumParticles; ++i)
     {
         if (mInvMass[i] >(Real)0)
@@ -155,6 +208,7 @@ void ParticleSystem<N, Real>::Update(Real time)
     }
 
     // Compute the third step.
+    PrepareAcceleration(halfTime, mPTmp, mVTmp);
     for (i = 0; i < mNumParticles; ++i)
     {
         if (mInvMass[i] >(Real)0)
@@ -178,6 +232,7 @@ void ParticleSystem<N, Real>::Update(Real time)
     }
 
     // Compute the fourth step.
+    PrepareAcceleration(fullTime, mPTmp, mVTmp);
     for (i = 0; i < mNumParticles; ++i)
     {
         if (mInvMass[i] >(Real)0)
@@ -201,3 +256,213 @@ void ParticleSystem<N, Real>::Update(Real time)
     }
 }
 //----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystem<N, Real>::UpdateImplicitEuler(Real time)
+{
+    // Solve (M - h^2*K)*dV = h*(F + h*K*V) for dV, then set V += dV and
+    // X += h*V.  The rows and columns of immovable particles are replaced
+    // by those of the identity matrix with zero right-hand side, so the
+    // matrix remains symmetric and dV = 0 for those particles.  For a
+    // spring, let D = X1 - X0, L = |D|, U = D/L, and t = 1 - length/L.  The
+    // stiffness block is Ks = constant*((1-t)*U*U^T + t*I), which is added
+    // to the diagonal blocks (0,0) and (1,1) and subtracted from the
+    // off-diagonal blocks (0,1) and (1,0) of -K.  The value t is clamped to
+    // be nonnegative so that Ks is positive semidefinite even when the
+    // spring is compressed; otherwise conjugate gradient can fail.
+    int const numRows = N * mNumParticles;
+    Real const sqrStep = mStep * mStep;
+
+    // Compute the accelerations at the current state.  These include the
+    // external accelerations, which are treated explicitly.
+    int i;
+    PrepareAcceleration(time, mPosition, mVelocity);
+    for (i = 0; i < mNumParticles; ++i)
+    {
+        if (mInvMass[i] > (Real)0)
+        {
+            mVAllTmp[i].d1 = Acceleration(i, time, mPosition, mVelocity);
+        }
+    }
+
+    mImplicitSprings.clear();
+    GetImplicitSprings(mImplicitSprings);
+
+    // Count the off-diagonal blocks in each block row.  Only springs that
+    // connect two movable particles generate off-diagonal blocks.
+    std::vector<int> numBlocks(mNumParticles, 1);
+    for (auto const& spring : mImplicitSprings)
+    {
+        if (mInvMass[spring.particle0] > (Real)0
+            && mInvMass[spring.particle1] > (Real)0)
+        {
+            ++numBlocks[spring.particle0];
+            ++numBlocks[spring.particle1];
+        }
+    }
+
+    // Block row i occupies the scalar rows N*i through N*i+N-1.  Each of
+    // these rows has N*numBlocks[i] entries.  The diagonal block is stored
+    // first.  The next free off-diagonal block of row i is nextBlock[i].
+    mMatrix.rowStart.resize(numRows + 1);
+    mMatrix.rowStart[0] = 0;
+    for (i = 0; i < mNumParticles; ++i)
+    {
+        for (int a = 0; a < N; ++a)
+        {
+            int row = N * i + a;
+            mMatrix.rowStart[row + 1] = mMatrix.rowStart[row] +
+                N * numBlocks[i];
+        }
+    }
+    int const numEntries = mMatrix.rowStart[numRows];
+    mMatrix.column.resize(numEntries);
+    mMatrix.value.resize(numEntries);
+    std::vector<int> nextBlock(mNumParticles, 1);
+
+    // Initialize the diagonal blocks to M and the right-hand side to h*F.
+    std::vector<Real> diagonal(N * N * mNumParticles, (Real)0);
+    mRHS.resize(numRows);
+    for (i = 0; i < mNumParticles; ++i)
+    {
+        Real* block = &diagonal[N * N * i];
+        if (mInvMass[i] > (Real)0)
+        {
+            for (int a = 0; a < N; ++a)
+            {
+                block[a * (N + 1)] = mMass[i];
+                mRHS[N * i + a] = mStep * mMass[i] * mVAllTmp[i].d1[a];
+            }
+        }
+        else
+        {
+            for (int a = 0; a < N; ++a)
+            {
+                block[a * (N + 1)] = (Real)1;
+                mRHS[N * i + a] = (Real)0;
+            }
+        }
+    }
+
+    // Add the spring terms.
+    Real Ks[N][N];
+    for (auto const& spring : mImplicitSprings)
+    {
+        int const i0 = spring.particle0, i1 = spring.particle1;
+        bool const movable0 = (mInvMass[i0] > (Real)0);
+        bool const movable1 = (mInvMass[i1] > (Real)0);
+        if (!movable0 && !movable1)
+        {
+            continue;
+        }
+
+        Vector<N, Real> diff = mPosition[i1] - mPosition[i0];
+        Real length = Length(diff);
+        if (length == (Real)0)
+        {
+            // The spring direction is undefined.
+            continue;
+        }
+        diff /= length;
+        Real t = std::max((Real)1 - spring.length / length, (Real)0);
+        for (int a = 0; a < N; ++a)
+        {
+            for (int b = 0; b < N; ++b)
+            {
+                Ks[a][b] = spring.constant * ((Real)1 - t) * diff[a] * diff[b];
+            }
+            Ks[a][a] += spring.constant * t;
+        }
+
+        // The velocities of immovable particles are treated as zero.
+        Vector<N, Real> vel0 = (movable0 ? mVelocity[i0] :
+            Vector<N, Real>::Zero());
+        Vector<N, Real> vel1 = (movable1 ? mVelocity[i1] :
+            Vector<N, Real>::Zero());
+        Vector<N, Real> dvel = vel1 - vel0;
+
+        for (int a = 0; a < N; ++a)
+        {
+            Real KsDVel = (Real)0;
+            for (int b = 0; b < N; ++b)
+            {
+                KsDVel += Ks[a][b] * dvel[b];
+            }
+
+            if (movable0)
+            {
+                Real* block = &diagonal[N * N * i0];
+                for (int b = 0; b < N; ++b)
+                {
+                    block[N * a + b] += sqrStep * Ks[a][b];
+                }
+                mRHS[N * i0 + a] += sqrStep * KsDVel;
+            }
+
+            if (movable1)
+            {
+                Real* block = &diagonal[N * N * i1];
+                for (int b = 0; b < N; ++b)
+                {
+                    block[N * a + b] += sqrStep * Ks[a][b];
+                }
+                mRHS[N * i1 + a] -= sqrStep * KsDVel;
+            }
+        }
+
+        if (movable0 && movable1)
+        {
+            int const slot0 = nextBlock[i0]++;
+            int const slot1 = nextBlock[i1]++;
+            for (int a = 0; a < N; ++a)
+            {
+                int k0 = mMatrix.rowStart[N * i0 + a] + N * slot0;
+                int k1 = mMatrix.rowStart[N * i1 + a] + N * slot1;
+                for (int b = 0; b < N; ++b, ++k0, ++k1)
+                {
+                    mMatrix.column[k0] = N * i1 + b;
+                    mMatrix.value[k0] = -sqrStep * Ks[a][b];
+                    mMatrix.column[k1] = N * i0 + b;
+                    mMatrix.value[k1] = -sqrStep * Ks[a][b];
+                }
+            }
+        }
+    }
+
+    // Copy the diagonal blocks to the matrix.
+    for (i = 0; i < mNumParticles; ++i)
+    {
+        Real const* block = &diagonal[N * N * i];
+        for (int a = 0; a < N; ++a)
+        {
+            int k = mMatrix.rowStart[N * i + a];
+            for (int b = 0; b < N; ++b, ++k)
+            {
+                mMatrix.column[k] = N * i + b;
+                mMatrix.value[k] = block[N * a + b];
+            }
+        }
+    }
+
+    // Solve for the change in velocity, starting with the change from the
+    // previous step.
+    if (static_cast<int>(mDeltaVelocity.size()) != numRows)
+    {
+        mDeltaVelocity.resize(numRows);
+        std::fill(mDeltaVelocity.begin(), mDeltaVelocity.end(), (Real)0);
+    }
+    mNumSolverIterations = LinearSystem<Real>::SolveSymmetricCG(numRows,
+        mMatrix, &mRHS[0], &mDeltaVelocity[0], mMaxIterations, mTolerance);
+
+    for (i = 0; i < mNumParticles; ++i)
+    {
+        if (mInvMass[i] > (Real)0)
+        {
+            for (int a = 0; a < N; ++a)
+            {
+                mVelocity[i][a] += mDeltaVelocity[N * i + a];
+            }
+            mPosition[i] += mStep * mVelocity[i];
+        }
+    }
+}
+//----------------------------------------------------------------------------
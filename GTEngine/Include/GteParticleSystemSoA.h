@@ -0,0 +1,132 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/06)
+
+#pragma once
+
+#include "GteComputeModel.h"
+#include "GteVector.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// This is an alternative to ParticleSystem for large numbers of particles.
+// The particle state is stored as a structure of arrays (SoA): component j
+// of the position of particle i is mPosition[j][i].  The acceleration
+// callback is applied to a contiguous range of particles at once rather
+// than to one particle at a time, which allows the compiler to vectorize
+// the inner loops and allows the Runge-Kutta stages to be partitioned among
+// multiple threads.  The integrator is the same fourth-order Runge-Kutta
+// method used by ParticleSystem, so the two classes produce the same
+// results up to floating-point rounding errors.
+
+namespace gte
+{
+
+template <int N, typename Real>
+class ParticleSystemSoA
+{
+public:
+    // The storage for an N-tuple per particle.  Component j of the tuple
+    // for particle i is array[j][i].
+    typedef std::array<std::vector<Real>, N> Components;
+
+    // Construction and destruction.  If a particle is to be immovable, set
+    // its mass to std::numeric_limits<Real>::max().  The particles are
+    // partitioned among cmodel->numThreads threads for the Runge-Kutta
+    // stages.  If cmodel is null, the update is single-threaded.
+    virtual ~ParticleSystemSoA();
+    ParticleSystemSoA(int numParticles, Real step,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    // Member access.
+    inline int GetNumParticles() const;
+    void SetMass(int i, Real mass);
+    inline void SetPosition(int i, Vector<N, Real> const& position);
+    inline void SetVelocity(int i, Vector<N, Real> const& velocity);
+    void SetStep(Real step);
+    inline Real const& GetMass(int i) const;
+    inline Vector<N, Real> GetPosition(int i) const;
+    inline Vector<N, Real> GetVelocity(int i) const;
+    inline Real GetStep() const;
+
+    // Direct access to the state arrays, useful for copying the positions
+    // to vertex buffers without converting to array-of-structures form.
+    inline Components const& GetPositions() const;
+    inline Components const& GetVelocities() const;
+
+    // Update the particle positions based on current time and particle state.
+    // The Acceleration(...) function is called in this update for each
+    // range of particles assigned to a thread.  This function is virtual so
+    // that derived classes can perform pre-update and/or post-update
+    // semantics.
+    virtual void Update(Real time);
+
+protected:
+    // Callback for acceleration (ODE solver uses x" = F/m) applied to
+    // particles imin through imax inclusive.  The function must write
+    // acceleration[j][i] for all components j and for all i in the range.
+    // It must not write acceleration outside the range, because other
+    // threads are concurrently processing their own ranges.  The positions
+    // and velocities are not necessarily mPosition and mVelocity, because
+    // the ODE solver evaluates the impulse function at intermediate
+    // positions.
+    virtual void Acceleration(int imin, int imax, Real time,
+        Components const& position, Components const& velocity,
+        Components& acceleration) = 0;
+
+    // Derived classes may override this function to compute quantities
+    // that Acceleration(...) needs for all particles before any range is
+    // processed, for example the forces of springs that are shared by two
+    // particles.  It is called on the main thread before each Runge-Kutta
+    // stage, so it may use Execute(...) itself.  The default does nothing.
+    virtual void PrepareAcceleration(Real time, Components const& position,
+        Components const& velocity);
+
+    // Partition the elements 0 through numElements-1 into contiguous ranges
+    // and execute stage(imin,imax) for each range.  The ranges are
+    // processed concurrently by the thread pool of the compute model when
+    // multiple threads are requested.  The function returns when all ranges
+    // are processed.
+    void Execute(int numElements,
+        std::function<void(int, int)> const& stage);
+
+    // Support for derived classes that model springs.  Add to the
+    // acceleration of particle i the impulse F/m generated by the spring
+    // connecting particle i to particle k.  The arithmetic is the same as
+    // that of the MassSpring* classes derived from ParticleSystem.
+    inline void AddSpringAcceleration(int i, int k, Real constant,
+        Real length, Components const& position,
+        Components& acceleration) const;
+
+    inline void Resize(Components& components);
+
+    int mNumParticles;
+    std::vector<Real> mMass, mInvMass;
+    Components mPosition, mVelocity;
+    Real mStep, mHalfStep, mSixthStep;
+
+    // The number of threads used by Execute(...).
+    std::shared_ptr<ComputeModel> mCModel;
+    int mNumThreads;
+
+    // Temporary storage for the Runge-Kutta differential equation solver.
+    // The intermediate states are ping-ponged between the two buffers so
+    // that a stage never overwrites the state other threads are reading.
+    // The weighted sums of the stage derivatives are accumulated in mPSum
+    // and mVSum.
+    Components mAcceleration;
+    std::array<Components, 2> mPTmp, mVTmp;
+    Components mPSum, mVSum;
+};
+
+#include "GteParticleSystemSoA.inl"
+
+}
@@ -0,0 +1,325 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/06)
+
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+ParticleSystemSoA<N, Real>::~ParticleSystemSoA()
+{
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+ParticleSystemSoA<N, Real>::ParticleSystemSoA(int numParticles, Real step,
+    std::shared_ptr<ComputeModel> const& cmodel)
+    :
+    mNumParticles(numParticles),
+    mMass(numParticles),
+    mInvMass(numParticles),
+    mStep(step),
+    mHalfStep(step / (Real)2),
+    mSixthStep(step / (Real)6),
+    mCModel(cmodel),
+    mNumThreads(cmodel ? static_cast<int>(cmodel->numThreads) : 1)
+{
+    std::fill(mMass.begin(), mMass.end(), (Real)0);
+    std::fill(mInvMass.begin(), mInvMass.end(), (Real)0);
+    Resize(mPosition);
+    Resize(mVelocity);
+    Resize(mAcceleration);
+    Resize(mPTmp[0]);
+    Resize(mPTmp[1]);
+    Resize(mVTmp[0]);
+    Resize(mVTmp[1]);
+    Resize(mPSum);
+    Resize(mVSum);
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+int ParticleSystemSoA<N, Real>::GetNumParticles() const
+{
+    return mNumParticles;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystemSoA<N, Real>::SetMass(int i, Real mass)
+{
+    if ((Real)0 < mass && mass < std::numeric_limits<Real>::max())
+    {
+        mMass[i] = mass;
+        mInvMass[i] = ((Real)1) / mass;
+    }
+    else
+    {
+        mMass[i] = std::numeric_limits<Real>::max();
+        mInvMass[i] = (Real)0;
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void ParticleSystemSoA<N, Real>::SetPosition(int i,
+    Vector<N, Real> const& position)
+{
+    for (int j = 0; j < N; ++j)
+    {
+        mPosition[j][i] = position[j];
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void ParticleSystemSoA<N, Real>::SetVelocity(int i,
+    Vector<N, Real> const& velocity)
+{
+    for (int j = 0; j < N; ++j)
+    {
+        mVelocity[j][i] = velocity[j];
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystemSoA<N, Real>::SetStep(Real step)
+{
+    mStep = step;
+    mHalfStep = mStep / (Real)2;
+    mSixthStep = mStep / (Real)6;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real const& ParticleSystemSoA<N, Real>::GetMass(int i) const
+{
+    return mMass[i];
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Vector<N, Real> ParticleSystemSoA<N, Real>::GetPosition(int i) const
+{
+    Vector<N, Real> position;
+    for (int j = 0; j < N; ++j)
+    {
+        position[j] = mPosition[j][i];
+    }
+    return position;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Vector<N, Real> ParticleSystemSoA<N, Real>::GetVelocity(int i) const
+{
+    Vector<N, Real> velocity;
+    for (int j = 0; j < N; ++j)
+    {
+        velocity[j] = mVelocity[j][i];
+    }
+    return velocity;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+Real ParticleSystemSoA<N, Real>::GetStep() const
+{
+    return mStep;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+typename ParticleSystemSoA<N, Real>::Components const&
+ParticleSystemSoA<N, Real>::GetPositions() const
+{
+    return mPosition;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+typename ParticleSystemSoA<N, Real>::Components const&
+ParticleSystemSoA<N, Real>::GetVelocities() const
+{
+    return mVelocity;
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystemSoA<N, Real>::Update(Real time)
+{
+    // Runge-Kutta fourth-order solver.  Each stage reads the intermediate
+    // state of all particles, so the threads must finish a stage before the
+    // next one starts.  Within a stage, a thread writes only the particles
+    // in its own range.
+    Real halfTime = time + mHalfStep;
+    Real fullTime = time + mStep;
+
+    // Compute the first step.
+    PrepareAcceleration(time, mPosition, mVelocity);
+    Execute(mNumParticles, [this, time](int imin, int imax)
+    {
+        Acceleration(imin, imax, time, mPosition, mVelocity, mAcceleration);
+        for (int j = 0; j < N; ++j)
+        {
+            Real const* x = &mPosition[j][0];
+            Real const* v = &mVelocity[j][0];
+            Real const* a = &mAcceleration[j][0];
+            Real* pSum = &mPSum[j][0];
+            Real* vSum = &mVSum[j][0];
+            Real* pTmp = &mPTmp[0][j][0];
+            Real* vTmp = &mVTmp[0][j][0];
+            for (int i = imin; i <= imax; ++i)
+            {
+                if (mInvMass[i] > (Real)0)
+                {
+                    pSum[i] = v[i];
+                    vSum[i] = a[i];
+                    pTmp[i] = x[i] + mHalfStep * v[i];
+                    vTmp[i] = v[i] + mHalfStep * a[i];
+                }
+                else
+                {
+                    pTmp[i] = x[i];
+                    vTmp[i] = (Real)0;
+                }
+            }
+        }
+    });
+
+    // Compute the second step.
+    PrepareAcceleration(halfTime, mPTmp[0], mVTmp[0]);
+    Execute(mNumParticles, [this, halfTime](int imin, int imax)
+    {
+        Acceleration(imin, imax, halfTime, mPTmp[0], mVTmp[0], mAcceleration);
+        for (int j = 0; j < N; ++j)
+        {
+            Real const* x = &mPosition[j][0];
+            Real const* v = &mVelocity[j][0];
+            Real const* a = &mAcceleration[j][0];
+            Real const* vStage = &mVTmp[0][j][0];
+            Real* pSum = &mPSum[j][0];
+            Real* vSum = &mVSum[j][0];
+            Real* pTmp = &mPTmp[1][j][0];
+            Real* vTmp = &mVTmp[1][j][0];
+            for (int i = imin; i <= imax; ++i)
+            {
+                if (mInvMass[i] > (Real)0)
+                {
+                    pSum[i] += ((Real)2) * vStage[i];
+                    vSum[i] += ((Real)2) * a[i];
+                    pTmp[i] = x[i] + mHalfStep * vStage[i];
+                    vTmp[i] = v[i] + mHalfStep * a[i];
+                }
+                else
+                {
+                    pTmp[i] = x[i];
+                    vTmp[i] = (Real)0;
+                }
+            }
+        }
+    });
+
+    // Compute the third step.
+    PrepareAcceleration(halfTime, mPTmp[1], mVTmp[1]);
+    Execute(mNumParticles, [this, halfTime](int imin, int imax)
+    {
+        Acceleration(imin, imax, halfTime, mPTmp[1], mVTmp[1], mAcceleration);
+        for (int j = 0; j < N; ++j)
+        {
+            Real const* x = &mPosition[j][0];
+            Real const* v = &mVelocity[j][0];
+            Real const* a = &mAcceleration[j][0];
+            Real const* vStage = &mVTmp[1][j][0];
+            Real* pSum = &mPSum[j][0];
+            Real* vSum = &mVSum[j][0];
+            Real* pTmp = &mPTmp[0][j][0];
+            Real* vTmp = &mVTmp[0][j][0];
+            for (int i = imin; i <= imax; ++i)
+            {
+                if (mInvMass[i] > (Real)0)
+                {
+                    pSum[i] += ((Real)2) * vStage[i];
+                    vSum[i] += ((Real)2) * a[i];
+                    pTmp[i] = x[i] + mStep * vStage[i];
+                    vTmp[i] = v[i] + mStep * a[i];
+                }
+                else
+                {
+                    pTmp[i] = x[i];
+                    vTmp[i] = (Real)0;
+                }
+            }
+        }
+    });
+
+    // Compute the fourth step and update the state.  Other threads read
+    // only the intermediate state in this stage, so it is safe to write
+    // mPosition and mVelocity for the particles in the range.
+    PrepareAcceleration(fullTime, mPTmp[0], mVTmp[0]);
+    Execute(mNumParticles, [this, fullTime](int imin, int imax)
+    {
+        Acceleration(imin, imax, fullTime, mPTmp[0], mVTmp[0], mAcceleration);
+        for (int j = 0; j < N; ++j)
+        {
+            Real* x = &mPosition[j][0];
+            Real* v = &mVelocity[j][0];
+            Real const* a = &mAcceleration[j][0];
+            Real const* vStage = &mVTmp[0][j][0];
+            Real const* pSum = &mPSum[j][0];
+            Real const* vSum = &mVSum[j][0];
+            for (int i = imin; i <= imax; ++i)
+            {
+                if (mInvMass[i] > (Real)0)
+                {
+                    x[i] += mSixthStep * (pSum[i] + vStage[i]);
+                    v[i] += mSixthStep * (vSum[i] + a[i]);
+                }
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystemSoA<N, Real>::PrepareAcceleration(Real,
+    Components const&, Components const&)
+{
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+void ParticleSystemSoA<N, Real>::Execute(int numElements,
+    std::function<void(int, int)> const& stage)
+{
+    // The ranges are processed by the persistent threads of the pool of
+    // the compute model, so an update does not create threads.
+    if (mNumThreads > 1 && numElements > 1)
+    {
+        mCModel->GetThreadPool().ParallelFor(numElements, mNumThreads,
+            stage);
+    }
+    else if (numElements > 0)
+    {
+        stage(0, numElements - 1);
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void ParticleSystemSoA<N, Real>::AddSpringAcceleration(int i, int k,
+    Real constant, Real length, Components const& position,
+    Components& acceleration) const
+{
+    Real diff[N];
+    Real sqrLength = (Real)0;
+    for (int j = 0; j < N; ++j)
+    {
+        diff[j] = position[j][k] - position[j][i];
+        sqrLength += diff[j] * diff[j];
+    }
+
+    Real ratio = length / sqrt(sqrLength);
+    Real coeff = constant * ((Real)1 - ratio);
+    for (int j = 0; j < N; ++j)
+    {
+        acceleration[j][i] += mInvMass[i] * (coeff * diff[j]);
+    }
+}
+//----------------------------------------------------------------------------
+template <int N, typename Real> inline
+void ParticleSystemSoA<N, Real>::Resize(Components& components)
+{
+    for (int j = 0; j < N; ++j)
+    {
+        components[j].resize(mNumParticles);
+        std::fill(components[j].begin(), components[j].end(), (Real)0);
+    }
+}
+//----------------------------------------------------------------------------
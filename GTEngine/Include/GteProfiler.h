@@ -0,0 +1,152 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/15)
+
+#pragma once
+
+#include "GTEngineDEF.h"
+#include "GteTimer.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Uncomment this to turn on the profiler, or define it in the project
+// settings.  When it is not defined, the ProfileScope macro expands to
+// nothing, so instrumented code has no profiling cost.
+//#define GTE_PROFILE
+
+// The macro ProfileScope(name) measures the time from the macro to the end
+// of the enclosing scope.  The name must be a string literal (or another
+// string that lives until the profiler is reset), because only the pointer
+// is stored.  Scopes nest, so a profiled function that calls profiled
+// functions produces a hierarchy of zones.
+//
+//   void MyAlgorithm()
+//   {
+//       ProfileScope("MyAlgorithm");
+//       ...
+//       {
+//           ProfileScope("MyAlgorithm::Phase1");
+//           ...
+//       }
+//   }
+//
+// Each thread records its zones in its own lock-free ring buffer, so
+// threads do not contend while profiling.  A thread moves its events to the
+// profiler when its buffer is half full; Collect() moves the events of all
+// threads.  If a buffer becomes full anyway, the events are dropped and
+// counted.  Call GetStatistics or ExportChromeTrace after the profiled code
+// has finished, for example at the end of a run.  The trace file can be
+// loaded in Chrome at chrome://tracing.
+
+namespace gte
+{
+
+class GTE_IMPEXP Profiler
+{
+private:
+    // Support for the events.  The types are defined in the source file.
+    class Event;
+    class ThreadBuffer;
+
+public:
+    // A scoped zone.  The constructor records the start time and the
+    // destructor records the event.  Use the ProfileScope macro rather than
+    // this class directly so that the zones are removed when GTE_PROFILE is
+    // not defined.
+    class GTE_IMPEXP Zone
+    {
+    public:
+        ~Zone();
+        Zone(char const* name);
+
+    private:
+        // Disallow copying.
+        Zone(Zone const&);
+        Zone& operator=(Zone const&);
+
+        ThreadBuffer* mBuffer;
+        char const* mName;
+        int64_t mBegin;
+        unsigned int mSequence;
+        int mDepth;
+    };
+
+    // Aggregated statistics for the zones that have the same path.  The
+    // path is the sequence of zone names from the outermost zone, separated
+    // by '/'.  The times are in seconds.  The inclusive time is that of the
+    // zone including its child zones, and the exclusive time excludes the
+    // child zones.  The percentiles are of the inclusive times of the calls.
+    struct Statistics
+    {
+        std::string path;
+        std::string name;
+        int depth;
+        unsigned int calls;
+        double inclusive, exclusive;
+        double minimum, median, percentile90, percentile99, maximum;
+    };
+
+    // Move the events of all threads to the profiler.
+    static void Collect();
+
+    // Discard all events.  Call this when no zones are active.
+    static void Reset();
+
+    // Collect the events and compute the statistics.  The elements are
+    // sorted by path, so a child zone follows its parent.
+    static void GetStatistics(std::vector<Statistics>& statistics);
+
+    // Collect the events and write them in the Chrome trace event format.
+    // The function returns 'false' when the file cannot be opened.
+    static bool ExportChromeTrace(std::string const& filename);
+
+    // The maximum number of events of a thread buffer.  The size applies to
+    // threads that profile for the first time after the call.
+    static void SetMaxThreadEvents(unsigned int maxThreadEvents);
+
+    // The number of events dropped because a thread buffer was full.
+    static unsigned int GetNumDropped();
+
+private:
+    static ThreadBuffer* GetThreadBuffer();
+    static void CollectThread(ThreadBuffer* buffer);
+
+    // The ring buffers are in a list that only grows, so threads search it
+    // without locking.  A thread whose identifier is that of an exited
+    // thread reuses the buffer of that thread.
+    static Timer msTimer;
+    static std::atomic<ThreadBuffer*> msThreadBuffers;
+    static std::atomic<unsigned int> msMaxThreadEvents;
+    static std::atomic<unsigned int> msNumDropped;
+    static std::atomic<int> msNumThreads;
+
+    // The events moved from the thread buffers.
+    static std::mutex msMutex;
+    static std::vector<Event> msEvents;
+};
+
+}
+
+//----------------------------------------------------------------------------
+#if defined(GTE_PROFILE)
+
+#define GTE_PROFILE_CONCATENATE_(x, y) x##y
+#define GTE_PROFILE_CONCATENATE(x, y) GTE_PROFILE_CONCATENATE_(x, y)
+
+#define ProfileScope(name) \
+    gte::Profiler::Zone \
+    GTE_PROFILE_CONCATENATE(gteProfileZone, __COUNTER__)(name)
+
+#else
+
+#define ProfileScope(name)
+
+#endif
+//----------------------------------------------------------------------------
@@ -0,0 +1,181 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/12)
+
+#pragma once
+
+#include "GteAlignedBox3.h"
+#include "GteComputeModel.h"
+#include "GteDistPoint3Segment3.h"
+#include "GteDistSegment3OrientedBox3.h"
+#include "GteIntrCapsule3Capsule3.h"
+#include "GteIntrOrientedBox3OrientedBox3.h"
+#include "GteIntrOrientedBox3Sphere3.h"
+#include "GteIntrSphere3Sphere3.h"
+#include "GteRigidBody.h"
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// A container of rigid bodies that finds the pairs of bodies whose shapes
+// intersect.  Each body has a sphere, box, or capsule shape attached to it.
+// The broad phase uses a dynamic bounding volume tree whose leaves are the
+// world-space axis-aligned bounding boxes of the bodies.  A leaf box is the
+// tight bounding box enlarged by a margin, so a body that moves a small
+// amount between calls to Update() does not require the tree to be
+// modified.  Otherwise, the leaf is removed and reinserted.  Insertion
+// chooses the sibling that minimizes the surface area of the tree, and the
+// tree is rebalanced by rotations as in Erin Catto's Box2D.  Each body
+// queries the tree for the bodies whose bounding boxes overlap its own, and
+// the candidate pairs are tested with the test-intersection and distance
+// queries for the shapes.  The queries are partitioned among the threads of
+// the compute model's thread pool.
+
+namespace gte
+{
+
+template <typename Real>
+class RigidBodyWorld
+{
+public:
+    // Construction and destruction.  The margin is the amount by which the
+    // leaf boxes of the tree are larger than the tight bounding boxes.  A
+    // margin that is about the distance a body moves in a few simulation
+    // steps is a good choice.  The queries are processed by at most
+    // cmodel->numThreads threads of the compute model's thread pool.  If
+    // cmodel is null, the queries are executed on the calling thread.
+    virtual ~RigidBodyWorld();
+    RigidBodyWorld(Real margin,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr);
+
+    // The shapes are specified in body coordinates.  The center of each
+    // shape is the body position.  The box axes are the columns of the body
+    // rotation matrix.  The capsule segment has direction the column 2 of
+    // the body rotation matrix.
+    enum ShapeType
+    {
+        SHAPE_SPHERE,
+        SHAPE_BOX,
+        SHAPE_CAPSULE
+    };
+
+    // Insert a body with a shape.  The returned handle is used to identify
+    // the body in the pairs reported by the queries.  Handles of removed
+    // bodies are reused by later insertions.  The world stores the body
+    // pointer, so changes to the body state are visible to the next call
+    // to Update().
+    int InsertSphere(std::shared_ptr<RigidBody<Real>> const& body,
+        Real radius);
+
+    int InsertBox(std::shared_ptr<RigidBody<Real>> const& body,
+        Vector3<Real> const& extent);
+
+    int InsertCapsule(std::shared_ptr<RigidBody<Real>> const& body,
+        Real halfLength, Real radius);
+
+    // The function returns 'false' when the handle is not that of a body in
+    // the world.
+    bool Remove(int handle);
+
+    // Member access.  The shape accessors return the world-space shape for
+    // the current body state.  They are valid only for bodies with the
+    // corresponding shape type.
+    inline int GetNumBodies() const;
+    inline std::shared_ptr<RigidBody<Real>> const& GetBody(int handle) const;
+    inline ShapeType GetShapeType(int handle) const;
+    inline AlignedBox3<Real> const& GetBound(int handle) const;
+    Sphere3<Real> GetSphere(int handle) const;
+    OrientedBox3<Real> GetBox(int handle) const;
+    Capsule3<Real> GetCapsule(int handle) const;
+
+    // Compute the bounding boxes for the current body states, update the
+    // tree, and find the intersecting pairs.  Call this after the
+    // bodies have been moved, typically once per simulation step.
+    void Update();
+
+    // The results of the last call to Update().  Each pair (h0,h1) has
+    // h0 < h1.  The candidates are the pairs of bodies whose bounding boxes
+    // overlap.  The intersections are the candidates whose shapes overlap.
+    typedef std::pair<int, int> Pair;
+    inline std::vector<Pair> const& GetCandidates() const;
+    inline std::vector<Pair> const& GetIntersections() const;
+
+protected:
+    struct Body
+    {
+        std::shared_ptr<RigidBody<Real>> body;
+        ShapeType type;
+        Real radius;            // sphere and capsule
+        Real halfLength;        // capsule
+        Vector3<Real> extent;   // box
+        AlignedBox3<Real> bound;
+        int leaf;
+        bool active;
+    };
+
+    // A node of the tree.  The node is a leaf when child[0] is -1, in which
+    // case 'handle' is the body stored at the leaf.  The height of a leaf
+    // is 0.
+    struct Node
+    {
+        AlignedBox3<Real> box;
+        int parent, child[2], height, handle;
+    };
+
+    int Insert(Body const& item);
+    void UpdateBound(Body& item) const;
+    bool Intersects(int handle0, int handle1) const;
+
+    // Find the candidates and intersections for the bodies with handles
+    // mLeafOrder[i] for imin <= i < imax.  The pairs (h,g) have h < g.
+    void FindPairs(int imin, int imax, std::vector<Pair>& candidates,
+        std::vector<Pair>& intersections) const;
+
+    // Support for the tree.
+    int AllocateNode();
+    void FreeNode(int node);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int node);
+    void Refit(int node);
+
+    // Support for the boxes.
+    static Real GetArea(AlignedBox3<Real> const& box);
+    static AlignedBox3<Real> Merge(AlignedBox3<Real> const& box0,
+        AlignedBox3<Real> const& box1);
+    static bool Contains(AlignedBox3<Real> const& outer,
+        AlignedBox3<Real> const& inner);
+    static bool Overlap(AlignedBox3<Real> const& box0,
+        AlignedBox3<Real> const& box1);
+
+    Real mMargin;
+    std::shared_ptr<ComputeModel> mCModel;
+    std::vector<Body> mBodies;
+    std::vector<int> mFreeHandles;
+    int mNumBodies;
+
+    std::vector<Node> mNodes;
+    std::vector<int> mFreeNodes;
+    int mRoot;
+
+    // Temporary storage for the sibling search of InsertLeaf.  The pairs
+    // are a node and the cost inherited from its ancestors.
+    std::vector<std::pair<int, Real>> mInsertStack;
+
+    // The handles of the bodies in the order of the leaves of the tree, and
+    // temporary storage for the traversal that computes them.
+    std::vector<int> mLeafOrder, mQueryStack;
+
+    // The results of the queries.  Each chunk of the leaf order stores its
+    // pairs in its own arrays, which are then concatenated.
+    std::vector<Pair> mCandidates, mIntersections;
+    std::vector<std::vector<Pair>> mChunkCandidates, mChunkIntersections;
+};
+
+#include "GteRigidBodyWorld.inl"
+
+}
@@ -0,0 +1,734 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/12)
+
+//----------------------------------------------------------------------------
+template <typename Real>
+RigidBodyWorld<Real>::~RigidBodyWorld()
+{
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+RigidBodyWorld<Real>::RigidBodyWorld(Real margin,
+    std::shared_ptr<ComputeModel> const& cmodel)
+    :
+    mMargin(margin),
+    mCModel(cmodel),
+    mNumBodies(0),
+    mRoot(-1)
+{
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int RigidBodyWorld<Real>::InsertSphere(
+    std::shared_ptr<RigidBody<Real>> const& body, Real radius)
+{
+    Body item;
+    item.body = body;
+    item.type = SHAPE_SPHERE;
+    item.radius = radius;
+    item.halfLength = (Real)0;
+    item.extent = Vector3<Real>::Zero();
+    return Insert(item);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int RigidBodyWorld<Real>::InsertBox(
+    std::shared_ptr<RigidBody<Real>> const& body, Vector3<Real> const& extent)
+{
+    Body item;
+    item.body = body;
+    item.type = SHAPE_BOX;
+    item.radius = (Real)0;
+    item.halfLength = (Real)0;
+    item.extent = extent;
+    return Insert(item);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int RigidBodyWorld<Real>::InsertCapsule(
+    std::shared_ptr<RigidBody<Real>> const& body, Real halfLength,
+    Real radius)
+{
+    Body item;
+    item.body = body;
+    item.type = SHAPE_CAPSULE;
+    item.radius = radius;
+    item.halfLength = halfLength;
+    item.extent = Vector3<Real>::Zero();
+    return Insert(item);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool RigidBodyWorld<Real>::Remove(int handle)
+{
+    if (0 <= handle && handle < static_cast<int>(mBodies.size())
+        && mBodies[handle].active)
+    {
+        Body& item = mBodies[handle];
+        RemoveLeaf(item.leaf);
+        FreeNode(item.leaf);
+        item.body = nullptr;
+        item.leaf = -1;
+        item.active = false;
+        mFreeHandles.push_back(handle);
+        --mNumBodies;
+        return true;
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+int RigidBodyWorld<Real>::GetNumBodies() const
+{
+    return mNumBodies;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+std::shared_ptr<RigidBody<Real>> const& RigidBodyWorld<Real>::GetBody(
+    int handle) const
+{
+    return mBodies[handle].body;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+typename RigidBodyWorld<Real>::ShapeType RigidBodyWorld<Real>::GetShapeType(
+    int handle) const
+{
+    return mBodies[handle].type;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+AlignedBox3<Real> const& RigidBodyWorld<Real>::GetBound(int handle) const
+{
+    return mBodies[handle].bound;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+Sphere3<Real> RigidBodyWorld<Real>::GetSphere(int handle) const
+{
+    Body const& item = mBodies[handle];
+    return Sphere3<Real>(item.body->GetPosition(), item.radius);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+OrientedBox3<Real> RigidBodyWorld<Real>::GetBox(int handle) const
+{
+    Body const& item = mBodies[handle];
+    Matrix3x3<Real> const& rotate = item.body->GetROrientation();
+    OrientedBox3<Real> box;
+    box.center = item.body->GetPosition();
+    for (int i = 0; i < 3; ++i)
+    {
+        box.axis[i] = rotate.GetCol(i);
+    }
+    box.extent = item.extent;
+    return box;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+Capsule3<Real> RigidBodyWorld<Real>::GetCapsule(int handle) const
+{
+    Body const& item = mBodies[handle];
+    Vector3<Real> direction = item.body->GetROrientation().GetCol(2);
+    return Capsule3<Real>(Segment3<Real>(item.body->GetPosition(),
+        direction, item.halfLength), item.radius);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void RigidBodyWorld<Real>::Update()
+{
+    // Reinsert the leaves of the bodies that have moved outside their leaf
+    // boxes.
+    for (auto& item : mBodies)
+    {
+        if (item.active)
+        {
+            UpdateBound(item);
+            if (!Contains(mNodes[item.leaf].box, item.bound))
+            {
+                RemoveLeaf(item.leaf);
+                for (int i = 0; i < 3; ++i)
+                {
+                    mNodes[item.leaf].box.min[i] = item.bound.min[i] - mMargin;
+                    mNodes[item.leaf].box.max[i] = item.bound.max[i] + mMargin;
+                }
+                InsertLeaf(item.leaf);
+            }
+        }
+    }
+
+    // The bodies are queried in the order of the leaves of the tree.
+    // Consecutive queries then visit mostly the same nodes, which improves
+    // the cache hit rate substantially over the order of the handles.
+    mLeafOrder.clear();
+    if (mRoot != -1)
+    {
+        mQueryStack.clear();
+        mQueryStack.push_back(mRoot);
+        while (mQueryStack.size() > 0)
+        {
+            Node const& node = mNodes[mQueryStack.back()];
+            mQueryStack.pop_back();
+            if (node.child[0] == -1)
+            {
+                mLeafOrder.push_back(node.handle);
+            }
+            else
+            {
+                mQueryStack.push_back(node.child[1]);
+                mQueryStack.push_back(node.child[0]);
+            }
+        }
+    }
+
+    // The tree is not modified by the queries, so they can run
+    // concurrently.  The leaf order is split into contiguous chunks, each
+    // with its own arrays of pairs, and the chunks are processed by the
+    // thread pool of the compute model.  There are more chunks than threads
+    // for load balancing.  The arrays are concatenated in chunk order, so
+    // the order of the pairs does not depend on the number of threads.
+    int const numLeaves = static_cast<int>(mLeafOrder.size());
+    int const numThreads =
+        (mCModel ? static_cast<int>(mCModel->numThreads) : 1);
+    int numChunks = (numThreads > 1 ? 4 * numThreads : 1);
+    numChunks = std::max(std::min(numChunks, numLeaves), 1);
+    mChunkCandidates.resize(numChunks);
+    mChunkIntersections.resize(numChunks);
+    int const numPerChunk = numLeaves / numChunks;
+    auto process = [this, numChunks, numLeaves, numPerChunk](int cmin,
+        int cmax)
+    {
+        for (int c = cmin; c <= cmax; ++c)
+        {
+            int imin = c * numPerChunk;
+            int imax = (c + 1 < numChunks ? imin + numPerChunk : numLeaves);
+            FindPairs(imin, imax, mChunkCandidates[c],
+                mChunkIntersections[c]);
+        }
+    };
+
+    if (numChunks > 1)
+    {
+        mCModel->GetThreadPool().ParallelFor(numChunks, numThreads,
+            process);
+    }
+    else
+    {
+        process(0, 0);
+    }
+
+    mCandidates.clear();
+    mIntersections.clear();
+    for (int c = 0; c < numChunks; ++c)
+    {
+        mCandidates.insert(mCandidates.end(),
+            mChunkCandidates[c].begin(), mChunkCandidates[c].end());
+        mIntersections.insert(mIntersections.end(),
+            mChunkIntersections[c].begin(), mChunkIntersections[c].end());
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+std::vector<typename RigidBodyWorld<Real>::Pair> const&
+RigidBodyWorld<Real>::GetCandidates() const
+{
+    return mCandidates;
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+std::vector<typename RigidBodyWorld<Real>::Pair> const&
+RigidBodyWorld<Real>::GetIntersections() const
+{
+    return mIntersections;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int RigidBodyWorld<Real>::Insert(Body const& item)
+{
+    int handle;
+    if (mFreeHandles.size() > 0)
+    {
+        handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+        mBodies[handle] = item;
+    }
+    else
+    {
+        handle = static_cast<int>(mBodies.size());
+        mBodies.push_back(item);
+    }
+
+    Body& newItem = mBodies[handle];
+    newItem.active = true;
+    UpdateBound(newItem);
+    newItem.leaf = AllocateNode();
+    Node& node = mNodes[newItem.leaf];
+    node.handle = handle;
+    for (int i = 0; i < 3; ++i)
+    {
+        node.box.min[i] = newItem.bound.min[i] - mMargin;
+        node.box.max[i] = newItem.bound.max[i] + mMargin;
+    }
+    InsertLeaf(newItem.leaf);
+    ++mNumBodies;
+    return handle;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void RigidBodyWorld<Real>::UpdateBound(Body& item) const
+{
+    Vector3<Real> const& center = item.body->GetPosition();
+    Matrix3x3<Real> const& rotate = item.body->GetROrientation();
+    Vector3<Real> extent;
+    int i;
+    if (item.type == SHAPE_SPHERE)
+    {
+        for (i = 0; i < 3; ++i)
+        {
+            extent[i] = item.radius;
+        }
+    }
+    else if (item.type == SHAPE_BOX)
+    {
+        // The projection of the box onto axis i has radius
+        // sum_j |R(i,j)|*e[j].
+        for (i = 0; i < 3; ++i)
+        {
+            extent[i] =
+                std::abs(rotate(i, 0)) * item.extent[0] +
+                std::abs(rotate(i, 1)) * item.extent[1] +
+                std::abs(rotate(i, 2)) * item.extent[2];
+        }
+    }
+    else  // item.type == SHAPE_CAPSULE
+    {
+        for (i = 0; i < 3; ++i)
+        {
+            extent[i] = std::abs(rotate(i, 2)) * item.halfLength +
+                item.radius;
+        }
+    }
+
+    for (i = 0; i < 3; ++i)
+    {
+        item.bound.min[i] = center[i] - extent[i];
+        item.bound.max[i] = center[i] + extent[i];
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool RigidBodyWorld<Real>::Intersects(int handle0, int handle1) const
+{
+    // Order the pair so that the shape types are nondecreasing.
+    if (mBodies[handle0].type > mBodies[handle1].type)
+    {
+        std::swap(handle0, handle1);
+    }
+    ShapeType type0 = mBodies[handle0].type;
+    ShapeType type1 = mBodies[handle1].type;
+
+    if (type0 == SHAPE_SPHERE)
+    {
+        Sphere3<Real> sphere = GetSphere(handle0);
+        if (type1 == SHAPE_SPHERE)
+        {
+            TIQuery<Real, Sphere3<Real>, Sphere3<Real>> query;
+            return query(sphere, GetSphere(handle1)).intersect;
+        }
+        else if (type1 == SHAPE_BOX)
+        {
+            TIQuery<Real, OrientedBox3<Real>, Sphere3<Real>> query;
+            return query(GetBox(handle1), sphere).intersect;
+        }
+        else  // type1 == SHAPE_CAPSULE
+        {
+            Capsule3<Real> capsule = GetCapsule(handle1);
+            DCPQuery<Real, Vector3<Real>, Segment3<Real>> query;
+            Real distance = query(sphere.center, capsule.segment).distance;
+            return distance <= sphere.radius + capsule.radius;
+        }
+    }
+    else if (type0 == SHAPE_BOX)
+    {
+        OrientedBox3<Real> box = GetBox(handle0);
+        if (type1 == SHAPE_BOX)
+        {
+            TIQuery<Real, OrientedBox3<Real>, OrientedBox3<Real>> query;
+            return query(box, GetBox(handle1)).intersect;
+        }
+        else  // type1 == SHAPE_CAPSULE
+        {
+            Capsule3<Real> capsule = GetCapsule(handle1);
+            DCPQuery<Real, Segment3<Real>, OrientedBox3<Real>> query;
+            Real distance = query(capsule.segment, box).distance;
+            return distance <= capsule.radius;
+        }
+    }
+    else  // type0 == SHAPE_CAPSULE && type1 == SHAPE_CAPSULE
+    {
+        TIQuery<Real, Capsule3<Real>, Capsule3<Real>> query;
+        return query(GetCapsule(handle0), GetCapsule(handle1)).intersect;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void RigidBodyWorld<Real>::FindPairs(int imin, int imax,
+    std::vector<Pair>& candidates, std::vector<Pair>& intersections) const
+{
+    candidates.clear();
+    intersections.clear();
+
+    std::vector<int> stack;
+    for (int i = imin; i < imax; ++i)
+    {
+        int h = mLeafOrder[i];
+        Body const& item = mBodies[h];
+
+        stack.push_back(mRoot);
+        while (stack.size() > 0)
+        {
+            Node const& node = mNodes[stack.back()];
+            stack.pop_back();
+            if (Overlap(node.box, item.bound))
+            {
+                if (node.child[0] == -1)
+                {
+                    int g = node.handle;
+                    if (h < g && Overlap(item.bound, mBodies[g].bound))
+                    {
+                        candidates.push_back(std::make_pair(h, g));
+                        if (Intersects(h, g))
+                        {
+                            intersections.push_back(
+                                std::make_pair(h, g));
+                        }
+                    }
+                }
+                else
+                {
+                    stack.push_back(node.child[0]);
+                    stack.push_back(node.child[1]);
+                }
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int RigidBodyWorld<Real>::AllocateNode()
+{
+    int index;
+    if (mFreeNodes.size() > 0)
+    {
+        index = mFreeNodes.back();
+        mFreeNodes.pop_back();
+    }
+    else
+    {
+        index = static_cast<int>(mNodes.size());
+        mNodes.push_back(Node());
+    }
+
+    Node& node = mNodes[index];
+    node.parent = -1;
+    node.child[0] = -1;
+    node.child[1] = -1;
+    node.height = 0;
+    node.handle = -1;
+    return index;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void RigidBodyWorld<Real>::FreeNode(int node)
+{
+    mFreeNodes.push_back(node);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void RigidBodyWorld<Real>::InsertLeaf(int leaf)
+{
+    if (mRoot == -1)
+    {
+        mRoot = leaf;
+        mNodes[leaf].parent = -1;
+        return;
+    }
+
+    // Find the sibling for the leaf that minimizes the increase in the
+    // surface area of the tree.  Making node S the sibling costs the area
+    // of the box containing S and the leaf plus the increase in the areas
+    // of the ancestors of S.  The search is branch-and-bound: the subtree
+    // of S is skipped when the cost inherited by the children of S plus the
+    // area of the leaf, a lower bound for the cost of any node in the
+    // subtree, is not smaller than the minimum cost found so far.
+    AlignedBox3<Real> leafBox = mNodes[leaf].box;
+    Real const leafArea = GetArea(leafBox);
+    int sibling = mRoot;
+    Real minCost = GetArea(Merge(mNodes[mRoot].box, leafBox));
+    mInsertStack.clear();
+    mInsertStack.push_back(std::make_pair(mRoot, (Real)0));
+    while (mInsertStack.size() > 0)
+    {
+        int index = mInsertStack.back().first;
+        Real inheritedCost = mInsertStack.back().second;
+        mInsertStack.pop_back();
+
+        Node const& node = mNodes[index];
+        Real directCost = GetArea(Merge(node.box, leafBox));
+        Real cost = directCost + inheritedCost;
+        if (cost < minCost)
+        {
+            minCost = cost;
+            sibling = index;
+        }
+
+        if (node.child[0] != -1)
+        {
+            inheritedCost += directCost - GetArea(node.box);
+            if (leafArea + inheritedCost < minCost)
+            {
+                mInsertStack.push_back(std::make_pair(node.child[0],
+                    inheritedCost));
+                mInsertStack.push_back(std::make_pair(node.child[1],
+                    inheritedCost));
+            }
+        }
+    }
+
+    // Create a new parent for the leaf and the sibling.  AllocateNode can
+    // resize mNodes, so the nodes are referenced by index until it returns.
+    int oldParent = mNodes[sibling].parent;
+    int newParent = AllocateNode();
+    mNodes[newParent].parent = oldParent;
+    mNodes[newParent].box = Merge(leafBox, mNodes[sibling].box);
+    mNodes[newParent].height = mNodes[sibling].height + 1;
+    mNodes[newParent].child[0] = sibling;
+    mNodes[newParent].child[1] = leaf;
+    mNodes[sibling].parent = newParent;
+    mNodes[leaf].parent = newParent;
+    if (oldParent != -1)
+    {
+        Node& parent = mNodes[oldParent];
+        parent.child[parent.child[0] == sibling ? 0 : 1] = newParent;
+    }
+    else
+    {
+        mRoot = newParent;
+    }
+
+    Refit(oldParent);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void RigidBodyWorld<Real>::RemoveLeaf(int leaf)
+{
+    if (leaf == mRoot)
+    {
+        mRoot = -1;
+        return;
+    }
+
+    // Replace the parent of the leaf by the sibling of the leaf.
+    int parent = mNodes[leaf].parent;
+    int grandParent = mNodes[parent].parent;
+    int sibling = mNodes[parent].child[0];
+    if (sibling == leaf)
+    {
+        sibling = mNodes[parent].child[1];
+    }
+    FreeNode(parent);
+    mNodes[sibling].parent = grandParent;
+    mNodes[leaf].parent = -1;
+    if (grandParent != -1)
+    {
+        Node& node = mNodes[grandParent];
+        node.child[node.child[0] == parent ? 0 : 1] = sibling;
+        Refit(grandParent);
+    }
+    else
+    {
+        mRoot = sibling;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void RigidBodyWorld<Real>::Refit(int node)
+{
+    // Walk from the node to the root, rebalancing and recomputing the
+    // boxes and heights.
+    while (node != -1)
+    {
+        node = Balance(node);
+        Node& parent = mNodes[node];
+        Node const& child0 = mNodes[parent.child[0]];
+        Node const& child1 = mNodes[parent.child[1]];
+        parent.height = 1 + std::max(child0.height, child1.height);
+        parent.box = Merge(child0.box, child1.box);
+        node = parent.parent;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int RigidBodyWorld<Real>::Balance(int iA)
+{
+    // If the subtree rooted at A is unbalanced, rotate the taller child of
+    // A to the position of A and return its index.  Otherwise, return the
+    // index of A.  The children of A are B and C.
+    Node& A = mNodes[iA];
+    if (A.child[0] == -1 || A.height < 2)
+    {
+        return iA;
+    }
+
+    int iB = A.child[0];
+    int iC = A.child[1];
+    Node& B = mNodes[iB];
+    Node& C = mNodes[iC];
+    int balance = C.height - B.height;
+
+    if (balance > 1)
+    {
+        // Rotate C up.  The children of C are F and G.
+        int iF = C.child[0];
+        int iG = C.child[1];
+        Node& F = mNodes[iF];
+        Node& G = mNodes[iG];
+
+        C.child[0] = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+        if (C.parent != -1)
+        {
+            Node& parent = mNodes[C.parent];
+            parent.child[parent.child[0] == iA ? 0 : 1] = iC;
+        }
+        else
+        {
+            mRoot = iC;
+        }
+
+        if (F.height > G.height)
+        {
+            C.child[1] = iF;
+            A.child[1] = iG;
+            G.parent = iA;
+            A.box = Merge(B.box, G.box);
+            C.box = Merge(A.box, F.box);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        }
+        else
+        {
+            C.child[1] = iG;
+            A.child[1] = iF;
+            F.parent = iA;
+            A.box = Merge(B.box, F.box);
+            C.box = Merge(A.box, G.box);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    if (balance < -1)
+    {
+        // Rotate B up.  The children of B are D and E.
+        int iD = B.child[0];
+        int iE = B.child[1];
+        Node& D = mNodes[iD];
+        Node& E = mNodes[iE];
+
+        B.child[0] = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+        if (B.parent != -1)
+        {
+            Node& parent = mNodes[B.parent];
+            parent.child[parent.child[0] == iA ? 0 : 1] = iB;
+        }
+        else
+        {
+            mRoot = iB;
+        }
+
+        if (D.height > E.height)
+        {
+            B.child[1] = iD;
+            A.child[0] = iE;
+            E.parent = iA;
+            A.box = Merge(C.box, E.box);
+            B.box = Merge(A.box, D.box);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        }
+        else
+        {
+            B.child[1] = iE;
+            A.child[0] = iD;
+            D.parent = iA;
+            A.box = Merge(C.box, D.box);
+            B.box = Merge(A.box, E.box);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+Real RigidBodyWorld<Real>::GetArea(AlignedBox3<Real> const& box)
+{
+    // This is half the surface area, which suffices for comparisons.
+    Real dx = box.max[0] - box.min[0];
+    Real dy = box.max[1] - box.min[1];
+    Real dz = box.max[2] - box.min[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+AlignedBox3<Real> RigidBodyWorld<Real>::Merge(AlignedBox3<Real> const& box0,
+    AlignedBox3<Real> const& box1)
+{
+    AlignedBox3<Real> box;
+    for (int i = 0; i < 3; ++i)
+    {
+        box.min[i] = std::min(box0.min[i], box1.min[i]);
+        box.max[i] = std::max(box0.max[i], box1.max[i]);
+    }
+    return box;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool RigidBodyWorld<Real>::Contains(AlignedBox3<Real> const& outer,
+    AlignedBox3<Real> const& inner)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        if (inner.min[i] < outer.min[i] || inner.max[i] > outer.max[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+bool RigidBodyWorld<Real>::Overlap(AlignedBox3<Real> const& box0,
+    AlignedBox3<Real> const& box1)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        if (box0.min[i] > box1.max[i] || box1.min[i] > box0.max[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
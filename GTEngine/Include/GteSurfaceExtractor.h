@@ -3,12 +3,22 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/19)
+// File Version: 1.0.2 (2014/10/18)
 
 #pragma once
 
+#include "GteComputeModel.h"
+#include "GteImage3.h"
 #include "GteMarchingCubes.h"
+#include "GteMarchingCubesTable.h"
+#include "GteVector3.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
 
 namespace gte
 {
@@ -41,6 +51,100 @@ public:
     };
 
     bool Extract(Real const F[8], Mesh& mesh) const;
+
+    // Extract the level surface F(x,y,z) = level of a 3D image whose
+    // samples are F(x,y,z).  A sample is on the negative side of the
+    // surface when F(x,y,z) < level and on the positive side otherwise, so
+    // samples equal to the level do not prevent extraction (but they can
+    // lead to triangles of zero area).  The vertices are in image
+    // coordinates; that is, sample (x,y,z) is at the point (x,y,z).  Each
+    // lattice edge with a sign change has one vertex that is shared by the
+    // triangles of all voxels containing the edge, so the mesh is indexed
+    // and has no duplicate vertices.  When normals are requested, they are
+    // the unit-length gradients of F at the vertices, obtained by linear
+    // interpolation of the central-difference gradients at the edge
+    // endpoints.  The triangles are counterclockwise ordered when viewed
+    // from the negative side of the surface.
+    struct Surface
+    {
+        std::vector<Vector3<Real>> vertices;
+        std::vector<Vector3<Real>> normals;
+        std::vector<int> indices;
+    };
+
+    // The slabs of voxels between consecutive z-slices are partitioned among
+    // cmodel->numThreads threads of the compute model's thread pool.  If
+    // cmodel is null, the extraction is single-threaded.
+    void Extract(Image3<Real> const& image, Real level, bool computeNormals,
+        Surface& surface,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr) const;
+
+    // Streaming extraction for volumes that are too large to be stored in
+    // memory.  The reader is called with each z-slice index exactly once,
+    // in increasing order, and must fill the array with the xBound*yBound
+    // samples of the slice (x varies fastest).  The slices are processed
+    // in chunks of slicesPerChunk voxel slabs; only the slices of a chunk
+    // and its neighbors are stored.  After each chunk, the writer is called
+    // with the vertices (and normals) created by the chunk and its
+    // triangles.  The triangle indices are relative to the entire surface;
+    // the vertices passed to the first call have indices starting at 0,
+    // those of the next call continue from there, and so on.
+    typedef std::function<void(int, Real*)> SliceReader;
+    typedef std::function<void(Surface const&)> SurfaceWriter;
+
+    void Extract(int xBound, int yBound, int zBound, Real level,
+        bool computeNormals, int slicesPerChunk, SliceReader const& reader,
+        SurfaceWriter const& writer,
+        std::shared_ptr<ComputeModel> const& cmodel = nullptr) const;
+
+protected:
+    // The surface for a range of slabs.  The last four arrays store the
+    // vertex indices of the x-edges and y-edges in the first and last
+    // z-slices of the range, or -1 for edges without a vertex.  They are
+    // used to identify the vertices that are shared by consecutive ranges.
+    struct Part
+    {
+        Surface surface;
+        std::vector<int> firstX, firstY, lastX, lastY;
+    };
+
+    // The slices[z] are the samples of z-slice z.  The pointers must be
+    // valid for zmin-1 <= z <= zmax+2 (clamped to the image); the others
+    // are not accessed.
+    void ExtractParts(int xBound, int yBound, int zBound,
+        std::vector<Real const*> const& slices, Real level,
+        bool computeNormals, int zmin, int zmax,
+        std::shared_ptr<ComputeModel> const& cmodel,
+        std::vector<Part>& parts) const;
+
+    // Extract the surface for the voxel slabs zmin <= z <= zmax.
+    void ExtractPart(int xBound, int yBound, int zBound,
+        std::vector<Real const*> const& slices, Real level,
+        bool computeNormals, int zmin, int zmax, Part& part) const;
+
+    // Create the vertices for the x-edges and y-edges of slice z.
+    void ComputeSliceEdges(int xBound, int yBound, int zBound,
+        std::vector<Real const*> const& slices, Real level,
+        bool computeNormals, int z, std::vector<int>& xEdge,
+        std::vector<int>& yEdge, Surface& surface) const;
+
+    // Create the vertex for the edge from (x,y,z) to (x,y,z)+e[axis].
+    int AddVertex(int xBound, int yBound, int zBound,
+        std::vector<Real const*> const& slices, Real level,
+        bool computeNormals, int x, int y, int z, int axis,
+        Surface& surface) const;
+
+    Vector3<Real> GetGradient(int xBound, int yBound, int zBound,
+        std::vector<Real const*> const& slices, int x, int y, int z) const;
+
+    // Append the parts to the output surface.  The vertices of the first
+    // slice of a part are those of the last slice of the previous part, so
+    // they are replaced by the output indices stored in lastX and lastY.
+    // On return, lastX and lastY are the output indices for the last slice
+    // of the last part.  The input numVertices is the number of vertices
+    // already output; on return it includes the vertices of the parts.
+    static void Stitch(std::vector<Part>& parts, std::vector<int>& lastX,
+        std::vector<int>& lastY, int& numVertices, Surface& output);
 };
 
 #include "GteSurfaceExtractor.inl"
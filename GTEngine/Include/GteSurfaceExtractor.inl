@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/10/18)
 
 //----------------------------------------------------------------------------
 template <typename Real>
@@ -66,3 +66,389 @@ bool SurfaceExtractor<Real>::Extract(Real const F[8], Mesh& mesh) const
     return true;
 }
 //----------------------------------------------------------------------------
+template <typename Real>
+void SurfaceExtractor<Real>::Extract(Image3<Real> const& image, Real level,
+    bool computeNormals, Surface& surface,
+    std::shared_ptr<ComputeModel> const& cmodel) const
+{
+    surface.vertices.clear();
+    surface.normals.clear();
+    surface.indices.clear();
+
+    int const xBound = image.GetDimension(0);
+    int const yBound = image.GetDimension(1);
+    int const zBound = image.GetDimension(2);
+    if (xBound < 2 || yBound < 2 || zBound < 2)
+    {
+        return;
+    }
+
+    size_t const sliceQuantity = static_cast<size_t>(xBound*yBound);
+    std::vector<Real const*> slices(zBound);
+    for (int z = 0; z < zBound; ++z)
+    {
+        slices[z] = image.GetPixels1D() + z*sliceQuantity;
+    }
+
+    std::vector<Part> parts;
+    ExtractParts(xBound, yBound, zBound, slices, level, computeNormals, 0,
+        zBound - 2, cmodel, parts);
+
+    std::vector<int> lastX, lastY;
+    int numVertices = 0;
+    Stitch(parts, lastX, lastY, numVertices, surface);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SurfaceExtractor<Real>::Extract(int xBound, int yBound, int zBound,
+    Real level, bool computeNormals, int slicesPerChunk,
+    SliceReader const& reader, SurfaceWriter const& writer,
+    std::shared_ptr<ComputeModel> const& cmodel) const
+{
+    if (xBound < 2 || yBound < 2 || zBound < 2)
+    {
+        return;
+    }
+    slicesPerChunk = std::max(slicesPerChunk, 1);
+
+    // The slices currently in memory.  A chunk of slabs zmin through zmax
+    // requires the slices zmin-1 through zmax+2 for the gradients.
+    size_t const sliceQuantity = static_cast<size_t>(xBound*yBound);
+    std::map<int, std::vector<Real>> stored;
+    std::vector<Real const*> slices(zBound, nullptr);
+    int numRead = 0;
+
+    std::vector<int> lastX, lastY;
+    int numVertices = 0;
+    Surface output;
+    std::vector<Part> parts;
+    for (int zmin = 0; zmin <= zBound - 2; zmin += slicesPerChunk)
+    {
+        int zmax = std::min(zmin + slicesPerChunk - 1, zBound - 2);
+
+        // Discard the slices that are no longer needed.
+        while (!stored.empty() && stored.begin()->first < zmin - 1)
+        {
+            slices[stored.begin()->first] = nullptr;
+            stored.erase(stored.begin());
+        }
+
+        // Read the slices for the chunk.
+        int zLast = std::min(zmax + 2, zBound - 1);
+        for (; numRead <= zLast; ++numRead)
+        {
+            std::vector<Real>& slice = stored[numRead];
+            slice.resize(sliceQuantity);
+            reader(numRead, &slice[0]);
+            slices[numRead] = &slice[0];
+        }
+
+        ExtractParts(xBound, yBound, zBound, slices, level, computeNormals,
+            zmin, zmax, cmodel, parts);
+
+        output.vertices.clear();
+        output.normals.clear();
+        output.indices.clear();
+        Stitch(parts, lastX, lastY, numVertices, output);
+        writer(output);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SurfaceExtractor<Real>::ExtractParts(int xBound, int yBound,
+    int zBound, std::vector<Real const*> const& slices, Real level,
+    bool computeNormals, int zmin, int zmax,
+    std::shared_ptr<ComputeModel> const& cmodel,
+    std::vector<Part>& parts) const
+{
+    // The slabs are partitioned into one range per thread.  Each range is
+    // extracted to its own part, which the caller stitches to the others in
+    // order.  The parts are processed by the thread pool of the compute
+    // model.  There is no point in having more parts than slabs.
+    int const numSlabs = zmax - zmin + 1;
+    int const numThreads = std::min(
+        (cmodel ? static_cast<int>(cmodel->numThreads) : 1), numSlabs);
+    int const numParts = std::max(numThreads, 1);
+    parts.resize(numParts);
+    int const numPerPart = numSlabs / numParts;
+    auto process = [this, xBound, yBound, zBound, &slices, level,
+        computeNormals, zmin, zmax, numParts, numPerPart, &parts](int pmin,
+        int pmax)
+    {
+        for (int p = pmin; p <= pmax; ++p)
+        {
+            int tmin = zmin + p * numPerPart;
+            int tmax = (p + 1 < numParts ? tmin + numPerPart - 1 : zmax);
+            ExtractPart(xBound, yBound, zBound, slices, level,
+                computeNormals, tmin, tmax, parts[p]);
+        }
+    };
+
+    if (numParts > 1)
+    {
+        cmodel->GetThreadPool().ParallelFor(numParts, numThreads, process);
+    }
+    else
+    {
+        process(0, 0);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SurfaceExtractor<Real>::ExtractPart(int xBound, int yBound, int zBound,
+    std::vector<Real const*> const& slices, Real level, bool computeNormals,
+    int zmin, int zmax, Part& part) const
+{
+    Surface& surface = part.surface;
+    surface.vertices.clear();
+    surface.normals.clear();
+    surface.indices.clear();
+
+    // The vertex indices for the x-edges and y-edges of the slices z
+    // (lower) and z+1 (upper) and for the z-edges between them.  The edge
+    // from (x,y,z) has index x + xBound*y.
+    size_t const sliceQuantity = static_cast<size_t>(xBound*yBound);
+    std::vector<int> lowerX(sliceQuantity), lowerY(sliceQuantity);
+    std::vector<int> upperX(sliceQuantity), upperY(sliceQuantity);
+    std::vector<int> zEdge(sliceQuantity);
+
+    ComputeSliceEdges(xBound, yBound, zBound, slices, level, computeNormals,
+        zmin, lowerX, lowerY, surface);
+    part.firstX = lowerX;
+    part.firstY = lowerY;
+
+    for (int z = zmin; z <= zmax; ++z)
+    {
+        Real const* F0 = slices[z];
+        Real const* F1 = slices[z + 1];
+        for (size_t i = 0; i < sliceQuantity; ++i)
+        {
+            zEdge[i] = -1;
+            if ((F0[i] < level) != (F1[i] < level))
+            {
+                int x = static_cast<int>(i % xBound);
+                int y = static_cast<int>(i / xBound);
+                zEdge[i] = AddVertex(xBound, yBound, zBound, slices, level,
+                    computeNormals, x, y, z, 2, surface);
+            }
+        }
+        ComputeSliceEdges(xBound, yBound, zBound, slices, level,
+            computeNormals, z + 1, upperX, upperY, surface);
+
+        std::vector<int> const* edge[2][3] =
+        {
+            { &lowerX, &lowerY, &zEdge },
+            { &upperX, &upperY, &zEdge }
+        };
+
+        for (int y = 0; y + 1 < yBound; ++y)
+        {
+            for (int x = 0; x + 1 < xBound; ++x)
+            {
+                // The corner bits are those of MarchingCubes.
+                int i = x + xBound*y;
+                int entry = 0;
+                if (F0[i] < level) { entry |= 0x01; }
+                if (F0[i + 1] < level) { entry |= 0x02; }
+                if (F0[i + xBound] < level) { entry |= 0x04; }
+                if (F0[i + xBound + 1] < level) { entry |= 0x08; }
+                if (F1[i] < level) { entry |= 0x10; }
+                if (F1[i + 1] < level) { entry |= 0x20; }
+                if (F1[i + xBound] < level) { entry |= 0x40; }
+                if (F1[i + xBound + 1] < level) { entry |= 0x80; }
+                if (entry == 0 || entry == 255)
+                {
+                    continue;
+                }
+
+                // Each table vertex is on the edge from corner j0 to corner
+                // j1 > j0, where j1 - j0 is 1, 2, or 4 for an x-, y-, or
+                // z-edge.
+                int const* item = gMarchingCubesTable[entry];
+                int const numV = item[0], numT = item[1];
+                int vertex[MAX_VERTICES];
+                for (int k = 0; k < numV; ++k)
+                {
+                    int j0 = item[VSTART + 2*k];
+                    int axis = ((item[VSTART + 2*k + 1] - j0) >> 1);
+                    int e = i + (j0 & 1) + xBound*((j0 & 2) >> 1);
+                    vertex[k] = (*edge[(j0 & 4) >> 2][axis])[e];
+                }
+
+                for (int k = 0; k < 3*numT; ++k)
+                {
+                    surface.indices.push_back(vertex[item[ISTART + k]]);
+                }
+            }
+        }
+
+        std::swap(lowerX, upperX);
+        std::swap(lowerY, upperY);
+    }
+
+    part.lastX = lowerX;
+    part.lastY = lowerY;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SurfaceExtractor<Real>::ComputeSliceEdges(int xBound, int yBound,
+    int zBound, std::vector<Real const*> const& slices, Real level,
+    bool computeNormals, int z, std::vector<int>& xEdge,
+    std::vector<int>& yEdge, Surface& surface) const
+{
+    Real const* F = slices[z];
+    for (int y = 0, i = 0; y < yBound; ++y)
+    {
+        for (int x = 0; x < xBound; ++x, ++i)
+        {
+            bool negative = (F[i] < level);
+
+            xEdge[i] = -1;
+            if (x + 1 < xBound && negative != (F[i + 1] < level))
+            {
+                xEdge[i] = AddVertex(xBound, yBound, zBound, slices, level,
+                    computeNormals, x, y, z, 0, surface);
+            }
+
+            yEdge[i] = -1;
+            if (y + 1 < yBound && negative != (F[i + xBound] < level))
+            {
+                yEdge[i] = AddVertex(xBound, yBound, zBound, slices, level,
+                    computeNormals, x, y, z, 1, surface);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+int SurfaceExtractor<Real>::AddVertex(int xBound, int yBound, int zBound,
+    std::vector<Real const*> const& slices, Real level, bool computeNormals,
+    int x, int y, int z, int axis, Surface& surface) const
+{
+    int p0[3] = { x, y, z };
+    int p1[3] = { x, y, z };
+    ++p1[axis];
+
+    // The signs of F0 and F1 differ, so the denominator is not zero.
+    Real F0 = slices[p0[2]][p0[0] + xBound*p0[1]] - level;
+    Real F1 = slices[p1[2]][p1[0] + xBound*p1[1]] - level;
+    Real t = F0/(F0 - F1);
+
+    Vector3<Real> position((Real)x, (Real)y, (Real)z);
+    position[axis] += t;
+    surface.vertices.push_back(position);
+
+    if (computeNormals)
+    {
+        Vector3<Real> grad0 = GetGradient(xBound, yBound, zBound, slices,
+            p0[0], p0[1], p0[2]);
+        Vector3<Real> grad1 = GetGradient(xBound, yBound, zBound, slices,
+            p1[0], p1[1], p1[2]);
+        Vector3<Real> normal = grad0 + t*(grad1 - grad0);
+        Normalize(normal);
+        surface.normals.push_back(normal);
+    }
+
+    return static_cast<int>(surface.vertices.size()) - 1;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+Vector3<Real> SurfaceExtractor<Real>::GetGradient(int xBound, int yBound,
+    int zBound, std::vector<Real const*> const& slices, int x, int y, int z)
+    const
+{
+    // Central differences in the interior, one-sided differences on the
+    // boundary.
+    int const i = x + xBound*y;
+    Real const* F = slices[z];
+    Vector3<Real> gradient;
+
+    if (0 < x && x + 1 < xBound)
+    {
+        gradient[0] = ((Real)0.5)*(F[i + 1] - F[i - 1]);
+    }
+    else
+    {
+        gradient[0] = (x == 0 ? F[i + 1] - F[i] : F[i] - F[i - 1]);
+    }
+
+    if (0 < y && y + 1 < yBound)
+    {
+        gradient[1] = ((Real)0.5)*(F[i + xBound] - F[i - xBound]);
+    }
+    else
+    {
+        gradient[1] = (y == 0 ? F[i + xBound] - F[i] : F[i] - F[i - xBound]);
+    }
+
+    if (0 < z && z + 1 < zBound)
+    {
+        gradient[2] = ((Real)0.5)*(slices[z + 1][i] - slices[z - 1][i]);
+    }
+    else
+    {
+        gradient[2] = (z == 0 ? slices[1][i] - F[i] : F[i] - slices[z - 1][i]);
+    }
+
+    return gradient;
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SurfaceExtractor<Real>::Stitch(std::vector<Part>& parts,
+    std::vector<int>& lastX, std::vector<int>& lastY, int& numVertices,
+    Surface& output)
+{
+    std::vector<int> remap;
+    for (auto& part : parts)
+    {
+        Surface const& surface = part.surface;
+        bool const hasNormals = (surface.normals.size() > 0);
+        remap.resize(surface.vertices.size());
+        std::fill(remap.begin(), remap.end(), -1);
+
+        // The vertices of the first slice were output with the previous
+        // part.  Both parts computed them from the same samples, so the
+        // edges with vertices are the same.
+        if (lastX.size() > 0)
+        {
+            for (size_t i = 0; i < part.firstX.size(); ++i)
+            {
+                if (part.firstX[i] >= 0)
+                {
+                    remap[part.firstX[i]] = lastX[i];
+                }
+                if (part.firstY[i] >= 0)
+                {
+                    remap[part.firstY[i]] = lastY[i];
+                }
+            }
+        }
+
+        for (size_t v = 0; v < remap.size(); ++v)
+        {
+            if (remap[v] < 0)
+            {
+                remap[v] = numVertices++;
+                output.vertices.push_back(surface.vertices[v]);
+                if (hasNormals)
+                {
+                    output.normals.push_back(surface.normals[v]);
+                }
+            }
+        }
+
+        for (auto index : surface.indices)
+        {
+            output.indices.push_back(remap[index]);
+        }
+
+        lastX.resize(part.lastX.size());
+        lastY.resize(part.lastY.size());
+        for (size_t i = 0; i < part.lastX.size(); ++i)
+        {
+            lastX[i] = (part.lastX[i] >= 0 ? remap[part.lastX[i]] : -1);
+            lastY[i] = (part.lastY[i] >= 0 ? remap[part.lastY[i]] : -1);
+        }
+    }
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/05)
+
+#pragma once
+
+#include "GTEngineDEF.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A pool of persistent worker threads that execute tasks.  Each worker has
+// its own task queue.  A worker takes the most recently pushed task from
+// its own queue and, when its queue is empty, steals the least recently
+// pushed task from another queue.  Tasks pushed by a thread that is not a
+// worker are distributed among the queues.
+//
+// A thread that waits for tasks to finish (TaskGroup::Wait, ParallelFor,
+// ParallelReduce) executes queued tasks while it waits, so tasks may
+// create and wait for their own tasks without deadlock and a pool with no
+// worker threads executes all tasks on the waiting thread.  A task should
+// not block for a long time waiting on other tasks by means other than a
+// TaskGroup, because the worker thread is unavailable while it blocks.
+//
+// The process-wide pool GetDefault() has hardware_concurrency()-1 worker
+// threads; the thread that calls ParallelFor participates, so all hardware
+// threads are used.  It is created on first use.  See
+// ComputeModel::GetThreadPool() for how algorithms select a pool.
+
+namespace gte
+{
+
+class GTE_IMPEXP ThreadPool
+{
+public:
+    // Construction and destruction.  The number of threads includes the
+    // thread that submits the work, so numThreads-1 worker threads are
+    // launched.  The destructor waits for the queued tasks to finish.
+    ~ThreadPool();
+    ThreadPool(unsigned int numThreads);
+
+    // The process-wide pool.
+    static ThreadPool& GetDefault();
+
+    // The number of worker threads plus one.
+    inline unsigned int GetNumThreads() const;
+
+    // A set of tasks that can be waited on.  Run() queues a task and Wait()
+    // returns when all tasks of the group have finished.  The destructor
+    // calls Wait().
+    class GTE_IMPEXP TaskGroup
+    {
+    public:
+        ~TaskGroup();
+        TaskGroup(ThreadPool& pool);
+
+        void Run(std::function<void()> const& task);
+        void Wait();
+
+    private:
+        // Disallow copying.
+        TaskGroup(TaskGroup const&);
+        TaskGroup& operator=(TaskGroup const&);
+
+        ThreadPool& mPool;
+        std::atomic<int> mNumPending;
+        std::mutex mMutex;
+        std::condition_variable mFinished;
+    };
+
+    // Partition lines 0 through numLines-1 into contiguous ranges and call
+    // process(lmin,lmax) for each range, where the range is lmin through
+    // lmax inclusive.  At most numThreads calls run concurrently.  The
+    // ranges are claimed dynamically, so a thread that finishes its range
+    // early claims another; there are more ranges than threads for load
+    // balancing.  Do not assume a particular range is processed by a
+    // particular thread.
+    void ParallelFor(int numLines, int numThreads,
+        std::function<void(int, int)> const& process);
+
+    // Partition the lines as in ParallelFor, compute process(lmin,lmax) for
+    // each range and combine the results with combine(T,T), starting with
+    // 'identity'.  The results are combined in the order of the ranges, so
+    // the result does not depend on the order of execution.
+    template <typename T, typename Combine>
+    T ParallelReduce(int numLines, int numThreads, T const& identity,
+        std::function<T(int, int)> const& process, Combine combine);
+
+private:
+    // Disallow copying.
+    ThreadPool(ThreadPool const&);
+    ThreadPool& operator=(ThreadPool const&);
+
+    typedef std::function<void()> Task;
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Support for ParallelFor and ParallelReduce.
+    static int GetNumRanges(int numLines, int numThreads);
+    static void GetRange(int range, int numRanges, int numLines, int& lmin,
+        int& lmax);
+
+    // Queue a task.  A worker queues it on its own queue; other threads
+    // distribute tasks among the queues.
+    void Push(Task const& task);
+
+    // Execute one queued task.  The return value is 'false' when no task
+    // is queued.
+    bool RunOne();
+
+    // The index of the calling worker or -1 when the caller is not a
+    // worker of this pool.
+    int GetWorkerIndex() const;
+
+    void WorkerLoop();
+
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::vector<std::thread> mWorkers;
+    std::atomic<int> mNumQueued;
+    std::atomic<unsigned int> mNextQueue;
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeUp;
+    bool mStop;
+};
+
+#include "GteThreadPool.inl"
+
+}
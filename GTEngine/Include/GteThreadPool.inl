@@ -0,0 +1,58 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.1 (2014/11/07)
+
+//----------------------------------------------------------------------------
+inline unsigned int ThreadPool::GetNumThreads() const
+{
+    return static_cast<unsigned int>(mWorkers.size()) + 1;
+}
+//----------------------------------------------------------------------------
+template <typename T, typename Combine>
+T ThreadPool::ParallelReduce(int numLines, int numThreads,
+    T const& identity, std::function<T(int, int)> const& process,
+    Combine combine)
+{
+    numThreads = std::min(numThreads, static_cast<int>(GetNumThreads()));
+    int const numRanges = GetNumRanges(numLines, numThreads);
+    if (numRanges == 0)
+    {
+        return identity;
+    }
+    if (numRanges == 1)
+    {
+        return combine(identity, process(0, numLines - 1));
+    }
+
+    std::vector<T> results(numRanges, identity);
+    std::atomic<int> next(0);
+    auto runner = [&]()
+    {
+        int range, lmin, lmax;
+        while ((range = next++) < numRanges)
+        {
+            GetRange(range, numRanges, numLines, lmin, lmax);
+            results[range] = process(lmin, lmax);
+        }
+    };
+
+    // The calling thread is one of the runners.
+    TaskGroup group(*this);
+    for (int t = 1; t < numThreads; ++t)
+    {
+        group.Run(runner);
+    }
+    runner();
+    group.Wait();
+
+    T result = identity;
+    for (int range = 0; range < numRanges; ++range)
+    {
+        result = combine(result, results[range]);
+    }
+    return result;
+}
+//----------------------------------------------------------------------------
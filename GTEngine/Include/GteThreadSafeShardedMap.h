@@ -0,0 +1,69 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/11)
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// A thread-safe map with the interface of ThreadSafeMap.  ThreadSafeMap
+// protects a single std::map with a single mutex, so all threads contend
+// for that mutex.  This map partitions the keys among NumShards hash maps,
+// each with its own mutex, so operations on keys in different shards do
+// not contend.  The shard is selected by the high-order bits of the mixed
+// hash of the key, which is important for pointer keys whose low-order
+// bits are zero.  Unlike ThreadSafeMap, GatherAll does not return the
+// values in key order.  GatherAll and RemoveAll lock all shards, so they
+// are consistent snapshots.
+
+namespace gte
+{
+
+template <typename Key, typename Value, int NumShards = 16,
+    typename Hash = std::hash<Key>>
+class ThreadSafeShardedMap
+{
+public:
+    static_assert(NumShards > 0 && (NumShards & (NumShards - 1)) == 0,
+        "NumShards must be a power of two.");
+
+    // Construction and destruction.
+    virtual ~ThreadSafeShardedMap();
+    ThreadSafeShardedMap();
+
+    // All the operations are thread-safe.
+    bool HasElements() const;
+    bool Exists(Key key) const;
+    void Insert(Key key, Value value);
+    bool Remove(Key key, Value& value);
+    void RemoveAll();
+    bool Get(Key key, Value& value) const;
+    void GatherAll(std::vector<Value>& values) const;
+
+protected:
+    // The mutexes of different shards are on different cache lines to
+    // avoid false sharing.
+    struct Shard
+    {
+        std::unordered_map<Key, Value, Hash> map;
+        mutable std::mutex mutex;
+        char padding[64];
+    };
+
+    Shard& GetShard(Key const& key);
+    Shard const& GetShard(Key const& key) const;
+
+    std::array<Shard, NumShards> mShards;
+};
+
+#include "GteThreadSafeShardedMap.inl"
+
+}
@@ -0,0 +1,156 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/11)
+
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+ThreadSafeShardedMap<Key, Value, NumShards, Hash>::~ThreadSafeShardedMap()
+{
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+ThreadSafeShardedMap<Key, Value, NumShards, Hash>::ThreadSafeShardedMap()
+{
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+bool ThreadSafeShardedMap<Key, Value, NumShards, Hash>::HasElements() const
+{
+    for (auto const& shard : mShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.map.size() > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+bool ThreadSafeShardedMap<Key, Value, NumShards, Hash>::Exists(Key key)
+    const
+{
+    Shard const& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.find(key) != shard.map.end();
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+void ThreadSafeShardedMap<Key, Value, NumShards, Hash>::Insert(Key key,
+    Value value)
+{
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.map[key] = value;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+bool ThreadSafeShardedMap<Key, Value, NumShards, Hash>::Remove(Key key,
+    Value& value)
+{
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.map.find(key);
+    if (iter != shard.map.end())
+    {
+        value = iter->second;
+        shard.map.erase(iter);
+        return true;
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+void ThreadSafeShardedMap<Key, Value, NumShards, Hash>::RemoveAll()
+{
+    // Lock the shards in order so that concurrent calls cannot deadlock.
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(NumShards);
+    for (auto& shard : mShards)
+    {
+        locks.push_back(std::unique_lock<std::mutex>(shard.mutex));
+    }
+    for (auto& shard : mShards)
+    {
+        shard.map.clear();
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+bool ThreadSafeShardedMap<Key, Value, NumShards, Hash>::Get(Key key,
+    Value& value) const
+{
+    Shard const& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.map.find(key);
+    if (iter != shard.map.end())
+    {
+        value = iter->second;
+        return true;
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+void ThreadSafeShardedMap<Key, Value, NumShards, Hash>::GatherAll(
+    std::vector<Value>& values) const
+{
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(NumShards);
+    for (auto const& shard : mShards)
+    {
+        locks.push_back(std::unique_lock<std::mutex>(shard.mutex));
+    }
+
+    size_t numValues = 0;
+    for (auto const& shard : mShards)
+    {
+        numValues += shard.map.size();
+    }
+
+    values.clear();
+    values.reserve(numValues);
+    for (auto const& shard : mShards)
+    {
+        for (auto const& element : shard.map)
+        {
+            values.push_back(element.second);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+typename ThreadSafeShardedMap<Key, Value, NumShards, Hash>::Shard&
+ThreadSafeShardedMap<Key, Value, NumShards, Hash>::GetShard(Key const& key)
+{
+    Shard const& shard =
+        static_cast<ThreadSafeShardedMap const*>(this)->GetShard(key);
+    return const_cast<Shard&>(shard);
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, int NumShards, typename Hash>
+typename ThreadSafeShardedMap<Key, Value, NumShards, Hash>::Shard const&
+ThreadSafeShardedMap<Key, Value, NumShards, Hash>::GetShard(Key const& key)
+    const
+{
+    // Fibonacci hashing: multiply by 2^64 divided by the golden ratio and
+    // use the high-order bits, which depend on all bits of the hash.
+    uint64_t h = static_cast<uint64_t>(Hash()(key));
+    h *= 0x9E3779B97F4A7C15ull;
+    int index = 0;
+    if (NumShards > 1)
+    {
+        int shift = 64;
+        for (int n = NumShards; n > 1; n >>= 1)
+        {
+            --shift;
+        }
+        index = static_cast<int>(h >> shift);
+    }
+    return mShards[index];
+}
+//----------------------------------------------------------------------------
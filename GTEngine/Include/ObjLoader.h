@@ -4,17 +4,45 @@
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
 //
-// File Version: 5.1.0 (2010/03/30)
+// File Version: 5.1.1 (2014/11/19)
 
 #ifndef OBJLOADER_H
 #define OBJLOADER_H
 
 #include "MtlLoader.h"
+#include <cstdint>
+
+// The loader memory-maps the file, splits it into chunks at line
+// boundaries and parses the chunks in parallel using the process-wide
+// thread pool.  The numbers are parsed in place without allocations.  The
+// groups and materials are merged in file order after the chunks are
+// parsed.  Negative (relative) vertex references are supported, and a face
+// vertex may be any of v, v/vt, v//vn or v/vt/vn.  The load fails with
+// EC_INVALID_VERTEX when a reference is not to an element of the file.
+//
+// Faces that precede the first 'g' are in a group named "default", and
+// faces that precede the first 'usemtl' are in a mesh whose MtlIndex is -1.
+//
+// The options are bit flags.  OPTION_LOG writes the result of the load to
+// ObjLogFile.txt.  OPTION_CACHE loads the binary cache path + filename +
+// ".cache" when it was written for the current size and modification time
+// of the OBJ file; otherwise, the OBJ file is parsed and the cache is
+// written.  The cache stores the arrays in their memory layout, so loading
+// it is a single mapping and a copy per array.  The materials are not
+// cached; the material library is loaded again.
 
 class ObjLoader
 {
 public:
-    ObjLoader (const string& path, const string& filename);
+    enum Option
+    {
+        OPTION_NONE  = 0x00000000,
+        OPTION_LOG   = 0x00000001,
+        OPTION_CACHE = 0x00000002
+    };
+
+    ObjLoader (const string& path, const string& filename,
+        unsigned int options = OPTION_NONE);
     ~ObjLoader ();
 
     enum ErrorCode
@@ -30,6 +58,7 @@ public:
         EC_FAILED_TO_LOAD_MATERIALS,
         EC_FAILED_TO_FIND_MATERIAL,
         EC_INVALID_VERTEX,
+        EC_INVALID_NUMBER,
         EC_MAX_ERROR_CODES
     };
 
@@ -84,10 +113,13 @@ public:
         int PosIndex, TcdIndex, NorIndex;
     };
 
+    // The vertices of a face are Vertices[First] through
+    // Vertices[First+Count-1] of its mesh.  Storing the vertices of all the
+    // faces of a mesh in one array avoids an allocation per face.
     class Face
     {
     public:
-        vector<Vertex> Vertices;
+        int First, Count;
     };
 
     class Mesh
@@ -95,6 +127,7 @@ public:
     public:
         int MtlIndex;
         vector<Face> Faces;
+        vector<Vertex> Vertices;
     };
 
     class Group
@@ -113,20 +146,79 @@ public:
     inline const vector<Float3>& GetNormals () const;
 
 private:
-    void GetTokens (const string& line, vector<string>& tokens);
-    bool GetMaterialLibrary (const string& path,
-        const vector<string>& tokens);
-    bool GetDefaultGroup (const vector<string>& tokens);
-    bool GetPosition (const vector<string>& tokens);
-    bool GetTCoord (const vector<string>& tokens);
-    bool GetNormal (const vector<string>& tokens);
-    bool GetGroup (const vector<string>& tokens);
-    bool GetMaterialAndMesh (const vector<string>& tokens);
-    bool GetFace (const vector<string>& tokens);
+    // The output of parsing a chunk of the file.  The commands are the
+    // lines that change the material library, group or material, in file
+    // order.  NumFaces is the number of faces of the chunk that precede the
+    // command.  A negative (relative) vertex index is stored relative to
+    // the elements of the chunk, and the indices of those vertices are in
+    // the fixup arrays.
+    class Command
+    {
+    public:
+        enum Type { MTLLIB, DEFAULT_GROUP, GROUP, USEMTL };
+
+        Type CommandType;
+        string Name;
+        const char* Line;
+        int NumPositions, NumTCoords, NumNormals, NumFaces;
+    };
+
+    class Chunk
+    {
+    public:
+        Chunk ();
+
+        ErrorCode Code;
+        const char* ErrorLine;
+        vector<Float3> Positions;
+        vector<Float2> TCoords;
+        vector<Float3> Normals;
+        vector<Command> Commands;
+        vector<int> FaceCounts;
+        vector<Vertex> Vertices;
+        vector<size_t> PosFixups, TcdFixups, NorFixups;
+    };
+
+    // Parse the memory-mapped file in parallel and merge the chunks.
+    bool Parse (const string& path, const string& filePath, size_t fileSize,
+        string& errorLine);
+    static void ParseChunk (const char* begin, const char* end,
+        Chunk& chunk);
+    static ErrorCode ParseLine (const char* line, const char* end,
+        Chunk& chunk);
+    static ErrorCode ParseFloats (const char*& text, const char* end,
+        int numValues, float* values);
+    static bool ParseFloat (const char*& text, const char* end,
+        float& value);
+    static ErrorCode ParseVertex (const char*& text, const char* end,
+        Chunk& chunk);
+    static bool ParseIndex (const char*& text, const char* end,
+        int numElements, int& index, vector<size_t>& fixups, size_t fixup);
+    bool Merge (const string& path, vector<Chunk>& chunks,
+        const char* dataEnd, string& errorLine);
+    static bool FixIndices (const vector<size_t>& fixups, int base,
+        int Vertex::*member, Chunk& chunk);
+    static bool CheckIndices (const Chunk& chunk, int numPositions,
+        int numTCoords, int numNormals);
+    void AddFaces (const Chunk& chunk, int numFaces, int& face, int& vertex);
+
+    // The commands, applied in file order by Merge.
+    bool GetMaterialLibrary (const string& path, const string& name);
+    void GetDefaultGroup (int numPositions, int numTCoords, int numNormals);
+    void GetGroup (const string& name, int numPositions, int numTCoords,
+        int numNormals);
+    bool GetMaterialAndMesh (const string& name);
+    Mesh& GetCurrentMesh ();
+
+    // Support for the binary cache.
+    bool LoadCache (const string& path, const string& cachePath,
+        uint64_t fileSize, int64_t fileTime);
+    void SaveCache (const string& cachePath, uint64_t fileSize,
+        int64_t fileTime) const;
 
     ErrorCode mCode;
-    FILE* mLogFile;
     vector<MtlLoader::Material> mMaterials;
+    string mMaterialLibrary;
     int mCurrentGroup, mCurrentPos, mCurrentTcd, mCurrentNor;
     int mCurrentMtl, mCurrentMesh;
     vector<Group> mGroups;
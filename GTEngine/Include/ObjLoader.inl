@@ -4,7 +4,7 @@
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
 //
-// File Version: 5.1.0 (2010/03/30)
+// File Version: 5.1.1 (2014/11/19)
 
 //----------------------------------------------------------------------------
 inline ObjLoader::ErrorCode ObjLoader::GetCode () const
@@ -0,0 +1,171 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+using namespace gte;
+
+// Contention test of LockFreeQueue against ThreadSafeQueue for 1 to 32
+// threads.  Half of the threads push 400000 integers in total and the other
+// half pop them, both spinning (with a yield) when Push or Pop fails, which
+// is how VideoStreamManager uses its frame queue.  The queues have 1024
+// slots.  Every integer must be popped exactly once.  The last tests are a
+// single producer and consumer, for which the SPSC specialization is also
+// timed, and a producer and consumer using BlockingPush and BlockingPop on
+// a queue of 4 slots.  The program returns a nonzero value when a test
+// fails.
+
+//----------------------------------------------------------------------------
+template <typename Queue>
+bool Run(int numProducers, int numConsumers, int numElements,
+    double& milliseconds)
+{
+    Queue queue(1024);
+    int const numPerProducer = numElements / numProducers;
+    numElements = numPerProducer * numProducers;
+    std::vector<std::atomic<int>> popCount(numElements);
+    for (auto& count : popCount)
+    {
+        count = 0;
+    }
+    std::atomic<int> numRemaining(numElements);
+
+    Timer timer;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < numProducers; ++p)
+    {
+        threads.push_back(std::thread([&queue, p, numPerProducer]()
+        {
+            for (int i = 0; i < numPerProducer; ++i)
+            {
+                while (!queue.Push(p * numPerProducer + i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+    for (int c = 0; c < numConsumers; ++c)
+    {
+        threads.push_back(std::thread([&queue, &popCount, &numRemaining]()
+        {
+            while (numRemaining > 0)
+            {
+                int element;
+                if (queue.Pop(element))
+                {
+                    ++popCount[element];
+                    --numRemaining;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    milliseconds = 1000.0 * timer.GetSeconds();
+
+    for (auto const& count : popCount)
+    {
+        if (count != 1)
+        {
+            return false;
+        }
+    }
+    return queue.GetNumElements() == 0;
+}
+//----------------------------------------------------------------------------
+bool RunBlocking(int numElements)
+{
+    LockFreeQueue<int> queue(4);
+    long long sum = 0;
+    std::thread consumer([&queue, &sum, numElements]()
+    {
+        for (int i = 0; i < numElements; ++i)
+        {
+            int element;
+            queue.BlockingPop(element);
+            sum += element;
+        }
+    });
+    for (int i = 0; i < numElements; ++i)
+    {
+        queue.BlockingPush(i);
+    }
+    consumer.join();
+    return sum == (long long)numElements * (numElements - 1) / 2;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(1);
+    int const numElements = 400000;
+    bool passed = true;
+    double msMutex, msLockFree, msSPSC;
+
+    for (int numThreads = 2; numThreads <= 32; numThreads *= 2)
+    {
+        int numProducers = numThreads / 2;
+        int numConsumers = numThreads - numProducers;
+        bool ok = Run<ThreadSafeQueue<int>>(numProducers, numConsumers,
+            numElements, msMutex);
+        ok = Run<LockFreeQueue<int>>(numProducers, numConsumers,
+            numElements, msLockFree) && ok;
+        std::cout << std::setw(2) << numThreads << " threads: mutex "
+            << msMutex << " ms, lock-free " << msLockFree << " ms"
+            << (ok ? "" : "  FAILED") << std::endl;
+        passed = passed && ok;
+    }
+
+    // One thread pushes and pops, so the queue must not fill.
+    {
+        LockFreeQueue<int> queue(1024);
+        Timer timer;
+        bool ok = true;
+        for (int i = 0; i < numElements; ++i)
+        {
+            int element;
+            ok = ok && queue.Push(i) && queue.Pop(element) && element == i;
+        }
+        std::cout << " 1 thread: lock-free " << 1000.0 * timer.GetSeconds()
+            << " ms" << (ok ? "" : "  FAILED") << std::endl;
+        passed = passed && ok;
+    }
+
+    bool ok = Run<ThreadSafeQueue<int>>(1, 1, numElements, msMutex);
+    ok = Run<LockFreeQueue<int>>(1, 1, numElements, msLockFree) && ok;
+    ok = Run<LockFreeQueue<int, true>>(1, 1, numElements, msSPSC) && ok;
+    std::cout << "1 producer, 1 consumer: mutex " << msMutex
+        << " ms, lock-free " << msLockFree << " ms, SPSC " << msSPSC
+        << " ms" << (ok ? "" : "  FAILED") << std::endl;
+    passed = passed && ok;
+
+    ok = RunBlocking(numElements);
+    std::cout << "blocking push and pop" << (ok ? "" : "  FAILED")
+        << std::endl;
+    passed = passed && ok;
+
+    std::cout << (passed ? "all tests passed" : "some tests FAILED")
+        << std::endl;
+    return passed ? 0 : 1;
+}
+//----------------------------------------------------------------------------
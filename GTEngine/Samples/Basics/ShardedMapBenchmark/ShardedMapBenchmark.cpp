@@ -0,0 +1,140 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+using namespace gte;
+
+// Scaling of ThreadSafeShardedMap against ThreadSafeMap for 1 to 16 threads.
+// The keys are pointers to 100000 objects, as in the maps of the DX11
+// engine that associate graphics objects with their DX11 counterparts, and
+// half of the keys are in the map initially.  Each thread performs 400000
+// operations on random keys.
+//
+// 1. Read-heavy.  90% of the operations are Get, 5% Insert and 5% Remove,
+//    as when resources are looked up while others are loaded.
+//
+// 2. Write-heavy.  50% of the operations are Insert and 50% Remove.
+//
+// Each thread inserts and removes only its own keys, so the final contents
+// of the maps do not depend on the interleaving and must be the same for
+// both maps.  The lookups are over all keys.
+
+//----------------------------------------------------------------------------
+struct Resource
+{
+    int id;
+};
+
+template <typename Map>
+double Run(Map& map, std::vector<Resource> const& resources,
+    int numThreads, int readPercent, std::vector<int>& contents)
+{
+    int const numResources = static_cast<int>(resources.size());
+    for (int i = 0; i < numResources; i += 2)
+    {
+        map.Insert(&resources[i], resources[i].id);
+    }
+
+    Timer timer;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t)
+    {
+        threads.push_back(std::thread(
+            [&map, &resources, numResources, numThreads, readPercent, t]()
+        {
+            std::mt19937 mte(t);
+            std::uniform_int_distribution<int> rndKey(0, numResources - 1);
+            std::uniform_int_distribution<int> rndPercent(0, 99);
+            int const numOwned = (numResources - t + numThreads - 1) /
+                numThreads;
+            std::uniform_int_distribution<int> rndOwned(0, numOwned - 1);
+            for (int i = 0; i < 400000; ++i)
+            {
+                int percent = rndPercent(mte);
+                if (percent < readPercent)
+                {
+                    int value;
+                    map.Get(&resources[rndKey(mte)], value);
+                }
+                else
+                {
+                    // Thread t owns the keys k with k % numThreads == t.
+                    Resource const* key =
+                        &resources[rndOwned(mte) * numThreads + t];
+                    if ((percent - readPercent) % 2 == 0)
+                    {
+                        map.Insert(key, key->id);
+                    }
+                    else
+                    {
+                        int value;
+                        map.Remove(key, value);
+                    }
+                }
+            }
+        }));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double milliseconds = 1000.0 * timer.GetSeconds();
+
+    map.GatherAll(contents);
+    std::sort(contents.begin(), contents.end());
+    return milliseconds;
+}
+//----------------------------------------------------------------------------
+bool Test(std::vector<Resource> const& resources, int readPercent)
+{
+    std::cout << readPercent << "% reads" << std::endl;
+    bool passed = true;
+    for (int numThreads = 1; numThreads <= 16; numThreads *= 2)
+    {
+        ThreadSafeMap<Resource const*, int> map;
+        ThreadSafeShardedMap<Resource const*, int> shardedMap;
+        std::vector<int> contents, shardedContents;
+        double msMap = Run(map, resources, numThreads, readPercent,
+            contents);
+        double msShardedMap = Run(shardedMap, resources, numThreads,
+            readPercent, shardedContents);
+        bool same = (contents == shardedContents);
+        std::cout << "  " << std::setw(2) << numThreads
+            << " threads: ThreadSafeMap " << msMap
+            << " ms, ThreadSafeShardedMap " << msShardedMap << " ms"
+            << (same ? "" : "  MISMATCH") << std::endl;
+        passed = passed && same;
+    }
+    return passed;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::vector<Resource> resources(100000);
+    for (int i = 0; i < static_cast<int>(resources.size()); ++i)
+    {
+        resources[i].id = i;
+    }
+
+    bool passed = Test(resources, 90);
+    passed = Test(resources, 0) && passed;
+    return passed ? 0 : 1;
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,133 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+using namespace gte;
+
+// The cost of dispatching a loop to ThreadPool::ParallelFor compared to
+// spawning and joining std::thread objects for every call, which is what
+// the Execute helpers of the algorithms did before the pool existed.  Each
+// call processes numLines lines, output[i] = sqrt(input[i] + 1), for 10^3
+// to 10^6 lines and for 2, 4, 8, ... threads.  The calls are repeated so
+// that each configuration processes 10^7 lines, and the average time per
+// call is reported.  For small loops the time is dominated by the overhead
+// of the dispatch, for large loops by the work.  The pool of numThreads
+// threads has numThreads-1 workers, and the spawning version launches
+// numThreads-1 threads with the calling thread processing the last range,
+// so both use numThreads threads.  The outputs must equal those of a
+// single-threaded loop.  The program returns a nonzero value when a test
+// fails.
+
+//----------------------------------------------------------------------------
+void Process(std::vector<float> const& input, std::vector<float>& output,
+    int lmin, int lmax)
+{
+    for (int i = lmin; i <= lmax; ++i)
+    {
+        output[i] = std::sqrt(input[i] + 1.0f);
+    }
+}
+//----------------------------------------------------------------------------
+void SpawnFor(int numLines, int numThreads,
+    std::function<void(int, int)> const& process)
+{
+    std::vector<std::thread> threads(numThreads - 1);
+    for (int t = 0; t < numThreads; ++t)
+    {
+        int lmin = numLines * t / numThreads;
+        int lmax = numLines * (t + 1) / numThreads - 1;
+        if (t < numThreads - 1)
+        {
+            threads[t] = std::thread([&process, lmin, lmax]()
+            {
+                process(lmin, lmax);
+            });
+        }
+        else
+        {
+            process(lmin, lmax);
+        }
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+//----------------------------------------------------------------------------
+bool Test(int numLines, std::vector<float> const& input)
+{
+    std::cout << numLines << " lines" << std::endl;
+    std::vector<float> expected(numLines), output(numLines);
+    Process(input, expected, 0, numLines - 1);
+    auto process = [&input, &output](int lmin, int lmax)
+    {
+        Process(input, output, lmin, lmax);
+    };
+
+    int const numCalls = std::max(10000000 / numLines, 10);
+    unsigned int maxThreads = std::max(std::thread::hardware_concurrency(),
+        8u);
+    bool passed = true;
+    for (unsigned int numThreads = 2; numThreads <= maxThreads;
+        numThreads *= 2)
+    {
+        ThreadPool pool(numThreads);
+        std::fill(output.begin(), output.end(), 0.0f);
+        Timer timer;
+        for (int call = 0; call < numCalls; ++call)
+        {
+            pool.ParallelFor(numLines, numThreads, process);
+        }
+        double usPool = 1.0e+06 * timer.GetSeconds() / numCalls;
+        bool ok = (output == expected);
+
+        std::fill(output.begin(), output.end(), 0.0f);
+        timer.Reset();
+        for (int call = 0; call < numCalls; ++call)
+        {
+            SpawnFor(numLines, numThreads, process);
+        }
+        double usSpawn = 1.0e+06 * timer.GetSeconds() / numCalls;
+        ok = ok && (output == expected);
+
+        std::cout << "  numThreads = " << numThreads << ": ParallelFor "
+            << usPool << " us/call, spawn " << usSpawn << " us/call, ratio "
+            << usSpawn / usPool << (ok ? "" : "  MISMATCH") << std::endl;
+        passed = passed && ok;
+    }
+    return passed;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::vector<float> input(1000000);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = static_cast<float>(i);
+    }
+
+    bool passed = true;
+    for (int numLines = 1000; numLines <= 1000000; numLines *= 10)
+    {
+        passed = Test(numLines, input) && passed;
+    }
+    std::cout << (passed ? "all tests passed" : "some tests FAILED")
+        << std::endl;
+    return passed ? 0 : 1;
+}
+//----------------------------------------------------------------------------
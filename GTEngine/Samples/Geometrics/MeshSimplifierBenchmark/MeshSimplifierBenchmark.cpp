@@ -0,0 +1,202 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+using namespace gte;
+
+// Throughput of MeshSimplifier in input triangles per second.  The mesh is
+// a bumpy sphere of 261120 triangles built as a latitude-longitude grid, so
+// the vertices of the first and last columns are at the same positions,
+// which is a texture seam.
+//
+// 1. Simplification to 1% of the triangles for 1, 2, 4, ... threads.  With
+//    more than one thread the mesh is split into clusters that are
+//    simplified in parallel, and the errors must remain comparable to the
+//    single-threaded error.
+//
+// 2. A chain of 8 levels of detail, each with half the triangles of the
+//    previous level.  The errors of the levels are with respect to the
+//    input, so they must not decrease.
+//
+// The simplified meshes must reach their targets and have valid indices.
+// The program returns a nonzero value when a test fails.
+
+//----------------------------------------------------------------------------
+void CreateSphere(int numSlices, std::vector<Vector3<float>>& positions,
+    std::vector<int>& indices)
+{
+    // The rings are r = 1..numRings-1 and the slices are s = 0..numSlices,
+    // where slice numSlices duplicates the positions of slice 0.
+    int const numRings = numSlices / 2;
+    positions.clear();
+    positions.push_back(Vector3<float>(0.0f, 0.0f, 1.0f));
+    for (int r = 1; r < numRings; ++r)
+    {
+        float theta = (float)GTE_C_PI * r / numRings;
+        for (int s = 0; s <= numSlices; ++s)
+        {
+            float phi = (float)GTE_C_TWO_PI * (s % numSlices) / numSlices;
+            float radius = 1.0f + 0.05f * sin(5.0f * theta) * cos(7.0f * phi);
+            positions.push_back(Vector3<float>(
+                radius * sin(theta) * cos(phi),
+                radius * sin(theta) * sin(phi),
+                radius * cos(theta)));
+        }
+    }
+    int const south = static_cast<int>(positions.size());
+    positions.push_back(Vector3<float>(0.0f, 0.0f, -1.0f));
+
+    auto vertex = [numSlices](int r, int s)
+    {
+        return 1 + (r - 1) * (numSlices + 1) + s;
+    };
+
+    indices.clear();
+    for (int s = 0; s < numSlices; ++s)
+    {
+        indices.insert(indices.end(),
+            { 0, vertex(1, s), vertex(1, s + 1) });
+        indices.insert(indices.end(),
+            { south, vertex(numRings - 1, s + 1), vertex(numRings - 1, s) });
+    }
+    for (int r = 1; r < numRings - 1; ++r)
+    {
+        for (int s = 0; s < numSlices; ++s)
+        {
+            int v0 = vertex(r, s), v1 = v0 + 1;
+            int v2 = vertex(r + 1, s), v3 = v2 + 1;
+            indices.insert(indices.end(), { v0, v2, v1, v1, v2, v3 });
+        }
+    }
+}
+//----------------------------------------------------------------------------
+bool IsValid(std::vector<int> const& indices, int numVertices,
+    int maxTriangles)
+{
+    if (indices.size() % 3 != 0
+        || static_cast<int>(indices.size() / 3) > maxTriangles)
+    {
+        return false;
+    }
+    for (auto index : indices)
+    {
+        if (index < 0 || index >= numVertices)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+bool TestSimplify(std::vector<Vector3<float>> const& positions,
+    std::vector<int> const& indices)
+{
+    int const numVertices = static_cast<int>(positions.size());
+    int const numTriangles = static_cast<int>(indices.size() / 3);
+    int const targetTriangles = numTriangles / 100;
+    std::cout << "simplification of " << numTriangles << " to "
+        << targetTriangles << " triangles" << std::endl;
+
+    bool passed = true;
+    float error1 = 0.0f;
+    unsigned int maxThreads = std::max(std::thread::hardware_concurrency(),
+        1u);
+    for (unsigned int numThreads = 1; numThreads <= maxThreads;
+        numThreads *= 2)
+    {
+        MeshSimplifier<float> simplifier(
+            std::make_shared<ComputeModel>(numThreads));
+        std::vector<int> simplified = indices;
+        float error;
+        Timer timer;
+        bool ok = simplifier(numVertices, &positions[0], simplified,
+            targetTriangles, std::numeric_limits<float>::max(), error);
+        double seconds = timer.GetSeconds();
+
+        ok = ok && IsValid(simplified, numVertices, targetTriangles);
+        if (numThreads == 1)
+        {
+            error1 = error;
+        }
+        else
+        {
+            // The clusters stop at a common error bound, so the error of
+            // the parallel simplification is close to the sequential one.
+            ok = ok && error <= 2.0f * error1;
+        }
+
+        std::cout << "  numThreads = " << numThreads << ": " << seconds
+            << " s, " << numTriangles / seconds / 1.0e+06 << " Mtri/s, "
+            << simplified.size() / 3 << " triangles, error " << error
+            << (ok ? "" : "  FAILED") << std::endl;
+        passed = passed && ok;
+    }
+    return passed;
+}
+//----------------------------------------------------------------------------
+bool TestLODChain(std::vector<Vector3<float>> const& positions,
+    std::vector<int> const& indices)
+{
+    int const numVertices = static_cast<int>(positions.size());
+    int const numTriangles = static_cast<int>(indices.size() / 3);
+    int const numLevels = 8;
+    std::cout << "chain of " << numLevels << " levels of detail"
+        << std::endl;
+
+    MeshSimplifier<float> simplifier(std::make_shared<ComputeModel>(
+        std::max(std::thread::hardware_concurrency(), 1u)));
+    std::vector<MeshSimplifier<float>::Level> levels;
+    Timer timer;
+    bool passed = simplifier.GenerateLODChain(numVertices, &positions[0],
+        indices, numLevels, 0.5f, std::numeric_limits<float>::max(),
+        levels);
+    double seconds = timer.GetSeconds();
+    passed = passed && static_cast<int>(levels.size()) == numLevels;
+
+    std::cout << "  " << seconds << " s, " << numTriangles / seconds / 1.0e+06
+        << " Mtri/s" << std::endl;
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        int maxTriangles = static_cast<int>(
+            std::ceil(numTriangles * std::pow(0.5, (double)i)));
+        bool ok = IsValid(levels[i].indices, numVertices, maxTriangles);
+        if (i > 0)
+        {
+            ok = ok && levels[i].error >= levels[i - 1].error;
+        }
+        std::cout << "  level " << i << ": "
+            << levels[i].indices.size() / 3 << " triangles, error "
+            << levels[i].error << (ok ? "" : "  FAILED") << std::endl;
+        passed = passed && ok;
+    }
+    return passed;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(4);
+    std::vector<Vector3<float>> positions;
+    std::vector<int> indices;
+    CreateSphere(512, positions, indices);
+
+    bool passed = TestSimplify(positions, indices);
+    passed = TestLODChain(positions, indices) && passed;
+    std::cout << (passed ? "all tests passed" : "some tests FAILED")
+        << std::endl;
+    return passed ? 0 : 1;
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <ObjLoader.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+using namespace gte;
+
+// Tests of the vertex references of ObjLoader.  Each test writes an OBJ
+// file to the working directory, loads it and compares the error code with
+// the expected one.  The small files test the v, v/vt, v//vn and v/vt/vn
+// forms, relative (negative) references, and references outside the
+// elements of the file, which must fail with EC_INVALID_VERTEX.  The large
+// files are split into several chunks that are parsed in parallel, so
+// their relative references are resolved across chunks, and a reference
+// outside the file in the last chunk must still be detected.
+//
+// ObjLoader asserts when a load fails, so the tests of invalid files are
+// run only when NDEBUG is defined (the Release configurations).  The
+// program returns a nonzero value when a test fails.
+
+//----------------------------------------------------------------------------
+std::string const filename = "ObjLoaderTest.obj";
+
+bool Test(char const* name, std::string const& text,
+    ObjLoader::ErrorCode expected)
+{
+#if !defined(NDEBUG)
+    if (expected != ObjLoader::EC_SUCCESSFUL)
+    {
+        std::cout << name << ": skipped in a debug build" << std::endl;
+        return true;
+    }
+#endif
+
+    std::ofstream output(filename, std::ios::binary);
+    output << text;
+    output.close();
+
+    ObjLoader loader("", filename);
+    bool ok = (loader.GetCode() == expected);
+    std::cout << name << ": code " << loader.GetCode()
+        << (ok ? "" : "  FAILED") << std::endl;
+    return ok;
+}
+//----------------------------------------------------------------------------
+bool TestLarge()
+{
+    // Each triangle has its own three vertices, referenced relative to the
+    // end of the vertices, so the position indices of the triangles are
+    // 0, 1, 2, ... in file order.
+    int const numTriangles = 60000;
+    std::ostringstream text;
+    for (int t = 0; t < numTriangles; ++t)
+    {
+        text << "v " << t << " 0 0\nv " << t << " 1 0\nv " << t
+            << " 0 1\nf -3 -2 -1\n";
+    }
+    std::string const valid = text.str();
+    bool passed = Test("large file", valid, ObjLoader::EC_SUCCESSFUL);
+
+    ObjLoader loader("", filename);
+    int index = 0;
+    for (auto const& group : loader.GetGroups())
+    {
+        for (auto const& mesh : group.Meshes)
+        {
+            for (auto const& vertex : mesh.Vertices)
+            {
+                passed = passed && vertex.PosIndex == index++;
+            }
+        }
+    }
+    bool ok = (index == 3 * numTriangles);
+    std::cout << "large file indices" << (ok ? "" : "  FAILED")
+        << std::endl;
+    passed = passed && ok;
+
+    std::ostringstream invalid;
+    invalid << valid << "f 1 2 " << 3 * numTriangles + 1 << "\n";
+    passed = Test("large file, position out of range", invalid.str(),
+        ObjLoader::EC_INVALID_VERTEX) && passed;
+    return passed;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::string const triangle = "v 0 0 0\nv 1 0 0\nv 0 1 0\n";
+    bool passed = Test("v/vt/vn",
+        triangle + "vt 0 0\nvn 0 0 1\nf 1 2/1 3//1 1/1/1\n",
+        ObjLoader::EC_SUCCESSFUL);
+    passed = Test("relative",
+        triangle + "f -3 -2 -1\nv 1 1 0\nf -3 -2 -1\n",
+        ObjLoader::EC_SUCCESSFUL) && passed;
+    passed = Test("position out of range",
+        "v 0 0 0\nf 1 2 9\n",
+        ObjLoader::EC_INVALID_VERTEX) && passed;
+    passed = Test("texture coordinate out of range",
+        triangle + "vt 0 0\nf 1/1 2/2 3/1\n",
+        ObjLoader::EC_INVALID_VERTEX) && passed;
+    passed = Test("normal out of range",
+        triangle + "f 1//1 2//1 3//1\n",
+        ObjLoader::EC_INVALID_VERTEX) && passed;
+    passed = Test("relative out of range",
+        triangle + "f -4 -2 -1\n",
+        ObjLoader::EC_INVALID_VERTEX) && passed;
+    passed = Test("zero",
+        triangle + "f 0 1 2\n",
+        ObjLoader::EC_INVALID_VERTEX) && passed;
+    passed = TestLarge() && passed;
+
+    std::cout << (passed ? "all tests passed" : "some tests FAILED")
+        << std::endl;
+    return passed ? 0 : 1;
+}
+//----------------------------------------------------------------------------
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/11/17)
 
 #include "VideoStream.h"
 using namespace gte;
@@ -19,6 +19,8 @@ VideoStream::VideoStream(DX11Engine* engine)
     mType(DF_UNKNOWN),
     mWidth(0),
     mHeight(0),
+    mNumPoolFrames(4),
+    mNumDroppedFrames(0),
     mPerformanceFrames(0),
     mPerformanceTicks(0)
 {
@@ -56,14 +58,34 @@ void VideoStream::CaptureFrame()
     char* data = GetImage();
     if (data)
     {
-        // The texture is created without system memory.  The derived class
-        // provides this data, so the texture is given temporary access to
-        // it in order for the Bind(...) call to copy the data to the GPU.
-        mFrame.image.reset(
-            new Texture2(mType, mWidth, mHeight, false, false));
-        mFrame.image->SetData(data);
-        mEngine->Bind(mFrame.image);
-        mFrame.image->SetData(nullptr);
+        if (!mFramePool)
+        {
+            CreateFramePool();
+        }
+
+        unsigned int slot;
+        if (mFramePool->available.Pop(slot))
+        {
+            // No other frame uses the texture, so its system memory can be
+            // written on this thread.  The consumer copies it to the GPU
+            // with Upload(...).
+            std::shared_ptr<Texture2> const& texture =
+                mFramePool->textures[slot];
+            memcpy(texture->GetData(), data, texture->GetNumBytes());
+
+            // The frame does not own the texture.  When its last reference
+            // is released, the deleter returns the texture to the pool.
+            std::shared_ptr<FramePool> pool = mFramePool;
+            mFrame.image.reset(texture.get(), [pool, slot](Texture2*)
+            {
+                pool->available.Push(slot);
+            });
+        }
+        else
+        {
+            // The consumer still holds all the other textures.
+            ++mNumDroppedFrames;
+        }
     }
     // else: GetImage has signaled that there is no image available.
 
@@ -74,6 +96,46 @@ void VideoStream::CaptureFrame()
     ++mPerformanceFrames;
 }
 //----------------------------------------------------------------------------
+void VideoStream::Upload(Frame const& frame) const
+{
+    if (frame.image)
+    {
+        mEngine->Update(frame.image);
+    }
+}
+//----------------------------------------------------------------------------
+void VideoStream::SetNumPoolFrames(unsigned int numPoolFrames)
+{
+    // The pool is recreated on the next capture.  Textures of the old pool
+    // that are still in use are destroyed when their frames are released.
+    mNumPoolFrames = std::max(numPoolFrames, 2u);
+    mFramePool = nullptr;
+}
+//----------------------------------------------------------------------------
+unsigned int VideoStream::GetNumPoolFrames() const
+{
+    return mNumPoolFrames;
+}
+//----------------------------------------------------------------------------
+unsigned int VideoStream::GetNumDroppedFrames() const
+{
+    return mNumDroppedFrames;
+}
+//----------------------------------------------------------------------------
+void VideoStream::CreateFramePool()
+{
+    mFramePool = std::make_shared<FramePool>(mNumPoolFrames);
+    for (unsigned int i = 0; i < mNumPoolFrames; ++i)
+    {
+        std::shared_ptr<Texture2> texture(
+            new Texture2(mType, mWidth, mHeight, false, true));
+        texture->SetUsage(Resource::DYNAMIC_UPDATE);
+        mEngine->Bind(texture);
+        mFramePool->textures[i] = texture;
+        mFramePool->available.Push(i);
+    }
+}
+//----------------------------------------------------------------------------
 void VideoStream::ResetPerformanceMeasurements()
 {
     mPerformanceFrames = 0;
@@ -111,3 +173,14 @@ double VideoStream::GetSecondsPerFrame() const
     return 0.0;
 }
 //----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// VideoStream::FramePool
+//----------------------------------------------------------------------------
+VideoStream::FramePool::FramePool(unsigned int numFrames)
+    :
+    textures(numFrames),
+    available(numFrames)
+{
+}
+//----------------------------------------------------------------------------
@@ -3,12 +3,14 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/11/17)
 
 #pragma once
 
 #include <GteDX11Engine.h>
+#include <GteLockFreeQueue.h>
 #include <GteTimer.h>
+#include <atomic>
 
 class VideoStream
 {
@@ -25,7 +27,15 @@ public:
 
     // A frame consists of a frame number (unique identifier), the image data
     // represented as a texture, and the time (in ticks) to acquire the image
-    // and copy it to GPU memory.
+    // and copy it to the texture's system memory.  The texture belongs to a
+    // fixed pool of textures of the video stream.  It is returned to the
+    // pool when the last copy of the frame's shared_ptr is released, so a
+    // consumer must not hold on to more than a few frames of a stream.
+    //
+    // CaptureFrame may be called on any thread, but the immediate context
+    // of the engine is not thread-safe, so the capture does not copy the
+    // image to GPU memory.  The consumer must call Upload(frame) on the
+    // thread that draws with the engine before drawing the texture.
     struct Frame
     {
         Frame() : number(0xFFFFFFFF), ticks(0) {}
@@ -40,10 +50,25 @@ public:
     Frame GetFrame() const;
 
     // Support for production of a single frame.  The function assigns values
-    // to the current frame.  It returns 'true' iff the production was
-    // successful (a malformed file can lead to a failed read of data).
+    // to the current frame.  If all the textures of the pool are in use, the
+    // image is dropped and the current frame is unchanged.
     void CaptureFrame();
 
+    // Copy the image of the frame from the texture's system memory to GPU
+    // memory.  This must be called on the thread that draws with the
+    // engine.
+    void Upload(Frame const& frame) const;
+
+    // The number of textures in the pool.  The pool is created on the first
+    // capture, when the derived class has set the type and size.  The stream
+    // holds one texture for its current frame; the other textures are for
+    // frames in flight to the consumer (see VideoStreamManager).
+    void SetNumPoolFrames(unsigned int numPoolFrames);
+    unsigned int GetNumPoolFrames() const;
+
+    // The number of images dropped because the pool had no free texture.
+    unsigned int GetNumDroppedFrames() const;
+
     // Performance measurements.  These are accumulated measurements starting
     // from a call to ResetPerformanceMeasurements().
     void ResetPerformanceMeasurements();
@@ -61,8 +86,9 @@ protected:
     // 'void CaptureFrame ()' call.
     virtual char* GetImage() = 0;
 
-    // The engine that is used to upload textures to GPU memory and the
-    // texture information.  The derived class must see these four members.
+    // The engine that is used to create the textures and upload them to GPU
+    // memory and the texture information.  The derived class must see these
+    // four members.
     gte::DX11Engine* mEngine;
     gte::DFType mType;
     unsigned int mWidth;
@@ -73,6 +99,24 @@ protected:
     Frame mFrame;
     gte::Timer mProductionTimer;
 
+    // The pool of textures.  The textures are created with system memory and
+    // DYNAMIC_UPDATE usage and are bound once, after which a capture only
+    // copies the image to the system memory of a free texture and Upload
+    // copies it to GPU memory.  The frames share ownership of the pool, so
+    // it remains valid when frames outlive the video stream.
+    struct FramePool
+    {
+        FramePool(unsigned int numFrames);
+        std::vector<std::shared_ptr<gte::Texture2>> textures;
+        gte::LockFreeQueue<unsigned int> available;
+    };
+
+    void CreateFramePool();
+
+    std::shared_ptr<FramePool> mFramePool;
+    unsigned int mNumPoolFrames;
+    std::atomic<unsigned int> mNumDroppedFrames;
+
     // Performance measurements.
     gte::Timer mPerformanceTimer;
     unsigned int mPerformanceFrames;
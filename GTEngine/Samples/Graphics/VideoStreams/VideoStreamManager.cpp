@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.2 (2014/11/17)
 
 #include "VideoStreamManager.h"
 using namespace gte;
@@ -15,16 +15,21 @@ VideoStreamManager::~VideoStreamManager()
 }
 //----------------------------------------------------------------------------
 VideoStreamManager::VideoStreamManager(
-    std::vector<VideoStream*> const& videoStreams, size_t maxQueueElements)
+    std::vector<VideoStream*> const& videoStreams)
     :
     mVideoStreams(videoStreams),
-    mFrameQueue(maxQueueElements),
+    mBuffers(3, Frame(videoStreams.size())),
+    mWrite(0),
+    mRead(1),
+    mMiddle(2),
+    mCaptured(videoStreams.size()),
     mCurrentFrame(0),
     mTrigger(nullptr),
     mPerformanceFrames(0),
     mPerformanceTicks(0),
     mAccumulatedVSMTicks(0),
-    mAccumulatedVSTicks(videoStreams.size())
+    mAccumulatedVSTicks(videoStreams.size()),
+    mLatencies(videoStreams.size())
 {
     ResetPerformanceMeasurements();
 }
@@ -34,9 +39,41 @@ std::vector<VideoStream*> const& VideoStreamManager::GetVideoStreams() const
     return mVideoStreams;
 }
 //----------------------------------------------------------------------------
-bool VideoStreamManager::GetFrame(Frame& frame) const
+bool VideoStreamManager::GetFrame(Frame& frame)
 {
-    return mFrameQueue.Pop(frame);
+    if ((mMiddle.load(std::memory_order_relaxed) & FRESH) == 0)
+    {
+        return false;
+    }
+
+    // Swap the read buffer with the middle buffer.  The acquire ordering
+    // makes the producer's writes to the frame visible.
+    mRead = mMiddle.exchange(mRead, std::memory_order_acq_rel) & ~FRESH;
+    frame = mBuffers[mRead];
+
+    int64_t const received = mProductionTimer.GetTicks();
+    size_t const numVideoStreams = mVideoStreams.size();
+    for (size_t i = 0; i < numVideoStreams; ++i)
+    {
+        if (frame.frames[i].image)
+        {
+            mVideoStreams[i]->Upload(frame.frames[i]);
+
+            Latency& latency = mLatencies[i];
+            int64_t const ticks = received - frame.captured[i];
+            if (latency.numFrames > 0)
+            {
+                int64_t const difference = ticks - latency.previousTicks;
+                latency.sumJitterTicks +=
+                    (difference >= 0 ? difference : -difference);
+            }
+            latency.sumTicks += ticks;
+            latency.maxTicks = std::max(latency.maxTicks, ticks);
+            latency.previousTicks = ticks;
+            ++latency.numFrames;
+        }
+    }
+    return true;
 }
 //----------------------------------------------------------------------------
 void VideoStreamManager::CaptureFrameSerial()
@@ -48,6 +85,7 @@ void VideoStreamManager::CaptureFrameSerial()
     for (size_t i = 0; i < numVideoStreams; ++i)
     {
         mVideoStreams[i]->CaptureFrame();
+        mCaptured[i] = mProductionTimer.GetTicks();
     }
 
     AssembleFullFrame(startTicks);
@@ -57,25 +95,24 @@ void VideoStreamManager::CaptureFrameParallel()
 {
     int64_t startTicks = mProductionTimer.GetTicks();
 
-    // Launch capture threads for all video streams.
+    // Capture the frames using the persistent threads of the thread pool.
+    // The calling thread captures frames while it waits.
     size_t const numVideoStreams = mVideoStreams.size();
-    std::vector<std::thread> captureThread(numVideoStreams);
+    ThreadPool::TaskGroup group(ThreadPool::GetDefault());
     for (size_t i = 0; i < numVideoStreams; ++i)
     {
-        captureThread[i] = std::thread
+        group.Run
         (
             [this, i]()
             {
                 mVideoStreams[i]->CaptureFrame();
+                mCaptured[i] = mProductionTimer.GetTicks();
             }
         );
     }
 
     // Wait for all video streams to capture their images.
-    for (size_t i = 0; i < numVideoStreams; ++i)
-    {
-        captureThread[i].join();
-    }
+    group.Wait();
 
     AssembleFullFrame(startTicks);
 }
@@ -165,6 +202,11 @@ void VideoStreamManager::ResetPerformanceMeasurements()
     {
         ticks = 0;
     }
+
+    for (auto& latency : mLatencies)
+    {
+        latency = Latency();
+    }
 }
 //----------------------------------------------------------------------------
 unsigned int VideoStreamManager::GetPerformanceFrames() const
@@ -230,19 +272,51 @@ void VideoStreamManager::GetStatistics(double& averageTime,
     }
 }
 //----------------------------------------------------------------------------
+void VideoStreamManager::GetStreamStatistics(
+    std::vector<StreamStatistics>& statistics) const
+{
+    size_t const numVideoStreams = mVideoStreams.size();
+    statistics.resize(numVideoStreams);
+    for (size_t i = 0; i < numVideoStreams; ++i)
+    {
+        Latency const& latency = mLatencies[i];
+        StreamStatistics& stat = statistics[i];
+        stat.averageLatency = 0.0;
+        stat.maximumLatency = 0.0;
+        stat.jitter = 0.0;
+        if (latency.numFrames > 0)
+        {
+            double const msecs = 1000.0 * mPerformanceTimer.GetSeconds(
+                latency.sumTicks);
+            stat.averageLatency = msecs / latency.numFrames;
+            stat.maximumLatency = 1000.0 * mPerformanceTimer.GetSeconds(
+                latency.maxTicks);
+        }
+        if (latency.numFrames > 1)
+        {
+            double const msecs = 1000.0 * mPerformanceTimer.GetSeconds(
+                latency.sumJitterTicks);
+            stat.jitter = msecs / (latency.numFrames - 1);
+        }
+        stat.numDroppedFrames = mVideoStreams[i]->GetNumDroppedFrames();
+    }
+}
+//----------------------------------------------------------------------------
 void VideoStreamManager::AssembleFullFrame(int64_t startTicks)
 {
+    // Assemble the frame in the write buffer.  The vectors were allocated
+    // by the constructor, so this only copies the stream frames.
     size_t const numVideoStreams = mVideoStreams.size();
-    Frame full(numVideoStreams);
+    Frame& full = mBuffers[mWrite];
     for (size_t i = 0; i < numVideoStreams; ++i)
     {
         full.frames[i] = mVideoStreams[i]->GetFrame();
+        full.captured[i] = mCaptured[i];
     }
 
     int64_t finalTicks = mProductionTimer.GetTicks();
     full.number = mCurrentFrame++;
     full.ticks = finalTicks - startTicks;
-    mFrameQueue.Push(full);
 
     mPerformanceTicks = mPerformanceTimer.GetTicks();
     ++mPerformanceFrames;
@@ -252,5 +326,25 @@ void VideoStreamManager::AssembleFullFrame(int64_t startTicks)
     {
         mAccumulatedVSTicks[i] += full.frames[i].ticks;
     }
+
+    // Publish the frame by swapping the write buffer with the middle
+    // buffer.  The release ordering makes the writes to the frame visible
+    // to the consumer.
+    mWrite = mMiddle.exchange(mWrite | FRESH, std::memory_order_acq_rel) &
+        ~FRESH;
+}
+//----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// VideoStreamManager::Latency
+//----------------------------------------------------------------------------
+VideoStreamManager::Latency::Latency()
+    :
+    numFrames(0),
+    sumTicks(0),
+    maxTicks(0),
+    sumJitterTicks(0),
+    previousTicks(0)
+{
 }
 //----------------------------------------------------------------------------
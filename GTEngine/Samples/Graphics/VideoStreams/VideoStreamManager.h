@@ -3,12 +3,13 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.3 (2014/11/17)
 
 #pragma once
 
-#include <GteThreadSafeQueue.h>
+#include <GteThreadPool.h>
 #include "VideoStream.h"
+#include <atomic>
 #include <thread>
 
 class VideoStreamManager
@@ -16,32 +17,46 @@ class VideoStreamManager
 public:
     // Construction and destruction.  The input videoStreams must have at
     // least one element and all elements must be nonnull.  NOTE:  No
-    // error checking is performed for this condition.  The manager maintains
-    // a queue of pending frames to process.  You must specify the maximum
-    // number.  In the producer-consumer model where the producer and
-    // consumer keep up with each other, the number of elements in the queue
-    // is 0 or 1.
+    // error checking is performed for this condition.  The frames are
+    // handed to the consumer by triple buffering:  the producer assembles
+    // a frame in its own buffer and then swaps it with the middle buffer,
+    // and the consumer swaps its buffer with the middle buffer when that
+    // contains a new frame.  Neither waits for the other, and the consumer
+    // always gets the most recent frame; frames that are replaced before
+    // the consumer asks for them are skipped.
     ~VideoStreamManager();
-    VideoStreamManager(std::vector<VideoStream*> const& videoStreams,
-        size_t maxQueueElements);
+    VideoStreamManager(std::vector<VideoStream*> const& videoStreams);
 
     // Access to the managed video streams.
     std::vector<VideoStream*> const& GetVideoStreams() const;
 
     // A frame consists of a frame number (unique identifier), a collection of
-    // frames from the video streams, and the time (in ticks) to capture all
-    // frames from the video streams.
+    // frames from the video streams, the time (in ticks) to capture all
+    // frames from the video streams, and the times (in ticks of the
+    // production timer) at which the capture of each stream finished.
     struct Frame
     {
-        Frame(size_t n) : number(0xFFFFFFFF), frames(n), ticks(0) {}
+        Frame(size_t n)
+            :
+            number(0xFFFFFFFF),
+            frames(n),
+            ticks(0),
+            captured(n, 0)
+        {
+        }
+
         unsigned int number;
         std::vector<VideoStream::Frame> frames;
         int64_t ticks;
+        std::vector<int64_t> captured;
     };
 
-    // Get the current frame.  The return value is 'true' iff the frame
-    // queue is not empty, in which case 'frame' is valid.
-    bool GetFrame(Frame& frame) const;
+    // Get the most recent frame.  The return value is 'true' iff a frame
+    // was produced since the previous call, in which case 'frame' is valid
+    // and its textures have been copied to GPU memory.  Only one thread may
+    // call this function, and it must be the thread that draws with the
+    // engine.
+    bool GetFrame(Frame& frame);
 
     // Support for production of a single frame of a collection of video
     // streams.  The functions return 'true' iff the prodcution was successful
@@ -50,8 +65,9 @@ public:
     // Capture an image from each video stream so that they run in series.
     void CaptureFrameSerial();
 
-    // Launch a thread per video stream so that they effectively run in
-    // parallel and then wait until all are finished (for synchronization).
+    // Capture an image from each video stream as a task of the process-wide
+    // thread pool so that they effectively run in parallel and then wait
+    // until all are finished (for synchronization).
     void CaptureFrameParallel();
 
     // The following functions allow the capture functions to be called at the
@@ -79,6 +95,20 @@ public:
     void GetStatistics(double& averageTime, double& averageVSMTime,
         std::vector<double>& averageVSTime);
 
+    // Per-stream statistics of the frames received by GetFrame, in
+    // milliseconds.  The latency is the time from the end of the capture of
+    // the stream's image to the GetFrame call that returns it.  The jitter
+    // is the average absolute difference of the latencies of consecutive
+    // frames.  The number of dropped frames is that of the video stream.
+    struct StreamStatistics
+    {
+        double averageLatency, maximumLatency, jitter;
+        unsigned int numDroppedFrames;
+    };
+
+    void GetStreamStatistics(std::vector<StreamStatistics>& statistics)
+        const;
+
 protected:
     // Common code for captures.
     void AssembleFullFrame(int64_t startTicks);
@@ -86,8 +116,18 @@ protected:
     // The managed video streams.
     std::vector<VideoStream*> mVideoStreams;
 
-    // The queue of frames to process.
-    mutable gte::ThreadSafeQueue<Frame> mFrameQueue;
+    // Triple buffering of the frames.  The producer owns mBuffers[mWrite]
+    // and the consumer owns mBuffers[mRead].  The low bits of mMiddle are
+    // the index of the third buffer, and the FRESH bit is set when that
+    // buffer has a frame the consumer has not seen.
+    enum { FRESH = 4 };
+    std::vector<Frame> mBuffers;
+    int mWrite, mRead;
+    std::atomic<int> mMiddle;
+
+    // The times at which the capture of each stream finished, written by
+    // the capture tasks.
+    std::vector<int64_t> mCaptured;
 
     // The timer is used to compute how long it takes to produce the frame.
     // The current frame counter is used for the Frame.number member.
@@ -110,4 +150,13 @@ protected:
     int64_t mPerformanceTicks;
     int64_t mAccumulatedVSMTicks;
     std::vector<int64_t> mAccumulatedVSTicks;
+
+    // Latency measurements, accessed only by the consumer thread.
+    struct Latency
+    {
+        Latency();
+        unsigned int numFrames;
+        int64_t sumTicks, maxTicks, sumJitterTicks, previousTicks;
+    };
+    std::vector<Latency> mLatencies;
 };
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.0 (2014/08/11)
+// File Version: 1.0.1 (2014/11/17)
 
 #include "VideoStreamsWindow.h"
 
@@ -103,7 +103,7 @@ VideoStreamsWindow::VideoStreamsWindow (Parameters& parameters)
         std::string name = prefix + std::to_string(i) + ".raw";
         mVideoStreams[i] = new FileVideoStream(name, mEngine);
     }
-    mVideoStreamManager = new VideoStreamManager(mVideoStreams, 30);
+    mVideoStreamManager = new VideoStreamManager(mVideoStreams);
 
 #ifdef DO_TRIGGERED_SERIAL
     mVideoStreamManager->StartTriggeredCapture(30.0, false);
@@ -216,8 +216,23 @@ void VideoStreamsWindow::DrawStatistics ()
     mVideoStreamManager->GetStatistics(averageTime, averageVSMTime,
         averageVSTime);
 
-    std::string message = Environment::CreateString("frame: %u",
-        mCurrent.number);
+    std::vector<VideoStreamManager::StreamStatistics> streamStatistics;
+    mVideoStreamManager->GetStreamStatistics(streamStatistics);
+
+    std::string message = Environment::CreateString(
+        "vs latency/jitter msec: ");
+    for (int i = 0; i < NUM_VIDEO_STREAMS; ++i)
+    {
+        VideoStreamManager::StreamStatistics const& stat =
+            streamStatistics[i];
+        message += Environment::CreateString(
+            ", vs%d = %.1lf (max %.1lf) / %.1lf, dropped %u ", i,
+            stat.averageLatency, stat.maximumLatency, stat.jitter,
+            stat.numDroppedFrames);
+    }
+    mEngine->Draw(8, mYSize - 72, mTextColor, message);
+
+    message = Environment::CreateString("frame: %u", mCurrent.number);
     mEngine->Draw(8, mYSize - 56, mTextColor, message);
 
     message = Environment::CreateString("vsm average frame msec: %.1lf",
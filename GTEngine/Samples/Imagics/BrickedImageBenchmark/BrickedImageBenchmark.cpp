@@ -0,0 +1,247 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+using namespace gte;
+
+// Compare the linear layout of Image3 with the bricked layout of
+// BrickedImage3 for stencil-heavy operations on a 256x253x261 image of
+// uint8_t voxels.  The dimensions are not multiples of the brick size, so
+// the boundary bricks are padded.
+//
+// 1. Conversions.  The times to copy the image to and from the bricked
+//    layout.
+//
+// 2. Dilation by the 3x3x3 cube, the 26-neighborhood stencil of
+//    ImageUtility3 and of SurfaceExtractor-style voxel classification.
+//    The linear image is filtered with clamped Get() accesses, as a direct
+//    stencil would be, and with ImageUtility3::DilateBox, which is
+//    separable.  The bricked image is filtered brick by brick from
+//    GetBrickWithApron for 8^3 and 16^3 bricks and for 1, 2, 4, ...
+//    threads.  All results must equal the direct linear result.
+//
+// 3. Trilinear interpolation, as in IntpTrilinear3, at the samples of rays
+//    marched along the z-axis, which is the worst case for the linear
+//    layout because consecutive samples are slices apart.  The sums of the
+//    interpolated values must be the same for both layouts.
+
+//----------------------------------------------------------------------------
+typedef Image3<uint8_t> LinearImage;
+
+template <int BrickLog>
+using BrickedImage = BrickedImage3<uint8_t, BrickLog>;
+
+void DilateLinear(LinearImage const& input, LinearImage& output)
+{
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    int const dim2 = input.GetDimension(2);
+    output.Resize(dim0, dim1, dim2);
+    for (int z = 0; z < dim2; ++z)
+    {
+        for (int y = 0; y < dim1; ++y)
+        {
+            for (int x = 0; x < dim0; ++x)
+            {
+                uint8_t value = 0;
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    for (int dy = -1; dy <= 1; ++dy)
+                    {
+                        for (int dx = -1; dx <= 1; ++dx)
+                        {
+                            value = std::max(value,
+                                input.Get(x + dx, y + dy, z + dz));
+                        }
+                    }
+                }
+                output(x, y, z) = value;
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <int BrickLog>
+void DilateBricked(BrickedImage<BrickLog> const& input,
+    BrickedImage<BrickLog>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    int const size = BrickedImage<BrickLog>::BRICK_SIZE;
+    int const n = size + 2;
+    output.Resize(input.GetDimension(0), input.GetDimension(1),
+        input.GetDimension(2));
+    output.ForEachBrick([&input, &output, size, n](int bx, int by, int bz)
+    {
+        // The apron is one voxel, so block[] has n^3 voxels.
+        std::vector<uint8_t> block(n * n * n), row(size);
+        input.GetBrickWithApron(bx, by, bz, 1, &block[0]);
+        uint8_t* brick = output.GetBrick(bx, by, bz);
+        for (int z = 0; z < size; ++z)
+        {
+            for (int y = 0; y < size; ++y)
+            {
+                std::fill(row.begin(), row.end(), (uint8_t)0);
+                for (int dz = 0; dz < 3; ++dz)
+                {
+                    for (int dy = 0; dy < 3; ++dy)
+                    {
+                        uint8_t const* source =
+                            &block[n * ((y + dy) + n * (z + dz))];
+                        for (int x = 0; x < size; ++x)
+                        {
+                            row[x] = std::max(row[x], std::max(source[x],
+                                std::max(source[x + 1], source[x + 2])));
+                        }
+                    }
+                }
+                std::copy(row.begin(), row.end(),
+                    brick + size * (y + size * z));
+            }
+        }
+    }, cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename Image>
+double Trilinear(Image const& image, double x, double y, double z)
+{
+    int ix = static_cast<int>(x), iy = static_cast<int>(y);
+    int iz = static_cast<int>(z);
+    double dx = x - ix, dy = y - iy, dz = z - iz;
+    double result = 0.0;
+    for (int k = 0; k < 2; ++k)
+    {
+        double wz = (k == 0 ? 1.0 - dz : dz);
+        for (int j = 0; j < 2; ++j)
+        {
+            double wy = (j == 0 ? 1.0 - dy : dy);
+            for (int i = 0; i < 2; ++i)
+            {
+                double wx = (i == 0 ? 1.0 - dx : dx);
+                result += wx * wy * wz * image(ix + i, iy + j, iz + k);
+            }
+        }
+    }
+    return result;
+}
+//----------------------------------------------------------------------------
+template <typename Image>
+double MarchRays(Image const& image, std::vector<double> const& origins)
+{
+    // Each ray starts at (x,y,0) and marches along z with step 1/2 to the
+    // last slice.
+    double const maxZ = image.GetDimension(2) - 1.0;
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < origins.size(); i += 2)
+    {
+        for (double z = 0.0; z < maxZ; z += 0.5)
+        {
+            sum += Trilinear(image, origins[i], origins[i + 1], z);
+        }
+    }
+    return sum;
+}
+//----------------------------------------------------------------------------
+template <int BrickLog>
+void TestBricked(LinearImage const& image, LinearImage const& dilated,
+    std::vector<double> const& origins)
+{
+    int const size = BrickedImage<BrickLog>::BRICK_SIZE;
+    std::cout << size << "^3 bricks" << std::endl;
+
+    Timer timer;
+    BrickedImage<BrickLog> bricked(image);
+    double msFrom = 1000.0 * timer.GetSeconds();
+    LinearImage linear;
+    timer.Reset();
+    bricked.CopyTo(linear);
+    double msTo = 1000.0 * timer.GetSeconds();
+    std::cout << "  conversion to bricks " << msFrom << " ms, from bricks "
+        << msTo << " ms" << std::endl;
+
+    unsigned int maxThreads = std::max(std::thread::hardware_concurrency(),
+        1u);
+    for (unsigned int numThreads = 1; numThreads <= maxThreads;
+        numThreads *= 2)
+    {
+        BrickedImage<BrickLog> output;
+        timer.Reset();
+        DilateBricked(bricked, output,
+            std::make_shared<ComputeModel>(numThreads));
+        double msDilate = 1000.0 * timer.GetSeconds();
+        output.CopyTo(linear);
+        bool same = std::equal(linear.GetPixels1D(),
+            linear.GetPixels1D() + linear.GetNumPixels(),
+            dilated.GetPixels1D());
+        std::cout << "  dilation, numThreads = " << numThreads << ": "
+            << msDilate << " ms" << (same ? "" : "  MISMATCH") << std::endl;
+    }
+
+    timer.Reset();
+    double sum = MarchRays(bricked, origins);
+    std::cout << "  ray marching " << 1000.0 * timer.GetSeconds()
+        << " ms, sum " << sum << std::endl;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    std::mt19937 mte;
+    std::uniform_int_distribution<int> rndVoxel(0, 255);
+    LinearImage image(256, 253, 261);
+    for (size_t i = 0; i < image.GetNumPixels(); ++i)
+    {
+        image[i] = static_cast<uint8_t>(rndVoxel(mte));
+    }
+
+    std::vector<double> origins(2 * 20000);
+    std::uniform_real_distribution<double> rndX(0.0,
+        image.GetDimension(0) - 1.0);
+    std::uniform_real_distribution<double> rndY(0.0,
+        image.GetDimension(1) - 1.0);
+    for (size_t i = 0; i < origins.size(); i += 2)
+    {
+        origins[i] = rndX(mte);
+        origins[i + 1] = rndY(mte);
+    }
+
+    std::cout << "linear layout" << std::endl;
+    LinearImage dilated, separable(image.GetDimension(0),
+        image.GetDimension(1), image.GetDimension(2));
+    Timer timer;
+    DilateLinear(image, dilated);
+    std::cout << "  dilation by Get " << 1000.0 * timer.GetSeconds()
+        << " ms" << std::endl;
+    timer.Reset();
+    ImageUtility3::DilateBox(image, 1, 1, 1, separable);
+    bool same = std::equal(separable.GetPixels1D(),
+        separable.GetPixels1D() + separable.GetNumPixels(),
+        dilated.GetPixels1D());
+    std::cout << "  dilation by ImageUtility3::DilateBox "
+        << 1000.0 * timer.GetSeconds() << " ms"
+        << (same ? "" : "  MISMATCH") << std::endl;
+    timer.Reset();
+    double sum = MarchRays(image, origins);
+    std::cout << "  ray marching " << 1000.0 * timer.GetSeconds()
+        << " ms, sum " << sum << std::endl;
+
+    TestBricked<3>(image, dilated, origins);
+    TestBricked<4>(image, dilated, origins);
+    return 0;
+}
+//----------------------------------------------------------------------------
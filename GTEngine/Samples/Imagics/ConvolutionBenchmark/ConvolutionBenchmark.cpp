@@ -0,0 +1,234 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+using namespace gte;
+
+// Measured throughput of the ImageConvolution methods, to check the cost
+// model that AUTOMATIC uses to choose a method.  A 512x512 float image is
+// convolved with Gaussian kernels (separable) and disk kernels (not
+// separable) of sizes 3 to 65, and a 96x96x96 image with Gaussian kernels
+// of sizes 3 to 9.  For each kernel, DIRECT, SEPARABLE, FFT and AUTOMATIC
+// are timed (the best of 3 runs), and the time and the pixels per second
+// are reported, along with the method that AUTOMATIC chose and the
+// requested method that was measured fastest.  SEPARABLE falls back to
+// DIRECT for a disk, which is reported.  The outputs of all methods must
+// agree with the output of DIRECT to within 1e-2, which allows for the
+// rounding errors of a single-precision FFT of 2^20 elements (about 2e-3).
+// The program returns a nonzero value when a test fails.
+
+//----------------------------------------------------------------------------
+typedef ImageConvolution<float> Convolution;
+
+char const* GetName(Convolution::Method method)
+{
+    static char const* names[] =
+    {
+        "AUTOMATIC",
+        "DIRECT",
+        "SEPARABLE",
+        "FFT"
+    };
+    return names[method];
+}
+//----------------------------------------------------------------------------
+std::vector<float> CreateGaussian(int size)
+{
+    int const radius = size / 2;
+    float const sigma = std::max(size / 6.0f, 0.5f);
+    std::vector<float> weights(size);
+    float sum = 0.0f;
+    for (int i = 0; i < size; ++i)
+    {
+        float x = (float)(i - radius) / sigma;
+        weights[i] = exp(-0.5f * x * x);
+        sum += weights[i];
+    }
+    for (auto& weight : weights)
+    {
+        weight /= sum;
+    }
+    return weights;
+}
+//----------------------------------------------------------------------------
+Image2<float> CreateGaussian2(int size)
+{
+    std::vector<float> weights = CreateGaussian(size);
+    Image2<float> kernel(size, size);
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            kernel(x, y) = weights[x] * weights[y];
+        }
+    }
+    return kernel;
+}
+//----------------------------------------------------------------------------
+Image2<float> CreateDisk2(int size)
+{
+    int const radius = size / 2;
+    Image2<float> kernel(size, size);
+    float sum = 0.0f;
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            int dx = x - radius, dy = y - radius;
+            bool inside = (dx * dx + dy * dy <= radius * radius);
+            kernel(x, y) = (inside ? 1.0f : 0.0f);
+            sum += kernel(x, y);
+        }
+    }
+    for (size_t i = 0; i < kernel.GetNumPixels(); ++i)
+    {
+        kernel[i] /= sum;
+    }
+    return kernel;
+}
+//----------------------------------------------------------------------------
+Image3<float> CreateGaussian3(int size)
+{
+    std::vector<float> weights = CreateGaussian(size);
+    Image3<float> kernel(size, size, size);
+    for (int z = 0; z < size; ++z)
+    {
+        for (int y = 0; y < size; ++y)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                kernel(x, y, z) = weights[x] * weights[y] * weights[z];
+            }
+        }
+    }
+    return kernel;
+}
+//----------------------------------------------------------------------------
+template <typename Image>
+bool TestKernel(char const* name, Image const& input, Image const& kernel,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    static Convolution::Method const methods[4] =
+    {
+        Convolution::DIRECT,
+        Convolution::SEPARABLE,
+        Convolution::FFT,
+        Convolution::AUTOMATIC
+    };
+
+    std::cout << name << " " << kernel.GetDimension(0) << std::endl;
+    size_t const numPixels = input.GetNumPixels();
+    Image reference(input), output(input);
+    Convolution::Method fastest = Convolution::DIRECT;
+    double minSeconds = std::numeric_limits<double>::max();
+    bool passed = true;
+    for (auto method : methods)
+    {
+        Convolution::Report report;
+        double seconds = std::numeric_limits<double>::max();
+        for (int run = 0; run < 3; ++run)
+        {
+            Timer timer;
+            Convolution::Convolve(input, kernel, Convolution::CLAMP, output,
+                method, cmodel, &report);
+            seconds = std::min(seconds, timer.GetSeconds());
+        }
+
+        float maxError = 0.0f;
+        if (method == Convolution::DIRECT)
+        {
+            reference = output;
+        }
+        else
+        {
+            for (size_t i = 0; i < numPixels; ++i)
+            {
+                maxError = std::max(maxError,
+                    std::abs(output[i] - reference[i]));
+            }
+        }
+        bool ok = (maxError <= 1e-2f);
+        passed = passed && ok;
+
+        std::cout << "  " << std::setw(9) << GetName(method) << ": "
+            << std::setw(8) << 1000.0 * seconds << " ms, "
+            << std::setw(8) << numPixels / seconds / 1.0e+06
+            << " Mpixels/s";
+        if (method == Convolution::AUTOMATIC || report.method != method)
+        {
+            std::cout << " (used " << GetName(report.method) << ")";
+        }
+        std::cout << (ok ? "" : "  MISMATCH") << std::endl;
+
+        if (method != Convolution::AUTOMATIC && report.method == method
+            && seconds < minSeconds)
+        {
+            minSeconds = seconds;
+            fastest = method;
+        }
+    }
+
+    Convolution::Report choice = Convolution::GetReport(input, kernel);
+    std::cout << "  cost model chose " << GetName(choice.method)
+        << ", measured fastest " << GetName(fastest) << std::endl;
+    return passed;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(2);
+    auto cmodel = std::make_shared<ComputeModel>(
+        std::max(std::thread::hardware_concurrency(), 1u));
+    std::mt19937 mte;
+    std::uniform_real_distribution<float> rnd(0.0f, 1.0f);
+    bool passed = true;
+
+    Image2<float> image2(512, 512);
+    for (size_t i = 0; i < image2.GetNumPixels(); ++i)
+    {
+        image2[i] = rnd(mte);
+    }
+    int const sizes2[] = { 3, 5, 9, 15, 25, 41, 65 };
+    for (auto size : sizes2)
+    {
+        passed = TestKernel("2D Gaussian", image2, CreateGaussian2(size),
+            cmodel) && passed;
+    }
+    for (auto size : sizes2)
+    {
+        passed = TestKernel("2D disk", image2, CreateDisk2(size), cmodel)
+            && passed;
+    }
+
+    Image3<float> image3(96, 96, 96);
+    for (size_t i = 0; i < image3.GetNumPixels(); ++i)
+    {
+        image3[i] = rnd(mte);
+    }
+    int const sizes3[] = { 3, 5, 9 };
+    for (auto size : sizes3)
+    {
+        passed = TestKernel("3D Gaussian", image3, CreateGaussian3(size),
+            cmodel) && passed;
+    }
+
+    std::cout << (passed ? "all tests passed" : "some tests FAILED")
+        << std::endl;
+    return passed ? 0 : 1;
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,112 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+using namespace gte;
+
+// Time the construction of a 256-bucket Histogram from 200 million samples,
+// the size of a 200-megapixel image, for 1, 2, 4, ... threads.  The int
+// samples are counted directly (no rescaling) and the float samples are
+// rescaled, which requires an extra pass for the extremes.  The buckets
+// must not depend on the number of threads, so they are compared with
+// those computed by one thread.  The samples are stored one array at a
+// time to limit the memory to 800 MB.
+
+//----------------------------------------------------------------------------
+Histogram* CreateHistogram(int numBuckets, std::vector<int> const& samples,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    return new Histogram(numBuckets, static_cast<int>(samples.size()),
+        samples.data(), true, cmodel);
+}
+//----------------------------------------------------------------------------
+Histogram* CreateHistogram(int numBuckets, std::vector<float> const& samples,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    return new Histogram(numBuckets, static_cast<int>(samples.size()),
+        samples.data(), cmodel);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void TestHistogram(char const* name, std::vector<Real> const& samples)
+{
+    std::cout << name << " samples" << std::endl;
+
+    int const numBuckets = 256;
+    int const numSamples = static_cast<int>(samples.size());
+    std::vector<int> buckets1;
+    unsigned int maxThreads = std::max(std::thread::hardware_concurrency(),
+        1u);
+    double seconds1 = 0.0;
+    for (unsigned int numThreads = 1; numThreads <= maxThreads;
+        numThreads *= 2)
+    {
+        auto cmodel = std::make_shared<ComputeModel>(numThreads);
+        Timer timer;
+        std::unique_ptr<Histogram> histogram(
+            CreateHistogram(numBuckets, samples, cmodel));
+        double seconds = timer.GetSeconds();
+
+        int const* buckets = histogram->GetBuckets();
+        bool same = true;
+        if (numThreads == 1)
+        {
+            buckets1.assign(buckets, buckets + numBuckets);
+            seconds1 = seconds;
+        }
+        else
+        {
+            same = std::equal(buckets1.begin(), buckets1.end(), buckets);
+        }
+
+        std::cout << "  numThreads = " << numThreads << ": " << seconds
+            << " s, " << numSamples / seconds / 1.0e+06
+            << " Msamples/s, speedup " << seconds1 / seconds
+            << (same ? "" : "  MISMATCH") << std::endl;
+    }
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(2);
+    int const numSamples = 200000000;
+    std::mt19937 mte;
+    {
+        // Pixel values of an 8-bit image, with a few out of range.
+        std::uniform_int_distribution<int> rnd(-2, 257);
+        std::vector<int> samples(numSamples);
+        for (auto& sample : samples)
+        {
+            sample = rnd(mte);
+        }
+        TestHistogram("int", samples);
+    }
+    {
+        // Exposure values of a high-dynamic-range image.
+        std::uniform_real_distribution<float> rnd(0.0f, 1.0f);
+        std::vector<float> samples(numSamples);
+        for (auto& sample : samples)
+        {
+            float value = rnd(mte);
+            sample = value * value * 1000.0f;
+        }
+        TestHistogram("float", samples);
+    }
+    return 0;
+}
+//----------------------------------------------------------------------------
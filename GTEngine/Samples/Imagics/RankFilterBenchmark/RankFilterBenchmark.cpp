@@ -0,0 +1,149 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+using namespace gte;
+
+// Compare ImageUtility2::RankFilter with a naive rank filter that applies
+// std::nth_element to every window, for 1024x1024 images of uint8_t,
+// uint16_t and float pixels and for radii from 1 to 40.  The times are for
+// the median and one thread.  The outputs of the two filters must be equal
+// for the median and for the rank at a quarter of the window.  The naive
+// filter costs O(radius^2) per pixel, so it is not run for the largest
+// radii, nor is RankFilter for float pixels, which uses the same
+// algorithm.  The last lines time RankFilter with all hardware threads.
+
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void NaiveRankFilter(Image2<PixelType> const& input, int radius, int rank,
+    Image2<PixelType>& output)
+{
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    std::vector<PixelType> window;
+    for (int y = 0; y < dim1; ++y)
+    {
+        for (int x = 0; x < dim0; ++x)
+        {
+            window.clear();
+            for (int dy = -radius; dy <= radius; ++dy)
+            {
+                int wy = std::min(std::max(y + dy, 0), dim1 - 1);
+                for (int dx = -radius; dx <= radius; ++dx)
+                {
+                    int wx = std::min(std::max(x + dx, 0), dim0 - 1);
+                    window.push_back(input(wx, wy));
+                }
+            }
+            std::nth_element(window.begin(), window.begin() + rank,
+                window.end());
+            output(x, y) = window[rank];
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+bool Equal(Image2<PixelType> const& image0, Image2<PixelType> const& image1)
+{
+    for (size_t i = 0; i < image0.GetNumPixels(); ++i)
+    {
+        if (image0[i] != image1[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void TestRadius(Image2<PixelType> const& input, int radius, bool runNaive,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    int const size = 2 * radius + 1;
+    int const median = (size * size - 1) / 2;
+    Image2<PixelType> output(input.GetDimension(0), input.GetDimension(1));
+
+    Timer timer;
+    ImageUtility2::RankFilter(input, radius, median, output, cmodel);
+    double msRank = 1000.0 * timer.GetSeconds();
+    std::cout << "  radius " << std::setw(2) << radius << ": RankFilter "
+        << std::setw(8) << msRank << " ms";
+
+    if (runNaive)
+    {
+        Image2<PixelType> naiveOutput(input.GetDimension(0),
+            input.GetDimension(1));
+        timer.Reset();
+        NaiveRankFilter(input, radius, median, naiveOutput);
+        double msNaive = 1000.0 * timer.GetSeconds();
+        bool equal = Equal(output, naiveOutput);
+
+        int const quarter = (size * size - 1) / 4;
+        ImageUtility2::RankFilter(input, radius, quarter, output, cmodel);
+        NaiveRankFilter(input, radius, quarter, naiveOutput);
+        equal = equal && Equal(output, naiveOutput);
+
+        std::cout << ", naive " << std::setw(9) << msNaive << " ms, speedup "
+            << std::setw(7) << msNaive / msRank
+            << (equal ? "" : "  MISMATCH");
+    }
+    std::cout << std::endl;
+}
+//----------------------------------------------------------------------------
+template <typename PixelType>
+void TestType(char const* name, int maxValue, int maxRadius,
+    int maxNaiveRadius)
+{
+    int const dim = 1024;
+    Image2<PixelType> input(dim, dim);
+    std::mt19937 mte;
+    std::uniform_int_distribution<int> rnd(0, maxValue);
+    for (size_t i = 0; i < input.GetNumPixels(); ++i)
+    {
+        input[i] = static_cast<PixelType>(rnd(mte));
+    }
+
+    std::cout << name << " pixels, " << dim << "x" << dim << std::endl;
+    int const radii[] = { 1, 2, 3, 5, 10, 20, 40 };
+    for (auto radius : radii)
+    {
+        if (radius <= maxRadius)
+        {
+            TestRadius(input, radius, radius <= maxNaiveRadius,
+                std::make_shared<ComputeModel>(1));
+        }
+    }
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads > 1)
+    {
+        std::cout << " numThreads = " << numThreads << std::endl;
+        TestRadius(input, std::min(maxRadius, 10), false,
+            std::make_shared<ComputeModel>(numThreads));
+    }
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(1);
+    TestType<uint8_t>("uint8_t", 255, 40, 10);
+    TestType<uint16_t>("uint16_t", 65535, 40, 10);
+    TestType<float>("float", 65535, 10, 10);
+    return 0;
+}
+//----------------------------------------------------------------------------
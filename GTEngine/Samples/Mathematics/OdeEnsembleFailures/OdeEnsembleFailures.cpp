@@ -0,0 +1,119 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+using namespace gte;
+
+// Failures of systems in an OdeEnsemble integrated by the adaptive method
+// METHOD_RUNGE_KUTTA_45.  The ensemble has 1024 harmonic oscillators
+// x'' = -w^2*x with x(0) = 1 and x'(0) = 0, whose solution is cos(w*t).
+// The derivative of one system becomes NaN at t = 0.5 and that of another
+// is infinite from the start.  Update must return with only these two
+// systems failed, their states those of their last accepted steps (so
+// finite), and the other systems accurate.  The test is run for 1 and 4
+// threads and for two consecutive updates.  The program returns a nonzero
+// value when a test fails.
+
+//----------------------------------------------------------------------------
+int const numSystems = 1024;
+int const nanSystem = 100;
+int const infSystem = 200;
+
+double GetFrequency(int s)
+{
+    return 1.0 + 0.01 * s;
+}
+//----------------------------------------------------------------------------
+void F(int smin, int smax, double const* time, double const* state,
+    double* derivative)
+{
+    // Component 0 is the position and component 1 is the velocity.
+    for (int s = smin; s <= smax; ++s)
+    {
+        double w = GetFrequency(s);
+        derivative[s] = state[numSystems + s];
+        derivative[numSystems + s] = -w * w * state[s];
+        if (s == nanSystem && time[s] > 0.5)
+        {
+            derivative[numSystems + s] =
+                std::numeric_limits<double>::quiet_NaN();
+        }
+        else if (s == infSystem)
+        {
+            derivative[s] = std::numeric_limits<double>::infinity();
+        }
+    }
+}
+//----------------------------------------------------------------------------
+bool Test(unsigned int numThreads)
+{
+    std::cout << "numThreads = " << numThreads << std::endl;
+    OdeEnsemble<double> ensemble(numSystems, 2, 1.0, F,
+        std::make_shared<ComputeModel>(numThreads));
+    ensemble.SetMethod(OdeEnsemble<double>::METHOD_RUNGE_KUTTA_45);
+    ensemble.SetTolerance(1e-9, 1e-9, 1e-6);
+    for (int s = 0; s < numSystems; ++s)
+    {
+        double x[2] = { 1.0, 0.0 };
+        ensemble.SetState(s, x);
+    }
+
+    bool passed = true;
+    double tIn = 0.0, tOut;
+    for (int update = 0; update < 2; ++update, tIn = tOut)
+    {
+        Timer timer;
+        ensemble.Update(tIn, tOut);
+        double milliseconds = 1000.0 * timer.GetSeconds();
+
+        bool ok = true;
+        double maxError = 0.0;
+        for (int s = 0; s < numSystems; ++s)
+        {
+            double x[2];
+            ensemble.GetState(s, x);
+            bool failed = ensemble.HasFailed(s);
+            if (s == nanSystem || s == infSystem)
+            {
+                ok = ok && failed && std::isfinite(x[0])
+                    && std::isfinite(x[1]);
+            }
+            else
+            {
+                double error = std::abs(x[0] - cos(GetFrequency(s) * tOut));
+                maxError = std::max(maxError, error);
+                ok = ok && !failed && error <= 1e-6;
+            }
+        }
+
+        std::cout << "  update to t = " << tOut << ": " << milliseconds
+            << " ms, max error " << maxError << (ok ? "" : "  FAILED")
+            << std::endl;
+        passed = passed && ok;
+    }
+    return passed;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::scientific << std::setprecision(3);
+    bool passed = Test(1);
+    passed = Test(4) && passed;
+    std::cout << (passed ? "all tests passed" : "some tests FAILED")
+        << std::endl;
+    return passed ? 0 : 1;
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,80 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+using namespace gte;
+
+// Measure the simulation steps per second of Fluid3CPU on 128^3 and 256^3
+// grids for 1, 2, 4, ... threads.  The time step is that of the Fluids3D
+// sample.  The state after the steps must not depend on the number of
+// threads, so it is compared with the state computed by one thread.
+
+//----------------------------------------------------------------------------
+void TestFluid(int size, int numSteps)
+{
+    std::cout << size << "^3 grid, " << numSteps << " steps" << std::endl;
+
+    std::vector<float> state1;
+    unsigned int maxThreads = std::max(std::thread::hardware_concurrency(),
+        1u);
+    for (unsigned int numThreads = 1; numThreads <= maxThreads;
+        numThreads *= 2)
+    {
+        Fluid3CPU fluid(size, size, size, 0.002f,
+            std::make_shared<ComputeModel>(numThreads));
+
+        Timer timer;
+        fluid.Initialize();
+        double initializeSeconds = timer.GetSeconds();
+
+        timer.Reset();
+        for (int k = 0; k < numSteps; ++k)
+        {
+            fluid.DoSimulationStep();
+        }
+        double stepsPerSecond = numSteps / timer.GetSeconds();
+
+        std::vector<float> const& state = fluid.GetState();
+        float maxDifference = 0.0f;
+        if (numThreads == 1)
+        {
+            state1 = state;
+        }
+        else
+        {
+            for (size_t i = 0; i < state.size(); ++i)
+            {
+                maxDifference = std::max(maxDifference,
+                    std::abs(state[i] - state1[i]));
+            }
+        }
+
+        std::cout << "  numThreads = " << numThreads << ": initialize "
+            << initializeSeconds << " s, " << stepsPerSecond
+            << " steps/s, max difference from 1 thread " << maxDifference
+            << std::endl;
+    }
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(2);
+    TestFluid(128, 10);
+    TestFluid(256, 4);
+    return 0;
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,255 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <thread>
+using namespace gte;
+
+// Compare the time of a Runge-Kutta step of MassSpringArbitrary with that of
+// the original implementation, which stored the adjacent springs of each
+// particle in a std::set and computed each spring force once for each of
+// its particles, and with that of MassSpringArbitrarySoA.  The mesh is a
+// cubic lattice of N^3 particles, each cube split into six tetrahedra that
+// share its main diagonal.  The springs are the edges of the tetrahedra,
+// about 500000 of them for N = 42.
+
+//----------------------------------------------------------------------------
+template <int N, typename Real>
+class OriginalMassSpringArbitrary : public ParticleSystem<N, Real>
+{
+public:
+    typedef typename MassSpringArbitrary<N, Real>::Spring Spring;
+
+    OriginalMassSpringArbitrary(int numParticles, int numSprings, Real step)
+        :
+        ParticleSystem<N, Real>(numParticles, step),
+        mSpring(numSprings),
+        mAdjacent(numParticles)
+    {
+    }
+
+    void SetSpring(int index, Spring const& spring)
+    {
+        mSpring[index] = spring;
+        mAdjacent[spring.particle0].insert(index);
+        mAdjacent[spring.particle1].insert(index);
+    }
+
+protected:
+    virtual Vector<N, Real> Acceleration(int i, Real,
+        std::vector<Vector<N, Real>> const& position,
+        std::vector<Vector<N, Real>> const&)
+    {
+        Vector<N, Real> acceleration = Vector<N, Real>::Zero();
+        for (auto adj : mAdjacent[i])
+        {
+            Spring const& spring = mSpring[adj];
+            Vector<N, Real> diff;
+            if (i != spring.particle0)
+            {
+                diff = position[spring.particle0] - position[i];
+            }
+            else
+            {
+                diff = position[spring.particle1] - position[i];
+            }
+
+            Real ratio = spring.length / Length(diff);
+            Vector<N, Real> force =
+                spring.constant * ((Real)1 - ratio) * diff;
+            acceleration += this->mInvMass[i] * force;
+        }
+        return acceleration;
+    }
+
+    std::vector<Spring> mSpring;
+    std::vector<std::set<int>> mAdjacent;
+};
+//----------------------------------------------------------------------------
+struct Lattice
+{
+    struct Edge
+    {
+        int particle0, particle1;
+        double length;
+    };
+
+    Lattice(int inBound)
+        :
+        bound(inBound)
+    {
+        // The edges of the Kuhn triangulation of each cube are its axis
+        // edges, the face diagonals from its lower corner and its main
+        // diagonal.
+        int const offset[7][3] =
+        {
+            { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 },
+            { 1, 1, 0 }, { 0, 1, 1 }, { 1, 0, 1 },
+            { 1, 1, 1 }
+        };
+
+        for (int z = 0; z < bound; ++z)
+        {
+            for (int y = 0; y < bound; ++y)
+            {
+                for (int x = 0; x < bound; ++x)
+                {
+                    for (int k = 0; k < 7; ++k)
+                    {
+                        int x1 = x + offset[k][0];
+                        int y1 = y + offset[k][1];
+                        int z1 = z + offset[k][2];
+                        if (x1 < bound && y1 < bound && z1 < bound)
+                        {
+                            Edge edge;
+                            edge.particle0 = Index(x, y, z);
+                            edge.particle1 = Index(x1, y1, z1);
+                            edge.length = sqrt(static_cast<double>(
+                                offset[k][0] + offset[k][1] + offset[k][2]));
+                            edges.push_back(edge);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    inline int Index(int x, int y, int z) const
+    {
+        return x + bound * (y + bound * z);
+    }
+
+    // The rest positions are at the lattice points.  The lattice is
+    // stretched by 1 percent in x so that the springs exert forces, and the
+    // particles at z = 0 are immovable.
+    template <typename System, typename Spring>
+    void Initialize(System& system, Spring spring) const
+    {
+        for (int z = 0; z < bound; ++z)
+        {
+            for (int y = 0; y < bound; ++y)
+            {
+                for (int x = 0; x < bound; ++x)
+                {
+                    int i = Index(x, y, z);
+                    system.SetPosition(i, Vector3<double>(1.01 * x, y, z));
+                    system.SetMass(i, z > 0 ? 1.0 :
+                        std::numeric_limits<double>::max());
+                }
+            }
+        }
+
+        int const numSprings = static_cast<int>(edges.size());
+        for (int s = 0; s < numSprings; ++s)
+        {
+            spring.particle0 = edges[s].particle0;
+            spring.particle1 = edges[s].particle1;
+            spring.constant = 100.0;
+            spring.length = edges[s].length;
+            system.SetSpring(s, spring);
+        }
+    }
+
+    int bound;
+    std::vector<Edge> edges;
+};
+//----------------------------------------------------------------------------
+template <typename System>
+double TimeSteps(System& system, int numSteps)
+{
+    // The first step builds the adjacency arrays, so it is not timed.
+    system.Update(0.0);
+
+    Timer timer;
+    for (int k = 1; k <= numSteps; ++k)
+    {
+        system.Update(k * system.GetStep());
+    }
+    return 1000.0 * timer.GetSeconds() / numSteps;
+}
+//----------------------------------------------------------------------------
+template <typename System>
+double GetMaxDifference(
+    OriginalMassSpringArbitrary<3, double> const& system0,
+    System const& system1)
+{
+    double maxDifference = 0.0;
+    for (int i = 0; i < system0.GetNumParticles(); ++i)
+    {
+        Vector3<double> p0 = system0.GetPosition(i);
+        Vector3<double> p1 = system1.GetPosition(i);
+        for (int j = 0; j < 3; ++j)
+        {
+            maxDifference = std::max(maxDifference,
+                std::abs(p0[j] - p1[j]));
+        }
+    }
+    return maxDifference;
+}
+//----------------------------------------------------------------------------
+void TestMassSprings(int bound, int numSteps)
+{
+    Lattice lattice(bound);
+    int const numParticles = bound * bound * bound;
+    int const numSprings = static_cast<int>(lattice.edges.size());
+    double const step = 0.001;
+    std::cout << numParticles << " particles, " << numSprings
+        << " springs, " << numSteps << " steps" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    OriginalMassSpringArbitrary<3, double> original(numParticles, numSprings,
+        step);
+    lattice.Initialize(original,
+        OriginalMassSpringArbitrary<3, double>::Spring());
+    double msOriginal = TimeSteps(original, numSteps);
+    std::cout << "original (std::set, two evaluations per spring): "
+        << msOriginal << " ms/step" << std::endl;
+
+    MassSpringArbitrary<3, double> scalar(numParticles, numSprings, step);
+    lattice.Initialize(scalar, MassSpringArbitrary<3, double>::Spring());
+    double msScalar = TimeSteps(scalar, numSteps);
+    std::cout << "MassSpringArbitrary (CSR, one evaluation per spring): "
+        << msScalar << " ms/step, speedup " << std::setprecision(2)
+        << msOriginal / msScalar << ", max difference "
+        << std::scientific << GetMaxDifference(original, scalar)
+        << std::fixed << std::setprecision(1) << std::endl;
+
+    unsigned int maxThreads = std::max(std::thread::hardware_concurrency(),
+        1u);
+    for (unsigned int numThreads = 1; numThreads <= maxThreads;
+        numThreads *= 2)
+    {
+        MassSpringArbitrarySoA<3, double> soa(numParticles, numSprings, step,
+            std::make_shared<ComputeModel>(numThreads));
+        lattice.Initialize(soa,
+            MassSpringArbitrarySoA<3, double>::Spring());
+        double msSoA = TimeSteps(soa, numSteps);
+        std::cout << "MassSpringArbitrarySoA, numThreads = " << numThreads
+            << ": " << msSoA << " ms/step, speedup "
+            << std::setprecision(2) << msOriginal / msSoA
+            << ", max difference " << std::scientific
+            << GetMaxDifference(original, soa) << std::fixed
+            << std::setprecision(1) << std::endl;
+    }
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    TestMassSprings(42, 10);
+    return 0;
+}
+//----------------------------------------------------------------------------
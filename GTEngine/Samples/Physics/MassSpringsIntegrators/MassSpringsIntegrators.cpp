@@ -0,0 +1,255 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iostream>
+using namespace gte;
+
+// Regression test of the implicit Euler integrator of ParticleSystem against
+// the explicit Runge-Kutta integrator.  The system is a 20x20 cloth of stiff
+// springs hanging from its top row under gravity.
+//
+// 1. Energy drift.  Without damping, the total energy of the cloth (kinetic,
+//    spring and gravitational) is conserved.  Runge-Kutta with a small step
+//    is the reference; its energy must stay within a small tolerance of the
+//    initial energy.  Implicit Euler dissipates energy, so with 10 and 50
+//    times larger steps its energy must never increase by more than the
+//    tolerance.  Runge-Kutta is also run with the large steps; it becomes
+//    unstable for the largest one.  Those results are reported but not
+//    tested.
+//
+// 2. Equilibrium.  With viscous damping the cloth comes to rest.  The rest
+//    positions computed by implicit Euler with the large steps must match
+//    those computed by Runge-Kutta with the small step.
+//
+// The program prints the results and returns a nonzero value when a test
+// fails.
+
+//----------------------------------------------------------------------------
+class Cloth : public MassSpringSurface<3, double>
+{
+public:
+    Cloth(double step, double viscosity)
+        :
+        MassSpringSurface<3, double>(msBound, msBound, step),
+        mViscosity(viscosity)
+    {
+        // The cloth is horizontal and the top row (r = 0) is immovable.
+        for (int r = 0; r < msBound; ++r)
+        {
+            for (int c = 0; c < msBound; ++c)
+            {
+                SetMass(r, c, r > 0 ? 1.0 :
+                    std::numeric_limits<double>::max());
+                SetPosition(r, c, Vector3<double>(0.1*c, 0.1*r, 0.0));
+                SetVelocity(r, c, Vector3<double>::Zero());
+                if (r < msBound - 1)
+                {
+                    SetConstantR(r, c, msConstant);
+                    SetLengthR(r, c, 0.1);
+                }
+                if (c < msBound - 1)
+                {
+                    SetConstantC(r, c, msConstant);
+                    SetLengthC(r, c, 0.1);
+                }
+            }
+        }
+    }
+
+    // The sum of the kinetic, spring and gravitational energies.
+    double GetEnergy() const
+    {
+        double energy = 0.0;
+        for (int r = 0; r < msBound; ++r)
+        {
+            for (int c = 0; c < msBound; ++c)
+            {
+                Vector3<double> const& position = GetPosition(r, c);
+                if (r > 0)
+                {
+                    Vector3<double> const& velocity = GetVelocity(r, c);
+                    energy += 0.5 * Dot(velocity, velocity);
+                    energy += msGravity * position[2];
+                }
+                if (r < msBound - 1)
+                {
+                    double stretch = Length(GetPosition(r + 1, c) -
+                        position) - GetLengthR(r, c);
+                    energy += 0.5 * GetConstantR(r, c) * stretch * stretch;
+                }
+                if (c < msBound - 1)
+                {
+                    double stretch = Length(GetPosition(r, c + 1) -
+                        position) - GetLengthC(r, c);
+                    energy += 0.5 * GetConstantC(r, c) * stretch * stretch;
+                }
+            }
+        }
+        return energy;
+    }
+
+    // The energy differences are relative to the gravitational energy that
+    // the movable particles release when falling the length of the cloth.
+    // The initial energy is zero, so it cannot be used as the scale.
+    static double GetEnergyScale()
+    {
+        return msGravity * (msBound * (msBound - 1)) * (0.1 * (msBound - 1));
+    }
+
+    static int const msBound = 20;
+    static double const msConstant;
+    static double const msGravity;
+
+protected:
+    virtual Vector<3, double> ExternalAcceleration(int i, double,
+        std::vector<Vector<3, double>> const&,
+        std::vector<Vector<3, double>> const& velocity)
+    {
+        return Vector3<double>(0.0, 0.0, -msGravity) -
+            mViscosity * velocity[i];
+    }
+
+    double mViscosity;
+};
+
+double const Cloth::msConstant = 5000.0;
+double const Cloth::msGravity = 9.8;
+//----------------------------------------------------------------------------
+struct Result
+{
+    bool stable;
+    double maxEnergyIncrease;   // max over time of (E(t) - E(0))/scale
+    double maxEnergyDecrease;   // max over time of (E(0) - E(t))/scale
+    double averageIterations;
+};
+
+Result Simulate(Cloth& cloth, double duration)
+{
+    Result result = { true, 0.0, 0.0, 0.0 };
+    double step = cloth.GetStep();
+    double energy0 = cloth.GetEnergy();
+    double scale = Cloth::GetEnergyScale();
+    int const numSteps = static_cast<int>(duration / step + 0.5);
+    for (int k = 0; k < numSteps; ++k)
+    {
+        cloth.Update(k * step);
+        result.averageIterations += cloth.GetNumSolverIterations();
+
+        double energy = cloth.GetEnergy();
+        if (!(std::abs(energy) < 1e+03 * scale))
+        {
+            result.stable = false;
+            break;
+        }
+        double relative = (energy - energy0) / scale;
+        result.maxEnergyIncrease = std::max(result.maxEnergyIncrease,
+            relative);
+        result.maxEnergyDecrease = std::max(result.maxEnergyDecrease,
+            -relative);
+    }
+    result.averageIterations /= numSteps;
+    return result;
+}
+//----------------------------------------------------------------------------
+double GetMaxDifference(Cloth const& cloth0, Cloth const& cloth1)
+{
+    double maxDifference = 0.0;
+    for (int r = 0; r < Cloth::msBound; ++r)
+    {
+        for (int c = 0; c < Cloth::msBound; ++c)
+        {
+            maxDifference = std::max(maxDifference, Length(
+                cloth0.GetPosition(r, c) - cloth1.GetPosition(r, c)));
+        }
+    }
+    return maxDifference;
+}
+//----------------------------------------------------------------------------
+bool TestEnergyDrift()
+{
+    double const smallStep = 0.0005, duration = 2.0, tolerance = 1e-03;
+    double const largeStep[2] = { 0.005, 0.025 };
+    bool passed = true;
+
+    std::cout << "energy drift, no damping, " << duration << " seconds"
+        << std::endl;
+
+    Cloth reference(smallStep, 0.0);
+    Result result = Simulate(reference, duration);
+    bool ok = result.stable &&
+        result.maxEnergyIncrease <= tolerance &&
+        result.maxEnergyDecrease <= tolerance;
+    std::cout << "  Runge-Kutta, step " << smallStep << ": drift +"
+        << result.maxEnergyIncrease << " -" << result.maxEnergyDecrease
+        << (ok ? "  passed" : "  FAILED") << std::endl;
+    passed = passed && ok;
+
+    for (int j = 0; j < 2; ++j)
+    {
+        Cloth rk4(largeStep[j], 0.0);
+        result = Simulate(rk4, duration);
+        std::cout << "  Runge-Kutta, step " << largeStep[j] << ": "
+            << (result.stable ? "stable" : "unstable") << std::endl;
+
+        Cloth implicit(largeStep[j], 0.0);
+        implicit.SetIntegrator(Cloth::IT_IMPLICIT_EULER, 200, 1e-08);
+        result = Simulate(implicit, duration);
+        ok = result.stable && result.maxEnergyIncrease <= tolerance;
+        std::cout << "  implicit Euler, step " << largeStep[j] << ": drift +"
+            << result.maxEnergyIncrease << " -" << result.maxEnergyDecrease
+            << ", " << result.averageIterations << " iterations/step"
+            << (ok ? "  passed" : "  FAILED") << std::endl;
+        passed = passed && ok;
+    }
+    return passed;
+}
+//----------------------------------------------------------------------------
+bool TestEquilibrium()
+{
+    double const smallStep = 0.0005, duration = 20.0, viscosity = 2.0;
+    double const tolerance = 1e-03;
+    double const largeStep[2] = { 0.005, 0.025 };
+    bool passed = true;
+
+    std::cout << "equilibrium, viscosity " << viscosity << ", " << duration
+        << " seconds" << std::endl;
+
+    Cloth reference(smallStep, viscosity);
+    Simulate(reference, duration);
+
+    for (int j = 0; j < 2; ++j)
+    {
+        Cloth implicit(largeStep[j], viscosity);
+        implicit.SetIntegrator(Cloth::IT_IMPLICIT_EULER, 200, 1e-08);
+        Result result = Simulate(implicit, duration);
+        double difference = GetMaxDifference(reference, implicit);
+        bool ok = result.stable && difference <= tolerance;
+        std::cout << "  implicit Euler, step " << largeStep[j]
+            << ": max difference from Runge-Kutta " << difference
+            << (ok ? "  passed" : "  FAILED") << std::endl;
+        passed = passed && ok;
+    }
+    return passed;
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    bool passed = TestEnergyDrift();
+    passed = TestEquilibrium() && passed;
+    std::cout << (passed ? "all tests passed" : "some tests FAILED")
+        << std::endl;
+    return passed ? 0 : 1;
+}
+//----------------------------------------------------------------------------
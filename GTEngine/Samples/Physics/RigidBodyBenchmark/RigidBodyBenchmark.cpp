@@ -0,0 +1,174 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include <GTEngine.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+using namespace gte;
+
+// Time RigidBodyWorld::Update for 1000, 10000 and 100000 bodies with
+// spheres, boxes and capsules in equal numbers.  The bodies are randomly
+// placed in a cube whose volume grows with their number, so the number of
+// pairs per body is about the same for all sizes.  The first update builds
+// the tree.  The later updates move the bodies by a small random amount,
+// as in a simulation step, so most leaves are not reinserted.  For up to
+// 10000 bodies the candidates are compared with those of the O(n^2) test
+// of all pairs of bounding boxes, which is also timed.
+
+//----------------------------------------------------------------------------
+struct Scene
+{
+    Scene(int numBodies)
+        :
+        mte(numBodies),
+        rnd(0.0, 1.0)
+    {
+        double size = 2.0 * std::cbrt(static_cast<double>(numBodies));
+        bodies.resize(numBodies);
+        for (int i = 0; i < numBodies; ++i)
+        {
+            bodies[i] = std::make_shared<RigidBody<double>>();
+            bodies[i]->SetPosition(Vector3<double>(size * rnd(mte),
+                size * rnd(mte), size * rnd(mte)));
+            Quaternion<double> q(rnd(mte) - 0.5, rnd(mte) - 0.5,
+                rnd(mte) - 0.5, rnd(mte) - 0.5);
+            Normalize(q);
+            bodies[i]->SetQOrientation(q);
+        }
+    }
+
+    void Insert(RigidBodyWorld<double>& world) const
+    {
+        int const numBodies = static_cast<int>(bodies.size());
+        for (int i = 0; i < numBodies; ++i)
+        {
+            switch (i % 3)
+            {
+            case 0:
+                world.InsertSphere(bodies[i], 0.5);
+                break;
+            case 1:
+                world.InsertBox(bodies[i], Vector3<double>(0.5, 0.3, 0.4));
+                break;
+            default:
+                world.InsertCapsule(bodies[i], 0.5, 0.25);
+                break;
+            }
+        }
+    }
+
+    void Move()
+    {
+        for (auto const& body : bodies)
+        {
+            Vector3<double> position = body->GetPosition();
+            for (int j = 0; j < 3; ++j)
+            {
+                position[j] += 0.01 * (rnd(mte) - 0.5);
+            }
+            body->SetPosition(position);
+        }
+    }
+
+    std::mt19937 mte;
+    std::uniform_real_distribution<double> rnd;
+    std::vector<std::shared_ptr<RigidBody<double>>> bodies;
+};
+//----------------------------------------------------------------------------
+size_t CountOverlapsAllPairs(RigidBodyWorld<double> const& world)
+{
+    int const numBodies = world.GetNumBodies();
+    size_t numOverlaps = 0;
+    for (int i0 = 0; i0 < numBodies; ++i0)
+    {
+        AlignedBox3<double> const& box0 = world.GetBound(i0);
+        for (int i1 = i0 + 1; i1 < numBodies; ++i1)
+        {
+            AlignedBox3<double> const& box1 = world.GetBound(i1);
+            bool overlap = true;
+            for (int j = 0; j < 3; ++j)
+            {
+                if (box0.max[j] < box1.min[j] || box1.max[j] < box0.min[j])
+                {
+                    overlap = false;
+                    break;
+                }
+            }
+            if (overlap)
+            {
+                ++numOverlaps;
+            }
+        }
+    }
+    return numOverlaps;
+}
+//----------------------------------------------------------------------------
+void TestWorld(int numBodies, unsigned int numThreads, int numSteps)
+{
+    Scene scene(numBodies);
+    RigidBodyWorld<double> world(0.05,
+        std::make_shared<ComputeModel>(numThreads));
+    scene.Insert(world);
+
+    Timer timer;
+    world.Update();
+    double msBuild = 1000.0 * timer.GetSeconds();
+
+    double msStep = 0.0;
+    for (int k = 0; k < numSteps; ++k)
+    {
+        scene.Move();
+        timer.Reset();
+        world.Update();
+        msStep += 1000.0 * timer.GetSeconds();
+    }
+    msStep /= numSteps;
+
+    std::cout << "  numThreads = " << numThreads << ": first update "
+        << msBuild << " ms, later updates " << msStep << " ms, "
+        << world.GetCandidates().size() << " candidates, "
+        << world.GetIntersections().size() << " intersections"
+        << std::endl;
+
+    if (numThreads == 1 && numBodies <= 10000)
+    {
+        timer.Reset();
+        size_t numOverlaps = CountOverlapsAllPairs(world);
+        double msAllPairs = 1000.0 * timer.GetSeconds();
+        std::cout << "  all pairs: " << msAllPairs << " ms, "
+            << numOverlaps << " candidates"
+            << (numOverlaps == world.GetCandidates().size() ?
+            "" : "  MISMATCH") << std::endl;
+    }
+}
+//----------------------------------------------------------------------------
+int main(int, char const*[])
+{
+    LogReporter reporter(
+        "LogReport.txt",
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL,
+        Logger::Listener::LISTEN_FOR_ALL);
+
+    std::cout << std::fixed << std::setprecision(2);
+    unsigned int maxThreads = std::max(std::thread::hardware_concurrency(),
+        1u);
+    for (int numBodies = 1000; numBodies <= 100000; numBodies *= 10)
+    {
+        std::cout << numBodies << " bodies" << std::endl;
+        for (unsigned int numThreads = 1; numThreads <= maxThreads;
+            numThreads *= 2)
+        {
+            TestWorld(numBodies, numThreads, 10);
+        }
+    }
+    return 0;
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,38 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/05)
+
+#include "GTEnginePCH.h"
+#include "GteBarrier.h"
+using namespace gte;
+
+//----------------------------------------------------------------------------
+Barrier::Barrier(unsigned int numThreads)
+    :
+    mNumThreads(numThreads > 0 ? numThreads : 1),
+    mNumWaiting(0),
+    mPhase(0)
+{
+}
+//----------------------------------------------------------------------------
+bool Barrier::Wait()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (++mNumWaiting == mNumThreads)
+    {
+        mNumWaiting = 0;
+        ++mPhase;
+        mReleased.notify_all();
+        return true;
+    }
+
+    // The phase counter distinguishes a release from a spurious wakeup and
+    // allows the barrier to be reused immediately.
+    unsigned int const phase = mPhase;
+    mReleased.wait(lock, [this, phase]() { return mPhase != phase; });
+    return false;
+}
+//----------------------------------------------------------------------------
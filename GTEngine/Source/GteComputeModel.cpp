@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.4.0 (2014/09/25)
+// File Version: 1.4.1 (2014/11/05)
 
 #include "GTEnginePCH.h"
 #include "GteComputeModel.h"
@@ -46,3 +46,8 @@ ComputeModel::ComputeModel(DX11Engine* inEngine, unsigned int inNumThreads)
 
 #endif
 //----------------------------------------------------------------------------
+ThreadPool& ComputeModel::GetThreadPool() const
+{
+    return (threadPool ? *threadPool : ThreadPool::GetDefault());
+}
+//----------------------------------------------------------------------------
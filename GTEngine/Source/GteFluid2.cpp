@@ -22,10 +22,39 @@ Fluid2::Fluid2(DX11Engine* engine, int xSize, int ySize, float dt,
     mYSize(ySize),
     mDt(dt),
     mTime(0.0f)
+{
+    CreateShaders(densityViscosity, velocityViscosity);
+}
+//----------------------------------------------------------------------------
+Fluid2::Fluid2(std::shared_ptr<ComputeModel> const& cmodel, int xSize,
+    int ySize, float dt, float densityViscosity, float velocityViscosity)
+    :
+    mEngine(cmodel ? cmodel->engine : nullptr),
+    mXSize(xSize),
+    mYSize(ySize),
+    mDt(dt),
+    mTime(0.0f)
+{
+    if (mEngine)
+    {
+        CreateShaders(densityViscosity, velocityViscosity);
+    }
+    else
+    {
+        mCPU.reset(new Fluid2CPU(mXSize, mYSize, mDt, densityViscosity,
+            velocityViscosity, cmodel));
+        mStateTTexture.reset(new Texture2(DF_R32G32B32A32_FLOAT, mXSize,
+            mYSize));
+        mStateTTexture->SetUsage(Resource::DYNAMIC_UPDATE);
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid2::CreateShaders(float densityViscosity, float velocityViscosity)
 {
     // Create the shared parameters for many of the simulation shaders.
     float dx = 1.0f/static_cast<float>(mXSize);
     float dy = 1.0f/static_cast<float>(mYSize);
+    float dt = mDt;
     float dtDivDxDx = (dt/dx)/dx;
     float dtDivDyDy = (dt/dy)/dy;
     float ratio = dx/dy;
@@ -78,23 +107,39 @@ Fluid2::Fluid2(DX11Engine* engine, int xSize, int ySize, float dt,
 //----------------------------------------------------------------------------
 void Fluid2::Initialize()
 {
-    mInitializeSource->Execute(mEngine);
-    mInitializeState->Execute(mEngine);
-    mEnforceStateBoundary->Execute(mEngine, mStateTm1Texture);
-    mEnforceStateBoundary->Execute(mEngine, mStateTTexture);
+    if (mCPU)
+    {
+        mCPU->Initialize();
+        CopyStateFromCPU();
+    }
+    else
+    {
+        mInitializeSource->Execute(mEngine);
+        mInitializeState->Execute(mEngine);
+        mEnforceStateBoundary->Execute(mEngine, mStateTm1Texture);
+        mEnforceStateBoundary->Execute(mEngine, mStateTTexture);
+    }
 }
 //----------------------------------------------------------------------------
 void Fluid2::DoSimulationStep()
 {
-    mUpdateState->Execute(mEngine, mSourceTexture, mStateTm1Texture,
-        mStateTTexture);
-    mEnforceStateBoundary->Execute(mEngine, mStateTp1Texture);
-    mComputeDivergence->Execute(mEngine, mStateTp1Texture);
-    mSolvePoisson->Execute(mEngine, mDivergenceTexture);
-    mAdjustVelocity->Execute(mEngine, mStateTp1Texture, mPoissonTexture,
-        mStateTm1Texture);
-    mEnforceStateBoundary->Execute(mEngine, mStateTm1Texture);
-    std::swap(mStateTm1Texture, mStateTTexture);
+    if (mCPU)
+    {
+        mCPU->DoSimulationStep();
+        CopyStateFromCPU();
+    }
+    else
+    {
+        mUpdateState->Execute(mEngine, mSourceTexture, mStateTm1Texture,
+            mStateTTexture);
+        mEnforceStateBoundary->Execute(mEngine, mStateTp1Texture);
+        mComputeDivergence->Execute(mEngine, mStateTp1Texture);
+        mSolvePoisson->Execute(mEngine, mDivergenceTexture);
+        mAdjustVelocity->Execute(mEngine, mStateTp1Texture, mPoissonTexture,
+            mStateTm1Texture);
+        mEnforceStateBoundary->Execute(mEngine, mStateTm1Texture);
+        std::swap(mStateTm1Texture, mStateTTexture);
+    }
 
     mTime += mDt;
 }
@@ -104,3 +149,10 @@ std::shared_ptr<Texture2> const& Fluid2::GetState() const
     return mStateTTexture;
 }
 //----------------------------------------------------------------------------
+void Fluid2::CopyStateFromCPU()
+{
+    std::vector<float> const& state = mCPU->GetState();
+    memcpy(mStateTTexture->GetData(), &state[0],
+        mStateTTexture->GetNumBytes());
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,419 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/16)
+
+#include "GTEnginePCH.h"
+#include "GteFluid2CPU.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+using namespace gte;
+
+//----------------------------------------------------------------------------
+Fluid2CPU::~Fluid2CPU()
+{
+}
+//----------------------------------------------------------------------------
+Fluid2CPU::Fluid2CPU(int xSize, int ySize, float dt, float densityViscosity,
+    float velocityViscosity, std::shared_ptr<ComputeModel> const& cmodel,
+    int numPoissonIterations)
+    :
+    mXSize(xSize),
+    mYSize(ySize),
+    mDt(dt),
+    mCModel(cmodel),
+    mNumThreads(cmodel ? static_cast<int>(cmodel->numThreads) : 1),
+    mNumPoissonIterations(numPoissonIterations),
+    mTime(0.0f)
+{
+    // The parameters are those computed by Fluid2.
+    float dx = 1.0f/static_cast<float>(mXSize);
+    float dy = 1.0f/static_cast<float>(mYSize);
+    float dtDivDxDx = (dt/dx)/dx;
+    float dtDivDyDy = (dt/dy)/dy;
+    float ratio = dx/dy;
+    float ratioSqr = ratio*ratio;
+    float factor = 0.5f/(1.0f + ratioSqr);
+    float epsilonX = factor;
+    float epsilonY = ratioSqr*factor;
+    float epsilon0 = dx*dx*factor;
+    float denVX = densityViscosity*dtDivDxDx;
+    float denVY = densityViscosity*dtDivDyDy;
+    float velVX = velocityViscosity*dtDivDxDx;
+    float velVY = velocityViscosity*dtDivDyDy;
+
+    Fluid2Parameters& p = mParameters;
+    p.spaceDelta = Vector4<float>(dx, dy, 0.0f, 0.0f);
+    p.halfDivDelta = Vector4<float>(0.5f/dx, 0.5f/dy, 0.0f, 0.0f);
+    p.timeDelta = Vector4<float>(dt/dx, dt/dy, 0.0f, dt);
+    p.viscosityX = Vector4<float>(velVX, velVX, 0.0f, denVX);
+    p.viscosityY = Vector4<float>(velVY, velVY, 0.0f, denVY);
+    p.epsilon = Vector4<float>(epsilonX, epsilonY, 0.0f, epsilon0);
+
+    size_t const numPixels = static_cast<size_t>(mXSize*mYSize);
+    mSource.resize(4*numPixels);
+    mStateTm1.resize(4*numPixels);
+    mStateT.resize(4*numPixels);
+    mStateTp1.resize(4*numPixels);
+    mDivergence.resize(numPixels);
+    mPoisson.resize(numPixels);
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::Initialize()
+{
+    // Generate the vortices in the same order as Fluid2InitializeSource so
+    // that the two implementations have the same sources.
+    std::mt19937 mte;
+    std::uniform_real_distribution<float> unirnd(0.0f, 1.0f);
+    std::uniform_real_distribution<float> symrnd(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> posrnd0(0.001f, 0.01f);
+    std::uniform_real_distribution<float> posrnd1(128.0f, 256.0f);
+
+    mVortices.resize(NUM_VORTICES);
+    for (auto& v : mVortices)
+    {
+        v.position[0] = unirnd(mte);
+        v.position[1] = unirnd(mte);
+        v.variance = posrnd0(mte);
+        v.amplitude = posrnd1(mte);
+        if (symrnd(mte) < 0.0f)
+        {
+            v.amplitude = -v.amplitude;
+        }
+    }
+
+    Execute(mYSize, [this](int ymin, int ymax)
+    {
+        InitializeSource(ymin, ymax);
+    });
+
+    // Initial density values are randomly generated and initial velocity
+    // values are zero, as in Fluid2InitializeState.
+    std::mt19937 mteState;
+    size_t const numPixels = mDivergence.size();
+    for (size_t i = 0; i < numPixels; ++i)
+    {
+        mStateT[4*i + 0] = 0.0f;
+        mStateT[4*i + 1] = 0.0f;
+        mStateT[4*i + 2] = 0.0f;
+        mStateT[4*i + 3] = unirnd(mteState);
+    }
+    mStateTm1 = mStateT;
+
+    EnforceStateBoundary(mStateTm1);
+    EnforceStateBoundary(mStateT);
+    mTime = 0.0f;
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::DoSimulationStep()
+{
+    Execute(mYSize, [this](int ymin, int ymax)
+    {
+        UpdateState(ymin, ymax);
+    });
+    EnforceStateBoundary(mStateTp1);
+
+    Execute(mYSize, [this](int ymin, int ymax)
+    {
+        ComputeDivergence(ymin, ymax);
+    });
+
+    // The boundary values of the Poisson solution are zero.  Only the
+    // interior values are modified by the solver.
+    std::fill(mPoisson.begin(), mPoisson.end(), 0.0f);
+    for (int i = 0; i < mNumPoissonIterations; ++i)
+    {
+        for (int color = 0; color < 2; ++color)
+        {
+            Execute(mYSize - 2, [this, color](int ymin, int ymax)
+            {
+                SolvePoisson(ymin + 1, ymax + 1, color);
+            });
+        }
+    }
+
+    Execute(mYSize, [this](int ymin, int ymax)
+    {
+        AdjustVelocity(ymin, ymax);
+    });
+    EnforceStateBoundary(mStateTm1);
+    std::swap(mStateTm1, mStateT);
+
+    mTime += mDt;
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::InitializeSource(int ymin, int ymax)
+{
+    float const dx = mParameters.spaceDelta[0];
+    float const dy = mParameters.spaceDelta[1];
+    float* source = &mSource[4*Index(0, ymin)];
+    size_t const numRowPixels = static_cast<size_t>(mXSize*(ymax - ymin + 1));
+    std::fill(source, source + 4*numRowPixels, 0.0f);
+
+    // The velocity of a vortex is amplitude*exp(-|diff|^2/variance) times
+    // (diff.y,-diff.x), where diff is the pixel location relative to the
+    // vortex position.  The pixels outside the square of radius
+    // sqrt(variance*log(|amplitude|/threshold)) centered at the vortex
+    // position are skipped, because the magnitudes there are smaller than
+    // 'threshold'.
+    float const threshold = 1e-8f;
+    std::vector<float> xDiff(mXSize), xExp(mXSize);
+    for (auto const& v : mVortices)
+    {
+        float radius = sqrt(v.variance*log(fabs(v.amplitude)/threshold));
+        int x0 = std::max(static_cast<int>(
+            floor((v.position[0] - radius)/dx)), 0);
+        int x1 = std::min(static_cast<int>(
+            ceil((v.position[0] + radius)/dx)), mXSize - 1);
+        int y0 = std::max(static_cast<int>(
+            floor((v.position[1] - radius)/dy)), ymin);
+        int y1 = std::min(static_cast<int>(
+            ceil((v.position[1] + radius)/dy)), ymax);
+        if (y0 > y1)
+        {
+            continue;
+        }
+
+        for (int x = x0; x <= x1; ++x)
+        {
+            xDiff[x] = dx*(x + 0.5f) - v.position[0];
+            xExp[x] = exp(-xDiff[x]*xDiff[x]/v.variance);
+        }
+
+        for (int y = y0; y <= y1; ++y)
+        {
+            float const d1 = dy*(y + 0.5f) - v.position[1];
+            float const magnitudeY = v.amplitude*exp(-d1*d1/v.variance);
+            float* velocity = &mSource[4*Index(x0, y)];
+            for (int x = x0; x <= x1; ++x, velocity += 4)
+            {
+                float const magnitude = magnitudeY*xExp[x];
+                velocity[0] += magnitude*d1;
+                velocity[1] -= magnitude*xDiff[x];
+            }
+        }
+    }
+
+    // The density producer and consumer, gravity, and wind of
+    // Fluid2InitializeSource, each (x, y, variance, amplitude).
+    float const producer[4] = { 0.25f, 0.75f, 0.01f, 2.0f };
+    float const consumer[4] = { 0.75f, 0.25f, 0.01f, 2.0f };
+    float const gravity[2] = { 0.0f, 0.0f };
+    float const wind[4] = { 0.0f, 0.5f, 0.001f, 32.0f };
+    for (int y = ymin; y <= ymax; ++y)
+    {
+        float const ly = dy*(y + 0.5f);
+        float* src = &mSource[4*Index(0, y)];
+        for (int x = 0; x < mXSize; ++x, src += 4)
+        {
+            float const lx = dx*(x + 0.5f);
+            float d0 = lx - producer[0];
+            float d1 = ly - producer[1];
+            float arg = -(d0*d0 + d1*d1)/producer[2];
+            float density = producer[3]*exp(arg);
+            d0 = lx - consumer[0];
+            d1 = ly - consumer[1];
+            arg = -(d0*d0 + d1*d1)/consumer[2];
+            density -= consumer[3]*exp(arg);
+
+            float windDiff = ly - wind[1];
+            float windArg = -windDiff*windDiff/wind[2];
+            src[0] += gravity[0] + wind[3]*exp(windArg);
+            src[1] += gravity[1];
+            src[2] = 0.0f;
+            src[3] = density;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::UpdateState(int ymin, int ymax)
+{
+    Fluid2Parameters const& p = mParameters;
+    float const* stateT = &mStateT[0];
+    float const dt = p.timeDelta[3];
+    for (int y = ymin; y <= ymax; ++y)
+    {
+        int ym = std::max(y - 1, 0);
+        int yp = std::min(y + 1, mYSize - 1);
+        for (int x = 0; x < mXSize; ++x)
+        {
+            int xm = std::max(x - 1, 0);
+            int xp = std::min(x + 1, mXSize - 1);
+
+            // Sample states at (x,y) and immediate neighbors.
+            float const* stateZZ = &stateT[4*Index(x, y)];
+            float const* statePZ = &stateT[4*Index(xp, y)];
+            float const* stateMZ = &stateT[4*Index(xm, y)];
+            float const* stateZP = &stateT[4*Index(x, yp)];
+            float const* stateZM = &stateT[4*Index(x, ym)];
+            float const* src = &mSource[4*Index(x, y)];
+
+            // Compute advection.  The shader samples stateTm1 at the
+            // normalized coordinates spaceDelta*(c - timeDelta*state + 0.5),
+            // which are the pixel coordinates c - timeDelta*state.
+            float advection[4];
+            Sample(
+                x - p.timeDelta[0]*stateZZ[0],
+                y - p.timeDelta[1]*stateZZ[1],
+                advection);
+
+            // Update the state.
+            float* result = &mStateTp1[4*Index(x, y)];
+            for (int i = 0; i < 4; ++i)
+            {
+                float dxx = statePZ[i] - 2.0f*stateZZ[i] + stateMZ[i];
+                float dyy = stateZP[i] - 2.0f*stateZZ[i] + stateZM[i];
+                result[i] = advection[i] + (p.viscosityX[i]*dxx +
+                    p.viscosityY[i]*dyy + dt*src[i]);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::ComputeDivergence(int ymin, int ymax)
+{
+    Fluid2Parameters const& p = mParameters;
+    float const* state = &mStateTp1[0];
+    for (int y = ymin; y <= ymax; ++y)
+    {
+        int ym = std::max(y - 1, 0);
+        int yp = std::min(y + 1, mYSize - 1);
+        for (int x = 0; x < mXSize; ++x)
+        {
+            int xm = std::max(x - 1, 0);
+            int xp = std::min(x + 1, mXSize - 1);
+            mDivergence[Index(x, y)] =
+                p.halfDivDelta[0]*(state[4*Index(xp, y) + 0] -
+                state[4*Index(xm, y) + 0]) +
+                p.halfDivDelta[1]*(state[4*Index(x, yp) + 1] -
+                state[4*Index(x, ym) + 1]);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::SolvePoisson(int ymin, int ymax, int color)
+{
+    // Update the interior pixels (x,y) of the rows for which x+y has the
+    // parity 'color'.  Their neighbors have the other parity, so the
+    // threads do not write values that other threads read.
+    Vector4<float> const& epsilon = mParameters.epsilon;
+    int const xStride = 1, yStride = mXSize;
+    float* poisson = &mPoisson[0];
+    float const* divergence = &mDivergence[0];
+    for (int y = ymin; y <= ymax; ++y)
+    {
+        int xmin = 1 + ((1 + y + color) & 1);
+        for (int x = xmin; x < mXSize - 1; x += 2)
+        {
+            int i = Index(x, y);
+            poisson[i] =
+                epsilon[0]*(poisson[i + xStride] + poisson[i - xStride]) +
+                epsilon[1]*(poisson[i + yStride] + poisson[i - yStride]) +
+                epsilon[3]*divergence[i];
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::AdjustVelocity(int ymin, int ymax)
+{
+    Vector4<float> const& halfDivDelta = mParameters.halfDivDelta;
+    for (int y = ymin; y <= ymax; ++y)
+    {
+        int ym = std::max(y - 1, 0);
+        int yp = std::min(y + 1, mYSize - 1);
+        for (int x = 0; x < mXSize; ++x)
+        {
+            int xm = std::max(x - 1, 0);
+            int xp = std::min(x + 1, mXSize - 1);
+            int i = Index(x, y);
+            float const* inState = &mStateTp1[4*i];
+            float* outState = &mStateTm1[4*i];
+            outState[0] = inState[0] + halfDivDelta[0]*(
+                mPoisson[Index(xp, y)] - mPoisson[Index(xm, y)]);
+            outState[1] = inState[1] + halfDivDelta[1]*(
+                mPoisson[Index(x, yp)] - mPoisson[Index(x, ym)]);
+            outState[2] = inState[2];
+            outState[3] = inState[3];
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::EnforceStateBoundary(std::vector<float>& state)
+{
+    // The edges are processed in the order x, y as in
+    // Fluid2EnforceStateBoundary.  The velocity component normal to an edge
+    // and the density are zero.  The tangential component is copied from
+    // the adjacent interior pixel.
+    float* s = &state[0];
+    int const xLast = mXSize - 1, yLast = mYSize - 1;
+    for (int y = 0; y < mYSize; ++y)
+    {
+        float* minEdge = &s[4*Index(0, y)];
+        float const* minInterior = &s[4*Index(1, y)];
+        float* maxEdge = &s[4*Index(xLast, y)];
+        float const* maxInterior = &s[4*Index(xLast - 1, y)];
+        minEdge[0] = 0.0f;
+        minEdge[1] = minInterior[1];
+        minEdge[2] = 0.0f;
+        minEdge[3] = 0.0f;
+        maxEdge[0] = 0.0f;
+        maxEdge[1] = maxInterior[1];
+        maxEdge[2] = 0.0f;
+        maxEdge[3] = 0.0f;
+    }
+
+    for (int x = 0; x < mXSize; ++x)
+    {
+        float* minEdge = &s[4*Index(x, 0)];
+        float const* minInterior = &s[4*Index(x, 1)];
+        float* maxEdge = &s[4*Index(x, yLast)];
+        float const* maxInterior = &s[4*Index(x, yLast - 1)];
+        minEdge[0] = minInterior[0];
+        minEdge[1] = 0.0f;
+        minEdge[2] = 0.0f;
+        minEdge[3] = 0.0f;
+        maxEdge[0] = maxInterior[0];
+        maxEdge[1] = 0.0f;
+        maxEdge[2] = 0.0f;
+        maxEdge[3] = 0.0f;
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::Execute(int numRows,
+    std::function<void(int, int)> const& stage)
+{
+    if (mNumThreads > 1 && numRows > 1)
+    {
+        mCModel->GetThreadPool().ParallelFor(numRows, mNumThreads, stage);
+    }
+    else if (numRows > 0)
+    {
+        stage(0, numRows - 1);
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid2CPU::Sample(float u, float v, float* result) const
+{
+    // The sampler of Fluid2UpdateState uses bilinear filtering and clamp
+    // addressing, which is equivalent to clamping the pixel coordinates to
+    // the grid.
+    u = std::min(std::max(u, 0.0f), static_cast<float>(mXSize - 1));
+    v = std::min(std::max(v, 0.0f), static_cast<float>(mYSize - 1));
+    int x0 = static_cast<int>(u), x1 = std::min(x0 + 1, mXSize - 1);
+    int y0 = static_cast<int>(v), y1 = std::min(y0 + 1, mYSize - 1);
+    float fu = u - x0, fv = v - y0;
+    float const* s00 = &mStateTm1[4*Index(x0, y0)];
+    float const* s10 = &mStateTm1[4*Index(x1, y0)];
+    float const* s01 = &mStateTm1[4*Index(x0, y1)];
+    float const* s11 = &mStateTm1[4*Index(x1, y1)];
+    for (int i = 0; i < 4; ++i)
+    {
+        float s0 = s00[i] + fu*(s10[i] - s00[i]);
+        float s1 = s01[i] + fu*(s11[i] - s01[i]);
+        result[i] = s0 + fv*(s1 - s0);
+    }
+}
+//----------------------------------------------------------------------------
@@ -23,11 +23,40 @@ Fluid3::Fluid3(DX11Engine* engine, int xSize, int ySize, int zSize,
     mZSize(zSize),
     mDt(dt),
     mTime(0.0f)
+{
+    CreateShaders();
+}
+//----------------------------------------------------------------------------
+Fluid3::Fluid3(std::shared_ptr<ComputeModel> const& cmodel, int xSize,
+    int ySize, int zSize, float dt)
+    :
+    mEngine(cmodel ? cmodel->engine : nullptr),
+    mXSize(xSize),
+    mYSize(ySize),
+    mZSize(zSize),
+    mDt(dt),
+    mTime(0.0f)
+{
+    if (mEngine)
+    {
+        CreateShaders();
+    }
+    else
+    {
+        mCPU.reset(new Fluid3CPU(mXSize, mYSize, mZSize, mDt, cmodel));
+        mStateTTexture.reset(new Texture3(DF_R32G32B32A32_FLOAT, mXSize,
+            mYSize, mZSize));
+        mStateTTexture->SetUsage(Resource::DYNAMIC_UPDATE);
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid3::CreateShaders()
 {
     // Create the shared parameters for many of the simulation shaders.
     float dx = 1.0f/static_cast<float>(mXSize);
     float dy = 1.0f/static_cast<float>(mYSize);
     float dz = 1.0f/static_cast<float>(mZSize);
+    float dt = mDt;
     float dtDivDxDx = (dt/dx)/dx;
     float dtDivDyDy = (dt/dy)/dy;
     float dtDivDzDz = (dt/dz)/dz;
@@ -90,23 +119,39 @@ Fluid3::Fluid3(DX11Engine* engine, int xSize, int ySize, int zSize,
 //----------------------------------------------------------------------------
 void Fluid3::Initialize()
 {
-    mInitializeSource->Execute(mEngine);
-    mInitializeState->Execute(mEngine);
-    mEnforceStateBoundary->Execute(mEngine, mStateTm1Texture);
-    mEnforceStateBoundary->Execute(mEngine, mStateTTexture);
+    if (mCPU)
+    {
+        mCPU->Initialize();
+        CopyStateFromCPU();
+    }
+    else
+    {
+        mInitializeSource->Execute(mEngine);
+        mInitializeState->Execute(mEngine);
+        mEnforceStateBoundary->Execute(mEngine, mStateTm1Texture);
+        mEnforceStateBoundary->Execute(mEngine, mStateTTexture);
+    }
 }
 //----------------------------------------------------------------------------
 void Fluid3::DoSimulationStep()
 {
-    mUpdateState->Execute(mEngine, mSourceTexture, mStateTm1Texture,
-        mStateTTexture);
-    mEnforceStateBoundary->Execute(mEngine, mStateTp1Texture);
-    mComputeDivergence->Execute(mEngine, mStateTp1Texture);
-    mSolvePoisson->Execute(mEngine, mDivergenceTexture);
-    mAdjustVelocity->Execute(mEngine, mStateTp1Texture, mPoissonTexture,
-        mStateTm1Texture);
-    mEnforceStateBoundary->Execute(mEngine, mStateTm1Texture);
-    std::swap(mStateTm1Texture, mStateTTexture);
+    if (mCPU)
+    {
+        mCPU->DoSimulationStep();
+        CopyStateFromCPU();
+    }
+    else
+    {
+        mUpdateState->Execute(mEngine, mSourceTexture, mStateTm1Texture,
+            mStateTTexture);
+        mEnforceStateBoundary->Execute(mEngine, mStateTp1Texture);
+        mComputeDivergence->Execute(mEngine, mStateTp1Texture);
+        mSolvePoisson->Execute(mEngine, mDivergenceTexture);
+        mAdjustVelocity->Execute(mEngine, mStateTp1Texture, mPoissonTexture,
+            mStateTm1Texture);
+        mEnforceStateBoundary->Execute(mEngine, mStateTm1Texture);
+        std::swap(mStateTm1Texture, mStateTTexture);
+    }
 
     mTime += mDt;
 }
@@ -116,3 +161,10 @@ std::shared_ptr<Texture3> const& Fluid3::GetState() const
     return mStateTTexture;
 }
 //----------------------------------------------------------------------------
+void Fluid3::CopyStateFromCPU()
+{
+    std::vector<float> const& state = mCPU->GetState();
+    memcpy(mStateTTexture->GetData(), &state[0],
+        mStateTTexture->GetNumBytes());
+}
+//----------------------------------------------------------------------------
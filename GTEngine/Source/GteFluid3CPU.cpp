@@ -0,0 +1,534 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/10/16)
+
+#include "GTEnginePCH.h"
+#include "GteFluid3CPU.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+using namespace gte;
+
+//----------------------------------------------------------------------------
+Fluid3CPU::~Fluid3CPU()
+{
+}
+//----------------------------------------------------------------------------
+Fluid3CPU::Fluid3CPU(int xSize, int ySize, int zSize, float dt,
+    std::shared_ptr<ComputeModel> const& cmodel, int numPoissonIterations)
+    :
+    mXSize(xSize),
+    mYSize(ySize),
+    mZSize(zSize),
+    mDt(dt),
+    mCModel(cmodel),
+    mNumThreads(cmodel ? static_cast<int>(cmodel->numThreads) : 1),
+    mNumPoissonIterations(numPoissonIterations),
+    mTime(0.0f)
+{
+    // The parameters are those computed by Fluid3.
+    float dx = 1.0f/static_cast<float>(mXSize);
+    float dy = 1.0f/static_cast<float>(mYSize);
+    float dz = 1.0f/static_cast<float>(mZSize);
+    float dtDivDxDx = (dt/dx)/dx;
+    float dtDivDyDy = (dt/dy)/dy;
+    float dtDivDzDz = (dt/dz)/dz;
+    float ratio0 = dx/dy;
+    float ratio1 = dx/dz;
+    float ratio0Sqr = ratio0*ratio0;
+    float ratio1Sqr = ratio1*ratio1;
+    float factor = 0.5f/(1.0f + ratio0Sqr + ratio1Sqr);
+    float epsilonX = factor;
+    float epsilonY = ratio0Sqr*factor;
+    float epsilonZ = ratio1Sqr*factor;
+    float epsilon0 = dx*dx*factor;
+    float const denViscosity = 0.0001f;
+    float const velViscosity = 0.0001f;
+    float denVX = denViscosity*dtDivDxDx;
+    float denVY = denViscosity*dtDivDyDy;
+    float denVZ = denViscosity*dtDivDzDz;
+    float velVX = velViscosity*dtDivDxDx;
+    float velVY = velViscosity*dtDivDyDy;
+    float velVZ = velViscosity*dtDivDzDz;
+
+    Fluid3Parameters& p = mParameters;
+    p.spaceDelta = Vector4<float>(dx, dy, dz, 0.0f);
+    p.halfDivDelta = Vector4<float>(0.5f/dx, 0.5f/dy, 0.5f/dz, 0.0f);
+    p.timeDelta = Vector4<float>(dt/dx, dt/dy, dt/dz, dt);
+    p.viscosityX = Vector4<float>(velVX, velVX, velVX, denVX);
+    p.viscosityY = Vector4<float>(velVY, velVY, velVY, denVY);
+    p.viscosityZ = Vector4<float>(velVZ, velVZ, velVZ, denVZ);
+    p.epsilon = Vector4<float>(epsilonX, epsilonY, epsilonZ, epsilon0);
+
+    size_t const numVoxels = static_cast<size_t>(mXSize*mYSize*mZSize);
+    mSource.resize(4*numVoxels);
+    mStateTm1.resize(4*numVoxels);
+    mStateT.resize(4*numVoxels);
+    mStateTp1.resize(4*numVoxels);
+    mDivergence.resize(numVoxels);
+    mPoisson.resize(numVoxels);
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::Initialize()
+{
+    // Generate the vortices in the same order as Fluid3InitializeSource so
+    // that the two implementations have the same sources.
+    std::mt19937 mte;
+    std::uniform_real_distribution<float> unirnd(0.0f, 1.0f);
+    std::uniform_real_distribution<float> symrnd(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> posrnd0(0.001f, 0.01f);
+    std::uniform_real_distribution<float> posrnd1(64.0f, 128.0f);
+
+    mVortices.resize(NUM_VORTICES);
+    for (auto& v : mVortices)
+    {
+        v.position[0] = unirnd(mte);
+        v.position[1] = unirnd(mte);
+        v.position[2] = unirnd(mte);
+        v.normal[0] = symrnd(mte);
+        v.normal[1] = symrnd(mte);
+        v.normal[2] = symrnd(mte);
+        float length = sqrt(v.normal[0]*v.normal[0] +
+            v.normal[1]*v.normal[1] + v.normal[2]*v.normal[2]);
+        if (length > 0.0f)
+        {
+            v.normal[0] /= length;
+            v.normal[1] /= length;
+            v.normal[2] /= length;
+        }
+        v.variance = posrnd0(mte);
+        v.amplitude = posrnd1(mte);
+    }
+
+    Execute(mZSize, [this](int zmin, int zmax)
+    {
+        InitializeSource(zmin, zmax);
+    });
+
+    // Initial density values are randomly generated and initial velocity
+    // values are zero, as in Fluid3InitializeState.
+    std::mt19937 mteState;
+    size_t const numVoxels = mDivergence.size();
+    for (size_t i = 0; i < numVoxels; ++i)
+    {
+        mStateT[4*i + 0] = 0.0f;
+        mStateT[4*i + 1] = 0.0f;
+        mStateT[4*i + 2] = 0.0f;
+        mStateT[4*i + 3] = unirnd(mteState);
+    }
+    mStateTm1 = mStateT;
+
+    EnforceStateBoundary(mStateTm1);
+    EnforceStateBoundary(mStateT);
+    mTime = 0.0f;
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::DoSimulationStep()
+{
+    Execute(mZSize, [this](int zmin, int zmax)
+    {
+        UpdateState(zmin, zmax);
+    });
+    EnforceStateBoundary(mStateTp1);
+
+    Execute(mZSize, [this](int zmin, int zmax)
+    {
+        ComputeDivergence(zmin, zmax);
+    });
+
+    // The boundary values of the Poisson solution are zero.  Only the
+    // interior values are modified by the solver.
+    std::fill(mPoisson.begin(), mPoisson.end(), 0.0f);
+    for (int i = 0; i < mNumPoissonIterations; ++i)
+    {
+        for (int color = 0; color < 2; ++color)
+        {
+            Execute(mZSize - 2, [this, color](int zmin, int zmax)
+            {
+                SolvePoisson(zmin + 1, zmax + 1, color);
+            });
+        }
+    }
+
+    Execute(mZSize, [this](int zmin, int zmax)
+    {
+        AdjustVelocity(zmin, zmax);
+    });
+    EnforceStateBoundary(mStateTm1);
+    std::swap(mStateTm1, mStateT);
+
+    mTime += mDt;
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::InitializeSource(int zmin, int zmax)
+{
+    float const dx = mParameters.spaceDelta[0];
+    float const dy = mParameters.spaceDelta[1];
+    float const dz = mParameters.spaceDelta[2];
+    float* source = &mSource[4*Index(0, 0, zmin)];
+    size_t const numSlabVoxels =
+        static_cast<size_t>(mXSize*mYSize*(zmax - zmin + 1));
+    std::fill(source, source + 4*numSlabVoxels, 0.0f);
+
+    // The velocity of a vortex is amplitude*exp(-|diff|^2/variance) times
+    // Cross(normal,diff), where diff is the voxel location relative to the
+    // vortex position.  The exponential is the product of exponentials in
+    // x, y, and z, which are computed once per vortex.  The voxels outside
+    // the box of radius sqrt(variance*log(amplitude/threshold)) centered at
+    // the vortex position are skipped.  The magnitudes there are smaller
+    // than 'threshold', which is below the float precision of the
+    // velocity.
+    float const threshold = 1e-8f;
+    std::vector<float> xDiff(mXSize), xExp(mXSize);
+    std::vector<float> yDiff(mYSize), yExp(mYSize);
+    std::vector<float> zDiff(mZSize), zExp(mZSize);
+    for (auto const& v : mVortices)
+    {
+        float radius = sqrt(v.variance*log(v.amplitude/threshold));
+        int x0 = std::max(static_cast<int>(
+            floor((v.position[0] - radius)/dx)), 0);
+        int x1 = std::min(static_cast<int>(
+            ceil((v.position[0] + radius)/dx)), mXSize - 1);
+        int y0 = std::max(static_cast<int>(
+            floor((v.position[1] - radius)/dy)), 0);
+        int y1 = std::min(static_cast<int>(
+            ceil((v.position[1] + radius)/dy)), mYSize - 1);
+        int z0 = std::max(static_cast<int>(
+            floor((v.position[2] - radius)/dz)), zmin);
+        int z1 = std::min(static_cast<int>(
+            ceil((v.position[2] + radius)/dz)), zmax);
+        if (z0 > z1)
+        {
+            continue;
+        }
+
+        for (int x = x0; x <= x1; ++x)
+        {
+            xDiff[x] = dx*(x + 0.5f) - v.position[0];
+            xExp[x] = exp(-xDiff[x]*xDiff[x]/v.variance);
+        }
+        for (int y = y0; y <= y1; ++y)
+        {
+            yDiff[y] = dy*(y + 0.5f) - v.position[1];
+            yExp[y] = exp(-yDiff[y]*yDiff[y]/v.variance);
+        }
+        for (int z = z0; z <= z1; ++z)
+        {
+            zDiff[z] = dz*(z + 0.5f) - v.position[2];
+            zExp[z] = v.amplitude*exp(-zDiff[z]*zDiff[z]/v.variance);
+        }
+
+        float const n0 = v.normal[0], n1 = v.normal[1], n2 = v.normal[2];
+        for (int z = z0; z <= z1; ++z)
+        {
+            float const d2 = zDiff[z];
+            for (int y = y0; y <= y1; ++y)
+            {
+                float const d1 = yDiff[y];
+                float const magnitudeYZ = zExp[z]*yExp[y];
+                float* velocity = &mSource[4*Index(x0, y, z)];
+                for (int x = x0; x <= x1; ++x, velocity += 4)
+                {
+                    float const d0 = xDiff[x];
+                    float const magnitude = magnitudeYZ*xExp[x];
+                    velocity[0] += magnitude*(n1*d2 - n2*d1);
+                    velocity[1] += magnitude*(n2*d0 - n0*d2);
+                    velocity[2] += magnitude*(n0*d1 - n1*d0);
+                }
+            }
+        }
+    }
+
+    // The density producer and consumer, gravity, and wind of
+    // Fluid3InitializeSource.
+    float const producer[3] = { 0.5f, 0.5f, 0.5f };
+    float const producerVariance = 0.01f, producerAmplitude = 16.0f;
+    float const consumer[3] = { 0.75f, 0.75f, 0.75f };
+    float const consumerVariance = 0.01f, consumerAmplitude = 0.0f;
+    float const gravity[3] = { 0.0f, 0.0f, 0.0f };
+    float const windVariance = 0.001f, windAmplitude = 0.0f;
+    for (int z = zmin; z <= zmax; ++z)
+    {
+        float const lz = dz*(z + 0.5f);
+        for (int y = 0; y < mYSize; ++y)
+        {
+            float const ly = dy*(y + 0.5f);
+            float* src = &mSource[4*Index(0, y, z)];
+            for (int x = 0; x < mXSize; ++x, src += 4)
+            {
+                float const lx = dx*(x + 0.5f);
+                float d0 = lx - producer[0];
+                float d1 = ly - producer[1];
+                float d2 = lz - producer[2];
+                float arg = -(d0*d0 + d1*d1 + d2*d2)/producerVariance;
+                float density = producerAmplitude*exp(arg);
+                d0 = lx - consumer[0];
+                d1 = ly - consumer[1];
+                d2 = lz - consumer[2];
+                arg = -(d0*d0 + d1*d1 + d2*d2)/consumerVariance;
+                density -= consumerAmplitude*exp(arg);
+
+                float windArg = -(lx*lx + lz*lz)/windVariance;
+                src[0] += gravity[0];
+                src[1] += gravity[1] + windAmplitude*exp(windArg);
+                src[2] += gravity[2];
+                src[3] = density;
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::UpdateState(int zmin, int zmax)
+{
+    Fluid3Parameters const& p = mParameters;
+    float const* stateT = &mStateT[0];
+    float const dt = p.timeDelta[3];
+    for (int z = zmin; z <= zmax; ++z)
+    {
+        int zm = std::max(z - 1, 0);
+        int zp = std::min(z + 1, mZSize - 1);
+        for (int y = 0; y < mYSize; ++y)
+        {
+            int ym = std::max(y - 1, 0);
+            int yp = std::min(y + 1, mYSize - 1);
+            for (int x = 0; x < mXSize; ++x)
+            {
+                int xm = std::max(x - 1, 0);
+                int xp = std::min(x + 1, mXSize - 1);
+
+                // Sample states at (x,y,z) and immediate neighbors.
+                float const* stateZZZ = &stateT[4*Index(x, y, z)];
+                float const* statePZZ = &stateT[4*Index(xp, y, z)];
+                float const* stateMZZ = &stateT[4*Index(xm, y, z)];
+                float const* stateZPZ = &stateT[4*Index(x, yp, z)];
+                float const* stateZMZ = &stateT[4*Index(x, ym, z)];
+                float const* stateZZP = &stateT[4*Index(x, y, zp)];
+                float const* stateZZM = &stateT[4*Index(x, y, zm)];
+                float const* src = &mSource[4*Index(x, y, z)];
+
+                // Compute advection.  The shader samples stateTm1 at the
+                // normalized coordinates spaceDelta*(c - timeDelta*state +
+                // 0.5), which are the voxel coordinates
+                // c - timeDelta*state.
+                float advection[4];
+                Sample(
+                    x - p.timeDelta[0]*stateZZZ[0],
+                    y - p.timeDelta[1]*stateZZZ[1],
+                    z - p.timeDelta[2]*stateZZZ[2],
+                    advection);
+
+                // Update the state.
+                float* result = &mStateTp1[4*Index(x, y, z)];
+                for (int i = 0; i < 4; ++i)
+                {
+                    float dxx = statePZZ[i] - 2.0f*stateZZZ[i] + stateMZZ[i];
+                    float dyy = stateZPZ[i] - 2.0f*stateZZZ[i] + stateZMZ[i];
+                    float dzz = stateZZP[i] - 2.0f*stateZZZ[i] + stateZZM[i];
+                    result[i] = advection[i] + (p.viscosityX[i]*dxx +
+                        p.viscosityY[i]*dyy + p.viscosityZ[i]*dzz +
+                        dt*src[i]);
+                }
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::ComputeDivergence(int zmin, int zmax)
+{
+    Fluid3Parameters const& p = mParameters;
+    float const* state = &mStateTp1[0];
+    for (int z = zmin; z <= zmax; ++z)
+    {
+        int zm = std::max(z - 1, 0);
+        int zp = std::min(z + 1, mZSize - 1);
+        for (int y = 0; y < mYSize; ++y)
+        {
+            int ym = std::max(y - 1, 0);
+            int yp = std::min(y + 1, mYSize - 1);
+            for (int x = 0; x < mXSize; ++x)
+            {
+                int xm = std::max(x - 1, 0);
+                int xp = std::min(x + 1, mXSize - 1);
+                mDivergence[Index(x, y, z)] =
+                    p.halfDivDelta[0]*(state[4*Index(xp, y, z) + 0] -
+                    state[4*Index(xm, y, z) + 0]) +
+                    p.halfDivDelta[1]*(state[4*Index(x, yp, z) + 1] -
+                    state[4*Index(x, ym, z) + 1]) +
+                    p.halfDivDelta[2]*(state[4*Index(x, y, zp) + 2] -
+                    state[4*Index(x, y, zm) + 2]);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::SolvePoisson(int zmin, int zmax, int color)
+{
+    // Update the interior voxels (x,y,z) of the slabs for which x+y+z has
+    // the parity 'color'.  Their neighbors have the other parity, so the
+    // threads do not write values that other threads read.
+    Vector4<float> const& epsilon = mParameters.epsilon;
+    int const xStride = 1, yStride = mXSize, zStride = mXSize*mYSize;
+    float* poisson = &mPoisson[0];
+    float const* divergence = &mDivergence[0];
+    for (int z = zmin; z <= zmax; ++z)
+    {
+        for (int y = 1; y < mYSize - 1; ++y)
+        {
+            int xmin = 1 + ((1 + y + z + color) & 1);
+            for (int x = xmin; x < mXSize - 1; x += 2)
+            {
+                int i = Index(x, y, z);
+                poisson[i] =
+                    epsilon[0]*(poisson[i + xStride] + poisson[i - xStride]) +
+                    epsilon[1]*(poisson[i + yStride] + poisson[i - yStride]) +
+                    epsilon[2]*(poisson[i + zStride] + poisson[i - zStride]) +
+                    epsilon[3]*divergence[i];
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::AdjustVelocity(int zmin, int zmax)
+{
+    Vector4<float> const& halfDivDelta = mParameters.halfDivDelta;
+    for (int z = zmin; z <= zmax; ++z)
+    {
+        int zm = std::max(z - 1, 0);
+        int zp = std::min(z + 1, mZSize - 1);
+        for (int y = 0; y < mYSize; ++y)
+        {
+            int ym = std::max(y - 1, 0);
+            int yp = std::min(y + 1, mYSize - 1);
+            for (int x = 0; x < mXSize; ++x)
+            {
+                int xm = std::max(x - 1, 0);
+                int xp = std::min(x + 1, mXSize - 1);
+                int i = Index(x, y, z);
+                float const* inState = &mStateTp1[4*i];
+                float* outState = &mStateTm1[4*i];
+                outState[0] = inState[0] + halfDivDelta[0]*(
+                    mPoisson[Index(xp, y, z)] - mPoisson[Index(xm, y, z)]);
+                outState[1] = inState[1] + halfDivDelta[1]*(
+                    mPoisson[Index(x, yp, z)] - mPoisson[Index(x, ym, z)]);
+                outState[2] = inState[2] + halfDivDelta[2]*(
+                    mPoisson[Index(x, y, zp)] - mPoisson[Index(x, y, zm)]);
+                outState[3] = inState[3];
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::EnforceStateBoundary(std::vector<float>& state)
+{
+    // The faces are processed in the order x, y, z as in
+    // Fluid3EnforceStateBoundary.  The velocity component normal to a face
+    // and the density are zero.  The tangential components are copied from
+    // the adjacent interior voxels.
+    float* s = &state[0];
+    int const xLast = mXSize - 1, yLast = mYSize - 1, zLast = mZSize - 1;
+    for (int z = 0; z < mZSize; ++z)
+    {
+        for (int y = 0; y < mYSize; ++y)
+        {
+            float* minFace = &s[4*Index(0, y, z)];
+            float const* minInterior = &s[4*Index(1, y, z)];
+            float* maxFace = &s[4*Index(xLast, y, z)];
+            float const* maxInterior = &s[4*Index(xLast - 1, y, z)];
+            minFace[0] = 0.0f;
+            minFace[1] = minInterior[1];
+            minFace[2] = minInterior[2];
+            minFace[3] = 0.0f;
+            maxFace[0] = 0.0f;
+            maxFace[1] = maxInterior[1];
+            maxFace[2] = maxInterior[2];
+            maxFace[3] = 0.0f;
+        }
+    }
+
+    for (int z = 0; z < mZSize; ++z)
+    {
+        for (int x = 0; x < mXSize; ++x)
+        {
+            float* minFace = &s[4*Index(x, 0, z)];
+            float const* minInterior = &s[4*Index(x, 1, z)];
+            float* maxFace = &s[4*Index(x, yLast, z)];
+            float const* maxInterior = &s[4*Index(x, yLast - 1, z)];
+            minFace[0] = minInterior[0];
+            minFace[1] = 0.0f;
+            minFace[2] = minInterior[2];
+            minFace[3] = 0.0f;
+            maxFace[0] = maxInterior[0];
+            maxFace[1] = 0.0f;
+            maxFace[2] = maxInterior[2];
+            maxFace[3] = 0.0f;
+        }
+    }
+
+    for (int y = 0; y < mYSize; ++y)
+    {
+        for (int x = 0; x < mXSize; ++x)
+        {
+            float* minFace = &s[4*Index(x, y, 0)];
+            float const* minInterior = &s[4*Index(x, y, 1)];
+            float* maxFace = &s[4*Index(x, y, zLast)];
+            float const* maxInterior = &s[4*Index(x, y, zLast - 1)];
+            minFace[0] = minInterior[0];
+            minFace[1] = minInterior[1];
+            minFace[2] = 0.0f;
+            minFace[3] = 0.0f;
+            maxFace[0] = maxInterior[0];
+            maxFace[1] = maxInterior[1];
+            maxFace[2] = 0.0f;
+            maxFace[3] = 0.0f;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::Execute(int numSlabs,
+    std::function<void(int, int)> const& stage)
+{
+    if (mNumThreads > 1 && numSlabs > 1)
+    {
+        mCModel->GetThreadPool().ParallelFor(numSlabs, mNumThreads, stage);
+    }
+    else if (numSlabs > 0)
+    {
+        stage(0, numSlabs - 1);
+    }
+}
+//----------------------------------------------------------------------------
+void Fluid3CPU::Sample(float u, float v, float w, float* result) const
+{
+    // The sampler of Fluid3UpdateState uses trilinear filtering and clamp
+    // addressing, which is equivalent to clamping the voxel coordinates to
+    // the grid.
+    u = std::min(std::max(u, 0.0f), static_cast<float>(mXSize - 1));
+    v = std::min(std::max(v, 0.0f), static_cast<float>(mYSize - 1));
+    w = std::min(std::max(w, 0.0f), static_cast<float>(mZSize - 1));
+    int x0 = static_cast<int>(u), x1 = std::min(x0 + 1, mXSize - 1);
+    int y0 = static_cast<int>(v), y1 = std::min(y0 + 1, mYSize - 1);
+    int z0 = static_cast<int>(w), z1 = std::min(z0 + 1, mZSize - 1);
+    float fu = u - x0, fv = v - y0, fw = w - z0;
+    float const* s000 = &mStateTm1[4*Index(x0, y0, z0)];
+    float const* s100 = &mStateTm1[4*Index(x1, y0, z0)];
+    float const* s010 = &mStateTm1[4*Index(x0, y1, z0)];
+    float const* s110 = &mStateTm1[4*Index(x1, y1, z0)];
+    float const* s001 = &mStateTm1[4*Index(x0, y0, z1)];
+    float const* s101 = &mStateTm1[4*Index(x1, y0, z1)];
+    float const* s011 = &mStateTm1[4*Index(x0, y1, z1)];
+    float const* s111 = &mStateTm1[4*Index(x1, y1, z1)];
+    for (int i = 0; i < 4; ++i)
+    {
+        float s00 = s000[i] + fu*(s100[i] - s000[i]);
+        float s10 = s010[i] + fu*(s110[i] - s010[i]);
+        float s01 = s001[i] + fu*(s101[i] - s001[i]);
+        float s11 = s011[i] + fu*(s111[i] - s011[i]);
+        float s0 = s00 + fv*(s10 - s00);
+        float s1 = s01 + fv*(s11 - s01);
+        result[i] = s0 + fw*(s1 - s0);
+    }
+}
+//----------------------------------------------------------------------------
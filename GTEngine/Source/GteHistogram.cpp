@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/31)
+// File Version: 1.0.2 (2014/10/30)
 
 #include "GTEnginePCH.h"
 #include "GteHistogram.h"
@@ -17,12 +17,15 @@ Histogram::~Histogram ()
 }
 //----------------------------------------------------------------------------
 Histogram::Histogram (int numBuckets, int numSamples, int const* samples,
-    bool noRescaling)
+    bool noRescaling, std::shared_ptr<ComputeModel> const& cmodel)
     :
     mNumBuckets(numBuckets),
     mBuckets(nullptr),
     mExcessLess(0),
-    mExcessGreater(0)
+    mExcessGreater(0),
+    mMinValue(0.0),
+    mMaxValue((double)(numBuckets - 1)),
+    mMultiplier(1.0)
 {
     if (mNumBuckets <= 0 || numSamples <= 0 || !samples)
     {
@@ -34,75 +37,27 @@ Histogram::Histogram (int numBuckets, int numSamples, int const* samples,
     mBuckets = new int[mNumBuckets];
     memset(mBuckets, 0, mNumBuckets*sizeof(int));
 
-    int i, value;
-
     if (noRescaling)
     {
         // Map to the buckets, also counting out-of-range pixels.
-        for (i = 0; i < numSamples; ++i)
-        {
-            value = samples[i];
-            if (0 <= value)
-            {
-                if (value < mNumBuckets)
-                {
-                    ++mBuckets[value];
-                }
-                else
-                {
-                    ++mExcessGreater;
-                }
-            }
-            else
-            {
-                ++mExcessLess;
-            }
-        }
+        Count(numSamples, samples, cmodel.get());
     }
     else
     {
-        // Compute the extremes.
-        int minValue = samples[0], maxValue = minValue;
-        for (i = 1; i < numSamples; ++i)
-        {
-            value = samples[i];
-            if (value < minValue)
-            {
-                minValue = value;
-            }
-            else if (value > maxValue)
-            {
-                maxValue = value;
-            }
-        }
-
-        // Map to the buckets.
-        if (minValue < maxValue)
-        {
-            // The image is not constant.
-            double numer = (double)(mNumBuckets - 1);
-            double denom = (double)(maxValue - minValue);
-            double mult = numer/denom;
-            for (i = 0; i < numSamples; ++i)
-            {
-                int index = (int)(mult*(double)(samples[i] - minValue));
-                ++mBuckets[index];
-            }
-        }
-        else
-        {
-            // The image is constant.
-            mBuckets[0] = numSamples;
-        }
+        Rescale(numSamples, samples, cmodel.get());
     }
 }
 //----------------------------------------------------------------------------
-Histogram::Histogram (int numBuckets, int numSamples, float const* samples)
+Histogram::Histogram (int numBuckets, int numSamples, float const* samples,
+    std::shared_ptr<ComputeModel> const& cmodel)
     :
     mNumBuckets(numBuckets),
     mBuckets(nullptr),
     mExcessLess(0),
-    mExcessGreater(0)
+    mExcessGreater(0),
+    mMinValue(0.0),
+    mMaxValue((double)(numBuckets - 1)),
+    mMultiplier(1.0)
 {
     if (mNumBuckets <= 0 || numSamples <= 0 || !samples)
     {
@@ -114,47 +69,19 @@ Histogram::Histogram (int numBuckets, int numSamples, float const* samples)
     mBuckets = new int[mNumBuckets];
     memset(mBuckets, 0, mNumBuckets*sizeof(int));
 
-    // Compute the extremes.
-    float minValue = samples[0], maxValue = minValue;
-    for (int i = 1; i < numSamples; ++i)
-    {
-        float value = samples[i];
-        if (value < minValue)
-        {
-            minValue = value;
-        }
-        else if (value > maxValue)
-        {
-            maxValue = value;
-        }
-    }
-
-    // Map to the buckets.
-    if (minValue < maxValue)
-    {
-        // The image is not constant.
-        double numer = (double)(mNumBuckets - 1);
-        double denom = (double)(maxValue - minValue);
-        double mult = numer/denom;
-        for (int i = 0; i < numSamples; ++i)
-        {
-            int index = (int)(mult*(double)(samples[i] - minValue));
-            ++mBuckets[index];
-        }
-    }
-    else
-    {
-        // The image is constant.
-        mBuckets[0] = numSamples;
-    }
+    Rescale(numSamples, samples, cmodel.get());
 }
 //----------------------------------------------------------------------------
-Histogram::Histogram (int numBuckets, int numSamples, double const* samples)
+Histogram::Histogram (int numBuckets, int numSamples, double const* samples,
+    std::shared_ptr<ComputeModel> const& cmodel)
     :
     mNumBuckets(numBuckets),
     mBuckets(nullptr),
     mExcessLess(0),
-    mExcessGreater(0)
+    mExcessGreater(0),
+    mMinValue(0.0),
+    mMaxValue((double)(numBuckets - 1)),
+    mMultiplier(1.0)
 {
     if (mNumBuckets <= 0 || numSamples <= 0 || !samples)
     {
@@ -166,39 +93,7 @@ Histogram::Histogram (int numBuckets, int numSamples, double const* samples)
     mBuckets = new int[mNumBuckets];
     memset(mBuckets, 0, mNumBuckets*sizeof(int));
 
-    // Compute the extremes.
-    double minValue = samples[0], maxValue = minValue;
-    for (int i = 1; i < numSamples; ++i)
-    {
-        double value = samples[i];
-        if (value < minValue)
-        {
-            minValue = value;
-        }
-        else if (value > maxValue)
-        {
-            maxValue = value;
-        }
-    }
-
-    // Map to the buckets.
-    if (minValue < maxValue)
-    {
-        // The image is not constant.
-        double numer = (double)(mNumBuckets - 1);
-        double denom = maxValue - minValue;
-        double mult = numer/denom;
-        for (int i = 0; i < numSamples; ++i)
-        {
-            int index = (int)(mult*(samples[i] - minValue));
-            ++mBuckets[index];
-        }
-    }
-    else
-    {
-        // The image is constant.
-        mBuckets[0] = numSamples;
-    }
+    Rescale(numSamples, samples, cmodel.get());
 }
 //----------------------------------------------------------------------------
 Histogram::Histogram (int numBuckets)
@@ -206,7 +101,10 @@ Histogram::Histogram (int numBuckets)
     mNumBuckets(numBuckets),
     mBuckets(nullptr),
     mExcessLess(0),
-    mExcessGreater(0)
+    mExcessGreater(0),
+    mMinValue(0.0),
+    mMaxValue((double)(numBuckets - 1)),
+    mMultiplier(1.0)
 {
     if (mNumBuckets <= 0)
     {
@@ -238,6 +136,15 @@ void Histogram::InsertCheck (int value)
     }
 }
 //----------------------------------------------------------------------------
+void Histogram::InsertCheck (int numSamples, int const* samples,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    if (mNumBuckets > 0 && numSamples > 0 && samples)
+    {
+        Count(numSamples, samples, cmodel.get());
+    }
+}
+//----------------------------------------------------------------------------
 int Histogram::GetLowerTail (double tailAmount)
 {
     int hSum = 0;
@@ -315,6 +222,82 @@ void Histogram::GetTails (double tailAmount, int& lower, int& upper)
     }
 }
 //----------------------------------------------------------------------------
+void Histogram::GetCDF (std::vector<double>& cdf) const
+{
+    cdf.resize(mNumBuckets);
+    double sum = 0.0;
+    for (int i = 0; i < mNumBuckets; ++i)
+    {
+        sum += (double)mBuckets[i];
+        cdf[i] = sum;
+    }
+
+    if (sum > 0.0)
+    {
+        for (int i = 0; i < mNumBuckets; ++i)
+        {
+            cdf[i] /= sum;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+int Histogram::GetPercentile (double fraction) const
+{
+    double hSum = 0.0;
+    for (int i = 0; i < mNumBuckets; ++i)
+    {
+        hSum += (double)mBuckets[i];
+    }
+
+    double hTarget = fraction*hSum;
+    double hLowerSum = 0.0;
+    int percentile;
+    for (percentile = 0; percentile < mNumBuckets - 1; ++percentile)
+    {
+        hLowerSum += (double)mBuckets[percentile];
+        if (hLowerSum >= hTarget)
+        {
+            break;
+        }
+    }
+    return percentile;
+}
+//----------------------------------------------------------------------------
+int Histogram::GetOtsuThreshold () const
+{
+    // The between-class variance for threshold T is
+    //   w0*w1*(m0 - m1)^2 = (m*w0 - s0)^2/(w0*w1)
+    // where w0 and w1 are the fractions of samples in the classes, m0 and m1
+    // are the class means, m is the mean, and s0 = w0*m0.  The unnormalized
+    // sums are used, which scales the variance by a constant.
+    double hSum = 0.0, hMoment = 0.0;
+    for (int i = 0; i < mNumBuckets; ++i)
+    {
+        hSum += (double)mBuckets[i];
+        hMoment += (double)i*(double)mBuckets[i];
+    }
+
+    double hSum0 = 0.0, hMoment0 = 0.0, maxVariance = -1.0;
+    int threshold = 0;
+    for (int t = 0; t < mNumBuckets - 1; ++t)
+    {
+        hSum0 += (double)mBuckets[t];
+        hMoment0 += (double)t*(double)mBuckets[t];
+        double hSum1 = hSum - hSum0;
+        if (hSum0 > 0.0 && hSum1 > 0.0)
+        {
+            double diff = hMoment*hSum0 - hMoment0*hSum;
+            double variance = diff*diff/(hSum0*hSum1);
+            if (variance > maxVariance)
+            {
+                maxVariance = variance;
+                threshold = t;
+            }
+        }
+    }
+    return threshold;
+}
+//----------------------------------------------------------------------------
 void Histogram::SaveAsText (std::string const& name)
 {
     std::ofstream output(name);
@@ -364,3 +347,102 @@ void Histogram::SaveAsImage (std::string const& name, int dimension0)
     image.Save(name);
 }
 //----------------------------------------------------------------------------
+void Histogram::Count (int numSamples, int const* samples,
+    ComputeModel const* cmodel)
+{
+    int const numThreads = GetNumThreads(numSamples, cmodel);
+    std::vector<std::vector<int>> buckets(numThreads);
+    std::vector<int> excessLess(numThreads), excessGreater(numThreads);
+    Execute(numSamples, cmodel, [&](int t, int imin, int imax)
+    {
+        int* counts = mBuckets;
+        if (t > 0)
+        {
+            buckets[t].resize(mNumBuckets);
+            counts = buckets[t].data();
+        }
+
+        int less = 0, greater = 0;
+        for (int i = imin; i <= imax; ++i)
+        {
+            int value = samples[i];
+            if (0 <= value)
+            {
+                if (value < mNumBuckets)
+                {
+                    ++counts[value];
+                }
+                else
+                {
+                    ++greater;
+                }
+            }
+            else
+            {
+                ++less;
+            }
+        }
+        excessLess[t] = less;
+        excessGreater[t] = greater;
+    });
+
+    AddBuckets(buckets);
+    for (int t = 0; t < numThreads; ++t)
+    {
+        mExcessLess += excessLess[t];
+        mExcessGreater += excessGreater[t];
+    }
+}
+//----------------------------------------------------------------------------
+void Histogram::AddBuckets (std::vector<std::vector<int>> const& buckets)
+{
+    for (size_t t = 1; t < buckets.size(); ++t)
+    {
+        int const* counts = buckets[t].data();
+        for (int i = 0; i < mNumBuckets; ++i)
+        {
+            mBuckets[i] += counts[i];
+        }
+    }
+}
+//----------------------------------------------------------------------------
+int Histogram::GetNumThreads (int numSamples, ComputeModel const* cmodel)
+{
+    int numThreads = (cmodel ? (int)cmodel->numThreads : 1);
+
+    // There is no point in having more threads than samples.
+    return std::max(std::min(numThreads, numSamples), 1);
+}
+//----------------------------------------------------------------------------
+void Histogram::Execute (int numSamples, ComputeModel const* cmodel,
+    std::function<void(int, int, int)> const& process)
+{
+    if (numSamples <= 0)
+    {
+        return;
+    }
+
+    int const numThreads = GetNumThreads(numSamples, cmodel);
+    if (numThreads > 1)
+    {
+        // Range t has its own buckets, so the ranges are fixed rather than
+        // the finer, dynamically claimed ranges of ParallelFor.
+        int const numPerThread = numSamples / numThreads;
+        cmodel->GetThreadPool().ParallelFor(numThreads, numThreads,
+            [&](int tmin, int tmax)
+        {
+            for (int t = tmin; t <= tmax; ++t)
+            {
+                int imin = t*numPerThread;
+                int imax = (t + 1 < numThreads ?
+                    imin + numPerThread - 1 : numSamples - 1);
+                process(t, imin, imax);
+            }
+        });
+    }
+    else
+    {
+        process(0, 0, numSamples - 1);
+    }
+}
+//----------------------------------------------------------------------------
@@ -3,11 +3,12 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.3 (2014/09/25)
+// File Version: 1.0.4 (2014/11/01)
 
 #include "GTEnginePCH.h"
 #include "GteImage.h"
 #include "GteLogger.h"
+#include <algorithm>
 #include <cstdarg>
 using namespace gte;
 
@@ -159,6 +160,7 @@ void Image::SetRawPixels(char* rawPixels)
 
     mRawPixels = rawPixels;
     mOwnerRawPixels = false;
+    mMappedFile = nullptr;
 }
 //----------------------------------------------------------------------------
 void Image::CreatePixelMetaData()
@@ -244,6 +246,12 @@ void Image::GetCoordinates(size_t index, int* coord) const
 //----------------------------------------------------------------------------
 void Image::ClearPixels()
 {
+    if (mMappedFile && mMappedFile->GetAccess() == MemoryMappedFile::READ_ONLY)
+    {
+        LogError("The pixels of a read-only mapped file cannot be cleared.");
+        return;
+    }
+
     if (mRawPixels)
     {
         memset(mRawPixels, 0, mNumPixels*mPixelSize);
@@ -322,74 +330,8 @@ bool Image::Load(std::string const& name,
         return false;
     }
 
-    if (!LoadHeader(input, mPixelType, mPixelSize, mNumDimensions))
-    {
-        input.close();
-        return false;
-    }
-
-    if (requiredNumDimensions)
-    {
-        int const numElements = (int)requiredNumDimensions->size();
-        int j;
-        for (j = 0; j < numElements; ++j)
-        {
-            if (mNumDimensions == (*requiredNumDimensions)[j])
-            {
-                break;
-            }
-        }
-        if (j == numElements)
-        {
-            CreateNullImage();
-            input.close();
-            return false;
-        }
-    }
-
-    if (requiredPixelTypes)
-    {
-        int const numElements = (int)requiredPixelTypes->size();
-        int j;
-        for (j = 0; j < numElements; ++j)
-        {
-            if (mPixelType == (*requiredPixelTypes)[j])
-            {
-                break;
-            }
-        }
-        if (j == numElements)
-        {
-            CreateNullImage();
-            input.close();
-            return false;
-        }
-    }
-
-    // Read the dimensions.
-    mDimensions = new int[mNumDimensions];
-    if (input.read((char*)mDimensions, mNumDimensions*sizeof(int)).bad())
-    {
-        LogError("Failed read dimensions.");
-        CreateNullImage();
-        input.close();
-        return false;
-    }
-
-    // Read the offsets.
-    mOffsets = new size_t[mNumDimensions];
-    if (input.read((char*)mOffsets, mNumDimensions*sizeof(size_t)).bad())
+    if (!ReadHeader(input, requiredNumDimensions, requiredPixelTypes))
     {
-        LogError("Failed read offsets.");
-        CreateNullImage();
-        input.close();
-        return false;
-    }
-
-    // Read the number of pixels.
-    if (input.read((char*)&mNumPixels, sizeof(size_t)).bad())
-    {
-        LogError("Failed read number of pixels.");
         CreateNullImage();
         input.close();
         return false;
@@ -406,80 +348,13 @@ bool Image::Load(std::string const& name,
         return false;
     }
 
-    // Read the length of the image metadata string.
-    int length;
-    if (input.read((char*)&length, sizeof(int)).bad())
+    if (!ReadMetaData(input))
     {
-        LogError("Failed read length(image metadata).");
         CreateNullImage();
         input.close();
         return false;
     }
 
-    // Read the image metadata string.
-    numBytes = length + 1;
-    char* temp = new char[numBytes];
-    if (input.read(temp, numBytes).bad() || temp[length] != 0)
-    {
-        LogError("Failed read image metadata.");
-        delete[] temp;
-        CreateNullImage();
-        input.close();
-        return false;
-    }
-    mImageMetaData = std::string(temp);
-    delete[] temp;
-
-    // Read the existence flag for pixel metadata.
-    int existsPixelMetaData = 0;
-    if (input.read((char*)&existsPixelMetaData, sizeof(int)).bad())
-    {
-        LogError("Failed read pixel metadata existence.");
-        CreateNullImage();
-        input.close();
-        return false;
-    }
-
-    if (existsPixelMetaData)
-    {
-        CreatePixelMetaData();
-
-        size_t maxNumBytes = 128;
-        temp = new char[maxNumBytes];
-        for (size_t i = 0; i < mNumPixels; ++i)
-        {
-            // Read the length of the pixel metadata string.
-            if (input.read((char*)&length, sizeof(int)).bad())
-            {
-                LogError("Failed read length.");
-                delete[] temp;
-                CreateNullImage();
-                input.close();
-                return false;
-            }
-
-            // Resize the temporary storage if necessary.
-            numBytes = length + 1;
-            if (numBytes > maxNumBytes)
-            {
-                maxNumBytes = numBytes;
-                delete[] temp;
-                temp = new char[maxNumBytes];
-            }
-
-            // Read the pixel metadata string.
-            if (input.read(temp, numBytes).bad() || temp[length] != 0)
-            {
-                LogError("Failed read pixel metadata.");
-                delete[] temp;
-                CreateNullImage();
-                input.close();
-                return false;
-            }
-            mPixelMetaData[i] = std::string(temp);
-        }
-    }
-
     input.close();
     return true;
 }
@@ -499,129 +374,168 @@ bool Image::Save(std::string const& name) const
         return false;
     }
 
-    // Write the length of the pixel type.
-    int length = (int)mPixelType.length();
-    if (output.write((char const*)&length, sizeof(int)).bad())
+    if (!WriteHeader(output))
     {
-        LogError("Failed write length(pixelType).");
         output.close();
         return false;
     }
 
-    // Write the pixel type string.
-    size_t numBytes = length + 1;
-    if (output.write(mPixelType.c_str(), numBytes).bad())
+    // Write the pixels.
+    size_t numBytes = mNumPixels*mPixelSize;
+    if (output.write(mRawPixels, numBytes).bad())
     {
-        LogError("Failed write pixelType.");
+        LogError("Failed write pixels.");
         output.close();
         return false;
     }
 
-    // Write the pixel size.
-    if (output.write((char const*)&mPixelSize, sizeof(size_t)).bad())
+    if (!WriteMetaData(output))
     {
-        LogError("Failed write pixelSize.");
         output.close();
         return false;
     }
 
-    // Write the number of dimensions.
-    if (output.write((char const*)&mNumDimensions, sizeof(int)).bad())
+    output.close();
+    return true;
+}
+//----------------------------------------------------------------------------
+bool Image::LoadMapped(std::string const& name,
+    MemoryMappedFile::Access access,
+    std::vector<int> const* requiredNumDimensions,
+    std::vector<std::string> const* requiredPixelTypes)
+{
+    CreateNullImage();
+
+    std::ifstream input(name, std::ios::in | std::ios::binary);
+    if (!input)
     {
-        LogError("Failed write numDimensions.");
-        output.close();
+        LogError("Failed to open file " + name + " for reading.");
         return false;
     }
 
-    // Write the dimensions.
-    numBytes = mNumDimensions*sizeof(int);
-    if (output.write((char const*)mDimensions, numBytes).bad())
+    if (!ReadHeader(input, requiredNumDimensions, requiredPixelTypes))
     {
-        LogError("Failed write dimensions.");
-        output.close();
+        CreateNullImage();
+        input.close();
         return false;
     }
 
-    // Write the offsets.
-    numBytes = mNumDimensions*sizeof(size_t);
-    if (output.write((char const*)mOffsets, numBytes).bad())
+    // Skip the pixels, which are accessed through the mapping.
+    size_t numBytes = mNumPixels*mPixelSize;
+    std::streamoff pixelOffset = input.tellg();
+    if ((size_t)pixelOffset % GetPixelAlignment(mPixelSize) != 0)
     {
-        LogError("Failed write offsets.");
-        output.close();
+        LogError("The pixels of file " + name + " are not aligned for "
+            "mapping.  Load the file or save it again to align them.");
+        CreateNullImage();
+        input.close();
         return false;
     }
 
-    // Write the number of pixels.
-    if (output.write((char const*)&mNumPixels, sizeof(size_t)).bad())
+    input.seekg((std::streamoff)numBytes, std::ios::cur);
+    if (!ReadMetaData(input))
     {
-        LogError("Failed write numPixels.");
-        output.close();
+        CreateNullImage();
+        input.close();
         return false;
     }
+    input.close();
 
-    // Write the pixels.
-    numBytes = mNumPixels*mPixelSize;
-    if (output.write(mRawPixels, numBytes).bad())
+    std::shared_ptr<MemoryMappedFile> file =
+        std::make_shared<MemoryMappedFile>();
+    if (!file->Open(name, access)
+        || file->GetSize() < (size_t)pixelOffset + numBytes)
     {
-        LogError("Failed write pixels.");
-        output.close();
+        LogError("Failed to map the pixels of file " + name + ".");
+        CreateNullImage();
         return false;
     }
 
-    // Write the length of the image metadata string.
-    length = (int)mImageMetaData.length();
-    if (output.write((char const*)&length, sizeof(int)).bad())
+    mRawPixels = file->GetData() + pixelOffset;
+    mOwnerRawPixels = false;
+    mMappedFile = file;
+    return true;
+}
+//----------------------------------------------------------------------------
+bool Image::Save(std::string const& name,
+    std::shared_ptr<ComputeModel> const& cmodel) const
+{
+    int numThreads = (cmodel ? (int)cmodel->numThreads : 1);
+    if (numThreads <= 1 || mNumPixels < (size_t)numThreads)
     {
-        LogError("Failed write length(image metadata).");
-        output.close();
+        return Save(name);
+    }
+
+    if (IsNullImage())
+    {
+        LogError("Cannot save a null image.");
         return false;
     }
 
-    // Write the image metadata string.
-    numBytes = length + 1;
-    if (output.write(mImageMetaData.c_str(), numBytes).bad())
+    // Write the header and the metadata, leaving space for the pixels.
+    std::ofstream output(name, std::ios::out | std::ios::binary);
+    if (!output)
+    {
+        LogError("Failed to open file " + name + " for writing.");
+        return false;
+    }
+
+    if (!WriteHeader(output))
     {
-        LogError("Failed write image metadata.");
         output.close();
         return false;
     }
 
-    // Write the existence flag for pixel metadata.
-    int existsPixelMetaData = (mPixelMetaData ? 1 : 0);
-    if (output.write((char const*)&existsPixelMetaData, sizeof(int)).bad())
+    std::streamoff pixelOffset = output.tellp();
+    output.seekp(pixelOffset + (std::streamoff)(mNumPixels*mPixelSize));
+    if (!WriteMetaData(output))
     {
-        LogError("Failed write pixel metadata existence.");
         output.close();
         return false;
     }
+    output.close();
 
-    if (mPixelMetaData)
+    // Write the pixels.  Each thread writes a contiguous block of pixels
+    // with its own stream, so the threads do not share a file position.
+    size_t const numPerThread = mNumPixels/numThreads;
+    std::vector<int> success(numThreads);
+    cmodel->GetThreadPool().ParallelFor(numThreads, numThreads,
+        [this, &name, &success, numThreads, numPerThread, pixelOffset](
+        int tmin, int tmax)
     {
-        for (size_t i = 0; i < mNumPixels; ++i)
+        for (int t = tmin; t <= tmax; ++t)
         {
-            // Write the length of the pixel metadata string.
-            std::string const& metadata = mPixelMetaData[i];
-            length = (int)metadata.length();
-            if (output.write((char const*)&length, sizeof(int)).bad())
-            {
-                LogError("Failed write length(pixel metadata).");
-                output.close();
-                return false;
-            }
-
-            // Write the pixel metadata string.
-            numBytes = length + 1;
-            if (output.write(metadata.c_str(), numBytes).bad())
-            {
-                LogError("Failed write pixel metadata.");
-                output.close();
-                return false;
-            }
+            size_t imin = t*numPerThread;
+            size_t imax = (t + 1 < numThreads ?
+                imin + numPerThread : mNumPixels);
+            std::fstream stream(name,
+                std::ios::in | std::ios::out | std::ios::binary);
+            size_t offset = imin*mPixelSize;
+            success[t] = (stream
+                && !stream.seekp(pixelOffset + (std::streamoff)offset).bad()
+                && !stream.write(mRawPixels + offset,
+                (imax - imin)*mPixelSize).bad() ? 1 : 0);
+            stream.close();
         }
-    }
+    });
 
-    output.close();
-    return true;
+    bool result = std::find(success.begin(), success.end(), 0) ==
+        success.end();
+    if (!result)
+    {
+        LogError("Failed write pixels.");
+    }
+    return result;
+}
+//----------------------------------------------------------------------------
+size_t Image::GetPixelAlignment(size_t pixelSize)
+{
+    size_t alignment = 1;
+    while (alignment < 16 && pixelSize % (2*alignment) == 0)
+    {
+        alignment *= 2;
+    }
+    return alignment;
 }
 //----------------------------------------------------------------------------
 void Image::CreateNullImage()
@@ -642,6 +556,7 @@ void Image::CreateNullImage()
     mNumPixels = 0;
     mRawPixels = nullptr;
     mOwnerRawPixels = true;
+    mMappedFile = nullptr;
     mImageMetaData = "";
     mPixelMetaData = nullptr;
     mDefaultPixelMetaData = "";
@@ -738,7 +653,15 @@ bool Image::IsCompatible(Image const& image) const
 //----------------------------------------------------------------------------
 bool Image::Copy(Image const& image)
 {
-    bool compatible = IsCompatible(image);
+    if (this == &image)
+    {
+        return true;
+    }
+
+    // The pixels of a read-only mapped file cannot be overwritten, so the
+    // image is reallocated.
+    bool compatible = IsCompatible(image) && !(mMappedFile &&
+        mMappedFile->GetAccess() == MemoryMappedFile::READ_ONLY);
     if (!compatible)
     {
         CreateNullImage();
@@ -792,3 +715,260 @@ bool Image::Copy(Image const& image)
     return compatible;
 }
 //----------------------------------------------------------------------------
+bool Image::ReadHeader(std::ifstream& input,
+    std::vector<int> const* requiredNumDimensions,
+    std::vector<std::string> const* requiredPixelTypes)
+{
+    if (!LoadHeader(input, mPixelType, mPixelSize, mNumDimensions))
+    {
+        return false;
+    }
+
+    if (requiredNumDimensions)
+    {
+        int const numElements = (int)requiredNumDimensions->size();
+        int j;
+        for (j = 0; j < numElements; ++j)
+        {
+            if (mNumDimensions == (*requiredNumDimensions)[j])
+            {
+                break;
+            }
+        }
+        if (j == numElements)
+        {
+            return false;
+        }
+    }
+
+    if (requiredPixelTypes)
+    {
+        int const numElements = (int)requiredPixelTypes->size();
+        int j;
+        for (j = 0; j < numElements; ++j)
+        {
+            if (mPixelType == (*requiredPixelTypes)[j])
+            {
+                break;
+            }
+        }
+        if (j == numElements)
+        {
+            return false;
+        }
+    }
+
+    // Read the dimensions.
+    mDimensions = new int[mNumDimensions];
+    if (input.read((char*)mDimensions, mNumDimensions*sizeof(int)).bad())
+    {
+        LogError("Failed read dimensions.");
+        return false;
+    }
+
+    // Read the offsets.
+    mOffsets = new size_t[mNumDimensions];
+    if (input.read((char*)mOffsets, mNumDimensions*sizeof(size_t)).bad())
+    {
+        LogError("Failed read offsets.");
+        return false;
+    }
+
+    // Read the number of pixels.
+    if (input.read((char*)&mNumPixels, sizeof(size_t)).bad())
+    {
+        LogError("Failed read number of pixels.");
+        return false;
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+bool Image::ReadMetaData(std::ifstream& input)
+{
+    // Read the length of the image metadata string.
+    int length;
+    if (input.read((char*)&length, sizeof(int)).bad())
+    {
+        LogError("Failed read length(image metadata).");
+        return false;
+    }
+
+    // Read the image metadata string.
+    size_t numBytes = length + 1;
+    char* temp = new char[numBytes];
+    if (input.read(temp, numBytes).bad() || temp[length] != 0)
+    {
+        LogError("Failed read image metadata.");
+        delete[] temp;
+        return false;
+    }
+    mImageMetaData = std::string(temp);
+    delete[] temp;
+
+    // Read the existence flag for pixel metadata.
+    int existsPixelMetaData = 0;
+    if (input.read((char*)&existsPixelMetaData, sizeof(int)).bad())
+    {
+        LogError("Failed read pixel metadata existence.");
+        return false;
+    }
+
+    if (existsPixelMetaData)
+    {
+        CreatePixelMetaData();
+
+        size_t maxNumBytes = 128;
+        temp = new char[maxNumBytes];
+        for (size_t i = 0; i < mNumPixels; ++i)
+        {
+            // Read the length of the pixel metadata string.
+            if (input.read((char*)&length, sizeof(int)).bad())
+            {
+                LogError("Failed read length.");
+                delete[] temp;
+                return false;
+            }
+
+            // Resize the temporary storage if necessary.
+            numBytes = length + 1;
+            if (numBytes > maxNumBytes)
+            {
+                maxNumBytes = numBytes;
+                delete[] temp;
+                temp = new char[maxNumBytes];
+            }
+
+            // Read the pixel metadata string.
+            if (input.read(temp, numBytes).bad() || temp[length] != 0)
+            {
+                LogError("Failed read pixel metadata.");
+                delete[] temp;
+                return false;
+            }
+            mPixelMetaData[i] = std::string(temp);
+        }
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+bool Image::WriteHeader(std::ofstream& output) const
+{
+    // Pad the pixel type string with null characters so that the pixels,
+    // which follow the header, are aligned for LoadMapped.
+    size_t headerSize = sizeof(int) + mPixelType.length() + 1 +
+        sizeof(size_t) + sizeof(int) +
+        mNumDimensions*(sizeof(int) + sizeof(size_t)) + sizeof(size_t);
+    size_t alignment = GetPixelAlignment(mPixelSize);
+    size_t padding = (alignment - headerSize % alignment) % alignment;
+    std::string paddedPixelType = mPixelType + std::string(padding, '\0');
+
+    // Write the length of the pixel type.
+    int length = (int)paddedPixelType.length();
+    if (output.write((char const*)&length, sizeof(int)).bad())
+    {
+        LogError("Failed write length(pixelType).");
+        return false;
+    }
+
+    // Write the pixel type string.
+    size_t numBytes = length + 1;
+    if (output.write(paddedPixelType.c_str(), numBytes).bad())
+    {
+        LogError("Failed write pixelType.");
+        return false;
+    }
+
+    // Write the pixel size.
+    if (output.write((char const*)&mPixelSize, sizeof(size_t)).bad())
+    {
+        LogError("Failed write pixelSize.");
+        return false;
+    }
+
+    // Write the number of dimensions.
+    if (output.write((char const*)&mNumDimensions, sizeof(int)).bad())
+    {
+        LogError("Failed write numDimensions.");
+        return false;
+    }
+
+    // Write the dimensions.
+    numBytes = mNumDimensions*sizeof(int);
+    if (output.write((char const*)mDimensions, numBytes).bad())
+    {
+        LogError("Failed write dimensions.");
+        return false;
+    }
+
+    // Write the offsets.
+    numBytes = mNumDimensions*sizeof(size_t);
+    if (output.write((char const*)mOffsets, numBytes).bad())
+    {
+        LogError("Failed write offsets.");
+        return false;
+    }
+
+    // Write the number of pixels.
+    if (output.write((char const*)&mNumPixels, sizeof(size_t)).bad())
+    {
+        LogError("Failed write numPixels.");
+        return false;
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+bool Image::WriteMetaData(std::ofstream& output) const
+{
+    // Write the length of the image metadata string.
+    int length = (int)mImageMetaData.length();
+    if (output.write((char const*)&length, sizeof(int)).bad())
+    {
+        LogError("Failed write length(image metadata).");
+        return false;
+    }
+
+    // Write the image metadata string.
+    size_t numBytes = length + 1;
+    if (output.write(mImageMetaData.c_str(), numBytes).bad())
+    {
+        LogError("Failed write image metadata.");
+        return false;
+    }
+
+    // Write the existence flag for pixel metadata.
+    int existsPixelMetaData = (mPixelMetaData ? 1 : 0);
+    if (output.write((char const*)&existsPixelMetaData, sizeof(int)).bad())
+    {
+        LogError("Failed write pixel metadata existence.");
+        return false;
+    }
+
+    if (mPixelMetaData)
+    {
+        for (size_t i = 0; i < mNumPixels; ++i)
+        {
+            // Write the length of the pixel metadata string.
+            std::string const& metadata = mPixelMetaData[i];
+            length = (int)metadata.length();
+            if (output.write((char const*)&length, sizeof(int)).bad())
+            {
+                LogError("Failed write length(pixel metadata).");
+                return false;
+            }
+
+            // Write the pixel metadata string.
+            numBytes = length + 1;
+            if (output.write(metadata.c_str(), numBytes).bad())
+            {
+                LogError("Failed write pixel metadata.");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
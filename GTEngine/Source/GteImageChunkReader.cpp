@@ -0,0 +1,115 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/01)
+
+#include "GTEnginePCH.h"
+#include "GteImageChunkReader.h"
+#include "GteLogger.h"
+using namespace gte;
+
+//----------------------------------------------------------------------------
+ImageChunkReader::~ImageChunkReader()
+{
+    Close();
+}
+//----------------------------------------------------------------------------
+ImageChunkReader::ImageChunkReader()
+    :
+    mPixelType(""),
+    mPixelSize(0),
+    mNumSlicePixels(0),
+    mPixelOffset(0)
+{
+}
+//----------------------------------------------------------------------------
+bool ImageChunkReader::Open(std::string const& name)
+{
+    Close();
+
+    mInput.open(name, std::ios::in | std::ios::binary);
+    if (!mInput)
+    {
+        LogError("Failed to open file " + name + " for reading.");
+        return false;
+    }
+
+    int numDimensions = 0;
+    if (!Image::LoadHeader(mInput, mPixelType, mPixelSize, numDimensions)
+        || numDimensions <= 0)
+    {
+        Close();
+        return false;
+    }
+
+    // Read the dimensions.
+    mDimensions.resize(numDimensions);
+    if (mInput.read((char*)&mDimensions[0], numDimensions*sizeof(int)).bad())
+    {
+        LogError("Failed read dimensions.");
+        Close();
+        return false;
+    }
+
+    // Skip the offsets and the number of pixels, which are determined by the
+    // dimensions.
+    mInput.seekg((numDimensions + 1)*sizeof(size_t), std::ios::cur);
+    mPixelOffset = mInput.tellg();
+    if (mPixelOffset < 0)
+    {
+        LogError("Failed read header.");
+        Close();
+        return false;
+    }
+
+    mNumSlicePixels = 1;
+    for (int d = 0; d + 1 < numDimensions; ++d)
+    {
+        mNumSlicePixels *= mDimensions[d];
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+void ImageChunkReader::Close()
+{
+    if (mInput.is_open())
+    {
+        mInput.close();
+    }
+    mInput.clear();
+
+    mPixelType = "";
+    mPixelSize = 0;
+    mDimensions.clear();
+    mNumSlicePixels = 0;
+    mPixelOffset = 0;
+}
+//----------------------------------------------------------------------------
+bool ImageChunkReader::Read(int first, int numSlices, char* pixels)
+{
+    if (!mInput.is_open() || first < 0 || numSlices < 0
+        || first + numSlices > GetNumSlices() || !pixels)
+    {
+        LogError("Invalid inputs.");
+        return false;
+    }
+
+    size_t const numSliceBytes = mNumSlicePixels*mPixelSize;
+    std::streamoff offset = mPixelOffset + (std::streamoff)first*
+        (std::streamoff)numSliceBytes;
+
+    // A failed read sets the fail bit, which must be cleared for the stream
+    // to be used again.
+    mInput.clear();
+    if (mInput.seekg(offset).fail()
+        || mInput.read(pixels, numSlices*numSliceBytes).fail())
+    {
+        LogError("Failed read pixels.");
+        mInput.clear();
+        return false;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
@@ -3,28 +3,35 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.2 (2014/09/03)
+// File Version: 1.0.6 (2014/10/26)
 
 #include "GTEnginePCH.h"
 #include "GteImageUtility2.h"
+#include <algorithm>
 #include <limits>
 using namespace gte;
 
 //----------------------------------------------------------------------------
 void ImageUtility2::GetComponents4(Image2<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components,
+    std::vector<ComponentStatistics>* statistics,
+    std::shared_ptr<ComputeModel> const& cmodel)
 {
-    std::array<int, 4> neighbors;
+    std::array<std::array<int, 2>, 4> neighbors;
     image.GetNeighborhood(neighbors);
-    GetComponents(4, &neighbors[0], image, components);
+    GetComponents(4, &neighbors[0], image, components, statistics,
+        cmodel.get());
 }
 //----------------------------------------------------------------------------
 void ImageUtility2::GetComponents8(Image2<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components,
+    std::vector<ComponentStatistics>* statistics,
+    std::shared_ptr<ComputeModel> const& cmodel)
 {
-    std::array<int, 8> neighbors;
+    std::array<std::array<int, 2>, 8> neighbors;
     image.GetNeighborhood(neighbors);
-    GetComponents(8, &neighbors[0], image, components);
+    GetComponents(8, &neighbors[0], image, components, statistics,
+        cmodel.get());
 }
 //----------------------------------------------------------------------------
 void ImageUtility2::Dilate4(Image2<int> const& input, Image2<int>& output)
@@ -556,6 +563,203 @@ void ImageUtility2::GetL2Distance(Image2<int> const& image,
     }
 }
 //----------------------------------------------------------------------------
+void ImageUtility2::GetL2Distance(Image2<int> const& image,
+    Image2<float>& transform, Image2<int>* nearest,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    // The index image is required by the passes, so create a temporary one
+    // when the caller does not want the nearest-pixel indices.
+    Image2<int> localNearest;
+    if (!nearest)
+    {
+        localNearest.Resize(image.GetDimension(0), image.GetDimension(1));
+        nearest = &localNearest;
+    }
+
+    L2Pass(0, &image, *nearest, nullptr, cmodel.get());
+    L2Pass(1, nullptr, *nearest, &transform, cmodel.get());
+}
+//----------------------------------------------------------------------------
+void ImageUtility2::RankFilter(Image2<uint8_t> const& input, int radius,
+    int rank, Image2<uint8_t>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    int const size = 2 * radius + 1;
+    if (radius < 0 || rank < 0 || rank >= size * size)
+    {
+        LogError("Invalid radius or rank.");
+        return;
+    }
+
+    if (1 <= radius && radius <= 2 && rank == (size * size - 1) / 2)
+    {
+        MedianBySelection(input, radius, output, cmodel.get());
+        return;
+    }
+
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    Execute(dim1, cmodel.get(), [&](int ymin, int ymax)
+    {
+        // The histograms of the columns for the window rows of the current
+        // output row.  Each column has 256 fine bins and 16 coarse bins.
+        std::vector<int> fine(256 * dim0), coarse(16 * dim0);
+        auto UpdateColumns = [&](int y, int increment)
+        {
+            uint8_t const* source = &input(0, std::min(std::max(y, 0),
+                dim1 - 1));
+            for (int x = 0; x < dim0; ++x)
+            {
+                fine[256 * x + source[x]] += increment;
+                coarse[16 * x + (source[x] >> 4)] += increment;
+            }
+        };
+
+        // The histogram of the window.
+        int kernelFine[256], kernelCoarse[16];
+        auto UpdateKernel = [&](int x, int increment)
+        {
+            x = std::min(std::max(x, 0), dim0 - 1);
+            int const* columnFine = &fine[256 * x];
+            int const* columnCoarse = &coarse[16 * x];
+            for (int i = 0; i < 256; ++i)
+            {
+                kernelFine[i] += increment * columnFine[i];
+            }
+            for (int i = 0; i < 16; ++i)
+            {
+                kernelCoarse[i] += increment * columnCoarse[i];
+            }
+        };
+
+        for (int dy = -radius; dy <= radius; ++dy)
+        {
+            UpdateColumns(ymin + dy, 1);
+        }
+
+        for (int y = ymin; y <= ymax; ++y)
+        {
+            if (y > ymin)
+            {
+                UpdateColumns(y - radius - 1, -1);
+                UpdateColumns(y + radius, 1);
+            }
+
+            std::fill(kernelFine, kernelFine + 256, 0);
+            std::fill(kernelCoarse, kernelCoarse + 16, 0);
+            for (int dx = -radius; dx <= radius; ++dx)
+            {
+                UpdateKernel(dx, 1);
+            }
+
+            uint8_t* target = &output(0, y);
+            for (int x = 0; x < dim0; ++x)
+            {
+                if (x > 0)
+                {
+                    // The columns are the same when both are clamped to
+                    // the same image column.
+                    int xRemove = std::max(x - radius - 1, 0);
+                    int xAdd = std::min(x + radius, dim0 - 1);
+                    if (xRemove != xAdd)
+                    {
+                        UpdateKernel(xRemove, -1);
+                        UpdateKernel(xAdd, 1);
+                    }
+                }
+
+                int sum = 0, i = 0;
+                while (sum + kernelCoarse[i] <= rank)
+                {
+                    sum += kernelCoarse[i++];
+                }
+                i *= 16;
+                while (sum + kernelFine[i] <= rank)
+                {
+                    sum += kernelFine[i++];
+                }
+                target[x] = static_cast<uint8_t>(i);
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+void ImageUtility2::RankFilter(Image2<uint16_t> const& input, int radius,
+    int rank, Image2<uint16_t>& output,
+    std::shared_ptr<ComputeModel> const& cmodel)
+{
+    int const size = 2 * radius + 1;
+    if (radius < 0 || rank < 0 || rank >= size * size)
+    {
+        LogError("Invalid radius or rank.");
+        return;
+    }
+
+    if (1 <= radius && radius <= 2 && rank == (size * size - 1) / 2)
+    {
+        MedianBySelection(input, radius, output, cmodel.get());
+        return;
+    }
+
+    int const dim0 = input.GetDimension(0);
+    int const dim1 = input.GetDimension(1);
+    int const numPadded = dim0 + 2 * radius;
+    Execute(dim1, cmodel.get(), [&](int ymin, int ymax)
+    {
+        // The histogram of the window, 65536 fine bins and 256 coarse bins.
+        std::vector<int> fine(65536, 0), coarse(256, 0);
+        std::vector<uint16_t> rows;
+        auto UpdateColumn = [&](int x, int increment)
+        {
+            for (int dy = 0; dy < size; ++dy)
+            {
+                uint16_t value = rows[dy * numPadded + x];
+                fine[value] += increment;
+                coarse[value >> 8] += increment;
+            }
+        };
+
+        for (int y = ymin; y <= ymax; ++y)
+        {
+            // The padded column x+radius is image column x.
+            GetPaddedRows(input, y, radius, rows);
+            for (int x = 0; x < size; ++x)
+            {
+                UpdateColumn(x, 1);
+            }
+
+            uint16_t* target = &output(0, y);
+            for (int x = 0; x < dim0; ++x)
+            {
+                if (x > 0)
+                {
+                    UpdateColumn(x - 1, -1);
+                    UpdateColumn(x + 2 * radius, 1);
+                }
+
+                int sum = 0, i = 0;
+                while (sum + coarse[i] <= rank)
+                {
+                    sum += coarse[i++];
+                }
+                i *= 256;
+                while (sum + fine[i] <= rank)
+                {
+                    sum += fine[i++];
+                }
+                target[x] = static_cast<uint16_t>(i);
+            }
+
+            // Remove the last window so the histogram is zero for the next
+            // row, which is less expensive than clearing 65536 bins.
+            for (int x = dim0 - 1; x < dim0 + size - 1; ++x)
+            {
+                UpdateColumn(x, -1);
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
 void ImageUtility2::GetSkeleton(Image2<int>& image)
 {
     int const dim0 = image.GetDimension(0);
@@ -856,74 +1060,361 @@ void ImageUtility2::DrawRectangle(int xMin, int yMin, int xMax,
     }
 }
 //----------------------------------------------------------------------------
-void ImageUtility2::GetComponents(int numNeighbors, int const* delta,
-    Image2<int>& image, std::vector<std::vector<size_t>>& components)
+void ImageUtility2::GetComponents(int numNeighbors,
+    std::array<int, 2> const* offsets, Image2<int>& image,
+    std::vector<std::vector<size_t>>& components,
+    std::vector<ComponentStatistics>* statistics, ComputeModel const* cmodel)
 {
-    size_t const numPixels = image.GetNumPixels();
-    int* numElements = new int[numPixels];
-    size_t* vstack = new size_t[numPixels];
-    size_t i, numComponents = 0;
-    int label = 2;
-    for (i = 0; i < numPixels; ++i)
+    int const dim0 = image.GetDimension(0);
+    int const dim1 = image.GetDimension(1);
+
+    // Only the neighbors that precede a pixel in raster order are visited
+    // by the scan.  Because the image boundary is zero, no neighbor offset
+    // of a foreground pixel wraps around a row.  Two preceding neighbors
+    // that are adjacent to each other were already merged when the later
+    // of them was scanned.  The scan skips the search for the root of a
+    // neighbor that is adjacent to a foreground neighbor visited before it,
+    // so the neighbors are visited in decreasing order of the number of
+    // their adjacent preceding neighbors.  For 8-connectivity this is
+    // equivalent to the decision tree of Wu, Otoo, and Suzuki,
+    // "Optimizing two-pass connected-component labeling algorithms".
+    std::vector<int> order, delta(numNeighbors);
+    int reach = 0;
+    for (int j = 0; j < numNeighbors; ++j)
     {
-        if (image[i] == 1)
+        delta[j] = offsets[j][0] + dim0 * offsets[j][1];
+        if (delta[j] < 0)
         {
-            int top = -1;
-            vstack[++top] = i;
+            order.push_back(j);
+            reach = std::max(reach, -delta[j]);
+        }
+    }
 
-            int& count = numElements[numComponents + 1];
-            count = 0;
-            while (top >= 0)
+    int const numPrevious = static_cast<int>(order.size());
+    std::vector<unsigned int> adjacent(numPrevious, 0);
+    for (int j = 0; j < numPrevious; ++j)
+    {
+        for (int k = 0; k < numPrevious; ++k)
+        {
+            int k0 = offsets[order[j]][0] - offsets[order[k]][0];
+            int k1 = offsets[order[j]][1] - offsets[order[k]][1];
+            for (int m = 0; m < numNeighbors; ++m)
             {
-                size_t v = vstack[top];
-                image[v] = -1;
-                int j;
-                for (j = 0; j < numNeighbors; ++j)
+                if (offsets[m][0] == k0 && offsets[m][1] == k1)
                 {
-                    size_t adj = v + delta[j];
-                    if (image[adj] == 1)
+                    adjacent[j] |= (1u << k);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<int> rank(numPrevious);
+    for (int j = 0; j < numPrevious; ++j)
+    {
+        rank[j] = j;
+    }
+    std::stable_sort(rank.begin(), rank.end(), [&adjacent](int j0, int j1)
+    {
+        return Popcount(adjacent[j0]) > Popcount(adjacent[j1]);
+    });
+
+    // When a foreground neighbor is adjacent to all the neighbors visited
+    // after it, those neighbors cannot change the root, so the visit stops.
+    std::vector<int> previous(numPrevious);
+    std::vector<unsigned int> skip(numPrevious, 0);
+    for (int j = 0; j < numPrevious; ++j)
+    {
+        previous[j] = delta[order[rank[j]]];
+        for (int k = 0; k < j; ++k)
+        {
+            if (adjacent[rank[j]] & (1u << rank[k]))
+            {
+                skip[j] |= (1u << k);
+            }
+        }
+    }
+
+    std::vector<char> last(numPrevious, 1);
+    for (int j = 0; j < numPrevious; ++j)
+    {
+        for (int k = j + 1; k < numPrevious; ++k)
+        {
+            if ((skip[k] & (1u << j)) == 0)
+            {
+                last[j] = 0;
+                break;
+            }
+        }
+    }
+
+    // Partition the rows into slabs.  Slab s contains the pixels with
+    // indices first[s] <= i < first[s+1].
+    int const numThreads =
+        (cmodel ? static_cast<int>(cmodel->numThreads) : 1);
+    int const numSlabs = std::max(1, std::min(numThreads, dim1));
+    std::vector<int> first(numSlabs + 1);
+    for (int s = 0; s <= numSlabs; ++s)
+    {
+        first[s] = dim0 * static_cast<int>(
+            (static_cast<long long>(dim1) * s) / numSlabs);
+    }
+
+    // Label each slab independently and count the roots of its trees.  The
+    // parent of a background pixel is never accessed, so it is not
+    // initialized.
+    int* parent = new int[image.GetNumPixels()];
+    int* pixels = image.GetPixels1D();
+    std::vector<int> numRoots(numSlabs + 1, 0);
+    Execute(numSlabs, cmodel, [&](int smin, int smax)
+    {
+        for (int s = smin; s <= smax; ++s)
+        {
+            int const imin = first[s], imax = first[s + 1];
+            int count = 0;
+            for (int i = imin; i < imax; ++i)
+            {
+                if (pixels[i] != 0)
+                {
+                    // The pixel is a singleton until it meets a foreground
+                    // neighbor, so it can be attached directly to the
+                    // smallest root among its neighbors.
+                    int root = i;
+                    unsigned int visited = 0;
+                    for (int j = 0; j < numPrevious; ++j)
                     {
-                        vstack[++top] = adj;
-                        break;
+                        int adj = i + previous[j];
+                        if (adj < imin || pixels[adj] == 0)
+                        {
+                            continue;
+                        }
+
+                        bool merged = ((visited & skip[j]) != 0);
+                        visited |= (1u << j);
+                        if (!merged)
+                        {
+                            int r = FindRoot(parent, adj);
+                            if (r < root)
+                            {
+                                if (root != i)
+                                {
+                                    parent[root] = r;
+                                    --count;
+                                }
+                                root = r;
+                            }
+                            else if (r > root)
+                            {
+                                parent[r] = root;
+                                --count;
+                            }
+                        }
+
+                        if (last[j])
+                        {
+                            break;
+                        }
+                    }
+                    parent[i] = root;
+                    if (root == i)
+                    {
+                        ++count;
                     }
                 }
-                if (j == numNeighbors)
+            }
+            numRoots[s + 1] = count;
+        }
+    });
+
+    // Merge the neighbors that straddle the slab boundaries.  Only the
+    // first 'reach' pixels of a slab have such neighbors.  A root that is
+    // linked to another root is removed from the count of its slab.
+    for (int s = 1; s < numSlabs; ++s)
+    {
+        int imax = std::min(first[s] + reach, first[s + 1]);
+        for (int i = first[s]; i < imax; ++i)
+        {
+            if (image[i] != 0)
+            {
+                for (auto d : previous)
                 {
-                    image[v] = label;
-                    ++count;
-                    --top;
+                    int adj = i + d;
+                    if (adj < first[s] && image[adj] != 0)
+                    {
+                        int r = Union(parent, i, adj);
+                        if (r >= 0)
+                        {
+                            int t = static_cast<int>(std::upper_bound(
+                                first.begin(), first.end(), r) -
+                                first.begin()) - 1;
+                            --numRoots[t + 1];
+                        }
+                    }
                 }
             }
-
-            ++numComponents;
-            ++label;
         }
     }
-    delete[] vstack;
 
+    // Number the roots in raster order, starting each slab after the roots
+    // of the preceding slabs.  Because parent[i] < i for a pixel that is
+    // not a root, the label of a pixel is the label of its parent when the
+    // parent is in the same slab and has been labeled.  Otherwise, the
+    // pixel is marked with -1 and its label is looked up at its root after
+    // all the roots are labeled.
+    for (int s = 1; s <= numSlabs; ++s)
+    {
+        numRoots[s] += numRoots[s - 1];
+    }
+
+    Execute(numSlabs, cmodel, [&](int smin, int smax)
+    {
+        for (int s = smin; s <= smax; ++s)
+        {
+            int label = numRoots[s];
+            for (int i = first[s]; i < first[s + 1]; ++i)
+            {
+                if (image[i] != 0)
+                {
+                    int j = parent[i];
+                    if (j == i)
+                    {
+                        image[i] = ++label;
+                    }
+                    else if (j >= first[s])
+                    {
+                        image[i] = image[j];
+                    }
+                    else
+                    {
+                        image[i] = -1;
+                    }
+                }
+            }
+        }
+    });
+
+    Execute(numSlabs, cmodel, [&](int smin, int smax)
+    {
+        for (int s = smin; s <= smax; ++s)
+        {
+            for (int i = first[s]; i < first[s + 1]; ++i)
+            {
+                if (image[i] < 0)
+                {
+                    int root = parent[i];
+                    while (parent[root] != root)
+                    {
+                        root = parent[root];
+                    }
+                    image[i] = image[root];
+                }
+            }
+        }
+    });
+    delete[] parent;
+
+    int const numComponents = numRoots[numSlabs];
     if (numComponents > 0)
     {
+        std::vector<int> numElements(numComponents + 1, 0);
+        for (size_t i = 0; i < image.GetNumPixels(); ++i)
+        {
+            ++numElements[image[i]];
+        }
+
         components.resize(numComponents + 1);
-        for (i = 1; i <= numComponents; ++i)
+        for (int k = 1; k <= numComponents; ++k)
+        {
+            components[k].resize(numElements[k]);
+            numElements[k] = 0;
+        }
+
+        if (statistics)
         {
-            components[i].resize(numElements[i]);
-            numElements[i] = 0;
+            ComponentStatistics initial;
+            initial.numPixels = 0;
+            initial.xMin = dim0;
+            initial.xMax = -1;
+            initial.yMin = dim1;
+            initial.yMax = -1;
+            initial.xCentroid = 0.0;
+            initial.yCentroid = 0.0;
+            statistics->resize(numComponents + 1);
+            std::fill(statistics->begin(), statistics->end(), initial);
         }
 
-        for (i = 0; i < numPixels; ++i)
+        for (int y = 0, i = 0; y < dim1; ++y)
         {
-            int value = image[i];
-            if (value != 0)
+            for (int x = 0; x < dim0; ++x, ++i)
             {
-                // Labels started at 2 to support the depth-first search,
-                // so they need to be decremented for the correct labels.
-                image[i] = --value;
-                components[value][numElements[value]] = i;
-                ++numElements[value];
+                int value = image[i];
+                if (value != 0)
+                {
+                    components[value][numElements[value]] = i;
+                    ++numElements[value];
+                    if (statistics)
+                    {
+                        ComponentStatistics& stat = (*statistics)[value];
+                        stat.xMin = std::min(stat.xMin, x);
+                        stat.xMax = std::max(stat.xMax, x);
+                        stat.yMin = std::min(stat.yMin, y);
+                        stat.yMax = std::max(stat.yMax, y);
+                        stat.xCentroid += static_cast<double>(x);
+                        stat.yCentroid += static_cast<double>(y);
+                    }
+                }
+            }
+        }
+
+        if (statistics)
+        {
+            for (int k = 1; k <= numComponents; ++k)
+            {
+                ComponentStatistics& stat = (*statistics)[k];
+                stat.numPixels = components[k].size();
+                stat.xCentroid /= static_cast<double>(stat.numPixels);
+                stat.yCentroid /= static_cast<double>(stat.numPixels);
             }
         }
     }
-    delete[] numElements;
+}
+//----------------------------------------------------------------------------
+int ImageUtility2::FindRoot(int* parent, int i)
+{
+    // Path halving keeps the trees shallow.
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+//----------------------------------------------------------------------------
+int ImageUtility2::Union(int* parent, int i0, int i1)
+{
+    int r0 = FindRoot(parent, i0);
+    int r1 = FindRoot(parent, i1);
+    if (r0 < r1)
+    {
+        parent[r1] = r0;
+        return r1;
+    }
+    if (r1 < r0)
+    {
+        parent[r0] = r1;
+        return r0;
+    }
+    return -1;
+}
+//----------------------------------------------------------------------------
+int ImageUtility2::Popcount(unsigned int bits)
+{
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1)
+    {
+        ++count;
+    }
+    return count;
 }
 //----------------------------------------------------------------------------
 void ImageUtility2::L2Check(int x, int y, int dx, int dy, Image2<int>& xNear,
@@ -949,6 +1440,140 @@ void ImageUtility2::L2Check(int x, int y, int dx, int dy, Image2<int>& xNear,
     }
 }
 //----------------------------------------------------------------------------
+void ImageUtility2::L2Pass(int axis, Image2<int> const* image,
+    Image2<int>& nearest, Image2<float>* transform, ComputeModel const* cmodel)
+{
+    int const dim0 = nearest.GetDimension(0);
+    int const dim1 = nearest.GetDimension(1);
+    int const numSamples = (axis == 0 ? dim0 : dim1);
+    int const numLines = (axis == 0 ? dim1 : dim0);
+    int const stride = (axis == 0 ? 1 : dim0);
+    int const lineStride = (axis == 0 ? dim0 : 1);
+
+    Execute(numLines, cmodel, [&](int lmin, int lmax)
+    {
+        std::vector<int> site(numSamples), closest(numSamples);
+        std::vector<int> v(numSamples);
+        std::vector<double> f(numSamples), z(numSamples);
+        for (int line = lmin; line <= lmax; ++line)
+        {
+            // Gather the line.  For the row pass, the background pixels
+            // are at distance zero.  For the column pass, the squared
+            // distance from a sample to the closest background pixel in its
+            // row involves only the x-difference.
+            int const base = line * lineStride;
+            for (int q = 0, i = base; q < numSamples; ++q, i += stride)
+            {
+                if (image)
+                {
+                    site[q] = ((*image)[i] == 0 ? i : -1);
+                    f[q] = 0.0;
+                }
+                else
+                {
+                    int s = nearest[i];
+                    site[q] = s;
+                    if (s >= 0)
+                    {
+                        double diff = static_cast<double>(s - i);
+                        f[q] = diff * diff;
+                    }
+                }
+            }
+
+            L2Envelope(numSamples, &site[0], &f[0], &closest[0], &v[0],
+                &z[0]);
+
+            // Scatter the line.
+            for (int p = 0, i = base; p < numSamples; ++p, i += stride)
+            {
+                int q = closest[p];
+                nearest[i] = (q >= 0 ? site[q] : -1);
+                if (transform)
+                {
+                    if (q >= 0)
+                    {
+                        double diff = static_cast<double>(p - q);
+                        (*transform)[i] = static_cast<float>(
+                            sqrt(diff * diff + f[q]));
+                    }
+                    else
+                    {
+                        (*transform)[i] = std::numeric_limits<float>::max();
+                    }
+                }
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+void ImageUtility2::L2Envelope(int numSamples, int const* site,
+    double const* f, int* closest, int* v, double* z)
+{
+    // v[0..k] are the samples whose parabolas form the lower envelope, and
+    // parabola v[j] is the minimum on the interval [z[j],z[j+1]].  The
+    // intersection of the parabolas for samples r < q is at
+    //   s = ((f[q] + q^2) - (f[r] + r^2))/(2*(q - r))
+    double const minReal = -std::numeric_limits<double>::max();
+    int k = -1;
+    for (int q = 0; q < numSamples; ++q)
+    {
+        if (site[q] < 0)
+        {
+            continue;
+        }
+
+        double gq = f[q] + static_cast<double>(q) * q;
+        double s = minReal;
+        while (k >= 0)
+        {
+            int r = v[k];
+            double gr = f[r] + static_cast<double>(r) * r;
+            s = (gq - gr) / (2.0 * static_cast<double>(q - r));
+            if (s > z[k])
+            {
+                break;
+            }
+            s = minReal;
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+    }
+
+    if (k < 0)
+    {
+        // The line has no background samples.
+        std::fill(closest, closest + numSamples, -1);
+        return;
+    }
+
+    for (int p = 0, j = 0; p < numSamples; ++p)
+    {
+        while (j < k && z[j + 1] < static_cast<double>(p))
+        {
+            ++j;
+        }
+        closest[p] = v[j];
+    }
+}
+//----------------------------------------------------------------------------
+void ImageUtility2::Execute(int numLines, ComputeModel const* cmodel,
+    std::function<void(int, int)> const& process)
+{
+    int const numThreads =
+        (cmodel ? static_cast<int>(cmodel->numThreads) : 1);
+    if (numThreads > 1 && numLines > 1)
+    {
+        cmodel->GetThreadPool().ParallelFor(numLines, numThreads, process);
+    }
+    else if (numLines > 0)
+    {
+        process(0, numLines - 1);
+    }
+}
+//----------------------------------------------------------------------------
 bool ImageUtility2::Interior2(Image2<int>& image, int x, int y)
 {
     bool b1 = (image(x, y-1) != 0);
@@ -3,35 +3,46 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/09/03)
+// File Version: 1.0.4 (2014/10/24)
 
 #include "GTEnginePCH.h"
 #include "GteImageUtility3.h"
+#include <algorithm>
+#include <limits>
 using namespace gte;
 
 //----------------------------------------------------------------------------
 void ImageUtility3::GetComponents6(Image3<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components,
+    std::vector<ComponentStatistics>* statistics,
+    std::shared_ptr<ComputeModel> const& cmodel)
 {
-    std::array<int, 6> neighbors;
+    std::array<std::array<int, 3>, 6> neighbors;
     image.GetNeighborhood(neighbors);
-    GetComponents(6, &neighbors[0], image, components);
+    GetComponents(6, &neighbors[0], image, components, statistics,
+        cmodel.get());
 }
 //----------------------------------------------------------------------------
 void ImageUtility3::GetComponents18(Image3<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components,
+    std::vector<ComponentStatistics>* statistics,
+    std::shared_ptr<ComputeModel> const& cmodel)
 {
-    std::array<int, 18> neighbors;
+    std::array<std::array<int, 3>, 18> neighbors;
     image.GetNeighborhood(neighbors);
-    GetComponents(18, &neighbors[0], image, components);
+    GetComponents(18, &neighbors[0], image, components, statistics,
+        cmodel.get());
 }
 //----------------------------------------------------------------------------
 void ImageUtility3::GetComponents26(Image3<int>& image,
-    std::vector<std::vector<size_t>>& components)
+    std::vector<std::vector<size_t>>& components,
+    std::vector<ComponentStatistics>* statistics,
+    std::shared_ptr<ComputeModel> const& cmodel)
 {
-    std::array<int, 26> neighbors;
+    std::array<std::array<int, 3>, 26> neighbors;
     image.GetNeighborhood(neighbors);
-    GetComponents(26, &neighbors[0], image, components);
+    GetComponents(26, &neighbors[0], image, components, statistics,
+        cmodel.get());
 }
 //----------------------------------------------------------------------------
 void ImageUtility3::Dilate6(Image3<int> const& inImage, Image3<int>& outImage)
@@ -173,6 +184,25 @@ void ImageUtility3::ComputeCDConvex(Image3<int>& image)
     }
 }
 //----------------------------------------------------------------------------
+void ImageUtility3::GetL2Distance(Image3<int> const& image,
+    std::array<float, 3> const& spacing, Image3<float>& transform,
+    Image3<int>* nearest, std::shared_ptr<ComputeModel> const& cmodel)
+{
+    // The index image is required by the passes, so create a temporary one
+    // when the caller does not want the nearest-voxel indices.
+    Image3<int> localNearest;
+    if (!nearest)
+    {
+        localNearest.Resize(image.GetDimension(0), image.GetDimension(1),
+            image.GetDimension(2));
+        nearest = &localNearest;
+    }
+
+    L2Pass(0, spacing, &image, *nearest, nullptr, cmodel.get());
+    L2Pass(1, spacing, nullptr, *nearest, nullptr, cmodel.get());
+    L2Pass(2, spacing, nullptr, *nearest, &transform, cmodel.get());
+}
+//----------------------------------------------------------------------------
 void ImageUtility3::DrawLine(int x0, int y0, int z0, int x1, int y1, int z1,
     std::function<void(int, int, int)> const& callback)
 {
@@ -331,73 +361,540 @@ void ImageUtility3::Dilate(int numNeighbors, std::array<int, 3> const* delta,
     }
 }
 //----------------------------------------------------------------------------
-void ImageUtility3::GetComponents(int numNeighbors, int const* delta,
-    Image3<int>& image, std::vector<std::vector<size_t>>& components)
+void ImageUtility3::GetComponents(int numNeighbors,
+    std::array<int, 3> const* offsets, Image3<int>& image,
+    std::vector<std::vector<size_t>>& components,
+    std::vector<ComponentStatistics>* statistics, ComputeModel const* cmodel)
 {
-    size_t const numVoxels = image.GetNumPixels();
-    int* numElements = new int[numVoxels];
-    size_t* vstack = new size_t[numVoxels];
-    size_t i, numComponents = 0;
-    int label = 2;
-    for (i = 0; i < numVoxels; ++i)
-    {
-        if (image[i] == 1)
+    int const dim0 = image.GetDimension(0);
+    int const dim1 = image.GetDimension(1);
+    int const dim2 = image.GetDimension(2);
+    int const dim01 = dim0 * dim1;
+
+    // Only the neighbors that precede a voxel in raster order are visited
+    // by the scan.  Because the image boundary is zero, no neighbor offset
+    // of a foreground voxel wraps around a row or slice.  Two preceding
+    // neighbors that are adjacent to each other were already merged when
+    // the later of them was scanned.  The scan skips the search for the
+    // root of a neighbor that is adjacent to a foreground neighbor visited
+    // before it, so the neighbors are visited in decreasing order of the
+    // number of their adjacent preceding neighbors.  This is the 3D analog
+    // of the decision tree of Wu, Otoo, and Suzuki, "Optimizing two-pass
+    // connected-component labeling algorithms".
+    std::vector<int> order, delta(numNeighbors);
+    int reach = 0;
+    for (int j = 0; j < numNeighbors; ++j)
+    {
+        delta[j] = offsets[j][0] +
+            dim0 * (offsets[j][1] + dim1 * offsets[j][2]);
+        if (delta[j] < 0)
         {
-            int top = -1;
-            vstack[++top] = i;
+            order.push_back(j);
+            reach = std::max(reach, -delta[j]);
+        }
+    }
 
-            int& count = numElements[numComponents + 1];
-            count = 0;
-            while (top >= 0)
+    int const numPrevious = static_cast<int>(order.size());
+    std::vector<unsigned int> adjacent(numPrevious, 0);
+    for (int j = 0; j < numPrevious; ++j)
+    {
+        for (int k = 0; k < numPrevious; ++k)
+        {
+            int k0 = offsets[order[j]][0] - offsets[order[k]][0];
+            int k1 = offsets[order[j]][1] - offsets[order[k]][1];
+            int k2 = offsets[order[j]][2] - offsets[order[k]][2];
+            for (int m = 0; m < numNeighbors; ++m)
+            {
+                if (offsets[m][0] == k0 && offsets[m][1] == k1
+                    && offsets[m][2] == k2)
+                {
+                    adjacent[j] |= (1u << k);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<int> rank(numPrevious);
+    for (int j = 0; j < numPrevious; ++j)
+    {
+        rank[j] = j;
+    }
+    std::stable_sort(rank.begin(), rank.end(), [&adjacent](int j0, int j1)
+    {
+        return Popcount(adjacent[j0]) > Popcount(adjacent[j1]);
+    });
+
+    // When a foreground neighbor is adjacent to all the neighbors visited
+    // after it, those neighbors cannot change the root, so the visit stops.
+    std::vector<int> previous(numPrevious);
+    std::vector<unsigned int> skip(numPrevious, 0);
+    for (int j = 0; j < numPrevious; ++j)
+    {
+        previous[j] = delta[order[rank[j]]];
+        for (int k = 0; k < j; ++k)
+        {
+            if (adjacent[rank[j]] & (1u << rank[k]))
+            {
+                skip[j] |= (1u << k);
+            }
+        }
+    }
+
+    std::vector<char> last(numPrevious, 1);
+    for (int j = 0; j < numPrevious; ++j)
+    {
+        for (int k = j + 1; k < numPrevious; ++k)
+        {
+            if ((skip[k] & (1u << j)) == 0)
+            {
+                last[j] = 0;
+                break;
+            }
+        }
+    }
+
+    // Partition the slices into slabs.  Slab s contains the voxels with
+    // indices first[s] <= i < first[s+1].
+    int const numThreads =
+        (cmodel ? static_cast<int>(cmodel->numThreads) : 1);
+    int const numSlabs = std::max(1, std::min(numThreads, dim2));
+    std::vector<int> first(numSlabs + 1);
+    for (int s = 0; s <= numSlabs; ++s)
+    {
+        first[s] = dim01 * static_cast<int>(
+            (static_cast<long long>(dim2) * s) / numSlabs);
+    }
+
+    // Label each slab independently and count the roots of its trees.  The
+    // parent of a background voxel is never accessed, so it is not
+    // initialized.
+    int* parent = new int[image.GetNumPixels()];
+    int* pixels = image.GetPixels1D();
+    std::vector<int> numRoots(numSlabs + 1, 0);
+    Execute(numSlabs, cmodel, [&](int smin, int smax)
+    {
+        for (int s = smin; s <= smax; ++s)
+        {
+            int const imin = first[s], imax = first[s + 1];
+            int count = 0;
+            for (int i = imin; i < imax; ++i)
             {
-                size_t v = vstack[top];
-                image[v] = -1;
-                int j;
-                for (j = 0; j < numNeighbors; ++j)
+                if (pixels[i] != 0)
                 {
-                    size_t adj = v + delta[j];
-                    if (image[adj] == 1)
+                    // The voxel is a singleton until it meets a foreground
+                    // neighbor, so it can be attached directly to the
+                    // smallest root among its neighbors.
+                    int root = i;
+                    unsigned int visited = 0;
+                    for (int j = 0; j < numPrevious; ++j)
                     {
-                        vstack[++top] = adj;
-                        break;
+                        int adj = i + previous[j];
+                        if (adj < imin || pixels[adj] == 0)
+                        {
+                            continue;
+                        }
+
+                        bool merged = ((visited & skip[j]) != 0);
+                        visited |= (1u << j);
+                        if (!merged)
+                        {
+                            int r = FindRoot(parent, adj);
+                            if (r < root)
+                            {
+                                if (root != i)
+                                {
+                                    parent[root] = r;
+                                    --count;
+                                }
+                                root = r;
+                            }
+                            else if (r > root)
+                            {
+                                parent[r] = root;
+                                --count;
+                            }
+                        }
+
+                        if (last[j])
+                        {
+                            break;
+                        }
+                    }
+                    parent[i] = root;
+                    if (root == i)
+                    {
+                        ++count;
                     }
                 }
-                if (j == numNeighbors)
+            }
+            numRoots[s + 1] = count;
+        }
+    });
+
+    // Merge the neighbors that straddle the slab boundaries.  Only the
+    // first 'reach' voxels of a slab have such neighbors.  A root that is
+    // linked to another root is removed from the count of its slab.
+    for (int s = 1; s < numSlabs; ++s)
+    {
+        int imax = std::min(first[s] + reach, first[s + 1]);
+        for (int i = first[s]; i < imax; ++i)
+        {
+            if (image[i] != 0)
+            {
+                for (auto d : previous)
                 {
-                    image[v] = label;
-                    ++count;
-                    --top;
+                    int adj = i + d;
+                    if (adj < first[s] && image[adj] != 0)
+                    {
+                        int r = Union(parent, i, adj);
+                        if (r >= 0)
+                        {
+                            int t = static_cast<int>(std::upper_bound(
+                                first.begin(), first.end(), r) -
+                                first.begin()) - 1;
+                            --numRoots[t + 1];
+                        }
+                    }
                 }
             }
-
-            ++numComponents;
-            ++label;
         }
     }
-    delete[] vstack;
 
+    // Number the roots in raster order, starting each slab after the roots
+    // of the preceding slabs.  Because parent[i] < i for a voxel that is
+    // not a root, the label of a voxel is the label of its parent when the
+    // parent is in the same slab and has been labeled.  Otherwise, the
+    // voxel is marked with -1 and its label is looked up at its root after
+    // all the roots are labeled.
+    for (int s = 1; s <= numSlabs; ++s)
+    {
+        numRoots[s] += numRoots[s - 1];
+    }
+
+    Execute(numSlabs, cmodel, [&](int smin, int smax)
+    {
+        for (int s = smin; s <= smax; ++s)
+        {
+            int label = numRoots[s];
+            for (int i = first[s]; i < first[s + 1]; ++i)
+            {
+                if (image[i] != 0)
+                {
+                    int j = parent[i];
+                    if (j == i)
+                    {
+                        image[i] = ++label;
+                    }
+                    else if (j >= first[s])
+                    {
+                        image[i] = image[j];
+                    }
+                    else
+                    {
+                        image[i] = -1;
+                    }
+                }
+            }
+        }
+    });
+
+    Execute(numSlabs, cmodel, [&](int smin, int smax)
+    {
+        for (int s = smin; s <= smax; ++s)
+        {
+            for (int i = first[s]; i < first[s + 1]; ++i)
+            {
+                if (image[i] < 0)
+                {
+                    int root = parent[i];
+                    while (parent[root] != root)
+                    {
+                        root = parent[root];
+                    }
+                    image[i] = image[root];
+                }
+            }
+        }
+    });
+    delete[] parent;
+
+    int const numComponents = numRoots[numSlabs];
     if (numComponents > 0)
     {
+        std::vector<int> numElements(numComponents + 1, 0);
+        for (size_t i = 0; i < image.GetNumPixels(); ++i)
+        {
+            ++numElements[image[i]];
+        }
+
         components.resize(numComponents + 1);
-        for (i = 1; i <= numComponents; ++i)
+        for (int k = 1; k <= numComponents; ++k)
+        {
+            components[k].resize(numElements[k]);
+            numElements[k] = 0;
+        }
+
+        if (statistics)
+        {
+            ComponentStatistics initial;
+            initial.numVoxels = 0;
+            initial.xMin = dim0;
+            initial.xMax = -1;
+            initial.yMin = dim1;
+            initial.yMax = -1;
+            initial.zMin = dim2;
+            initial.zMax = -1;
+            initial.xCentroid = 0.0;
+            initial.yCentroid = 0.0;
+            initial.zCentroid = 0.0;
+            statistics->resize(numComponents + 1);
+            std::fill(statistics->begin(), statistics->end(), initial);
+        }
+
+        for (int z = 0, i = 0; z < dim2; ++z)
+        {
+            for (int y = 0; y < dim1; ++y)
+            {
+                for (int x = 0; x < dim0; ++x, ++i)
+                {
+                    int value = image[i];
+                    if (value != 0)
+                    {
+                        components[value][numElements[value]] = i;
+                        ++numElements[value];
+                        if (statistics)
+                        {
+                            ComponentStatistics& stat = (*statistics)[value];
+                            stat.xMin = std::min(stat.xMin, x);
+                            stat.xMax = std::max(stat.xMax, x);
+                            stat.yMin = std::min(stat.yMin, y);
+                            stat.yMax = std::max(stat.yMax, y);
+                            stat.zMin = std::min(stat.zMin, z);
+                            stat.zMax = std::max(stat.zMax, z);
+                            stat.xCentroid += static_cast<double>(x);
+                            stat.yCentroid += static_cast<double>(y);
+                            stat.zCentroid += static_cast<double>(z);
+                        }
+                    }
+                }
+            }
+        }
+
+        if (statistics)
+        {
+            for (int k = 1; k <= numComponents; ++k)
+            {
+                ComponentStatistics& stat = (*statistics)[k];
+                stat.numVoxels = components[k].size();
+                stat.xCentroid /= static_cast<double>(stat.numVoxels);
+                stat.yCentroid /= static_cast<double>(stat.numVoxels);
+                stat.zCentroid /= static_cast<double>(stat.numVoxels);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+int ImageUtility3::FindRoot(int* parent, int i)
+{
+    // Path halving keeps the trees shallow.
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+//----------------------------------------------------------------------------
+int ImageUtility3::Union(int* parent, int i0, int i1)
+{
+    int r0 = FindRoot(parent, i0);
+    int r1 = FindRoot(parent, i1);
+    if (r0 < r1)
+    {
+        parent[r1] = r0;
+        return r1;
+    }
+    if (r1 < r0)
+    {
+        parent[r0] = r1;
+        return r0;
+    }
+    return -1;
+}
+//----------------------------------------------------------------------------
+int ImageUtility3::Popcount(unsigned int bits)
+{
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1)
+    {
+        ++count;
+    }
+    return count;
+}
+//----------------------------------------------------------------------------
+void ImageUtility3::L2Pass(int axis, std::array<float, 3> const& spacing,
+    Image3<int> const* image, Image3<int>& nearest, Image3<float>* transform,
+    ComputeModel const* cmodel)
+{
+    int const dim[3] =
+    {
+        nearest.GetDimension(0),
+        nearest.GetDimension(1),
+        nearest.GetDimension(2)
+    };
+
+    // The lines parallel to 'axis' are indexed by the coordinates of the
+    // other two axes, a0 varying fastest.  Consecutive lines are adjacent
+    // in memory, which keeps the strided y- and z-passes cache friendly.
+    int const a0 = (axis == 0 ? 1 : 0);
+    int const a1 = (axis == 2 ? 1 : 2);
+    int const stride[3] = { 1, dim[0], dim[0] * dim[1] };
+    int const numSamples = dim[axis];
+    int const numLines = dim[a0] * dim[a1];
+    double const weight = static_cast<double>(spacing[axis]);
+    double const sqrSpacing[3] =
+    {
+        static_cast<double>(spacing[0]) * static_cast<double>(spacing[0]),
+        static_cast<double>(spacing[1]) * static_cast<double>(spacing[1]),
+        static_cast<double>(spacing[2]) * static_cast<double>(spacing[2])
+    };
+
+    Execute(numLines, cmodel, [&](int lmin, int lmax)
+    {
+        std::vector<int> site(numSamples), closest(numSamples);
+        std::vector<int> v(numSamples);
+        std::vector<double> f(numSamples), z(numSamples);
+        int coord[3];
+        for (int line = lmin; line <= lmax; ++line)
         {
-            components[i].resize(numElements[i]);
-            numElements[i] = 0;
+            coord[a0] = line % dim[a0];
+            coord[a1] = line / dim[a0];
+            coord[axis] = 0;
+            int const base = coord[0] + dim[0] * (coord[1] +
+                dim[1] * coord[2]);
+
+            // Gather the line.  The squared distance from a sample to its
+            // current nearest background voxel involves only the previous
+            // axes, because both share the coordinate along 'axis'.
+            for (int q = 0, i = base; q < numSamples; ++q, i += stride[axis])
+            {
+                if (image)
+                {
+                    site[q] = ((*image)[i] == 0 ? i : -1);
+                    f[q] = 0.0;
+                }
+                else
+                {
+                    int s = nearest[i];
+                    site[q] = s;
+                    if (s >= 0)
+                    {
+                        coord[axis] = q;
+                        std::array<int, 3> sc = nearest.GetCoordinates(s);
+                        double sqrLength = 0.0;
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            double diff = static_cast<double>(
+                                coord[k] - sc[k]);
+                            sqrLength += sqrSpacing[k] * diff * diff;
+                        }
+                        f[q] = sqrLength;
+                    }
+                }
+            }
+
+            L2Envelope(numSamples, weight, &site[0], &f[0], &closest[0],
+                &v[0], &z[0]);
+
+            // Scatter the line.
+            for (int p = 0, i = base; p < numSamples; ++p, i += stride[axis])
+            {
+                int q = closest[p];
+                nearest[i] = (q >= 0 ? site[q] : -1);
+                if (transform)
+                {
+                    if (q >= 0)
+                    {
+                        double diff = weight * static_cast<double>(p - q);
+                        (*transform)[i] = static_cast<float>(
+                            sqrt(diff * diff + f[q]));
+                    }
+                    else
+                    {
+                        (*transform)[i] = std::numeric_limits<float>::max();
+                    }
+                }
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------
+void ImageUtility3::L2Envelope(int numSamples, double weight,
+    int const* site, double const* f, int* closest, int* v, double* z)
+{
+    // v[0..k] are the samples whose parabolas form the lower envelope, and
+    // parabola v[j] is the minimum on the interval [z[j],z[j+1]].  The
+    // intersection of the parabolas for samples r < q is at
+    //   s = ((f[q]/w^2 + q^2) - (f[r]/w^2 + r^2))/(2*(q - r))
+    double const invSqrWeight = 1.0 / (weight * weight);
+    double const minReal = -std::numeric_limits<double>::max();
+    int k = -1;
+    for (int q = 0; q < numSamples; ++q)
+    {
+        if (site[q] < 0)
+        {
+            continue;
         }
 
-        for (i = 0; i < numVoxels; ++i)
+        double gq = f[q] * invSqrWeight + static_cast<double>(q) * q;
+        double s = minReal;
+        while (k >= 0)
         {
-            int value = image[i];
-            if (value != 0)
+            int r = v[k];
+            double gr = f[r] * invSqrWeight + static_cast<double>(r) * r;
+            s = (gq - gr) / (2.0 * static_cast<double>(q - r));
+            if (s > z[k])
             {
-                // Labels started at 2 to support the depth-first search,
-                // so they need to be decremented for the correct labels.
-                image[i] = --value;
-                components[value][numElements[value]] = i;
-                ++numElements[value];
+                break;
             }
+            s = minReal;
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+    }
+
+    if (k < 0)
+    {
+        // The line has no background samples.
+        std::fill(closest, closest + numSamples, -1);
+        return;
+    }
+
+    for (int p = 0, j = 0; p < numSamples; ++p)
+    {
+        while (j < k && z[j + 1] < static_cast<double>(p))
+        {
+            ++j;
         }
+        closest[p] = v[j];
+    }
+}
+//----------------------------------------------------------------------------
+void ImageUtility3::Execute(int numLines, ComputeModel const* cmodel,
+    std::function<void(int, int)> const& process)
+{
+    int const numThreads =
+        (cmodel ? static_cast<int>(cmodel->numThreads) : 1);
+    if (numThreads > 1 && numLines > 1)
+    {
+        cmodel->GetThreadPool().ParallelFor(numLines, numThreads, process);
+    }
+    else if (numLines > 0)
+    {
+        process(0, numLines - 1);
     }
-    delete[] numElements;
 }
 //----------------------------------------------------------------------------
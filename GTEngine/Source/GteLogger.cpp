@@ -3,12 +3,55 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/31)
+// File Version: 1.0.2 (2014/11/13)
 
 #include "GTEnginePCH.h"
 #include "GteLogger.h"
+#include "GteLockFreeQueue.h"
+#include <algorithm>
+#include <chrono>
 using namespace gte;
 
+//----------------------------------------------------------------------------
+// Support for asynchronous logging.
+//----------------------------------------------------------------------------
+class Logger::Message
+{
+public:
+    Message()
+        :
+        flag(0)
+    {
+    }
+
+    Message(int inFlag, std::string const& inText)
+        :
+        flag(inFlag),
+        text(inText)
+    {
+    }
+
+    int flag;
+    std::string text;
+};
+
+class Logger::ThreadBuffer
+{
+public:
+    ThreadBuffer(std::thread::id inOwner, unsigned int maxMessages)
+        :
+        owner(inOwner),
+        messages(std::max(maxMessages, 1u)),
+        next(nullptr)
+    {
+    }
+
+    // The owner pushes and the thread that holds msDrainMutex pops.
+    std::thread::id const owner;
+    LockFreeQueue<Message, true> messages;
+    ThreadBuffer* next;
+};
+
 //----------------------------------------------------------------------------
 Logger::Logger(char const* file, char const* function, int line,
     std::string const& message)
@@ -21,69 +64,194 @@ Logger::Logger(char const* file, char const* function, int line,
 }
 //----------------------------------------------------------------------------
 void Logger::Assertion()
+{
+    Flush();
+    Report(Listener::LISTEN_FOR_ASSERTION, mMessage);
+}
+//----------------------------------------------------------------------------
+void Logger::Error()
+{
+    Flush();
+    Report(Listener::LISTEN_FOR_ERROR, mMessage);
+}
+//----------------------------------------------------------------------------
+void Logger::Warning()
+{
+    Post(Listener::LISTEN_FOR_WARNING, mMessage);
+}
+//----------------------------------------------------------------------------
+void Logger::Information()
+{
+    Post(Listener::LISTEN_FOR_INFORMATION, mMessage);
+}
+//----------------------------------------------------------------------------
+void Logger::Subscribe(Listener* listener)
 {
     msMutex.lock();
-    for (auto listener : msListeners)
+    msListeners.insert(listener);
+    msMutex.unlock();
+}
+//----------------------------------------------------------------------------
+void Logger::Unsubscribe(Listener* listener)
+{
+    Flush();
+    msMutex.lock();
+    msListeners.erase(listener);
+    msMutex.unlock();
+}
+//----------------------------------------------------------------------------
+void Logger::SetAsynchronous(bool asynchronous,
+    unsigned int maxThreadMessages)
+{
+    msMaxThreadMessages = maxThreadMessages;
+
+    if (asynchronous && !msAsynchronous)
+    {
+        msDrainerStop = false;
+        msDrainer = std::thread(DrainerLoop);
+        msAsynchronous = true;
+    }
+    else if (!asynchronous && msAsynchronous)
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_ASSERTION)
+        msAsynchronous = false;
         {
-            listener->Assertion(mMessage);
+            std::lock_guard<std::mutex> lock(msDrainerMutex);
+            msDrainerStop = true;
         }
+        msDrainerWakeUp.notify_all();
+        msDrainer.join();
+        Drain();
     }
-    msMutex.unlock();
 }
 //----------------------------------------------------------------------------
-void Logger::Error()
+bool Logger::IsAsynchronous()
 {
-    msMutex.lock();
+    return msAsynchronous;
+}
+//----------------------------------------------------------------------------
+void Logger::Flush()
+{
+    if (msThreadBuffers.load() != nullptr)
+    {
+        Drain();
+    }
+}
+//----------------------------------------------------------------------------
+unsigned int Logger::GetNumDropped()
+{
+    return msNumDropped;
+}
+//----------------------------------------------------------------------------
+void Logger::Report(int flag, std::string const& message)
+{
+    std::lock_guard<std::mutex> lock(msMutex);
     for (auto listener : msListeners)
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_ERROR)
+        if (listener->GetFlags() & flag)
         {
-            listener->Error(mMessage);
+            switch (flag)
+            {
+            case Listener::LISTEN_FOR_ASSERTION:
+                listener->Assertion(message);
+                break;
+            case Listener::LISTEN_FOR_ERROR:
+                listener->Error(message);
+                break;
+            case Listener::LISTEN_FOR_WARNING:
+                listener->Warning(message);
+                break;
+            default:
+                listener->Information(message);
+                break;
+            }
         }
     }
-    msMutex.unlock();
 }
 //----------------------------------------------------------------------------
-void Logger::Warning()
+void Logger::Post(int flag, std::string const& message)
 {
-    msMutex.lock();
-    for (auto listener : msListeners)
+    if (!msAsynchronous.load(std::memory_order_relaxed))
+    {
+        Report(flag, message);
+        return;
+    }
+
+    ThreadBuffer* buffer = GetThreadBuffer();
+    if (buffer->messages.Push(Message(flag, message)))
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_WARNING)
+        // The drainer wakes up periodically.  Wake it up early when the
+        // buffer is half full, so that bursts of messages are not dropped.
+        if (2 * buffer->messages.GetNumElements() >=
+            buffer->messages.GetMaxNumElements())
         {
-            listener->Warning(mMessage);
+            msDrainerWakeUp.notify_one();
         }
     }
-    msMutex.unlock();
+    else
+    {
+        ++msNumDropped;
+    }
 }
 //----------------------------------------------------------------------------
-void Logger::Information()
+Logger::ThreadBuffer* Logger::GetThreadBuffer()
 {
-    msMutex.lock();
-    for (auto listener : msListeners)
+    std::thread::id const id = std::this_thread::get_id();
+    ThreadBuffer* buffer = msThreadBuffers.load(std::memory_order_acquire);
+    for (; buffer; buffer = buffer->next)
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_INFORMATION)
+        if (buffer->owner == id)
         {
-            listener->Information(mMessage);
+            return buffer;
         }
     }
-    msMutex.unlock();
+
+    // This is the first message of the thread.  Only this thread can add a
+    // buffer for its identifier, so the list has no duplicates.
+    buffer = new ThreadBuffer(id, msMaxThreadMessages);
+    buffer->next = msThreadBuffers.load(std::memory_order_relaxed);
+    while (!msThreadBuffers.compare_exchange_weak(buffer->next, buffer,
+        std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return buffer;
 }
 //----------------------------------------------------------------------------
-void Logger::Subscribe(Listener* listener)
+void Logger::Drain()
 {
-    msMutex.lock();
-    msListeners.insert(listener);
-    msMutex.unlock();
+    // The mutex ensures that each ring buffer has a single consumer.
+    std::lock_guard<std::mutex> lock(msDrainMutex);
+
+    Message message;
+    ThreadBuffer* buffer = msThreadBuffers.load(std::memory_order_acquire);
+    for (; buffer; buffer = buffer->next)
+    {
+        while (buffer->messages.Pop(message))
+        {
+            Report(message.flag, message.text);
+        }
+    }
+
+    static unsigned int sNumReportedDropped = 0;
+    unsigned int const numDropped = msNumDropped;
+    if (numDropped != sNumReportedDropped)
+    {
+        Report(Listener::LISTEN_FOR_WARNING, "Logger dropped " +
+            std::to_string(numDropped - sNumReportedDropped) +
+            " messages because a thread buffer was full.\n\n");
+        sNumReportedDropped = numDropped;
+    }
 }
 //----------------------------------------------------------------------------
-void Logger::Unsubscribe(Listener* listener)
+void Logger::DrainerLoop()
 {
-    msMutex.lock();
-    msListeners.erase(listener);
-    msMutex.unlock();
+    std::unique_lock<std::mutex> lock(msDrainerMutex);
+    while (!msDrainerStop)
+    {
+        msDrainerWakeUp.wait_for(lock, std::chrono::milliseconds(10));
+        lock.unlock();
+        Drain();
+        lock.lock();
+    }
 }
 //----------------------------------------------------------------------------
 
@@ -133,3 +301,25 @@ void Logger::Listener::Report(std::string const&)
 
 std::mutex Logger::msMutex;
 std::set<Logger::Listener*> Logger::msListeners;
+std::atomic<Logger::ThreadBuffer*> Logger::msThreadBuffers(nullptr);
+std::atomic<bool> Logger::msAsynchronous(false);
+std::atomic<unsigned int> Logger::msMaxThreadMessages(1024);
+std::atomic<unsigned int> Logger::msNumDropped(0);
+std::mutex Logger::msDrainMutex;
+std::mutex Logger::msDrainerMutex;
+std::condition_variable Logger::msDrainerWakeUp;
+bool Logger::msDrainerStop = false;
+std::thread Logger::msDrainer;
+
+// Stop the background thread at exit if the application did not.  This
+// object is defined after the static members, so it is destroyed before
+// them.
+class LoggerDrainerShutdown
+{
+public:
+    ~LoggerDrainerShutdown()
+    {
+        Logger::SetAsynchronous(false);
+    }
+};
+static LoggerDrainerShutdown gsDrainerShutdown;
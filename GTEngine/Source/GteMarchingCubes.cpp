@@ -3,10 +3,11 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.1 (2014/08/31)
+// File Version: 1.0.2 (2014/10/18)
 
 #include "GTEnginePCH.h"
 #include "GteMarchingCubes.h"
+#include "GteMarchingCubesTable.h"
 #include <algorithm>
 using namespace gte;
 
@@ -16,18 +17,27 @@ MarchingCubes::~MarchingCubes ()
 }
 //----------------------------------------------------------------------------
 MarchingCubes::MarchingCubes ()
+    :
+    mTable(nullptr),
+    mEntry(0)
 {
-    // Create the lookup table.
-    memset(&mTable[0][0], 0, 256*41*sizeof(int));
-    for (mEntry = 0; mEntry < 256; ++mEntry)
-    {
-        (this->*msConfiguration[mEntry].F)(msConfiguration[mEntry].index);
-    }
 }
 //----------------------------------------------------------------------------
 int const* MarchingCubes::GetTable () const
 {
-    return &mTable[0][0];
+    return &gMarchingCubesTable[0][0];
+}
+//----------------------------------------------------------------------------
+void MarchingCubes::GenerateTable (int table[256][41])
+{
+    MarchingCubes generator;
+    generator.mTable = table;
+    memset(&table[0][0], 0, 256*41*sizeof(int));
+    for (generator.mEntry = 0; generator.mEntry < 256; ++generator.mEntry)
+    {
+        Configuration& config = msConfiguration[generator.mEntry];
+        (generator.*config.F)(config.index);
+    }
 }
 //----------------------------------------------------------------------------
 std::string MarchingCubes::GetConfigurationType (int entry)
@@ -42,7 +52,7 @@ std::string MarchingCubes::GetConfigurationType (int entry)
 void MarchingCubes::Pack (int numV, int const* vpair, int numT,
     int const* itriple)
 {
-    // The item is already zeroed in the constructor.
+    // The item is already zeroed in GenerateTable.
     int* item = mTable[mEntry];
     item[0] = numV;
     item[1] = numT;
@@ -64,7 +74,7 @@ void MarchingCubes::Pack (int numV, int const* vpair, int numT,
 void MarchingCubes::Unpack (int entry, int& numV, int vpair[2*MAX_VERTICES],
     int& numT, int itriple[3*MAX_TRIANGLES]) const
 {
-    int const* item = mTable[entry];
+    int const* item = gMarchingCubesTable[entry];
     numV = item[0];
     numT = item[1];
 
@@ -0,0 +1,155 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/01)
+
+#include "GTEnginePCH.h"
+#include "GteMemoryMappedFile.h"
+#include "GteLogger.h"
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace gte;
+
+//----------------------------------------------------------------------------
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+//----------------------------------------------------------------------------
+MemoryMappedFile::MemoryMappedFile()
+    :
+    mData(nullptr),
+    mSize(0),
+    mAccess(READ_ONLY)
+#if defined(WIN32)
+    ,
+    mFile(nullptr),
+    mMapping(nullptr)
+#endif
+{
+}
+//----------------------------------------------------------------------------
+bool MemoryMappedFile::Open(std::string const& name, Access access)
+{
+    Close();
+    mAccess = access;
+
+#if defined(WIN32)
+    DWORD fileAccess = (access == READ_WRITE ?
+        GENERIC_READ | GENERIC_WRITE : GENERIC_READ);
+    HANDLE file = CreateFileA(name.c_str(), fileAccess, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        LogError("Failed to open file " + name + ".");
+        return false;
+    }
+    mFile = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        LogError("Failed to get the size of file " + name + ".");
+        Close();
+        return false;
+    }
+    mSize = (size_t)size.QuadPart;
+
+    DWORD protect = PAGE_READONLY, viewAccess = FILE_MAP_READ;
+    if (access == COPY_ON_WRITE)
+    {
+        protect = PAGE_WRITECOPY;
+        viewAccess = FILE_MAP_COPY;
+    }
+    else if (access == READ_WRITE)
+    {
+        protect = PAGE_READWRITE;
+        viewAccess = FILE_MAP_WRITE;
+    }
+
+    mMapping = CreateFileMappingA(file, nullptr, protect, 0, 0, nullptr);
+    if (!mMapping)
+    {
+        LogError("Failed to create the mapping of file " + name + ".");
+        Close();
+        return false;
+    }
+
+    mData = (char*)MapViewOfFile(mMapping, viewAccess, 0, 0, 0);
+    if (!mData)
+    {
+        LogError("Failed to map file " + name + ".");
+        Close();
+        return false;
+    }
+#else
+    int file = open(name.c_str(), access == READ_WRITE ? O_RDWR : O_RDONLY);
+    if (file < 0)
+    {
+        LogError("Failed to open file " + name + ".");
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        LogError("Failed to get the size of file " + name + ".");
+        close(file);
+        return false;
+    }
+    mSize = (size_t)status.st_size;
+
+    int protect = (access == READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE);
+    int flags = (access == READ_WRITE ? MAP_SHARED : MAP_PRIVATE);
+    void* data = mmap(nullptr, mSize, protect, flags, file, 0);
+
+    // The mapping remains valid after the file is closed.
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        LogError("Failed to map file " + name + ".");
+        mSize = 0;
+        return false;
+    }
+    mData = (char*)data;
+#endif
+
+    return true;
+}
+//----------------------------------------------------------------------------
+void MemoryMappedFile::Close()
+{
+#if defined(WIN32)
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping)
+    {
+        CloseHandle((HANDLE)mMapping);
+        mMapping = nullptr;
+    }
+    if (mFile)
+    {
+        CloseHandle((HANDLE)mFile);
+        mFile = nullptr;
+    }
+#else
+    if (mData)
+    {
+        munmap(mData, mSize);
+    }
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+}
+//----------------------------------------------------------------------------
@@ -3,7 +3,7 @@
 // Distributed under the Boost Software License, Version 1.0.
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
-// File Version: 1.0.2 (2014/09/11)
+// File Version: 1.0.3 (2014/11/21)
 
 #include "GTEnginePCH.h"
 #include "GteMeshFactory.h"
@@ -20,6 +20,7 @@ MeshFactory::MeshFactory()
     mVBUsage(Resource::IMMUTABLE),
     mIBUsage(Resource::IMMUTABLE),
     mOutside(true),
+    mOptimize(false),
     mPositions(nullptr),
     mNormals(nullptr),
     mTangents(nullptr),
@@ -91,6 +92,8 @@ std::shared_ptr<Visual> MeshFactory::CreateRectangle(unsigned int numXSamples,
         }
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -163,6 +166,8 @@ std::shared_ptr<Visual> MeshFactory::CreateTriangle(unsigned int numSamples,
     }
     ibuffer->SetTriangle(t++, y0, y0 + 1, y1);
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -252,6 +257,8 @@ std::shared_ptr<Visual> MeshFactory::CreateDisk(unsigned int numShellSamples,
         }
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -342,6 +349,8 @@ std::shared_ptr<Visual> MeshFactory::CreateBox(float xExtent, float yExtent,
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -442,6 +451,8 @@ std::shared_ptr<Visual> MeshFactory::CreateCylinderOpen(
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -463,9 +474,14 @@ std::shared_ptr<Visual> MeshFactory::CreateCylinderClosed(
     unsigned int numAxisSamples, unsigned int numRadialSamples, float radius,
     float height)
 {
-    // Create a sphere and then deform it into a closed cylinder.
+    // Create a sphere and then deform it into a closed cylinder.  The
+    // deformation depends on the vertex order of the sphere, so the mesh is
+    // optimized afterwards.
+    bool optimize = mOptimize;
+    mOptimize = false;
     std::shared_ptr<Visual> visual = CreateSphere(numAxisSamples,
         numRadialSamples, radius);
+    mOptimize = optimize;
     if (!visual)
     {
         return nullptr;
@@ -514,6 +530,8 @@ std::shared_ptr<Visual> MeshFactory::CreateCylinderClosed(
         }
     }
 
+    Optimize(vbuffer, visual->GetIndexBuffer().get());
+
     // The duplication of vertices at the seam causes the automatically
     // generated bounding volume to be slightly off center.  Reset the bound
     // to use the true information.
@@ -675,6 +693,8 @@ std::shared_ptr<Visual> MeshFactory::CreateSphere(unsigned int numZSamples,
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -799,6 +819,8 @@ std::shared_ptr<Visual> MeshFactory::CreateTorus(
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -863,6 +885,8 @@ std::shared_ptr<Visual> MeshFactory::CreateTetrahedron()
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -933,6 +957,8 @@ std::shared_ptr<Visual> MeshFactory::CreateHexahedron()
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -996,6 +1022,8 @@ std::shared_ptr<Visual> MeshFactory::CreateOctahedron()
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -1104,6 +1132,8 @@ std::shared_ptr<Visual> MeshFactory::CreateDodecahedron()
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -1189,6 +1219,8 @@ std::shared_ptr<Visual> MeshFactory::CreateIcosahedron()
         ReverseTriangleOrder(ibuffer.get());
     }
 
+    Optimize(vbuffer.get(), ibuffer.get());
+
     // Create the mesh.
     std::shared_ptr<Visual> visual(new Visual(vbuffer, ibuffer));
     if (visual)
@@ -1354,3 +1386,11 @@ void MeshFactory::ReverseTriangleOrder(IndexBuffer* ibuffer)
     }
 }
 //----------------------------------------------------------------------------
+void MeshFactory::Optimize(VertexBuffer* vbuffer, IndexBuffer* ibuffer)
+{
+    if (mOptimize)
+    {
+        mOptimizer.Optimize(vbuffer, ibuffer);
+    }
+}
+//----------------------------------------------------------------------------
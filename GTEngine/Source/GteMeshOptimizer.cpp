@@ -0,0 +1,677 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/21)
+
+#include "GTEnginePCH.h"
+#include "GteMeshOptimizer.h"
+#include "GteLogger.h"
+#include "GteVector3.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+using namespace gte;
+
+//----------------------------------------------------------------------------
+MeshOptimizer::~MeshOptimizer()
+{
+}
+//----------------------------------------------------------------------------
+MeshOptimizer::MeshOptimizer()
+    :
+    mAlgorithm(FORSYTH),
+    mCacheSize(16),
+    mOverdrawThreshold(0.0f),
+    mReorderVertices(true)
+{
+    mBefore.acmr = 0.0f;
+    mBefore.atvr = 0.0f;
+    mAfter = mBefore;
+}
+//----------------------------------------------------------------------------
+bool MeshOptimizer::Optimize(VertexBuffer* vbuffer, IndexBuffer* ibuffer)
+{
+    if (!vbuffer || !ibuffer || !vbuffer->GetData() || !ibuffer->GetData())
+    {
+        LogError("The buffers must exist and have system-memory storage.");
+        return false;
+    }
+    if (ibuffer->GetPrimitiveType() != IP_TRIMESH || !ibuffer->IsIndexed())
+    {
+        LogError("The index buffer must be an indexed triangle mesh.");
+        return false;
+    }
+
+    // Copy the indices, which are 16-bit or 32-bit.
+    unsigned int const numVertices = vbuffer->GetNumElements();
+    unsigned int const numIndices = 3*ibuffer->GetNumPrimitives();
+    bool const use32Bit = (ibuffer->GetElementSize() == sizeof(unsigned int));
+    if (numIndices == 0)
+    {
+        mBefore.acmr = 0.0f;
+        mBefore.atvr = 0.0f;
+        mAfter = mBefore;
+        return true;
+    }
+    std::vector<unsigned int> indices(numIndices);
+    if (use32Bit)
+    {
+        memcpy(&indices[0], ibuffer->GetData(),
+            numIndices*sizeof(unsigned int));
+    }
+    else
+    {
+        unsigned short const* source =
+            reinterpret_cast<unsigned short const*>(ibuffer->GetData());
+        std::copy(source, source + numIndices, indices.begin());
+    }
+    for (auto index : indices)
+    {
+        if (index >= numVertices)
+        {
+            LogError("Index out of range.");
+            return false;
+        }
+    }
+
+    mBefore = GetStatistics(numVertices, indices, mCacheSize);
+
+    if (mAlgorithm == FORSYTH)
+    {
+        ReorderForsyth(numVertices, indices, mCacheSize);
+    }
+    else
+    {
+        ReorderTipsify(numVertices, indices, mCacheSize);
+    }
+
+    if (mOverdrawThreshold > 0.0f)
+    {
+        VertexFormat const& vformat = vbuffer->GetFormat();
+        int i = vformat.GetIndex(VA_POSITION, 0);
+        if (i >= 0 && (vformat.GetType(i) == DF_R32G32B32_FLOAT
+            || vformat.GetType(i) == DF_R32G32B32A32_FLOAT))
+        {
+            char const* positions = vbuffer->GetChannel(VA_POSITION, 0,
+                std::set<DFType>());
+            ReorderOverdraw(positions, vformat.GetVertexSize(), numVertices,
+                indices, mCacheSize, mOverdrawThreshold);
+        }
+    }
+
+    if (mReorderVertices)
+    {
+        std::vector<unsigned int> newVertex;
+        ReorderVertices(numVertices, indices, newVertex);
+
+        unsigned int const vertexSize = vbuffer->GetElementSize();
+        char* data = vbuffer->GetData();
+        std::vector<char> original(data, data + numVertices*vertexSize);
+        for (unsigned int v = 0; v < numVertices; ++v)
+        {
+            memcpy(data + newVertex[v]*vertexSize,
+                &original[v*vertexSize], vertexSize);
+        }
+    }
+
+    if (use32Bit)
+    {
+        memcpy(ibuffer->GetData(), &indices[0],
+            numIndices*sizeof(unsigned int));
+    }
+    else
+    {
+        unsigned short* target =
+            reinterpret_cast<unsigned short*>(ibuffer->GetData());
+        for (unsigned int i = 0; i < numIndices; ++i)
+        {
+            target[i] = static_cast<unsigned short>(indices[i]);
+        }
+    }
+
+    mAfter = GetStatistics(numVertices, indices, mCacheSize);
+    return true;
+}
+//----------------------------------------------------------------------------
+void MeshOptimizer::ReorderForsyth(unsigned int numVertices,
+    std::vector<unsigned int>& indices, unsigned int cacheSize)
+{
+    unsigned int const numTriangles =
+        static_cast<unsigned int>(indices.size()/3);
+    if (numTriangles == 0)
+    {
+        return;
+    }
+
+    std::vector<unsigned int> offsets, numLive, adjacent;
+    GetAdjacency(numVertices, indices, offsets, numLive, adjacent);
+
+    // The score of a vertex is the sum of a cache score and a valence
+    // score.  The vertices of the most recent triangle have a fixed score,
+    // so that the next triangle does not simply reuse them in a strip; the
+    // others decay with their position in the LRU cache.  The valence score
+    // favors vertices with few remaining triangles, so that they are not
+    // left isolated.  The constants are those of Forsyth.
+    float const lastTriangleScore = 0.75f;
+    float const cacheDecayPower = 1.5f;
+    float const valenceBoostScale = 2.0f;
+    float const valenceBoostPower = 0.5f;
+    unsigned int const maxValence = 32;
+
+    std::vector<float> cacheScore(cacheSize + 3, 0.0f);
+    for (unsigned int i = 0; i < cacheSize; ++i)
+    {
+        if (i < 3)
+        {
+            cacheScore[i] = lastTriangleScore;
+        }
+        else
+        {
+            float scale = 1.0f/static_cast<float>(cacheSize - 3);
+            cacheScore[i] = pow(1.0f - (i - 3)*scale, cacheDecayPower);
+        }
+    }
+    std::vector<float> valenceScore(maxValence + 1, 0.0f);
+    for (unsigned int i = 1; i <= maxValence; ++i)
+    {
+        valenceScore[i] = valenceBoostScale*pow(static_cast<float>(i),
+            -valenceBoostPower);
+    }
+
+    auto VertexScore = [&cacheScore, &valenceScore, maxValence,
+        valenceBoostScale, valenceBoostPower](int position,
+        unsigned int valence)
+    {
+        if (valence == 0)
+        {
+            // The vertex has no remaining triangles.
+            return -1.0f;
+        }
+        float score = (position >= 0 ? cacheScore[position] : 0.0f);
+        if (valence <= maxValence)
+        {
+            score += valenceScore[valence];
+        }
+        else
+        {
+            score += valenceBoostScale*pow(static_cast<float>(valence),
+                -valenceBoostPower);
+        }
+        return score;
+    };
+
+    std::vector<int> cachePosition(numVertices, -1);
+    std::vector<float> vertexScore(numVertices);
+    for (unsigned int v = 0; v < numVertices; ++v)
+    {
+        vertexScore[v] = VertexScore(-1, numLive[v]);
+    }
+
+    std::vector<float> triangleScore(numTriangles);
+    int best = 0;
+    for (unsigned int t = 0; t < numTriangles; ++t)
+    {
+        unsigned int const* tri = &indices[3*t];
+        triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] +
+            vertexScore[tri[2]];
+        if (triangleScore[t] > triangleScore[best])
+        {
+            best = static_cast<int>(t);
+        }
+    }
+
+    std::vector<char> emitted(numTriangles, 0);
+    std::vector<unsigned int> output(indices.size());
+    std::vector<unsigned int> cache, newCache;
+    cache.reserve(cacheSize + 3);
+    newCache.reserve(cacheSize + 3);
+    unsigned int next = 0;
+    for (unsigned int n = 0; n < numTriangles; ++n)
+    {
+        if (best < 0)
+        {
+            // No triangle is adjacent to a cached vertex, so take the next
+            // triangle in the input order.
+            while (emitted[next])
+            {
+                ++next;
+            }
+            best = static_cast<int>(next);
+        }
+
+        unsigned int const* tri = &indices[3*best];
+        emitted[best] = 1;
+        output[3*n + 0] = tri[0];
+        output[3*n + 1] = tri[1];
+        output[3*n + 2] = tri[2];
+
+        // Remove the triangle from the adjacency lists of its vertices.
+        for (int j = 0; j < 3; ++j)
+        {
+            unsigned int v = tri[j];
+            unsigned int* live = &adjacent[offsets[v]];
+            unsigned int last = --numLive[v];
+            for (unsigned int k = 0; k <= last; ++k)
+            {
+                if (live[k] == static_cast<unsigned int>(best))
+                {
+                    std::swap(live[k], live[last]);
+                    break;
+                }
+            }
+        }
+
+        // Move the vertices of the triangle to the front of the LRU cache.
+        // The cache temporarily holds up to cacheSize+3 vertices; those
+        // beyond cacheSize are evicted.
+        newCache.clear();
+        for (int j = 0; j < 3; ++j)
+        {
+            if (std::find(newCache.begin(), newCache.end(), tri[j]) ==
+                newCache.end())
+            {
+                newCache.push_back(tri[j]);
+            }
+        }
+        for (auto v : cache)
+        {
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+            {
+                newCache.push_back(v);
+            }
+        }
+
+        // Update the scores of the vertices whose cache position changed,
+        // and of their remaining triangles.
+        for (size_t i = 0; i < newCache.size(); ++i)
+        {
+            unsigned int v = newCache[i];
+            cachePosition[v] = (i < cacheSize ? static_cast<int>(i) : -1);
+            float score = VertexScore(cachePosition[v], numLive[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            unsigned int const* live = &adjacent[offsets[v]];
+            for (unsigned int k = 0; k < numLive[v]; ++k)
+            {
+                triangleScore[live[k]] += delta;
+            }
+        }
+        if (newCache.size() > cacheSize)
+        {
+            newCache.resize(cacheSize);
+        }
+        cache.swap(newCache);
+
+        // The next triangle is the best of those adjacent to the cache.
+        best = -1;
+        float bestScore = -1.0f;
+        for (auto v : cache)
+        {
+            unsigned int const* live = &adjacent[offsets[v]];
+            for (unsigned int k = 0; k < numLive[v]; ++k)
+            {
+                if (triangleScore[live[k]] > bestScore)
+                {
+                    bestScore = triangleScore[live[k]];
+                    best = static_cast<int>(live[k]);
+                }
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+//----------------------------------------------------------------------------
+void MeshOptimizer::ReorderTipsify(unsigned int numVertices,
+    std::vector<unsigned int>& indices, unsigned int cacheSize)
+{
+    unsigned int const numTriangles =
+        static_cast<unsigned int>(indices.size()/3);
+    if (numTriangles == 0)
+    {
+        return;
+    }
+
+    std::vector<unsigned int> offsets, numLive, adjacent;
+    GetAdjacency(numVertices, indices, offsets, numLive, adjacent);
+
+    // The algorithm fans around a vertex, emitting all its remaining
+    // triangles, and then selects the next fanning vertex among the
+    // vertices of the emitted triangles: the one that is oldest in the
+    // cache but that remains in the cache after its remaining triangles are
+    // emitted.  When there is no such vertex, it selects the most recently
+    // used vertex with remaining triangles (dead-end stack) or the next
+    // vertex in input order with remaining triangles.
+    std::vector<unsigned int> timeStamps(numVertices, 0);
+    std::vector<char> emitted(numTriangles, 0);
+    std::vector<unsigned int> deadEnd, candidates;
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    unsigned int time = cacheSize + 1;
+    unsigned int cursor = 0;
+    int fanning = 0;
+    while (fanning >= 0)
+    {
+        unsigned int const f = static_cast<unsigned int>(fanning);
+        candidates.clear();
+        unsigned int const* adj = &adjacent[offsets[f]];
+        unsigned int const numAdj = offsets[f + 1] - offsets[f];
+        for (unsigned int k = 0; k < numAdj; ++k)
+        {
+            unsigned int t = adj[k];
+            if (emitted[t])
+            {
+                continue;
+            }
+            emitted[t] = 1;
+
+            for (int j = 0; j < 3; ++j)
+            {
+                unsigned int v = indices[3*t + j];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --numLive[v];
+                if (time - timeStamps[v] > cacheSize)
+                {
+                    timeStamps[v] = time++;
+                }
+            }
+        }
+
+        // Select the next fanning vertex among the candidates.
+        fanning = -1;
+        int bestPriority = -1;
+        for (auto v : candidates)
+        {
+            if (numLive[v] > 0)
+            {
+                int priority = 0;
+                if (time - timeStamps[v] + 2*numLive[v] <= cacheSize)
+                {
+                    priority = static_cast<int>(time - timeStamps[v]);
+                }
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    fanning = static_cast<int>(v);
+                }
+            }
+        }
+
+        if (fanning < 0)
+        {
+            // Skip the dead end.
+            while (!deadEnd.empty())
+            {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (numLive[v] > 0)
+                {
+                    fanning = static_cast<int>(v);
+                    break;
+                }
+            }
+            while (fanning < 0 && cursor < numVertices)
+            {
+                if (numLive[cursor] > 0)
+                {
+                    fanning = static_cast<int>(cursor);
+                }
+                ++cursor;
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+//----------------------------------------------------------------------------
+void MeshOptimizer::ReorderOverdraw(char const* positions,
+    unsigned int stride, unsigned int numVertices,
+    std::vector<unsigned int>& indices, unsigned int cacheSize,
+    float threshold)
+{
+    unsigned int const numTriangles =
+        static_cast<unsigned int>(indices.size()/3);
+    if (numTriangles == 0 || threshold <= 0.0f)
+    {
+        return;
+    }
+
+    std::vector<unsigned int> clusters;
+    GetClusters(numVertices, indices, cacheSize, threshold, clusters);
+    unsigned int const numClusters =
+        static_cast<unsigned int>(clusters.size() - 1);
+    if (numClusters <= 1)
+    {
+        return;
+    }
+
+    // Compute the area-weighted centroid and the area-weighted normal of
+    // each cluster.  The length of the cross product is twice the area.
+    std::vector<Vector3<float>> centroid(numClusters), normal(numClusters);
+    std::vector<float> area(numClusters);
+    Vector3<float> meshCentroid = Vector3<float>::Zero();
+    float meshArea = 0.0f;
+    for (unsigned int c = 0; c < numClusters; ++c)
+    {
+        centroid[c] = Vector3<float>::Zero();
+        normal[c] = Vector3<float>::Zero();
+        area[c] = 0.0f;
+        for (unsigned int t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            Vector3<float> const& p0 = *reinterpret_cast<Vector3<float>
+                const*>(positions + indices[3*t + 0]*stride);
+            Vector3<float> const& p1 = *reinterpret_cast<Vector3<float>
+                const*>(positions + indices[3*t + 1]*stride);
+            Vector3<float> const& p2 = *reinterpret_cast<Vector3<float>
+                const*>(positions + indices[3*t + 2]*stride);
+            Vector3<float> cross = Cross(p1 - p0, p2 - p0);
+            float triangleArea = Length(cross);
+            centroid[c] += (triangleArea/3.0f)*(p0 + p1 + p2);
+            normal[c] += cross;
+            area[c] += triangleArea;
+        }
+        meshCentroid += centroid[c];
+        meshArea += area[c];
+        if (area[c] > 0.0f)
+        {
+            centroid[c] /= area[c];
+        }
+        if (Length(normal[c]) > 0.0f)
+        {
+            Normalize(normal[c]);
+        }
+    }
+    if (meshArea > 0.0f)
+    {
+        meshCentroid /= meshArea;
+    }
+
+    // Sort the clusters so that those facing away from the centroid of the
+    // mesh, which are likely to occlude the others, are drawn first.
+    std::vector<float> key(numClusters);
+    std::vector<unsigned int> order(numClusters);
+    for (unsigned int c = 0; c < numClusters; ++c)
+    {
+        key[c] = Dot(centroid[c] - meshCentroid, normal[c]);
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&key](unsigned int c0, unsigned int c1)
+        {
+            return key[c0] > key[c1];
+        }
+    );
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (auto c : order)
+    {
+        output.insert(output.end(), indices.begin() + 3*clusters[c],
+            indices.begin() + 3*clusters[c + 1]);
+    }
+    indices.swap(output);
+}
+//----------------------------------------------------------------------------
+void MeshOptimizer::ReorderVertices(unsigned int numVertices,
+    std::vector<unsigned int>& indices, std::vector<unsigned int>& newVertex)
+{
+    unsigned int const invalid = 0xFFFFFFFFu;
+    newVertex.assign(numVertices, invalid);
+    unsigned int next = 0;
+    for (auto& index : indices)
+    {
+        if (newVertex[index] == invalid)
+        {
+            newVertex[index] = next++;
+        }
+        index = newVertex[index];
+    }
+    for (auto& v : newVertex)
+    {
+        if (v == invalid)
+        {
+            v = next++;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+MeshOptimizer::Statistics MeshOptimizer::GetStatistics(
+    unsigned int numVertices, std::vector<unsigned int> const& indices,
+    unsigned int cacheSize)
+{
+    Statistics statistics;
+    statistics.acmr = 0.0f;
+    statistics.atvr = 0.0f;
+
+    unsigned int const numTriangles =
+        static_cast<unsigned int>(indices.size()/3);
+    if (numTriangles == 0)
+    {
+        return statistics;
+    }
+
+    std::vector<unsigned int> timeStamps(numVertices, 0);
+    unsigned int time = cacheSize;
+    unsigned int misses = CountMisses(indices, 0, numTriangles, cacheSize,
+        timeStamps, time);
+
+    std::vector<char> referenced(numVertices, 0);
+    unsigned int numReferenced = 0;
+    for (auto index : indices)
+    {
+        if (!referenced[index])
+        {
+            referenced[index] = 1;
+            ++numReferenced;
+        }
+    }
+
+    statistics.acmr = static_cast<float>(misses)/numTriangles;
+    statistics.atvr = static_cast<float>(misses)/numReferenced;
+    return statistics;
+}
+//----------------------------------------------------------------------------
+void MeshOptimizer::GetClusters(unsigned int numVertices,
+    std::vector<unsigned int> const& indices, unsigned int cacheSize,
+    float threshold, std::vector<unsigned int>& clusters)
+{
+    unsigned int const numTriangles =
+        static_cast<unsigned int>(indices.size()/3);
+    std::vector<unsigned int> timeStamps(numVertices, 0);
+    unsigned int time = cacheSize;
+
+    // A hard boundary is a triangle all of whose vertices miss the cache,
+    // so the order does not depend on the triangles that precede it.
+    std::vector<unsigned int> hard;
+    for (unsigned int t = 0; t < numTriangles; ++t)
+    {
+        if (CountMisses(indices, t, t + 1, cacheSize, timeStamps, time) == 3
+            || t == 0)
+        {
+            hard.push_back(t);
+        }
+    }
+    hard.push_back(numTriangles);
+
+    // Split the ranges between hard boundaries where the ACMR of the range
+    // so far, starting with an empty cache, is within the threshold of the
+    // ACMR of the whole range.
+    clusters.clear();
+    for (size_t h = 0; h + 1 < hard.size(); ++h)
+    {
+        unsigned int const tmin = hard[h], tmax = hard[h + 1];
+        time += cacheSize;
+        float acmr = static_cast<float>(CountMisses(indices, tmin, tmax,
+            cacheSize, timeStamps, time))/(tmax - tmin);
+
+        unsigned int first = tmin, misses = 0;
+        time += cacheSize;
+        for (unsigned int t = tmin; t < tmax; ++t)
+        {
+            misses += CountMisses(indices, t, t + 1, cacheSize, timeStamps,
+                time);
+            if (t + 1 < tmax
+                && misses <= threshold*acmr*(t + 1 - first))
+            {
+                clusters.push_back(first);
+                first = t + 1;
+                misses = 0;
+                time += cacheSize;
+            }
+        }
+        clusters.push_back(first);
+    }
+    clusters.push_back(numTriangles);
+}
+//----------------------------------------------------------------------------
+unsigned int MeshOptimizer::CountMisses(
+    std::vector<unsigned int> const& indices, unsigned int tmin,
+    unsigned int tmax, unsigned int cacheSize,
+    std::vector<unsigned int>& timeStamps, unsigned int& time)
+{
+    // A vertex enters the FIFO cache at the time of its miss and leaves it
+    // after cacheSize further misses.  Adding cacheSize to the time empties
+    // the cache.
+    unsigned int misses = 0;
+    for (unsigned int i = 3*tmin; i < 3*tmax; ++i)
+    {
+        unsigned int v = indices[i];
+        if (time - timeStamps[v] >= cacheSize)
+        {
+            timeStamps[v] = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+//----------------------------------------------------------------------------
+void MeshOptimizer::GetAdjacency(unsigned int numVertices,
+    std::vector<unsigned int> const& indices,
+    std::vector<unsigned int>& offsets, std::vector<unsigned int>& numLive,
+    std::vector<unsigned int>& adjacent)
+{
+    numLive.assign(numVertices, 0);
+    for (auto index : indices)
+    {
+        ++numLive[index];
+    }
+
+    offsets.resize(numVertices + 1);
+    offsets[0] = 0;
+    for (unsigned int v = 0; v < numVertices; ++v)
+    {
+        offsets[v + 1] = offsets[v] + numLive[v];
+    }
+
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    adjacent.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        adjacent[fill[indices[i]]++] = static_cast<unsigned int>(i/3);
+    }
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,40 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/24)
+
+#include "GTEnginePCH.h"
+#include "GteMorphologyFilter.h"
+using namespace gte;
+
+//----------------------------------------------------------------------------
+void MorphologyFilter::GetChords(int sqrRadius, std::vector<int>& chordIndex,
+    std::vector<int>& chordRadius)
+{
+    // The half-length of the chord at height dy is the largest integer w
+    // with w^2 + dy^2 <= sqrRadius.  It is nonincreasing in dy.
+    int radius = 0;
+    while ((radius + 1) * (radius + 1) <= sqrRadius)
+    {
+        ++radius;
+    }
+
+    chordIndex.resize(radius + 1);
+    chordRadius.clear();
+    int w = radius;
+    for (int dy = 0; dy <= radius; ++dy)
+    {
+        while (w * w + dy * dy > sqrRadius)
+        {
+            --w;
+        }
+        if (chordRadius.empty() || chordRadius.back() != w)
+        {
+            chordRadius.push_back(w);
+        }
+        chordIndex[dy] = static_cast<int>(chordRadius.size()) - 1;
+    }
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,334 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/15)
+
+#include "GTEnginePCH.h"
+#include "GteProfiler.h"
+#include "GteLockFreeQueue.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+using namespace gte;
+
+//----------------------------------------------------------------------------
+// Support for the events.
+//----------------------------------------------------------------------------
+class Profiler::Event
+{
+public:
+    Event()
+        :
+        name(nullptr),
+        begin(0),
+        end(0),
+        sequence(0),
+        thread(0),
+        depth(0)
+    {
+    }
+
+    // The sequence number orders the zones of a thread by their start,
+    // which the ticks cannot do for zones that start at the same tick.
+    char const* name;
+    int64_t begin, end;
+    unsigned int sequence;
+    int thread, depth;
+};
+
+class Profiler::ThreadBuffer
+{
+public:
+    ThreadBuffer(std::thread::id inOwner, int inThread,
+        unsigned int maxEvents)
+        :
+        owner(inOwner),
+        thread(inThread),
+        depth(0),
+        sequence(0),
+        events(maxEvents),
+        next(nullptr)
+    {
+    }
+
+    // The owner pushes and the thread that holds msMutex pops.  The depth
+    // and sequence are accessed only by the owner.
+    std::thread::id const owner;
+    int const thread;
+    int depth;
+    unsigned int sequence;
+    LockFreeQueue<Event, true> events;
+    ThreadBuffer* next;
+};
+
+//----------------------------------------------------------------------------
+// Profiler::Zone
+//----------------------------------------------------------------------------
+Profiler::Zone::~Zone()
+{
+    Event event;
+    event.name = mName;
+    event.begin = mBegin;
+    event.end = msTimer.GetTicks();
+    event.sequence = mSequence;
+    event.thread = mBuffer->thread;
+    event.depth = mDepth;
+    --mBuffer->depth;
+
+    if (mBuffer->events.Push(event))
+    {
+        if (2 * mBuffer->events.GetNumElements() >=
+            mBuffer->events.GetMaxNumElements())
+        {
+            CollectThread(mBuffer);
+        }
+    }
+    else
+    {
+        ++msNumDropped;
+    }
+}
+//----------------------------------------------------------------------------
+Profiler::Zone::Zone(char const* name)
+    :
+    mBuffer(GetThreadBuffer()),
+    mName(name)
+{
+    mSequence = mBuffer->sequence++;
+    mDepth = mBuffer->depth++;
+    mBegin = msTimer.GetTicks();
+}
+//----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+// Profiler
+//----------------------------------------------------------------------------
+void Profiler::Collect()
+{
+    ThreadBuffer* buffer = msThreadBuffers.load(std::memory_order_acquire);
+    for (; buffer; buffer = buffer->next)
+    {
+        CollectThread(buffer);
+    }
+}
+//----------------------------------------------------------------------------
+void Profiler::Reset()
+{
+    Collect();
+    std::lock_guard<std::mutex> lock(msMutex);
+    msEvents.clear();
+    msNumDropped = 0;
+}
+//----------------------------------------------------------------------------
+void Profiler::GetStatistics(std::vector<Statistics>& statistics)
+{
+    Collect();
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> lock(msMutex);
+        events = msEvents;
+    }
+
+    // Order the events of each thread by the start of their zones.  A zone
+    // is then preceded by its parent and its earlier siblings.
+    std::sort(events.begin(), events.end(),
+        [](Event const& e0, Event const& e1)
+        {
+            if (e0.thread != e1.thread)
+            {
+                return e0.thread < e1.thread;
+            }
+            return e0.sequence < e1.sequence;
+        });
+
+    struct Node
+    {
+        std::string path;
+        char const* name;
+        double inclusive, children;
+        int depth;
+    };
+
+    struct Accumulator
+    {
+        std::string name;
+        double exclusive;
+        std::vector<double> calls;
+    };
+
+    std::map<std::string, Accumulator> accumulators;
+    std::vector<Node> stack;
+    auto closeZone = [&accumulators, &stack]()
+    {
+        Node const& node = stack.back();
+        Accumulator& acc = accumulators[node.path];
+        acc.name = node.name;
+        acc.exclusive += node.inclusive - node.children;
+        acc.calls.push_back(node.inclusive);
+        stack.pop_back();
+    };
+
+    int thread = -1;
+    for (auto const& event : events)
+    {
+        if (event.thread != thread)
+        {
+            while (stack.size() > 0)
+            {
+                closeZone();
+            }
+            thread = event.thread;
+        }
+
+        // Close the zones that are not ancestors of this one.
+        while (stack.size() > 0 && stack.back().depth >= event.depth)
+        {
+            closeZone();
+        }
+
+        Node node;
+        node.path = (stack.size() > 0 ? stack.back().path + "/" : "") +
+            event.name;
+        node.name = event.name;
+        node.inclusive = msTimer.GetSeconds(event.end - event.begin);
+        node.children = 0.0;
+        node.depth = event.depth;
+        if (stack.size() > 0)
+        {
+            stack.back().children += node.inclusive;
+        }
+        stack.push_back(node);
+    }
+    while (stack.size() > 0)
+    {
+        closeZone();
+    }
+
+    statistics.clear();
+    statistics.reserve(accumulators.size());
+    for (auto& element : accumulators)
+    {
+        Accumulator& acc = element.second;
+        std::vector<double>& calls = acc.calls;
+        std::sort(calls.begin(), calls.end());
+        size_t const last = calls.size() - 1;
+
+        Statistics stat;
+        stat.path = element.first;
+        stat.name = acc.name;
+        stat.depth = static_cast<int>(
+            std::count(stat.path.begin(), stat.path.end(), '/'));
+        stat.calls = static_cast<unsigned int>(calls.size());
+        stat.inclusive = 0.0;
+        for (auto seconds : calls)
+        {
+            stat.inclusive += seconds;
+        }
+        stat.exclusive = acc.exclusive;
+        stat.minimum = calls[0];
+        stat.median = calls[last / 2];
+        stat.percentile90 = calls[(last * 90) / 100];
+        stat.percentile99 = calls[(last * 99) / 100];
+        stat.maximum = calls[last];
+        statistics.push_back(stat);
+    }
+}
+//----------------------------------------------------------------------------
+bool Profiler::ExportChromeTrace(std::string const& filename)
+{
+    std::ofstream output(filename);
+    if (!output)
+    {
+        return false;
+    }
+
+    Collect();
+    std::lock_guard<std::mutex> lock(msMutex);
+
+    // The times of the trace events are in microseconds.
+    output << std::fixed << std::setprecision(3);
+    output << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (auto const& event : msEvents)
+    {
+        if (!first)
+        {
+            output << ",\n";
+        }
+        first = false;
+
+        output << "{\"name\":\"";
+        for (char const* c = event.name; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                output << '\\';
+            }
+            output << *c;
+        }
+        output << "\",\"cat\":\"gte\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+            << event.thread
+            << ",\"ts\":" << 1e6 * msTimer.GetSeconds(event.begin)
+            << ",\"dur\":"
+            << 1e6 * msTimer.GetSeconds(event.end - event.begin)
+            << "}";
+    }
+    output << "\n]}\n";
+    return static_cast<bool>(output);
+}
+//----------------------------------------------------------------------------
+void Profiler::SetMaxThreadEvents(unsigned int maxThreadEvents)
+{
+    msMaxThreadEvents = maxThreadEvents;
+}
+//----------------------------------------------------------------------------
+unsigned int Profiler::GetNumDropped()
+{
+    return msNumDropped;
+}
+//----------------------------------------------------------------------------
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer()
+{
+    std::thread::id const id = std::this_thread::get_id();
+    ThreadBuffer* buffer = msThreadBuffers.load(std::memory_order_acquire);
+    for (; buffer; buffer = buffer->next)
+    {
+        if (buffer->owner == id)
+        {
+            return buffer;
+        }
+    }
+
+    // This is the first zone of the thread.  Only this thread can add a
+    // buffer for its identifier, so the list has no duplicates.
+    buffer = new ThreadBuffer(id, msNumThreads++, msMaxThreadEvents);
+    buffer->next = msThreadBuffers.load(std::memory_order_relaxed);
+    while (!msThreadBuffers.compare_exchange_weak(buffer->next, buffer,
+        std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return buffer;
+}
+//----------------------------------------------------------------------------
+void Profiler::CollectThread(ThreadBuffer* buffer)
+{
+    // The mutex ensures that each ring buffer has a single consumer.
+    std::lock_guard<std::mutex> lock(msMutex);
+    Event event;
+    while (buffer->events.Pop(event))
+    {
+        msEvents.push_back(event);
+    }
+}
+//----------------------------------------------------------------------------
+
+Timer Profiler::msTimer;
+std::atomic<Profiler::ThreadBuffer*> Profiler::msThreadBuffers(nullptr);
+std::atomic<unsigned int> Profiler::msMaxThreadEvents(16384);
+std::atomic<unsigned int> Profiler::msNumDropped(0);
+std::atomic<int> Profiler::msNumThreads(0);
+std::mutex Profiler::msMutex;
+std::vector<Profiler::Event> Profiler::msEvents;
@@ -0,0 +1,281 @@
+// Geometric Tools LLC, Redmond WA 98052
+// Copyright (c) 1998-2014
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
+// File Version: 1.5.0 (2014/11/05)
+
+#include "GTEnginePCH.h"
+#include "GteThreadPool.h"
+#include <chrono>
+using namespace gte;
+
+//----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStop = true;
+    }
+    mWakeUp.notify_all();
+
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+//----------------------------------------------------------------------------
+ThreadPool::ThreadPool(unsigned int numThreads)
+    :
+    mNumQueued(0),
+    mNextQueue(0),
+    mStop(false)
+{
+    // The pool always has a queue, even when it has no workers, so that
+    // tasks can be queued and executed by the waiting thread.
+    unsigned int const numWorkers = (numThreads > 1 ? numThreads - 1 : 0);
+    unsigned int const numQueues = (numWorkers > 0 ? numWorkers : 1);
+    mQueues.resize(numQueues);
+    for (auto& queue : mQueues)
+    {
+        queue.reset(new Queue());
+    }
+
+    // The workers wait for mSleepMutex before accessing mWorkers, so the
+    // array is complete when they query it in GetWorkerIndex.
+    std::lock_guard<std::mutex> lock(mSleepMutex);
+    mWorkers.resize(numWorkers);
+    for (unsigned int i = 0; i < numWorkers; ++i)
+    {
+        mWorkers[i] = std::thread([this]() { WorkerLoop(); });
+    }
+}
+//----------------------------------------------------------------------------
+ThreadPool& ThreadPool::GetDefault()
+{
+    static std::once_flag sCreated;
+    static std::unique_ptr<ThreadPool> sPool;
+    std::call_once(sCreated, []()
+    {
+        unsigned int numThreads = std::thread::hardware_concurrency();
+        sPool.reset(new ThreadPool(numThreads > 0 ? numThreads : 1));
+    });
+    return *sPool;
+}
+//----------------------------------------------------------------------------
+void ThreadPool::ParallelFor(int numLines, int numThreads,
+    std::function<void(int, int)> const& process)
+{
+    numThreads = std::min(numThreads, static_cast<int>(GetNumThreads()));
+    int const numRanges = GetNumRanges(numLines, numThreads);
+    if (numRanges <= 1)
+    {
+        if (numLines > 0)
+        {
+            process(0, numLines - 1);
+        }
+        return;
+    }
+
+    std::atomic<int> next(0);
+    auto runner = [&]()
+    {
+        int range, lmin, lmax;
+        while ((range = next++) < numRanges)
+        {
+            GetRange(range, numRanges, numLines, lmin, lmax);
+            process(lmin, lmax);
+        }
+    };
+
+    // The calling thread is one of the runners.
+    TaskGroup group(*this);
+    for (int t = 1; t < numThreads; ++t)
+    {
+        group.Run(runner);
+    }
+    runner();
+    group.Wait();
+}
+//----------------------------------------------------------------------------
+int ThreadPool::GetNumRanges(int numLines, int numThreads)
+{
+    if (numLines <= 0)
+    {
+        return 0;
+    }
+    if (numThreads <= 1)
+    {
+        return 1;
+    }
+
+    // Use several ranges per thread so that threads finishing early can
+    // claim the work of threads that are delayed.
+    return std::min(numLines, 4 * numThreads);
+}
+//----------------------------------------------------------------------------
+void ThreadPool::GetRange(int range, int numRanges, int numLines, int& lmin,
+    int& lmax)
+{
+    lmin = static_cast<int>(
+        static_cast<int64_t>(range) * numLines / numRanges);
+    lmax = static_cast<int>(
+        static_cast<int64_t>(range + 1) * numLines / numRanges) - 1;
+}
+//----------------------------------------------------------------------------
+void ThreadPool::Push(Task const& task)
+{
+    int index = GetWorkerIndex();
+    if (index < 0)
+    {
+        index = static_cast<int>(mNextQueue++ % mQueues.size());
+    }
+
+    Queue& queue = *mQueues[index];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+    ++mNumQueued;
+
+    // Lock the mutex so that the notification cannot occur between a
+    // worker's test of mNumQueued and its wait.
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+    }
+    mWakeUp.notify_one();
+}
+//----------------------------------------------------------------------------
+bool ThreadPool::RunOne()
+{
+    int const numQueues = static_cast<int>(mQueues.size());
+    int const index = GetWorkerIndex();
+    Task task;
+    bool found = false;
+
+    // A worker takes the most recent task of its own queue, which is likely
+    // to use data that is still in cache.
+    if (index >= 0)
+    {
+        Queue& queue = *mQueues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    // Steal the oldest task of another queue.
+    int const start = (index >= 0 ? index + 1 : 0);
+    for (int i = 0; i < numQueues && !found; ++i)
+    {
+        Queue& queue = *mQueues[(start + i) % numQueues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        --mNumQueued;
+        task();
+    }
+    return found;
+}
+//----------------------------------------------------------------------------
+int ThreadPool::GetWorkerIndex() const
+{
+    std::thread::id const id = std::this_thread::get_id();
+    int const numWorkers = static_cast<int>(mWorkers.size());
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        if (mWorkers[i].get_id() == id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+//----------------------------------------------------------------------------
+void ThreadPool::WorkerLoop()
+{
+    // Wait for the constructor to finish launching the workers.
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+    }
+
+    for (;;)
+    {
+        if (RunOne())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeUp.wait(lock, [this]()
+        {
+            return mStop || mNumQueued.load() > 0;
+        });
+        if (mStop && mNumQueued.load() == 0)
+        {
+            break;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+ThreadPool::TaskGroup::~TaskGroup()
+{
+    Wait();
+}
+//----------------------------------------------------------------------------
+ThreadPool::TaskGroup::TaskGroup(ThreadPool& pool)
+    :
+    mPool(pool),
+    mNumPending(0)
+{
+}
+//----------------------------------------------------------------------------
+void ThreadPool::TaskGroup::Run(std::function<void()> const& task)
+{
+    ++mNumPending;
+    mPool.Push([this, task]()
+    {
+        task();
+
+        // The decrement occurs while the mutex is locked, and Wait() locks
+        // the mutex before it returns, so the group is not destroyed while
+        // this function accesses it.
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mNumPending == 0)
+        {
+            mFinished.notify_all();
+        }
+    });
+}
+//----------------------------------------------------------------------------
+void ThreadPool::TaskGroup::Wait()
+{
+    while (mNumPending.load() > 0)
+    {
+        // Execute queued tasks while waiting.  When there are none, the
+        // tasks of the group are running on other threads.  The timeout
+        // allows this thread to help with tasks those tasks create.
+        if (!mPool.RunOne())
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mFinished.wait_for(lock, std::chrono::milliseconds(1), [this]()
+            {
+                return mNumPending.load() == 0;
+            });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+}
+//----------------------------------------------------------------------------
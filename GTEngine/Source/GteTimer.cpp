@@ -7,9 +7,17 @@
 
 #include "GTEnginePCH.h"
 #include "GteTimer.h"
+#if defined(WIN32)
 #include <Windows.h>
+#else
+#include <chrono>
+#endif
 using namespace gte;
 
+// On Windows, the ticks are those of the performance counter.  On other
+// platforms, they are those of std::chrono::steady_clock, which is also
+// monotonic and typically has nanosecond resolution.
+
 //----------------------------------------------------------------------------
 Timer::Timer()
     :
@@ -17,19 +25,32 @@ Timer::Timer()
     mInitialTicks(0),
     mInvFrequency(0.0)
 {
+#if defined(WIN32)
     LARGE_INTEGER frequency = { 1 }, counter = { 0 };
     QueryPerformanceFrequency(&frequency);
     QueryPerformanceCounter(&counter);
     mFrequency = static_cast<int64_t>(frequency.QuadPart);
     mInitialTicks = static_cast<int64_t>(counter.QuadPart);
+#else
+    typedef std::chrono::steady_clock::period Period;
+    mFrequency = static_cast<int64_t>(Period::den / Period::num);
+    mInitialTicks = static_cast<int64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
     mInvFrequency = 1.0/static_cast<double>(mFrequency);
 }
 //----------------------------------------------------------------------------
 int64_t Timer::GetTicks()
 {
+#if defined(WIN32)
     LARGE_INTEGER counter = { 0 };
     QueryPerformanceCounter(&counter);
     return static_cast<int64_t>(counter.QuadPart) - mInitialTicks;
+#else
+    return static_cast<int64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count())
+        - mInitialTicks;
+#endif
 }
 //----------------------------------------------------------------------------
 double Timer::GetSeconds()
@@ -49,8 +70,13 @@ int64_t Timer::GetTicks(double seconds) const
 //----------------------------------------------------------------------------
 void Timer::Reset()
 {
+#if defined(WIN32)
     LARGE_INTEGER counter = { 0 };
     QueryPerformanceCounter(&counter);
     mInitialTicks = static_cast<int64_t>(counter.QuadPart);
+#else
+    mInitialTicks = static_cast<int64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
 }
 //----------------------------------------------------------------------------
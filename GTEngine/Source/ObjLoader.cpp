@@ -4,17 +4,184 @@
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
 //
-// File Version: 5.1.0 (2010/03/30)
+// File Version: 5.1.1 (2014/11/19)
 
 #include "ObjLoader.h"
+#include "GteMemoryMappedFile.h"
+#include "GteThreadPool.h"
+#include <algorithm>
 #include <cassert>
-#include <fstream>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#if defined(WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
 
 // Disable Microsoft warning about unsafe functions (security).
 #pragma warning(disable:4996)
 
+// The cache is written and read by the same machine, so the numbers are
+// stored in native byte order.  The header is followed by the name of the
+// material library, the vertex arrays and the groups.
+static const char gsCacheMagic[8] = { 'G','T','E','O','B','J','0','2' };
+static const size_t gsMinChunkSize = 65536;
+
+//----------------------------------------------------------------------------
+static bool GetFileStatus (const string& name, uint64_t& size, int64_t& time)
+{
+    // The size is 64-bit on all platforms, because the 32-bit st_size of
+    // the Microsoft stat cannot represent files larger than 2 GB.  The
+    // modification time is in the finest units the platform provides
+    // (100 nanoseconds on Windows, nanoseconds otherwise), so that a file
+    // rewritten within a second of its cache being saved is not mistaken
+    // for the cached one.
+#if defined(WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA status;
+    if (!GetFileAttributesExA(name.c_str(), GetFileExInfoStandard, &status))
+    {
+        return false;
+    }
+    size = ((uint64_t)status.nFileSizeHigh << 32) | status.nFileSizeLow;
+    time = (int64_t)(((uint64_t)status.ftLastWriteTime.dwHighDateTime << 32)
+        | status.ftLastWriteTime.dwLowDateTime);
+#else
+    struct stat status;
+    if (stat(name.c_str(), &status) != 0)
+    {
+        return false;
+    }
+#if defined(__APPLE__)
+    const struct timespec& modified = status.st_mtimespec;
+#else
+    const struct timespec& modified = status.st_mtim;
+#endif
+    size = (uint64_t)status.st_size;
+    time = (int64_t)modified.tv_sec*1000000000 + (int64_t)modified.tv_nsec;
+#endif
+    return true;
+}
+//----------------------------------------------------------------------------
+static inline bool IsSpace (char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+//----------------------------------------------------------------------------
+static inline bool IsDigit (char c)
+{
+    return '0' <= c && c <= '9';
+}
+//----------------------------------------------------------------------------
+static inline const char* SkipSpaces (const char* text, const char* end)
+{
+    while (text < end && IsSpace(*text))
+    {
+        ++text;
+    }
+    return text;
+}
+//----------------------------------------------------------------------------
+static inline const char* SkipToken (const char* text, const char* end)
+{
+    while (text < end && !IsSpace(*text))
+    {
+        ++text;
+    }
+    return text;
+}
+//----------------------------------------------------------------------------
+static inline bool IsKeyword (const char* token, const char* tokenEnd,
+    const char* keyword)
+{
+    size_t length = strlen(keyword);
+    return (size_t)(tokenEnd - token) == length
+        && memcmp(token, keyword, length) == 0;
+}
+//----------------------------------------------------------------------------
+static string GetLine (const char* line, const char* end)
+{
+    const char* lineEnd = line;
+    while (lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r')
+    {
+        ++lineEnd;
+    }
+    return string(line, lineEnd);
+}
+//----------------------------------------------------------------------------
+template <typename T>
+static void WriteCache (vector<char>& buffer, const T* data, size_t count)
+{
+    const char* bytes = (const char*)data;
+    buffer.insert(buffer.end(), bytes, bytes + count*sizeof(T));
+}
+//----------------------------------------------------------------------------
+template <typename T>
+static void WriteCache (vector<char>& buffer, const vector<T>& elements)
+{
+    uint64_t numElements = (uint64_t)elements.size();
+    WriteCache(buffer, &numElements, 1);
+    if (numElements > 0)
+    {
+        WriteCache(buffer, &elements[0], elements.size());
+    }
+}
+//----------------------------------------------------------------------------
+static void WriteCache (vector<char>& buffer, const string& text)
+{
+    uint64_t length = (uint64_t)text.length();
+    WriteCache(buffer, &length, 1);
+    WriteCache(buffer, text.c_str(), text.length());
+}
+//----------------------------------------------------------------------------
+template <typename T>
+static bool ReadCache (const char*& current, const char* end, T* data,
+    size_t count)
+{
+    if ((size_t)(end - current)/sizeof(T) < count)
+    {
+        return false;
+    }
+    memcpy(data, current, count*sizeof(T));
+    current += count*sizeof(T);
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename T>
+static bool ReadCache (const char*& current, const char* end,
+    vector<T>& elements)
+{
+    uint64_t numElements;
+    if (!ReadCache(current, end, &numElements, 1)
+    ||  numElements > (uint64_t)(end - current)/sizeof(T))
+    {
+        return false;
+    }
+    elements.resize((size_t)numElements);
+    return numElements == 0
+        || ReadCache(current, end, &elements[0], elements.size());
+}
+//----------------------------------------------------------------------------
+static bool ReadCache (const char*& current, const char* end, string& text)
+{
+    uint64_t length;
+    if (!ReadCache(current, end, &length, 1)
+    ||  length > (uint64_t)(end - current))
+    {
+        return false;
+    }
+    text.assign(current, (size_t)length);
+    current += (size_t)length;
+    return true;
+}
 //----------------------------------------------------------------------------
-ObjLoader::ObjLoader (const string& path, const string& filename)
+
+//----------------------------------------------------------------------------
+ObjLoader::ObjLoader (const string& path, const string& filename,
+    unsigned int options)
     :
     mCode(EC_SUCCESSFUL),
     mCurrentGroup(-1),
@@ -24,329 +191,721 @@ ObjLoader::ObjLoader (const string& path, const string& filename)
     mCurrentMtl(-1),
     mCurrentMesh(-1)
 {
-    mLogFile = fopen("ObjLogFile.txt", "wt");
-    if (!mLogFile)
+    FILE* logFile = 0;
+    if (options & OPTION_LOG)
     {
-        assert(false);
-        mCode = EC_LOGFILE_OPEN_FAILED;
-        return;
+        logFile = fopen("ObjLogFile.txt", "wt");
+        if (!logFile)
+        {
+            assert(false);
+            mCode = EC_LOGFILE_OPEN_FAILED;
+            return;
+        }
     }
 
     string filePath = path + filename;
-    ifstream inFile(filePath.c_str());
-    if (!inFile)
+    string errorLine;
+    uint64_t fileSize;
+    int64_t fileTime;
+    if (!GetFileStatus(filePath, fileSize, fileTime))
     {
-        assert(false);
         mCode = EC_FILE_OPEN_FAILED;
-        fprintf(mLogFile, "%s: %s\n", msCodeString[mCode], filePath.c_str());
-        fclose(mLogFile);
-        return;
+        errorLine = filePath;
+    }
+    else
+    {
+        string cachePath = filePath + ".cache";
+        if (!(options & OPTION_CACHE)
+        ||  !LoadCache(path, cachePath, fileSize, fileTime))
+        {
+            if (Parse(path, filePath, (size_t)fileSize, errorLine)
+            &&  (options & OPTION_CACHE))
+            {
+                SaveCache(cachePath, fileSize, fileTime);
+            }
+        }
     }
 
-    string line;
-    vector<string> tokens;
-
-    while (!inFile.eof())
+    if (logFile)
+    {
+        if (mCode != EC_SUCCESSFUL)
+        {
+            fprintf(logFile, "%s: %s\n", msCodeString[mCode],
+                errorLine.c_str());
+        }
+        else
+        {
+            fprintf(logFile, "%s\n", msCodeString[EC_SUCCESSFUL]);
+        }
+        fclose(logFile);
+    }
+    assert(mCode == EC_SUCCESSFUL);
+}
+//----------------------------------------------------------------------------
+ObjLoader::~ObjLoader ()
+{
+}
+//----------------------------------------------------------------------------
+ObjLoader::Chunk::Chunk ()
+    :
+    Code(EC_SUCCESSFUL),
+    ErrorLine(0)
+{
+}
+//----------------------------------------------------------------------------
+bool ObjLoader::Parse (const string& path, const string& filePath,
+    size_t fileSize, string& errorLine)
+{
+    if (fileSize == 0)
     {
-        getline(inFile, line);
+        // The mapping of an empty file fails, but the file is valid.
+        return true;
+    }
 
-        // Skip blank lines.
-        if (line == "") { continue; }
+    gte::MemoryMappedFile file;
+    if (!file.Open(filePath, gte::MemoryMappedFile::READ_ONLY))
+    {
+        mCode = EC_FILE_OPEN_FAILED;
+        errorLine = filePath;
+        return false;
+    }
+    const char* data = file.GetData();
+    const char* dataEnd = data + file.GetSize();
 
-        // Skip comments.
-        if (line[0] == '#') { continue; }
+    // Split the file into chunks that start at the beginnings of lines.
+    // There are more chunks than threads so that the threads are balanced
+    // when the chunks take different times to parse.
+    gte::ThreadPool& pool = gte::ThreadPool::GetDefault();
+    int numThreads = (int)pool.GetNumThreads();
+    size_t maxChunks = 4*(size_t)numThreads;
+    int numChunks = (int)min(file.GetSize()/gsMinChunkSize + 1, maxChunks);
+    vector<const char*> bounds(numChunks + 1);
+    bounds[0] = data;
+    for (int i = 1; i < numChunks; ++i)
+    {
+        const char* bound = max(bounds[i - 1],
+            data + file.GetSize()*i/numChunks);
+        while (bound < dataEnd && bound > data && bound[-1] != '\n')
+        {
+            ++bound;
+        }
+        bounds[i] = bound;
+    }
+    bounds[numChunks] = dataEnd;
 
-        GetTokens(line, tokens);
-        if (tokens.size() == 0)
+    vector<Chunk> chunks(numChunks);
+    pool.ParallelFor(numChunks, numThreads,
+        [&chunks, &bounds](int cmin, int cmax)
         {
-            assert(false);
-            mCode = EC_NO_TOKENS;
-            break;
+            for (int c = cmin; c <= cmax; ++c)
+            {
+                ParseChunk(bounds[c], bounds[c + 1], chunks[c]);
+            }
         }
+    );
 
-        // mtllib
-        if (GetMaterialLibrary(path, tokens)) { continue; }
-        if (mCode != EC_SUCCESSFUL) { break; }
+    // The mapping stays open while merging, because the commands and the
+    // error lines point into it.
+    return Merge(path, chunks, dataEnd, errorLine);
+}
+//----------------------------------------------------------------------------
+void ObjLoader::ParseChunk (const char* begin, const char* end,
+    Chunk& chunk)
+{
+    for (const char* line = begin; line < end; /**/)
+    {
+        const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+        if (!lineEnd)
+        {
+            lineEnd = end;
+        }
 
-        // g default
-        if (GetDefaultGroup(tokens)) { continue; }
-        if (mCode != EC_SUCCESSFUL) { break; }
+        chunk.Code = ParseLine(line, lineEnd, chunk);
+        if (chunk.Code != EC_SUCCESSFUL)
+        {
+            chunk.ErrorLine = line;
+            return;
+        }
 
-        // v x y z
-        if (GetPosition(tokens)) { continue; }
-        if (mCode != EC_SUCCESSFUL) { break; }
+        line = lineEnd + 1;
+    }
+}
+//----------------------------------------------------------------------------
+ObjLoader::ErrorCode ObjLoader::ParseLine (const char* line,
+    const char* end, Chunk& chunk)
+{
+    const char* token = SkipSpaces(line, end);
 
-        // vt x y
-        if (GetTCoord(tokens)) { continue; }
-        if (mCode != EC_SUCCESSFUL) { break; }
+    // Skip blank lines and comments.
+    if (token == end || *token == '#')
+    {
+        return EC_SUCCESSFUL;
+    }
 
-        // vn x y z
-        if (GetNormal(tokens)) { continue; }
-        if (mCode != EC_SUCCESSFUL) { break; }
+    const char* tokenEnd = SkipToken(token, end);
+    const char* text = tokenEnd;
+    ErrorCode code;
 
-        // Ignore smoothing groups for now (syntax:  's number').
-        if (tokens[0] == "s") { continue; }
+    // v x y z
+    if (IsKeyword(token, tokenEnd, "v"))
+    {
+        Float3 pos;
+        code = ParseFloats(text, end, 3, &pos.x);
+        if (code == EC_SUCCESSFUL)
+        {
+            chunk.Positions.push_back(pos);
+        }
+        return code;
+    }
 
-        // g groupname
-        if (GetGroup(tokens)) { continue; }
-        if (mCode != EC_SUCCESSFUL) { break; }
+    // f vertexList
+    if (IsKeyword(token, tokenEnd, "f"))
+    {
+        int numVertices = 0;
+        for (text = SkipSpaces(text, end); text < end; ++numVertices)
+        {
+            code = ParseVertex(text, end, chunk);
+            if (code != EC_SUCCESSFUL)
+            {
+                return code;
+            }
+            text = SkipSpaces(text, end);
+        }
+        if (numVertices < 3)
+        {
+            // A face must have at least three vertices.
+            return EC_TOO_FEW_TOKENS;
+        }
+        chunk.FaceCounts.push_back(numVertices);
+        return EC_SUCCESSFUL;
+    }
 
-        // usemtl mtlname
-        if (GetMaterialAndMesh(tokens)) { continue; }
-        if (mCode != EC_SUCCESSFUL) { break; }
+    // vt x y
+    if (IsKeyword(token, tokenEnd, "vt"))
+    {
+        // TODO.  Need to handle 3D texture coordinates.
+        Float2 tcd;
+        code = ParseFloats(text, end, 2, &tcd.x);
+        if (code == EC_SUCCESSFUL)
+        {
+            chunk.TCoords.push_back(tcd);
+        }
+        return code;
+    }
 
-        // f vertexList
-        if (GetFace(tokens)) { continue; }
-        if (mCode != EC_SUCCESSFUL) { break; }
+    // vn x y z
+    if (IsKeyword(token, tokenEnd, "vn"))
+    {
+        Float3 nor;
+        code = ParseFloats(text, end, 3, &nor.x);
+        if (code == EC_SUCCESSFUL)
+        {
+            chunk.Normals.push_back(nor);
+        }
+        return code;
+    }
 
-        assert(false);
-        mCode = EC_UNEXPECTED_TOKEN;
-        break;
+    // Ignore smoothing groups for now (syntax:  's number').
+    if (IsKeyword(token, tokenEnd, "s"))
+    {
+        return EC_SUCCESSFUL;
     }
 
-    if (mCode != EC_SUCCESSFUL)
+    // mtllib filename, g default, g groupname, usemtl mtlname
+    Command command;
+    if (IsKeyword(token, tokenEnd, "mtllib"))
+    {
+        command.CommandType = Command::MTLLIB;
+    }
+    else if (IsKeyword(token, tokenEnd, "g"))
+    {
+        command.CommandType = Command::GROUP;
+    }
+    else if (IsKeyword(token, tokenEnd, "usemtl"))
     {
-        fprintf(mLogFile, "%s: %s\n", msCodeString[mCode], line.c_str());
+        command.CommandType = Command::USEMTL;
     }
     else
     {
-        fprintf(mLogFile, "%s\n", msCodeString[EC_SUCCESSFUL]);
+        return EC_UNEXPECTED_TOKEN;
+    }
+
+    // The name of a group is the concatenation of its tokens.
+    int numNames = 0;
+    for (text = SkipSpaces(text, end); text < end; ++numNames)
+    {
+        tokenEnd = SkipToken(text, end);
+        command.Name.append(text, tokenEnd);
+        text = SkipSpaces(tokenEnd, end);
+    }
+    if (numNames == 0)
+    {
+        return EC_TOO_FEW_TOKENS;
+    }
+    if (numNames > 1 && command.CommandType != Command::GROUP)
+    {
+        return EC_TOO_MANY_TOKENS;
+    }
+    if (numNames == 1 && command.CommandType == Command::GROUP
+    &&  command.Name == "default")
+    {
+        command.CommandType = Command::DEFAULT_GROUP;
     }
-    fclose(mLogFile);
-    inFile.close();
+
+    command.Line = line;
+    command.NumPositions = (int)chunk.Positions.size();
+    command.NumTCoords = (int)chunk.TCoords.size();
+    command.NumNormals = (int)chunk.Normals.size();
+    command.NumFaces = (int)chunk.FaceCounts.size();
+    chunk.Commands.push_back(command);
+    return EC_SUCCESSFUL;
 }
 //----------------------------------------------------------------------------
-ObjLoader::~ObjLoader ()
+ObjLoader::ErrorCode ObjLoader::ParseFloats (const char*& text,
+    const char* end, int numValues, float* values)
 {
+    for (int i = 0; i < numValues; ++i)
+    {
+        text = SkipSpaces(text, end);
+        if (text == end)
+        {
+            return EC_TOO_FEW_TOKENS;
+        }
+        if (!ParseFloat(text, end, values[i]))
+        {
+            return EC_INVALID_NUMBER;
+        }
+    }
+    return SkipSpaces(text, end) == end ? EC_SUCCESSFUL : EC_TOO_MANY_TOKENS;
 }
 //----------------------------------------------------------------------------
-void ObjLoader::GetTokens (const string & line, vector<string>& tokens)
+bool ObjLoader::ParseFloat (const char*& text, const char* end,
+    float& value)
 {
-    tokens.clear();
-
-    string::size_type begin, end = 0;
-    string token;
+    // The decimal digits are accumulated in an integer.  When the integer
+    // is smaller than 2^53 and the power of ten is at most 10^22, both are
+    // exactly representable as doubles, so the single multiplication or
+    // division is correctly rounded and the result is that of strtod.
+    // Other numbers, including "nan" and "inf", are passed to strtod.
+    static const double power10[23] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+        1e22
+    };
+    static const uint64_t maxMantissa = ((uint64_t)1 << 53);
 
-    while ((begin = line.find_first_not_of(" \t", end)) != string::npos)
+    const char* current = text;
+    bool negative = false;
+    if (current < end && (*current == '-' || *current == '+'))
     {
-        end = line.find_first_of(" \t", begin);
-        token = line.substr(begin, end-begin);
-        tokens.push_back(token);
+        negative = (*current == '-');
+        ++current;
     }
-}
-//----------------------------------------------------------------------------
-bool ObjLoader::GetMaterialLibrary (const string& path,
-    const vector<string>& tokens)
-{
-    if (tokens[0] == "mtllib")
+
+    uint64_t mantissa = 0;
+    int exponent = 0, numDigits = 0;
+    bool exact = true;
+    for (/**/; current < end && IsDigit(*current); ++current, ++numDigits)
     {
-        if (tokens.size() == 1)
+        if (mantissa < maxMantissa)
         {
-            assert(false);
-            mCode = EC_TOO_FEW_TOKENS;
-            return false;
+            mantissa = 10*mantissa + (uint64_t)(*current - '0');
         }
-        if (tokens.size() > 2)
+        else
         {
-            assert(false);
-            mCode = EC_TOO_MANY_TOKENS;
-            return false;
+            exact = false;
         }
-
-        MtlLoader loader(path, tokens[1]);
-        if (loader.GetCode() != MtlLoader::EC_SUCCESSFUL)
+    }
+    if (current < end && *current == '.')
+    {
+        for (++current; current < end && IsDigit(*current);
+            ++current, ++numDigits)
         {
-            assert(false);
-            mCode = EC_FAILED_TO_LOAD_MATERIALS;
-            return false;
+            if (mantissa < maxMantissa)
+            {
+                mantissa = 10*mantissa + (uint64_t)(*current - '0');
+                --exponent;
+            }
+            else
+            {
+                exact = false;
+            }
         }
-
-        mMaterials = loader.GetMaterials();
-        return true;
     }
-    return false;
-}
-//----------------------------------------------------------------------------
-bool ObjLoader::GetDefaultGroup (const vector<string>& tokens)
-{
-    if (tokens[0] == "g")
+    if (numDigits > 0 && current < end && (*current == 'e' || *current == 'E'))
     {
-        if (tokens.size() == 1)
+        ++current;
+        bool negativeExponent = false;
+        if (current < end && (*current == '-' || *current == '+'))
         {
-            assert(false);
-            mCode = EC_TOO_FEW_TOKENS;
-            return false;
+            negativeExponent = (*current == '-');
+            ++current;
         }
-        if (tokens.size() > 2)
+        if (current == end || !IsDigit(*current))
         {
-            assert(false);
-            mCode = EC_TOO_MANY_TOKENS;
-            return false;
+            exact = false;
         }
-
-        if (tokens[1] == "default")
+        int e = 0;
+        for (/**/; current < end && IsDigit(*current); ++current)
         {
-            mCurrentPos = (int)mPositions.size();
-            mCurrentTcd = (int)mTCoords.size();
-            mCurrentNor = (int)mNormals.size();
-            return true;
+            if (e < 10000)
+            {
+                e = 10*e + (*current - '0');
+            }
         }
+        exponent += (negativeExponent ? -e : e);
     }
-    return false;
-}
-//----------------------------------------------------------------------------
-bool ObjLoader::GetPosition (const vector<string>& tokens)
-{
-    if (tokens[0] == "v")
+
+    if (exact && numDigits > 0 && mantissa < maxMantissa
+    &&  -22 <= exponent && exponent <= 22
+    &&  (current == end || IsSpace(*current)))
     {
-        if (tokens.size() < 4)
+        double number = (double)mantissa;
+        if (exponent < 0)
         {
-            assert(false);
-            mCode = EC_TOO_FEW_TOKENS;
-            return false;
+            number /= power10[-exponent];
         }
-        if (tokens.size() > 4)
+        else
         {
-            assert(false);
-            mCode = EC_TOO_MANY_TOKENS;
-            return false;
+            number *= power10[exponent];
         }
-
-        Float3 pos;
-        pos.x = (float)atof(tokens[1].c_str());
-        pos.y = (float)atof(tokens[2].c_str());
-        pos.z = (float)atof(tokens[3].c_str());
-        mPositions.push_back(pos);
+        value = (float)(negative ? -number : number);
+        text = current;
         return true;
     }
-    return false;
+
+    // The mapped file is not null-terminated, so strtod is applied to a
+    // copy of the token.
+    const char* tokenEnd = SkipToken(text, end);
+    string token(text, tokenEnd);
+    char* numberEnd = 0;
+    double number = strtod(token.c_str(), &numberEnd);
+    if (numberEnd != token.c_str() + token.length() || token.empty())
+    {
+        return false;
+    }
+    value = (float)number;
+    text = tokenEnd;
+    return true;
 }
 //----------------------------------------------------------------------------
-bool ObjLoader::GetTCoord (const vector<string>& tokens)
+ObjLoader::ErrorCode ObjLoader::ParseVertex (const char*& text,
+    const char* end, Chunk& chunk)
 {
-    if (tokens[0] == "vt")
+    // A vertex is one of the following.
+    // v
+    // v/vt
+    // v/vt/vn
+    // v/vt/
+    // v//vn
+    // v//
+    Vertex vertex;
+    size_t fixup = chunk.Vertices.size();
+    if (!ParseIndex(text, end, (int)chunk.Positions.size(), vertex.PosIndex,
+        chunk.PosFixups, fixup))
+    {
+        return EC_INVALID_VERTEX;
+    }
+
+    if (text < end && *text == '/')
     {
-        if (tokens.size() < 3)
+        ++text;
+        if (text < end && *text != '/' && !IsSpace(*text))
         {
-            assert(false);
-            mCode = EC_TOO_FEW_TOKENS;
-            return false;
+            if (!ParseIndex(text, end, (int)chunk.TCoords.size(),
+                vertex.TcdIndex, chunk.TcdFixups, fixup))
+            {
+                return EC_INVALID_VERTEX;
+            }
         }
-        if (tokens.size() > 3)
+
+        if (text < end && *text == '/')
         {
-            // TODO.  Need to handle 3D texture coordinates.
-            assert(false);
-            mCode = EC_TOO_MANY_TOKENS;
-            return false;
+            ++text;
+            if (text < end && !IsSpace(*text))
+            {
+                if (!ParseIndex(text, end, (int)chunk.Normals.size(),
+                    vertex.NorIndex, chunk.NorFixups, fixup))
+                {
+                    return EC_INVALID_VERTEX;
+                }
+            }
         }
+    }
 
-        Float2 tcd;
-        tcd.x = (float)atof(tokens[1].c_str());
-        tcd.y = (float)atof(tokens[2].c_str());
-        mTCoords.push_back(tcd);
-        return true;
+    if (text < end && !IsSpace(*text))
+    {
+        return EC_INVALID_VERTEX;
     }
-    return false;
+
+    chunk.Vertices.push_back(vertex);
+    return EC_SUCCESSFUL;
 }
 //----------------------------------------------------------------------------
-bool ObjLoader::GetNormal (const vector<string>& tokens)
+bool ObjLoader::ParseIndex (const char*& text, const char* end,
+    int numElements, int& index, vector<size_t>& fixups, size_t fixup)
 {
-    if (tokens[0] == "vn")
+    // Positive indices are 1-based indices into the elements of the file.
+    // Negative indices are relative to the end of the elements that precede
+    // the face.  The chunk knows only its own elements, so a negative index
+    // is stored relative to the chunk and is fixed up when merging.
+    bool negative = false;
+    if (text < end && *text == '-')
     {
-        if (tokens.size() < 4)
-        {
-            assert(false);
-            mCode = EC_TOO_FEW_TOKENS;
-            return false;
-        }
-        if (tokens.size() > 4)
+        negative = true;
+        ++text;
+    }
+    if (text == end || !IsDigit(*text))
+    {
+        return false;
+    }
+
+    int value = 0;
+    for (/**/; text < end && IsDigit(*text); ++text)
+    {
+        if (value > (INT_MAX - 9)/10)
         {
-            assert(false);
-            mCode = EC_TOO_MANY_TOKENS;
             return false;
         }
+        value = 10*value + (*text - '0');
+    }
+    if (value == 0)
+    {
+        return false;
+    }
 
-        Float3 nor;
-        nor.x = (float)atof(tokens[1].c_str());
-        nor.y = (float)atof(tokens[2].c_str());
-        nor.z = (float)atof(tokens[3].c_str());
-        mNormals.push_back(nor);
-        return true;
+    if (negative)
+    {
+        index = numElements - value;
+        fixups.push_back(fixup);
+    }
+    else
+    {
+        index = value - 1;
     }
-    return false;
+    return true;
 }
 //----------------------------------------------------------------------------
-bool ObjLoader::GetGroup (const vector<string>& tokens)
+bool ObjLoader::Merge (const string& path, vector<Chunk>& chunks,
+    const char* dataEnd, string& errorLine)
 {
-    if (tokens[0] == "g")
+    size_t numPositions = 0, numTCoords = 0, numNormals = 0;
+    for (size_t c = 0; c < chunks.size(); ++c)
+    {
+        numPositions += chunks[c].Positions.size();
+        numTCoords += chunks[c].TCoords.size();
+        numNormals += chunks[c].Normals.size();
+    }
+    mPositions.reserve(numPositions);
+    mTCoords.reserve(numTCoords);
+    mNormals.reserve(numNormals);
+
+    for (size_t c = 0; c < chunks.size(); ++c)
     {
-        if (tokens.size() == 1)
+        Chunk& chunk = chunks[c];
+        int posBase = (int)mPositions.size();
+        int tcdBase = (int)mTCoords.size();
+        int norBase = (int)mNormals.size();
+        if (!FixIndices(chunk.PosFixups, posBase, &Vertex::PosIndex, chunk)
+        ||  !FixIndices(chunk.TcdFixups, tcdBase, &Vertex::TcdIndex, chunk)
+        ||  !FixIndices(chunk.NorFixups, norBase, &Vertex::NorIndex, chunk)
+        ||  !CheckIndices(chunk, (int)numPositions, (int)numTCoords,
+                (int)numNormals))
         {
-            assert(false);
-            mCode = EC_TOO_FEW_TOKENS;
+            mCode = EC_INVALID_VERTEX;
             return false;
         }
 
-        if (tokens[1] == "default")
+        mPositions.insert(mPositions.end(), chunk.Positions.begin(),
+            chunk.Positions.end());
+        mTCoords.insert(mTCoords.end(), chunk.TCoords.begin(),
+            chunk.TCoords.end());
+        mNormals.insert(mNormals.end(), chunk.Normals.begin(),
+            chunk.Normals.end());
+
+        // Apply the commands in file order, each after the faces that
+        // precede it.
+        int face = 0, vertex = 0;
+        for (size_t i = 0; i < chunk.Commands.size(); ++i)
         {
-            assert(false);
-            mCode = EC_UNEXPECTED_TOKEN;
-            return false;
+            const Command& command = chunk.Commands[i];
+            AddFaces(chunk, command.NumFaces, face, vertex);
+
+            int cmdPos = posBase + command.NumPositions;
+            int cmdTcd = tcdBase + command.NumTCoords;
+            int cmdNor = norBase + command.NumNormals;
+            bool success = true;
+            switch (command.CommandType)
+            {
+            case Command::MTLLIB:
+                success = GetMaterialLibrary(path, command.Name);
+                break;
+            case Command::DEFAULT_GROUP:
+                GetDefaultGroup(cmdPos, cmdTcd, cmdNor);
+                break;
+            case Command::GROUP:
+                GetGroup(command.Name, cmdPos, cmdTcd, cmdNor);
+                break;
+            case Command::USEMTL:
+                success = GetMaterialAndMesh(command.Name);
+                break;
+            }
+            if (!success)
+            {
+                errorLine = GetLine(command.Line, dataEnd);
+                return false;
+            }
         }
+        AddFaces(chunk, (int)chunk.FaceCounts.size(), face, vertex);
 
-        mCurrentGroup = (int)mGroups.size();
-        mGroups.push_back(Group());
-        Group& group = mGroups[mCurrentGroup];
-        group.Name = tokens[1];
-        for (int i = 2; i < (int)tokens.size(); ++i)
-        {
-            group.Name += tokens[i];
-        }
-        group.PosStart = mCurrentPos;
-        group.TcdStart = mCurrentTcd;
-        group.NorStart = mCurrentNor;
-        mCurrentPos = (int)mPositions.size();
-        mCurrentTcd = (int)mTCoords.size();
-        mCurrentNor = (int)mNormals.size();
-        return true;
+        if (chunk.Code != EC_SUCCESSFUL)
+        {
+            mCode = chunk.Code;
+            errorLine = GetLine(chunk.ErrorLine, dataEnd);
+            return false;
+        }
     }
-    return false;
+    return true;
 }
 //----------------------------------------------------------------------------
-bool ObjLoader::GetMaterialAndMesh (const vector<string>& tokens)
+bool ObjLoader::FixIndices (const vector<size_t>& fixups, int base,
+    int Vertex::*member, Chunk& chunk)
 {
-    if (tokens[0] == "usemtl")
+    for (size_t i = 0; i < fixups.size(); ++i)
     {
-        if (tokens.size() == 1)
+        int& index = chunk.Vertices[fixups[i]].*member;
+        index += base;
+        if (index < 0)
         {
-            assert(false);
-            mCode = EC_TOO_FEW_TOKENS;
             return false;
         }
-        if (tokens.size() > 2)
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+bool ObjLoader::CheckIndices (const Chunk& chunk, int numPositions,
+    int numTCoords, int numNormals)
+{
+    // A positive index may refer to an element of a later chunk, so the
+    // indices are checked against the elements of the whole file.  The
+    // fixed-up relative indices are nonnegative, and -1 is an absent
+    // texture coordinate or normal.
+    for (size_t i = 0; i < chunk.Vertices.size(); ++i)
+    {
+        const Vertex& vertex = chunk.Vertices[i];
+        if (vertex.PosIndex < 0 || vertex.PosIndex >= numPositions
+        ||  vertex.TcdIndex < -1 || vertex.TcdIndex >= numTCoords
+        ||  vertex.NorIndex < -1 || vertex.NorIndex >= numNormals)
         {
-            assert(false);
-            mCode = EC_TOO_MANY_TOKENS;
             return false;
         }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+void ObjLoader::AddFaces (const Chunk& chunk, int numFaces, int& face,
+    int& vertex)
+{
+    if (face == numFaces)
+    {
+        return;
+    }
 
-        int i;
-        for (i = 0; i < (int)mMaterials.size(); ++i)
-        {
-            if (tokens[1] == mMaterials[i].Name)
-            {
-                break;
-            }
-        }
-        if (i == (int)mMaterials.size())
+    Mesh& mesh = GetCurrentMesh();
+    int first = (int)mesh.Vertices.size();
+    int vbegin = vertex;
+    for (/**/; face < numFaces; ++face)
+    {
+        Face newFace;
+        newFace.First = first + vertex - vbegin;
+        newFace.Count = chunk.FaceCounts[face];
+        mesh.Faces.push_back(newFace);
+        vertex += newFace.Count;
+    }
+    mesh.Vertices.insert(mesh.Vertices.end(), chunk.Vertices.begin() + vbegin,
+        chunk.Vertices.begin() + vertex);
+}
+//----------------------------------------------------------------------------
+bool ObjLoader::GetMaterialLibrary (const string& path, const string& name)
+{
+    MtlLoader loader(path, name);
+    if (loader.GetCode() != MtlLoader::EC_SUCCESSFUL)
+    {
+        mCode = EC_FAILED_TO_LOAD_MATERIALS;
+        return false;
+    }
+
+    mMaterials = loader.GetMaterials();
+    mMaterialLibrary = name;
+    return true;
+}
+//----------------------------------------------------------------------------
+void ObjLoader::GetDefaultGroup (int numPositions, int numTCoords,
+    int numNormals)
+{
+    mCurrentPos = numPositions;
+    mCurrentTcd = numTCoords;
+    mCurrentNor = numNormals;
+}
+//----------------------------------------------------------------------------
+void ObjLoader::GetGroup (const string& name, int numPositions,
+    int numTCoords, int numNormals)
+{
+    mCurrentGroup = (int)mGroups.size();
+    mGroups.push_back(Group());
+    Group& group = mGroups[mCurrentGroup];
+    group.Name = name;
+    group.PosStart = mCurrentPos;
+    group.TcdStart = mCurrentTcd;
+    group.NorStart = mCurrentNor;
+    mCurrentPos = numPositions;
+    mCurrentTcd = numTCoords;
+    mCurrentNor = numNormals;
+
+    // The current material applies to the faces of the new group.
+    mCurrentMesh = -1;
+}
+//----------------------------------------------------------------------------
+bool ObjLoader::GetMaterialAndMesh (const string& name)
+{
+    int i;
+    for (i = 0; i < (int)mMaterials.size(); ++i)
+    {
+        if (name == mMaterials[i].Name)
         {
-            assert(false);
-            mCode = EC_FAILED_TO_FIND_MATERIAL;
-            return false;
+            break;
         }
-        mCurrentMtl = i;
+    }
+    if (i == (int)mMaterials.size())
+    {
+        mCode = EC_FAILED_TO_FIND_MATERIAL;
+        return false;
+    }
+    mCurrentMtl = i;
+    mCurrentMesh = -1;
+    GetCurrentMesh();
+    return true;
+}
+//----------------------------------------------------------------------------
+ObjLoader::Mesh& ObjLoader::GetCurrentMesh ()
+{
+    if (mCurrentGroup < 0)
+    {
+        // The faces precede the first group.
+        mCurrentGroup = 0;
+        mGroups.push_back(Group());
+        Group& group = mGroups[0];
+        group.Name = "default";
+        group.PosStart = max(mCurrentPos, 0);
+        group.TcdStart = max(mCurrentTcd, 0);
+        group.NorStart = max(mCurrentNor, 0);
+    }
 
-        Group& group = mGroups[mCurrentGroup];
+    Group& group = mGroups[mCurrentGroup];
+    if (mCurrentMesh < 0)
+    {
+        int i;
         for (i = 0; i < (int)group.Meshes.size(); ++i)
         {
             if (group.Meshes[i].MtlIndex == mCurrentMtl)
@@ -356,71 +915,157 @@ bool ObjLoader::GetMaterialAndMesh (const vector<string>& tokens)
         }
         if (i == (int)group.Meshes.size())
         {
-            // Mesh with this material does not yet exist.
+            // Mesh with this material does not yet exist.  The material
+            // index is -1 for faces that precede the first usemtl.
             group.Meshes.push_back(Mesh());
             group.Meshes.back().MtlIndex = mCurrentMtl;
         }
-
         mCurrentMesh = i;
-        return true;
     }
-    return false;
+    return group.Meshes[mCurrentMesh];
 }
 //----------------------------------------------------------------------------
-bool ObjLoader::GetFace (const vector<string>& tokens)
+bool ObjLoader::LoadCache (const string& path, const string& cachePath,
+    uint64_t fileSize, int64_t fileTime)
 {
-    if (tokens[0] == "f")
+    // A missing cache is not an error, so test for the file before mapping
+    // it, because MemoryMappedFile reports the failure to open a file.
+    uint64_t cacheSize;
+    int64_t cacheTime;
+    gte::MemoryMappedFile file;
+    if (!GetFileStatus(cachePath, cacheSize, cacheTime)
+    ||  !file.Open(cachePath, gte::MemoryMappedFile::READ_ONLY))
+    {
+        return false;
+    }
+    const char* current = file.GetData();
+    const char* end = current + file.GetSize();
+
+    char magic[8];
+    uint64_t cacheFileSize;
+    int64_t cacheFileTime;
+    string materialLibrary;
+    vector<Float3> positions, normals;
+    vector<Float2> tcoords;
+    uint64_t numGroups;
+    if (!ReadCache(current, end, magic, 8)
+    ||  memcmp(magic, gsCacheMagic, 8) != 0
+    ||  !ReadCache(current, end, &cacheFileSize, 1)
+    ||  !ReadCache(current, end, &cacheFileTime, 1)
+    ||  cacheFileSize != fileSize
+    ||  cacheFileTime != fileTime
+    ||  !ReadCache(current, end, materialLibrary)
+    ||  !ReadCache(current, end, positions)
+    ||  !ReadCache(current, end, tcoords)
+    ||  !ReadCache(current, end, normals)
+    ||  !ReadCache(current, end, &numGroups, 1)
+    ||  numGroups > (uint64_t)(end - current))
     {
-        if (tokens.size() < 4)
+        return false;
+    }
+
+    vector<Group> groups((size_t)numGroups);
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        Group& group = groups[g];
+        uint64_t numMeshes;
+        if (!ReadCache(current, end, group.Name)
+        ||  !ReadCache(current, end, &group.PosStart, 1)
+        ||  !ReadCache(current, end, &group.TcdStart, 1)
+        ||  !ReadCache(current, end, &group.NorStart, 1)
+        ||  !ReadCache(current, end, &numMeshes, 1)
+        ||  numMeshes > (uint64_t)(end - current))
         {
-            // A face must have at least three vertices.
-            assert(false);
-            mCode = EC_TOO_FEW_TOKENS;
             return false;
         }
 
-        Group& group = mGroups[mCurrentGroup];
-        Mesh& mesh = group.Meshes[mCurrentMesh];
-        mesh.Faces.push_back(Face());
-        Face& face = mesh.Faces.back();
-
-        // A vertex is one of the following.
-        // v/vt/vn
-        // v/vt/
-        // v//vn
-        // v//
-        const int numVertices = (int)tokens.size() - 1;
-        face.Vertices.resize(numVertices);
-        for (int i = 0; i < numVertices; ++i)
-        {
-            string token = tokens[i+1];
-            string::size_type slash1 = token.find_first_of("/");
-            string::size_type slash2 = token.find_last_of("/");
-            if (slash1 == 0 || slash1 == string::npos
-            ||  slash2 == 0 || slash2 == string::npos
-            ||  slash1 == slash2)
+        group.Meshes.resize((size_t)numMeshes);
+        for (size_t m = 0; m < group.Meshes.size(); ++m)
+        {
+            Mesh& mesh = group.Meshes[m];
+            if (!ReadCache(current, end, &mesh.MtlIndex, 1)
+            ||  !ReadCache(current, end, mesh.Faces)
+            ||  !ReadCache(current, end, mesh.Vertices))
             {
-                assert(false);
-                mCode = EC_INVALID_VERTEX;
                 return false;
             }
+        }
+    }
+    if (current != end)
+    {
+        return false;
+    }
 
-            string pos = token.substr(0, slash1);
-            face.Vertices[i].PosIndex = atoi(pos.c_str()) - 1;
-            int numDigits = slash2 - slash1 - 1;
-            if (numDigits > 0)
-            {
-                string tcd = token.substr(slash1 + 1, numDigits);
-                face.Vertices[i].TcdIndex = atoi(tcd.c_str()) - 1;
-            }
-            if (token.length() > slash2 + 1)
+    // The materials are loaded from the material library rather than from
+    // the cache, so changes to the library are seen.
+    if (!materialLibrary.empty()
+    &&  !GetMaterialLibrary(path, materialLibrary))
+    {
+        mCode = EC_SUCCESSFUL;
+        mMaterials.clear();
+        mMaterialLibrary.clear();
+        return false;
+    }
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        for (size_t m = 0; m < groups[g].Meshes.size(); ++m)
+        {
+            int mtlIndex = groups[g].Meshes[m].MtlIndex;
+            if (mtlIndex < -1 || mtlIndex >= (int)mMaterials.size())
             {
-                string nor = token.substr(slash2 + 1, string::npos);
-                face.Vertices[i].NorIndex = atoi(nor.c_str()) - 1;
+                mMaterials.clear();
+                mMaterialLibrary.clear();
+                return false;
             }
         }
-        return true;
     }
-    return false;
+
+    mGroups.swap(groups);
+    mPositions.swap(positions);
+    mTCoords.swap(tcoords);
+    mNormals.swap(normals);
+    return true;
+}
+//----------------------------------------------------------------------------
+void ObjLoader::SaveCache (const string& cachePath, uint64_t fileSize,
+    int64_t fileTime) const
+{
+    vector<char> buffer;
+    WriteCache(buffer, gsCacheMagic, 8);
+    WriteCache(buffer, &fileSize, 1);
+    WriteCache(buffer, &fileTime, 1);
+    WriteCache(buffer, mMaterialLibrary);
+    WriteCache(buffer, mPositions);
+    WriteCache(buffer, mTCoords);
+    WriteCache(buffer, mNormals);
+    uint64_t numGroups = (uint64_t)mGroups.size();
+    WriteCache(buffer, &numGroups, 1);
+    for (size_t g = 0; g < mGroups.size(); ++g)
+    {
+        const Group& group = mGroups[g];
+        uint64_t numMeshes = (uint64_t)group.Meshes.size();
+        WriteCache(buffer, group.Name);
+        WriteCache(buffer, &group.PosStart, 1);
+        WriteCache(buffer, &group.TcdStart, 1);
+        WriteCache(buffer, &group.NorStart, 1);
+        WriteCache(buffer, &numMeshes, 1);
+        for (size_t m = 0; m < group.Meshes.size(); ++m)
+        {
+            const Mesh& mesh = group.Meshes[m];
+            WriteCache(buffer, &mesh.MtlIndex, 1);
+            WriteCache(buffer, mesh.Faces);
+            WriteCache(buffer, mesh.Vertices);
+        }
+    }
+
+    // A failure to write the cache is not an error of the load.  A partly
+    // written cache is rejected by LoadCache, because its data does not end
+    // where the file ends.
+    FILE* cacheFile = fopen(cachePath.c_str(), "wb");
+    if (cacheFile)
+    {
+        fwrite(&buffer[0], 1, buffer.size(), cacheFile);
+        fclose(cacheFile);
+    }
 }
 //----------------------------------------------------------------------------
@@ -4,7 +4,7 @@
 // http://www.boost.org/LICENSE_1_0.txt
 // http://www.geometrictools.com/License/Boost/LICENSE_1_0.txt
 //
-// File Version: 5.1.0 (2010/03/30)
+// File Version: 5.1.1 (2014/11/19)
 
 #include "ObjLoader.h"
 
@@ -20,5 +20,6 @@ const char* ObjLoader::msCodeString[EC_MAX_ERROR_CODES] =
     "Not yet implemented",          // EC_NOT_YET_IMPLEMENTED
     "Failed to load materials",     // EC_FAILED_TO_LOAD_MATERIALS
     "Failed to find material",      // EC_FAILED_TO_FIND_MATERIAL
-    "Invalid vertex"                // EC_INVALID_VERTEX
+    "Invalid vertex",               // EC_INVALID_VERTEX
+    "Invalid number"                // EC_INVALID_NUMBER
 };